@@ -35,6 +35,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <random>
 
 using namespace caret;
 using namespace std;
@@ -99,10 +100,19 @@ OperationParameters* AlgorithmCiftiCorrelationGradient::getParameters()
     secondCorrOpt->createOptionalParameter(2, "-no-demean-first", "instead of correlation for the FIRST operation, do dot product of rows, then normalize by diagonal");
     secondCorrOpt->createOptionalParameter(3, "-covariance-first", "instead of correlation for the FIRST operation, compute covariance");
     
+    OptionalParameter* lowRankOpt = ret->createOptionalParameter(16, "-low-rank", "approximate the correlations from a truncated basis of the timeseries");
+    lowRankOpt->addDoubleParameter(1, "variance", "fraction of the variance of the normalized timeseries to keep, such as 0.99");
+    
     ret->setHelpText(
         AString("For each structure, compute the correlation of the rows in the structure, and take the gradients of ") +
         "the resulting rows, then average them.  " +
-        "Memory limit does not need to be an integer, you may also specify 0 to use as little memory as possible (this may be very slow)."
+        "Memory limit does not need to be an integer, you may also specify 0 to use as little memory as possible (this may be very slow).\n\n" +
+        "The -low-rank option projects the demeaned, normalized rows onto the smallest set of principal components " +
+        "(found by randomized subspace iteration) that keeps the specified fraction of their total variance, " +
+        "and computes each correlation as a dot product of the projections, which is much faster when the number of components is much smaller than the number of timepoints.  " +
+        "If keeping that fraction of the variance needs more than about 3/8 as many components as there are timepoints, or the basis or projected rows would not fit in the memory limit, " +
+        "the full correlation is computed instead.  " +
+        "It cannot be used with -covariance or -double-correlation."
     );
     return ret;
 }
@@ -202,9 +212,19 @@ void AlgorithmCiftiCorrelationGradient::useParameters(OperationParameters* myPar
         firstNoDemean = doubleCorrOpt->getOptionalParameter(2)->m_present;
         firstCovar = doubleCorrOpt->getOptionalParameter(3)->m_present;
     }
+    float lowRankVariance = -1.0f;
+    OptionalParameter* lowRankOpt = myParams->getOptionalParameter(16);
+    if (lowRankOpt->m_present)
+    {
+        lowRankVariance = (float)lowRankOpt->getDouble(1);
+        if (!(lowRankVariance > 0.0f && lowRankVariance < 1.0f))
+        {
+            throw AlgorithmException("low rank variance fraction must be greater than 0 and less than 1");
+        }
+    }
     AlgorithmCiftiCorrelationGradient(myProgObj, myCifti, myCiftiOut, myLeftSurf, myRightSurf, myCerebSurf, myLeftAreas, myRightAreas, myCerebAreas,
                                       surfKern, volKern, undoFisherInput, applyFisher, surfaceExclude, volumeExclude, covariance, memLimitGB,
-                                      doubleCorr, firstFisher, firstNoDemean, firstCovar);
+                                      doubleCorr, firstFisher, firstNoDemean, firstCovar, lowRankVariance);
 }
 
 AlgorithmCiftiCorrelationGradient::AlgorithmCiftiCorrelationGradient(ProgressObject* myProgObj, CiftiFile* myCifti, CiftiFile* myCiftiOut,
@@ -214,10 +234,11 @@ AlgorithmCiftiCorrelationGradient::AlgorithmCiftiCorrelationGradient(ProgressObj
                                                                      const float& surfaceExclude, const float& volumeExclude,
                                                                      const bool& covariance,
                                                                      const float& memLimitGB,
-                                                                     const bool doubleCorr, const bool firstFisher, const bool firstNoDemean, const bool firstCovar) : AbstractAlgorithm(myProgObj)
+                                                                     const bool doubleCorr, const bool firstFisher, const bool firstNoDemean, const bool firstCovar,
+                                                                     const float lowRankVariance) : AbstractAlgorithm(myProgObj)
 {
     LevelProgress myProgress(myProgObj);
-    init(myCifti, memLimitGB, undoFisherInput, applyFisher, covariance, doubleCorr, firstFisher, firstNoDemean, firstCovar);
+    init(myCifti, memLimitGB, undoFisherInput, applyFisher, covariance, doubleCorr, firstFisher, firstNoDemean, firstCovar, lowRankVariance);
     const CiftiXML& myXML = myCifti->getCiftiXML();
     CiftiXML myNewXML = myXML;
     CiftiScalarsMap newMap(1);
@@ -453,6 +474,115 @@ namespace
         //unlike ordinary correlation, the memory for storing the in-progress output has already been dictated to us, so there is no advantage to chunking any smaller than the input cache
         return ret;
     }
+    
+    //reads rows and makes them demeaned and unit length, so that correlation is their dot product, rows with no variance become zero
+    void readNormalizedRows(CiftiFile* input, const int64_t firstRow, const int64_t endRow, vector<AlgorithmCiftiCorrelationGradient::RowInfo>& rowInfo,
+                            const bool undoFisher, float* rowsOut)
+    {
+        const int64_t rowLength = input->getNumberOfColumns();
+        for (int64_t i = firstRow; i < endRow; ++i)
+        {//sequential reading
+            input->getRow(rowsOut + (i - firstRow) * rowLength, i);
+        }
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t i = firstRow; i < endRow; ++i)
+        {
+            float* row = rowsOut + (i - firstRow) * rowLength;
+            adjustRow(row, rowLength, rowInfo[i], undoFisher, false, false);
+            float scale = 0.0f;
+            if (rowInfo[i].m_rootResidSqr > 0.0f) scale = 1.0f / rowInfo[i].m_rootResidSqr;
+            for (int64_t j = 0; j < rowLength; ++j)
+            {
+                row[j] *= scale;
+            }
+        }
+    }
+    
+    //modified gram-schmidt, vectors that are numerically dependent on the previous ones become zero
+    void orthonormalize(vector<vector<double> >& vectors)
+    {
+        const int64_t numVectors = (int64_t)vectors.size();
+        for (int64_t i = 0; i < numVectors; ++i)
+        {
+            vector<double>& current = vectors[i];
+            const int64_t length = (int64_t)current.size();
+            double origNorm = 0.0;
+            for (int64_t k = 0; k < length; ++k) origNorm += current[k] * current[k];
+            for (int pass = 0; pass < 2; ++pass)//second pass fixes the loss of orthogonality from cancellation
+            {
+                for (int64_t j = 0; j < i; ++j)
+                {
+                    const vector<double>& previous = vectors[j];
+                    double proj = 0.0;
+                    for (int64_t k = 0; k < length; ++k) proj += current[k] * previous[k];
+                    for (int64_t k = 0; k < length; ++k) current[k] -= proj * previous[k];
+                }
+            }
+            double norm = 0.0;
+            for (int64_t k = 0; k < length; ++k) norm += current[k] * current[k];
+            if (norm <= origNorm * 1e-20 || norm == 0.0)
+            {
+                current.assign(length, 0.0);
+            } else {
+                norm = sqrt(norm);
+                for (int64_t k = 0; k < length; ++k) current[k] /= norm;
+            }
+        }
+    }
+    
+    //cyclic jacobi, matrix is destroyed, vectorsOut[i][j] is element i of eigenvector j
+    void symmetricEigen(vector<vector<double> >& matrix, vector<double>& valuesOut, vector<vector<double> >& vectorsOut)
+    {
+        const int64_t size = (int64_t)matrix.size();
+        vectorsOut.assign(size, vector<double>(size, 0.0));
+        double total = 0.0;
+        for (int64_t i = 0; i < size; ++i)
+        {
+            vectorsOut[i][i] = 1.0;
+            for (int64_t j = 0; j < size; ++j) total += matrix[i][j] * matrix[i][j];
+        }
+        for (int sweep = 0; sweep < 100; ++sweep)
+        {
+            double offDiag = 0.0;
+            for (int64_t p = 0; p < size; ++p)
+            {
+                for (int64_t q = p + 1; q < size; ++q) offDiag += matrix[p][q] * matrix[p][q];
+            }
+            if (offDiag <= total * 1e-24) break;
+            for (int64_t p = 0; p < size; ++p)
+            {
+                for (int64_t q = p + 1; q < size; ++q)
+                {
+                    const double apq = matrix[p][q];
+                    if (apq == 0.0) continue;
+                    const double theta = (matrix[q][q] - matrix[p][p]) / (2.0 * apq);
+                    double t = 1.0 / (fabs(theta) + sqrt(theta * theta + 1.0));
+                    if (theta < 0.0) t = -t;
+                    const double c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+                    for (int64_t k = 0; k < size; ++k)
+                    {
+                        const double akp = matrix[k][p], akq = matrix[k][q];
+                        matrix[k][p] = c * akp - s * akq;
+                        matrix[k][q] = s * akp + c * akq;
+                    }
+                    for (int64_t k = 0; k < size; ++k)
+                    {
+                        const double apk = matrix[p][k], aqk = matrix[q][k];
+                        matrix[p][k] = c * apk - s * aqk;
+                        matrix[q][k] = s * apk + c * aqk;
+                    }
+                    for (int64_t k = 0; k < size; ++k)
+                    {
+                        const double vkp = vectorsOut[k][p], vkq = vectorsOut[k][q];
+                        vectorsOut[k][p] = c * vkp - s * vkq;
+                        vectorsOut[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+        valuesOut.resize(size);
+        for (int64_t i = 0; i < size; ++i) valuesOut[i] = matrix[i][i];
+    }
 }
 
 void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::Enum& myStructure, const float& surfKern, const float& memLimitGB, SurfaceFile* mySurf, const MetricFile* myAreas)
@@ -1109,7 +1239,8 @@ void AlgorithmCiftiCorrelationGradient::processVolumeComponent(StructureEnum::En
 }
 
 void AlgorithmCiftiCorrelationGradient::init(CiftiFile* input, const float& memLimitGB, const bool& undoFisherInput, const bool& applyFisher,
-                                             const bool& covariance, const bool doubleCorr, const bool firstFisher, const bool firstNoDemean, const bool firstCovar)
+                                             const bool& covariance, const bool doubleCorr, const bool firstFisher, const bool firstNoDemean, const bool firstCovar,
+                                             const float lowRankVariance)
 {
     if (input->getCiftiXML().getMappingType(CiftiXML::ALONG_COLUMN) != CiftiMappingType::BRAIN_MODELS) throw AlgorithmException("input cifti file must have brain models mapping along column");
     if (covariance)
@@ -1138,11 +1269,206 @@ void AlgorithmCiftiCorrelationGradient::init(CiftiFile* input, const float& memL
     m_memLimitGB = memLimitGB;
     m_rowInfo.resize(colLength);
     m_outColumn.resize(colLength);
+    m_lowRankVariance = lowRankVariance;
+    m_lowRankComponents = 0;
+    if (lowRankVariance > 0.0f)
+    {
+        if (covariance) throw AlgorithmException("low rank mode cannot be used with covariance");
+        if (doubleCorr) throw AlgorithmException("low rank mode cannot be used with double correlation");
+        computeLowRankRows();
+        if (!m_lowRankRows.empty())
+        {
+            m_numCols = (int64_t)m_lowRankRows.size() / colLength;//the row length used by everything else is now the number of components
+        }
+    }
+}
+
+void AlgorithmCiftiCorrelationGradient::computeLowRankRows()
+{
+    m_lowRankRows.clear();
+    m_lowRankComponents = 0;
+    const int64_t numRows = m_inputCifti->getNumberOfRows(), rowLength = m_inputCifti->getNumberOfColumns();
+    //gram matrix of the normalized rows, its eigenvectors are the principal components, and its trace is the total variance
+    const int64_t blockSize = 256;
+    int64_t limitBytes = -1;
+    if (m_memLimitGB >= 0.0f)
+    {
+        limitBytes = (int64_t)(m_memLimitGB * 1024 * 1024 * 1024);
+        //gram matrix, plus the subspace and its product, which are at most half its size each
+        int64_t basisBytes = 2 * rowLength * rowLength * sizeof(double) + blockSize * rowLength * sizeof(float);
+        if (m_inputCifti->isInMemory()) basisBytes += sizeof(float) * rowLength * numRows;
+        if (basisBytes > limitBytes)
+        {
+            CaretLogInfo("low rank basis would exceed the memory limit, computing full correlation");
+            return;
+        }
+    }
+    vector<vector<double> > gram(rowLength, vector<double>(rowLength, 0.0));
+    vector<float> block(blockSize * rowLength);
+    for (int64_t blockStart = 0; blockStart < numRows; blockStart += blockSize)
+    {
+        const int64_t blockEnd = min(numRows, blockStart + blockSize);
+        readNormalizedRows(m_inputCifti, blockStart, blockEnd, m_rowInfo, m_undoFisherInput, block.data());
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t a = 0; a < rowLength; ++a)
+        {
+            double* gramRow = gram[a].data();
+            for (int64_t r = 0; r < blockEnd - blockStart; ++r)
+            {
+                const float* blockRow = block.data() + r * rowLength;
+                const double scale = blockRow[a];
+                if (scale == 0.0) continue;
+                for (int64_t b = a; b < rowLength; ++b)//upper triangle only
+                {
+                    gramRow[b] += scale * blockRow[b];
+                }
+            }
+        }
+    }
+    double totalVariance = 0.0;
+    for (int64_t a = 0; a < rowLength; ++a)
+    {
+        totalVariance += gram[a][a];
+        for (int64_t b = 0; b < a; ++b)
+        {
+            gram[a][b] = gram[b][a];
+        }
+    }
+    if (totalVariance <= 0.0) return;
+    //randomized subspace iteration, increasing the subspace until it contains enough variance with some oversampling
+    mt19937 myRand(1);//fixed seed, so the output doesn't change between runs
+    normal_distribution<double> myDist;
+    vector<double> values;
+    vector<vector<double> > subspace, smallVectors;
+    int64_t numComponents = -1;
+    const int64_t maxSubspace = rowLength / 2;//beyond this, the dot products of projections aren't much cheaper than the full correlation
+    if (maxSubspace < 2) return;
+    for (int64_t subspaceSize = min(maxSubspace, (int64_t)64); ; subspaceSize = min(maxSubspace, subspaceSize * 2))
+    {
+        subspace.assign(subspaceSize, vector<double>(rowLength));
+        for (int64_t i = 0; i < subspaceSize; ++i)
+        {
+            for (int64_t j = 0; j < rowLength; ++j)
+            {
+                subspace[i][j] = myDist(myRand);
+            }
+        }
+        orthonormalize(subspace);
+        vector<vector<double> > product(subspaceSize, vector<double>(rowLength));
+        const int numIterations = 4;
+        for (int iter = 0; iter <= numIterations; ++iter)
+        {
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int64_t i = 0; i < subspaceSize; ++i)
+            {
+                for (int64_t a = 0; a < rowLength; ++a)
+                {
+                    double accum = 0.0;
+                    const double* gramRow = gram[a].data();
+                    for (int64_t b = 0; b < rowLength; ++b) accum += gramRow[b] * subspace[i][b];
+                    product[i][a] = accum;
+                }
+            }
+            if (iter == numIterations) break;//keep the last orthonormal subspace for the rayleigh-ritz step
+            subspace.swap(product);
+            orthonormalize(subspace);
+        }
+        vector<vector<double> > smallMatrix(subspaceSize, vector<double>(subspaceSize));
+        for (int64_t i = 0; i < subspaceSize; ++i)
+        {
+            for (int64_t j = 0; j < subspaceSize; ++j)
+            {
+                double accum = 0.0;
+                for (int64_t b = 0; b < rowLength; ++b) accum += subspace[i][b] * product[j][b];
+                smallMatrix[i][j] = accum;
+            }
+        }
+        for (int64_t i = 0; i < subspaceSize; ++i)
+        {//make exactly symmetric
+            for (int64_t j = 0; j < i; ++j)
+            {
+                double temp = (smallMatrix[i][j] + smallMatrix[j][i]) / 2.0;
+                smallMatrix[i][j] = temp;
+                smallMatrix[j][i] = temp;
+            }
+        }
+        symmetricEigen(smallMatrix, values, smallVectors);
+        vector<int64_t> order(subspaceSize);
+        for (int64_t i = 0; i < subspaceSize; ++i) order[i] = i;
+        sort(order.begin(), order.end(), [&values](const int64_t left, const int64_t right) { return values[left] > values[right]; });
+        double kept = 0.0;
+        for (int64_t i = 0; i < subspaceSize * 3 / 4; ++i)//don't trust the components near the end of the subspace
+        {
+            kept += values[order[i]];
+            if (kept >= m_lowRankVariance * totalVariance)
+            {
+                numComponents = i + 1;
+                break;
+            }
+        }
+        if (numComponents > 0 && limitBytes >= 0)
+        {
+            int64_t projectedBytes = sizeof(float) * numRows * numComponents + sizeof(double) * numComponents * rowLength;
+            if (m_inputCifti->isInMemory()) projectedBytes += sizeof(float) * rowLength * numRows;
+            if (projectedBytes > limitBytes)
+            {
+                CaretLogInfo("low rank rows would exceed the memory limit, computing full correlation");
+                return;
+            }
+        }
+        if (numComponents > 0)
+        {
+            CaretLogInfo("low rank correlation using " + AString::number(numComponents) + " components, keeping " +
+                         AString::number(100.0 * kept / totalVariance) + "% of the variance");
+            //convert the top eigenvectors of the small matrix to basis vectors for the rows
+            vector<vector<double> > basis(numComponents, vector<double>(rowLength, 0.0));
+            for (int64_t c = 0; c < numComponents; ++c)
+            {
+                for (int64_t i = 0; i < subspaceSize; ++i)
+                {
+                    const double weight = smallVectors[i][order[c]];
+                    for (int64_t b = 0; b < rowLength; ++b) basis[c][b] += weight * subspace[i][b];
+                }
+            }
+            subspace.clear();
+            product.clear();
+            gram.clear();
+            vector<vector<float> > floatBasis(numComponents, vector<float>(rowLength));
+            for (int64_t c = 0; c < numComponents; ++c)
+            {
+                for (int64_t b = 0; b < rowLength; ++b) floatBasis[c][b] = basis[c][b];
+            }
+            m_lowRankRows.resize(numRows * numComponents);
+            for (int64_t blockStart = 0; blockStart < numRows; blockStart += blockSize)
+            {
+                const int64_t blockEnd = min(numRows, blockStart + blockSize);
+                readNormalizedRows(m_inputCifti, blockStart, blockEnd, m_rowInfo, m_undoFisherInput, block.data());
+#pragma omp CARET_PARFOR schedule(dynamic)
+                for (int64_t r = blockStart; r < blockEnd; ++r)
+                {
+                    const float* blockRow = block.data() + (r - blockStart) * rowLength;
+                    float* projected = m_lowRankRows.data() + r * numComponents;
+                    for (int64_t c = 0; c < numComponents; ++c)
+                    {
+                        projected[c] = dsdot(blockRow, floatBasis[c].data(), rowLength);
+                    }
+                }
+            }
+            m_lowRankComponents = numComponents;
+            return;
+        }
+        if (subspaceSize == maxSubspace)
+        {
+            CaretLogInfo("low rank basis would need more than " + AString::number(maxSubspace * 3 / 4) + " components to keep the requested variance, computing full correlation");
+            return;
+        }
+    }
 }
 
 void AlgorithmCiftiCorrelationGradient::cacheRows(const vector<int64_t>& ciftiIndices, const int64_t mapSize)
 {
     clearCache();//clear first, to be sure we never keep a cache around too long
+    if (!m_lowRankRows.empty()) return;//all projected rows are already in memory
     int64_t numIndices = (int64_t)ciftiIndices.size();
     m_rowCache.resize(numIndices, CacheRow(m_numCols));
     if (m_doubleCorr)
@@ -1268,6 +1594,11 @@ const float* AlgorithmCiftiCorrelationGradient::getRow(const int& ciftiIndex, fl
 {
     float* ret;
     CaretAssertVectorIndex(m_rowInfo, ciftiIndex);
+    if (!m_lowRankRows.empty())
+    {//projections of normalized rows, so their dot product is the correlation
+        rootResidSqr = (m_rowInfo[ciftiIndex].m_rootResidSqr > 0.0f ? 1.0f : 0.0f);//zero for rows with no variance, so they give NaN like the full correlation does
+        return m_lowRankRows.data() + ciftiIndex * m_numCols;
+    }
     if (m_rowInfo[ciftiIndex].m_cacheIndex != -1)
     {
         ret = m_rowCache[m_rowInfo[ciftiIndex].m_cacheIndex].m_row.data();
@@ -1314,6 +1645,7 @@ int AlgorithmCiftiCorrelationGradient::numRowsForMem(const int64_t& inrowBytes,
         targetBytes -= inputFileSize;//count in-memory input against the total too
     }
     targetBytes -= numRows * sizeof(RowInfo) + 2 * outrowBytes;//storage for mean, stdev, and info about caching, output structures
+    targetBytes -= m_lowRankRows.size() * sizeof(float);//low rank mode keeps all projected rows in memory
     if (targetBytes < 1)
     {
         if (!inputIsMemory) CaretLogWarning("extremely low memory limit used, this may take a long time and do a lot of IO");
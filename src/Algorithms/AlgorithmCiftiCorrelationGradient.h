@@ -61,11 +61,15 @@ namespace caret {
         int64_t m_rowLengthFirst;//for -double-correlation
         bool m_doubleCorr, m_firstCovar, m_firstNoDemean, m_firstFisher;
         float m_memLimitGB;
+        float m_lowRankVariance;//fraction of variance to keep in the truncated basis, negative for full rank
+        std::vector<float> m_lowRankRows;//normalized rows projected onto the truncated basis, m_numCols long
+        int64_t m_lowRankComponents;//number of components in the truncated basis, 0 when computing the full correlation
+        void computeLowRankRows();//returns with m_lowRankRows empty if the basis wouldn't be much smaller than the rows
         void cacheRows(const std::vector<int64_t>& ciftiIndices, const int64_t mapSize);//grabs the rows and does whatever it needs to, using as much IO bandwidth and CPU resources as available/needed
         void clearCache();
         const float* getRow(const int& ciftiIndex, float& rootResidSqr, float* scratchStorage);
         void init(CiftiFile* input, const float& memLimitGB, const bool& undoFisherInput, const bool& applyFisher, const bool& covariance,
-                  const bool doubleCorr, const bool firstFisher, const bool firstNoDemean, const bool firstCovar);
+                  const bool doubleCorr, const bool firstFisher, const bool firstNoDemean, const bool firstCovar, const float lowRankVariance);
         int numRowsForMem(const int64_t& inrowBytes, const int64_t& outrowBytes, const int& numRows, bool& cacheFullInput);
         //void processSurfaceComponentLocal(StructureEnum::Enum& myStructure, const float& surfKern, const float& memLimitGB, SurfaceFile* mySurf);
         void processSurfaceComponent(StructureEnum::Enum& myStructure, const float& surfKern, const float& memLimitGB, SurfaceFile* mySurf, const MetricFile* myAreas);
@@ -84,7 +88,10 @@ namespace caret {
                                           const float& surfaceExclude = -1.0f, const float& volumeExclude = -1.0f,
                                           const bool& covariance = false,
                                           const float& memLimitGB = -1.0f,
-                                          const bool doubleCorr = false, const bool firstFisher = false, const bool firstNoDemean = false, const bool firstCovar = false);
+                                          const bool doubleCorr = false, const bool firstFisher = false, const bool firstNoDemean = false, const bool firstCovar = false,
+                                          const float lowRankVariance = -1.0f);
+        ///number of components the low rank approximation used, 0 if the full correlation was computed
+        int64_t getLowRankComponents() const { return m_lowRankComponents; }
         static OperationParameters* getParameters();
         static void useParameters(OperationParameters* myParams, ProgressObject* myProgObj);
         static AString getCommandSwitch();
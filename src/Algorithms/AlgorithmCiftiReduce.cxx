@@ -26,11 +26,17 @@
 #include "MultiDimIterator.h"
 #include "ReductionOperation.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    const int64_t ROW_BLOCK_ELEMENTS = 1 << 24;//when reducing along rows, read this many values worth of rows, then reduce them in parallel
+}
+
 AString AlgorithmCiftiReduce::getCommandSwitch()
 {
     return "-cifti-reduce";
@@ -112,18 +118,28 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
         {
             CaretLogWarning("-cifti-reduce is being used for a length=1 reduction on file '" + ciftiIn->getFileName() + "'");
         }
-        vector<float> scratchInRow(inDims[0]);
-        for (MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end())); !iter.atEnd(); ++iter)
-        {// + 1 to exclude row dimension, because getRow/setRow
-            ciftiIn->getRow(scratchInRow.data(), *iter);
-            float result = -1;
-            if (onlyNumeric)
+        int64_t numRows = 1;
+        for (int i = 1; i < (int)inDims.size(); ++i)
+        {
+            numRows *= inDims[i];
+        }
+        const int64_t rowsPerBlock = max(int64_t(1), min(numRows, ROW_BLOCK_ELEMENTS / inDims[0]));
+        vector<float> scratchInRows(rowsPerBlock * inDims[0]), results(rowsPerBlock);
+        vector<vector<int64_t> > blockIndices;
+        MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end()));// + 1 to exclude row dimension, because getRow/setRow
+        while (!iter.atEnd())
+        {
+            blockIndices.clear();
+            for (; !iter.atEnd() && (int64_t)blockIndices.size() < rowsPerBlock; ++iter)
             {
-                result = ReductionOperation::reduceOnlyNumeric(scratchInRow.data(), inDims[0], myReduce);
-            } else {
-                result = ReductionOperation::reduce(scratchInRow.data(), inDims[0], myReduce);
+                ciftiIn->getRow(scratchInRows.data() + blockIndices.size() * inDims[0], *iter);
+                blockIndices.push_back(*iter);
+            }
+            ReductionOperation::reduceRows(scratchInRows.data(), blockIndices.size(), inDims[0], myReduce, results.data(), onlyNumeric);
+            for (int64_t i = 0; i < (int64_t)blockIndices.size(); ++i)
+            {
+                ciftiOut->setRow(results.data() + i, blockIndices[i]);//if reducing along row, length of output row is 1
             }
-            ciftiOut->setRow(&result, *iter);//if reducing along row, length of output row is 1
         }
     } else {
         if (inDims[direction] == 1 && ! ReductionOperation::isLengthOneReasonable(myReduce))
@@ -131,7 +147,12 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
             CaretLogWarning("-cifti-reduce is being used for a length=1 reduction on file '" + ciftiIn->getFileName() + "'");
         }
         vector<vector<float> > scratchInRows(inDims[direction], vector<float>(inDims[0]));
-        vector<float> outRow(inDims[0]), reduceScratch(inDims[direction]);//reduction isn't along row, so out rows will be same length as in rows
+        vector<float> outRow(inDims[0]);//reduction isn't along row, so out rows will be same length as in rows
+        vector<const float*> rowPointers(inDims[direction]);//reduce across the rows directly, no transposing
+        for (int64_t i = 0; i < inDims[direction]; ++i)
+        {
+            rowPointers[i] = scratchInRows[i].data();
+        }
         vector<int64_t> otherDims = inDims;
         otherDims.erase(otherDims.begin() + direction);//direction isn't 0
         otherDims.erase(otherDims.begin());//remove row direction because getRow/setRow
@@ -144,19 +165,7 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
                 indexvec[direction - 1] = i;
                 ciftiIn->getRow(scratchInRows[i].data(), indexvec);
             }
-            for (int64_t i = 0; i < inDims[0]; ++i)
-            {
-                for (int64_t j = 0; j < inDims[direction]; ++j)
-                {//need reduction input in contiguous array
-                    reduceScratch[j] = scratchInRows[j][i];
-                }
-                if (onlyNumeric)
-                {
-                    outRow[i] = ReductionOperation::reduceOnlyNumeric(reduceScratch.data(), inDims[direction], myReduce);
-                } else {
-                    outRow[i] = ReductionOperation::reduce(reduceScratch.data(), inDims[direction], myReduce);
-                }
-            }
+            ReductionOperation::reduceAcross(rowPointers, inDims[0], myReduce, outRow.data(), onlyNumeric);
             indexvec[direction - 1] = 0;//only one element along reduce output direction
             ciftiOut->setRow(outRow.data(), indexvec);
         }
@@ -179,16 +188,37 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
     vector<int64_t> inDims = inputXML.getDimensions();
     if (direction == CiftiXML::ALONG_ROW)
     {
-        vector<float> scratchInRow(inDims[0]);
-        for (MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end())); !iter.atEnd(); ++iter)
-        {// + 1 to exclude row dimension, because getRow/setRow
-            ciftiIn->getRow(scratchInRow.data(), *iter);
-            float result = ReductionOperation::reduceExcludeDev(scratchInRow.data(), inDims[0], myReduce, sigmaBelow, sigmaAbove);
-            ciftiOut->setRow(&result, *iter);//if reducing along row, length of output row is 1
+        int64_t numRows = 1;
+        for (int i = 1; i < (int)inDims.size(); ++i)
+        {
+            numRows *= inDims[i];
+        }
+        const int64_t rowsPerBlock = max(int64_t(1), min(numRows, ROW_BLOCK_ELEMENTS / inDims[0]));
+        vector<float> scratchInRows(rowsPerBlock * inDims[0]), results(rowsPerBlock);
+        vector<vector<int64_t> > blockIndices;
+        MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end()));// + 1 to exclude row dimension, because getRow/setRow
+        while (!iter.atEnd())
+        {
+            blockIndices.clear();
+            for (; !iter.atEnd() && (int64_t)blockIndices.size() < rowsPerBlock; ++iter)
+            {
+                ciftiIn->getRow(scratchInRows.data() + blockIndices.size() * inDims[0], *iter);
+                blockIndices.push_back(*iter);
+            }
+            ReductionOperation::reduceRowsExcludeDev(scratchInRows.data(), blockIndices.size(), inDims[0], myReduce, sigmaBelow, sigmaAbove, results.data());
+            for (int64_t i = 0; i < (int64_t)blockIndices.size(); ++i)
+            {
+                ciftiOut->setRow(results.data() + i, blockIndices[i]);//if reducing along row, length of output row is 1
+            }
         }
     } else {
         vector<vector<float> > scratchInRows(inDims[direction], vector<float>(inDims[0]));
-        vector<float> outRow(inDims[0]), reduceScratch(inDims[direction]);//reduction isn't along row, so out rows will be same length as in rows
+        vector<float> outRow(inDims[0]);//reduction isn't along row, so out rows will be same length as in rows
+        vector<const float*> rowPointers(inDims[direction]);//reduce across the rows directly, no transposing
+        for (int64_t i = 0; i < inDims[direction]; ++i)
+        {
+            rowPointers[i] = scratchInRows[i].data();
+        }
         vector<int64_t> otherDims = inDims;
         otherDims.erase(otherDims.begin() + direction);//direction isn't 0
         otherDims.erase(otherDims.begin());//remove row direction because getRow/setRow
@@ -201,14 +231,7 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
                 indexvec[direction - 1] = i;
                 ciftiIn->getRow(scratchInRows[i].data(), indexvec);
             }
-            for (int64_t i = 0; i < inDims[0]; ++i)
-            {
-                for (int64_t j = 0; j < inDims[direction]; ++j)
-                {//need reduction input in contiguous array
-                    reduceScratch[j] = scratchInRows[j][i];
-                }
-                outRow[i] = ReductionOperation::reduceExcludeDev(reduceScratch.data(), inDims[direction], myReduce, sigmaBelow, sigmaAbove);
-            }
+            ReductionOperation::reduceAcrossExcludeDev(rowPointers, inDims[0], myReduce, sigmaBelow, sigmaAbove, outRow.data());
             indexvec[direction - 1] = 0;//only one element along reduce output direction
             ciftiOut->setRow(outRow.data(), indexvec);
         }
@@ -20,8 +20,17 @@
 
 #include "AlgorithmCiftiTranspose.h"
 #include "AlgorithmException.h"
+
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cstring>
+
 using namespace caret;
 using namespace std;
 
@@ -47,7 +56,9 @@ OperationParameters* AlgorithmCiftiTranspose::getParameters()
     
     ret->setHelpText(
         AString("The input must be a 2-dimensional cifti file.  ") +
-        "The output is a cifti file where every row in the input is a column in the output."
+        "The output is a cifti file where every row in the input is a column in the output.\n\n" +
+        "If -mem-limit is too small to hold the output in a few passes over the input, the input is instead read once, " +
+        "using a scratch file as large as the output, placed in the same directory as the output file."
     );
     return ret;
 }
@@ -69,6 +80,111 @@ void AlgorithmCiftiTranspose::useParameters(OperationParameters* myParams, Progr
     AlgorithmCiftiTranspose(myProgObj, ciftiIn, ciftiOut, memLimitGB);
 }
 
+namespace
+{
+    const int64_t TILE = 16;//16x16 floats is 4 cache lines per side, so both the reads and the writes stay in L1
+    
+    //out[(c - colStart) * outStride + r] = in[r * inStride + c], for r in [0, numRows) and c in [colStart, colEnd)
+    void transposeBlock(const float* in, const int64_t& inStride, const int64_t& numRows, const int64_t& colStart, const int64_t& colEnd, float* out, const int64_t& outStride)
+    {
+#pragma omp CARET_PARFOR schedule(static)
+        for (int64_t tileCol = colStart; tileCol < colEnd; tileCol += TILE)
+        {
+            const int64_t tileColEnd = min(tileCol + TILE, colEnd);
+            for (int64_t tileRow = 0; tileRow < numRows; tileRow += TILE)
+            {
+                const int64_t tileRowEnd = min(tileRow + TILE, numRows);
+                for (int64_t c = tileCol; c < tileColEnd; ++c)
+                {
+                    float* outPtr = out + (c - colStart) * outStride;
+                    for (int64_t r = tileRow; r < tileRowEnd; ++r)
+                    {
+                        outPtr[r] = in[r * inStride + c];
+                    }
+                }
+            }
+        }
+    }
+    
+    //read the input once per chunk of output rows, best when the input is in memory or there are only a few chunks
+    void transposeMultiPass(const CiftiFile* ciftiIn, CiftiFile* ciftiOut, const int64_t& rowSize, const int64_t& colSize, const int64_t& numCacheRows)
+    {
+        vector<float> cache(numCacheRows * rowSize), panel(TILE * colSize);
+        for (int64_t chunkStart = 0; chunkStart < colSize; chunkStart += numCacheRows)
+        {
+            const int64_t chunkEnd = min(chunkStart + numCacheRows, colSize);
+            for (int64_t panelStart = 0; panelStart < rowSize; panelStart += TILE)
+            {
+                const int64_t panelRows = min(TILE, rowSize - panelStart);
+                for (int64_t j = 0; j < panelRows; ++j)
+                {
+                    ciftiIn->getRow(panel.data() + j * colSize, panelStart + j);
+                }
+                transposeBlock(panel.data(), colSize, panelRows, chunkStart, chunkEnd, cache.data() + panelStart, rowSize);
+            }
+            for (int64_t k = chunkStart; k < chunkEnd; ++k)
+            {
+                ciftiOut->setRow(cache.data() + (k - chunkStart) * rowSize, k);
+            }
+        }
+    }
+    
+    //read the input once: transpose panels of input rows into a scratch file, where each panel is stored as output row segments
+    //then each chunk of output rows needs one contiguous read per panel
+    void transposeWithRunFile(const CiftiFile* ciftiIn, CiftiFile* ciftiOut, const int64_t& rowSize, const int64_t& colSize, const int64_t& memLimitBytes)
+    {
+        const int64_t panelRows = max(int64_t(1), min(rowSize, memLimitBytes / (2 * colSize * (int64_t)sizeof(float))));//panel and its transpose
+        AString scratchDir = QDir::tempPath();
+        if (ciftiOut->getFileName() != "")//the scratch file is as big as the output, so put it next to the output rather than filling up /tmp
+        {
+            scratchDir = QFileInfo(ciftiOut->getFileName()).absolutePath();
+        }
+        QTemporaryFile scratchFile(scratchDir + "/wb_transpose_XXXXXX.tmp");
+        if (!scratchFile.open()) throw AlgorithmException("failed to create scratch file in directory '" + scratchDir + "'");
+        {
+            vector<float> panel(panelRows * colSize), transposed(panelRows * colSize);
+            for (int64_t panelStart = 0; panelStart < rowSize; panelStart += panelRows)
+            {
+                const int64_t thisPanelRows = min(panelRows, rowSize - panelStart);
+                for (int64_t j = 0; j < thisPanelRows; ++j)
+                {
+                    ciftiIn->getRow(panel.data() + j * colSize, panelStart + j);
+                }
+                transposeBlock(panel.data(), colSize, thisPanelRows, 0, colSize, transposed.data(), thisPanelRows);
+                const int64_t panelBytes = thisPanelRows * colSize * sizeof(float);//panels are written in order, so this one starts at panelStart * colSize floats
+                if (scratchFile.write((const char*)transposed.data(), panelBytes) != panelBytes)
+                {
+                    throw AlgorithmException("failed to write to scratch file '" + scratchFile.fileName() + "', check free disk space");
+                }
+            }
+        }
+        const int64_t numCacheRows = max(int64_t(1), min(colSize, memLimitBytes / ((rowSize + panelRows) * (int64_t)sizeof(float))));
+        vector<float> cache(numCacheRows * rowSize), segments(numCacheRows * panelRows);
+        for (int64_t chunkStart = 0; chunkStart < colSize; chunkStart += numCacheRows)
+        {
+            const int64_t chunkRows = min(numCacheRows, colSize - chunkStart);
+            for (int64_t panelStart = 0; panelStart < rowSize; panelStart += panelRows)
+            {
+                const int64_t thisPanelRows = min(panelRows, rowSize - panelStart);
+                const int64_t readBytes = chunkRows * thisPanelRows * sizeof(float);
+                if (!scratchFile.seek((panelStart * colSize + chunkStart * thisPanelRows) * sizeof(float)) ||
+                    scratchFile.read((char*)segments.data(), readBytes) != readBytes)
+                {
+                    throw AlgorithmException("failed to read from scratch file '" + scratchFile.fileName() + "'");
+                }
+                for (int64_t k = 0; k < chunkRows; ++k)
+                {
+                    memcpy(cache.data() + k * rowSize + panelStart, segments.data() + k * thisPanelRows, thisPanelRows * sizeof(float));
+                }
+            }
+            for (int64_t k = 0; k < chunkRows; ++k)
+            {
+                ciftiOut->setRow(cache.data() + k * rowSize, chunkStart + k);
+            }
+        }
+    }
+}
+
 AlgorithmCiftiTranspose::AlgorithmCiftiTranspose(ProgressObject* myProgObj, const CiftiFile* ciftiIn, CiftiFile* ciftiOut, const float& memLimitGB) : AbstractAlgorithm(myProgObj)
 {
     LevelProgress myProgress(myProgObj);
@@ -82,33 +198,23 @@ AlgorithmCiftiTranspose::AlgorithmCiftiTranspose(ProgressObject* myProgObj, cons
     outXML.setMap(0, *(inXML.getMap(1)));
     outXML.setMap(1, *(inXML.getMap(0)));
     ciftiOut->setCiftiXML(outXML);
-    int rowSize = outXML.getDimensionLength(CiftiXML::ALONG_ROW), colSize = outXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
+    int64_t rowSize = outXML.getDimensionLength(CiftiXML::ALONG_ROW), colSize = outXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
     int64_t outRowBytes = rowSize * sizeof(float);
-    int numCacheRows = colSize;
+    int64_t numCacheRows = colSize;
+    int64_t memLimitBytes = -1;
     if (memLimitGB >= 0.0f)
     {
-        numCacheRows = memLimitGB * 1024 * 1024 * 1024 / outRowBytes;
+        memLimitBytes = (int64_t)(memLimitGB * 1024 * 1024 * 1024);
+        numCacheRows = memLimitBytes / outRowBytes;
         if (numCacheRows < 1) numCacheRows = 1;
         if (numCacheRows > colSize) numCacheRows = colSize;
     }
-    vector<vector<float> > cacheRows(numCacheRows, vector<float>(rowSize));
-    vector<float> scratchInRow(colSize);
-    for (int i = 0; i < colSize; i += numCacheRows)//loop through cache chunks
-    {
-        int end = i + numCacheRows;
-        if (end > colSize) end = colSize;
-        for (int j = 0; j < rowSize; ++j)//loop through all input rows
-        {
-            ciftiIn->getRow(scratchInRow.data(), j);
-            for (int k = i; k < end; ++k)
-            {
-                cacheRows[k - i][j] = scratchInRow[k];
-            }
-        }
-        for (int k = i; k < end; ++k)
-        {
-            ciftiOut->setRow(cacheRows[k - i].data(), k);
-        }
+    const int64_t numPasses = (colSize + numCacheRows - 1) / numCacheRows;
+    if (numPasses <= 3 || ciftiIn->isInMemory())
+    {//the scratch file method does 3 passes worth of IO (read input, write and read scratch), so don't use it when rereading is no worse
+        transposeMultiPass(ciftiIn, ciftiOut, rowSize, colSize, numCacheRows);
+    } else {
+        transposeWithRunFile(ciftiIn, ciftiOut, rowSize, colSize, memLimitBytes);
     }
 }
 
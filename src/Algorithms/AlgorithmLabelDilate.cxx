@@ -29,6 +29,8 @@
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 
+#include <map>
+
 using namespace caret;
 using namespace std;
 
@@ -125,7 +127,23 @@ AlgorithmLabelDilate::AlgorithmLabelDilate(ProgressObject* myProgObj, const Labe
         throw AlgorithmException("corrected areas metric number of vertices does not match");
     }
     CaretArray<int32_t> colScratch(numNodes);
-    CaretArray<int> markArray(numNodes);
+    vector<int> inputColumns;//output column i is made from input column inputColumns[i]
+    if (columnNum == -1)
+    {
+        for (int thisCol = 0; thisCol < numColumns; ++thisCol)
+        {
+            inputColumns.push_back(thisCol);
+        }
+    } else {
+        inputColumns.push_back(columnNum);
+    }
+    int numOutColumns = (int)inputColumns.size();
+    myLabelOut->setNumberOfNodesAndColumns(numNodes, numOutColumns);
+    *(myLabelOut->getLabelTable()) = *(myLabel->getLabelTable());
+    myLabelOut->setStructure(mySurf->getStructure());
+    //which vertex a bad vertex takes its label from only depends on which vertices are good, so find the sources once per distinct set of good vertices
+    map<vector<char>, vector<int> > maskGroups;//good vertex mask to output columns using it
+    vector<char> markArray(numNodes);
     if (badNodeRoi != NULL)
     {
         const float* myRoiData = badNodeRoi->getValuePointerForColumn(0);
@@ -138,109 +156,15 @@ AlgorithmLabelDilate::AlgorithmLabelDilate(ProgressObject* myProgObj, const Labe
                 markArray[i] = 1;
             }
         }
-    }
-    CaretPointer<GeodesicHelperBase> myCorrBase;
-    if (corrAreas != NULL)
-    {
-        myCorrBase.grabNew(new GeodesicHelperBase(mySurf, corrAreas->getValuePointerForColumn(0)));
-    }
-    if (columnNum == -1)
-    {
-        myLabelOut->setNumberOfNodesAndColumns(numNodes, myLabel->getNumberOfColumns());
-        *(myLabelOut->getLabelTable()) = *(myLabel->getLabelTable());
-        myLabelOut->setStructure(mySurf->getStructure());
-        for (int thisCol = 0; thisCol < myLabel->getNumberOfColumns(); ++thisCol)
+        vector<int>& allColumns = maskGroups[markArray];
+        for (int outCol = 0; outCol < numOutColumns; ++outCol)
         {
-            const int32_t* myInputData = myLabel->getLabelKeyPointerForColumn(thisCol);
-            myLabelOut->setColumnName(thisCol, myLabel->getColumnName(thisCol) + " dilated");
-            if (badNodeRoi == NULL)
-            {
-                for (int i = 0; i < numNodes; ++i)
-                {
-                    if (myInputData[i] == unusedLabel)
-                    {
-                        markArray[i] = 0;
-                    } else {
-                        markArray[i] = 1;
-                    }
-                }
-            }
-#pragma omp CARET_PAR
-            {
-                CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
-                CaretPointer<GeodesicHelper> myGeoHelp;
-                if (corrAreas == NULL)
-                {
-                    myGeoHelp = mySurf->getGeodesicHelper();
-                } else {
-                    myGeoHelp.grabNew(new GeodesicHelper(myCorrBase));
-                }
-#pragma omp CARET_FOR schedule(dynamic)
-                for (int i = 0; i < numNodes; ++i)
-                {
-                    if (markArray[i] == 0)
-                    {
-                        vector<int32_t> nodeList;
-                        vector<float> distList;
-                        myGeoHelp->getNodesToGeoDist(i, myDist, nodeList, distList);
-                        int numInRange = (int)nodeList.size();
-                        bool first = true;
-                        float bestDist = -1.0f;
-                        int32_t bestLabel = unusedLabel;
-                        for (int j = 0; j < numInRange; ++j)
-                        {
-                            if (markArray[nodeList[j]] == 1)
-                            {
-                                if (first || distList[j] < bestDist)
-                                {
-                                    first = false;
-                                    bestDist = distList[j];
-                                    bestLabel = myInputData[nodeList[j]];
-                                }
-                            }
-                        }
-                        if (!first)
-                        {
-                            colScratch[i] = bestLabel;
-                        } else {
-                            nodeList = myTopoHelp->getNodeNeighbors(i);
-                            nodeList.push_back(i);
-                            myGeoHelp->getGeoToTheseNodes(i, nodeList, distList);//ok, its a little silly to do this
-                            numInRange = (int)nodeList.size();
-                            for (int j = 0; j < numInRange; ++j)
-                            {
-                                if (markArray[nodeList[j]] == 1)
-                                {
-                                    if (first || distList[j] < bestDist)
-                                    {
-                                        first = false;
-                                        bestDist = distList[j];
-                                        bestLabel = myInputData[nodeList[j]];
-                                    }
-                                }
-                            }
-                            if (!first)
-                            {
-                                colScratch[i] = bestLabel;
-                            } else {
-                                colScratch[i] = unusedLabel;
-                            }
-                        }
-                    } else {
-                        colScratch[i] = myInputData[i];
-                    }
-                }
-            }
-            myLabelOut->setLabelKeysForColumn(thisCol, colScratch.getArray());
+            allColumns.push_back(outCol);
         }
     } else {
-        myLabelOut->setNumberOfNodesAndColumns(numNodes, 1);
-        *(myLabelOut->getLabelTable()) = *(myLabel->getLabelTable());
-        myLabelOut->setStructure(mySurf->getStructure());
-        const int32_t* myInputData = myLabel->getLabelKeyPointerForColumn(columnNum);
-        myLabelOut->setColumnName(0, myLabel->getColumnName(columnNum) + " dilated");
-        if (badNodeRoi == NULL)
+        for (int outCol = 0; outCol < numOutColumns; ++outCol)
         {
+            const int32_t* myInputData = myLabel->getLabelKeyPointerForColumn(inputColumns[outCol]);
             for (int i = 0; i < numNodes; ++i)
             {
                 if (myInputData[i] == unusedLabel)
@@ -250,7 +174,18 @@ AlgorithmLabelDilate::AlgorithmLabelDilate(ProgressObject* myProgObj, const Labe
                     markArray[i] = 1;
                 }
             }
+            maskGroups[markArray].push_back(outCol);
         }
+    }
+    CaretPointer<GeodesicHelperBase> myCorrBase;
+    if (corrAreas != NULL)
+    {
+        myCorrBase.grabNew(new GeodesicHelperBase(mySurf, corrAreas->getValuePointerForColumn(0)));
+    }
+    vector<int32_t> sourceNode(numNodes);//vertex to take the label from, -1 for unlabeled
+    for (map<vector<char>, vector<int> >::const_iterator iter = maskGroups.begin(); iter != maskGroups.end(); ++iter)
+    {
+        const vector<char>& groupMark = iter->first;
 #pragma omp CARET_PAR
         {
             CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
@@ -264,7 +199,7 @@ AlgorithmLabelDilate::AlgorithmLabelDilate(ProgressObject* myProgObj, const Labe
 #pragma omp CARET_FOR schedule(dynamic)
             for (int i = 0; i < numNodes; ++i)
             {
-                if (markArray[i] == 0)
+                if (groupMark[i] == 0)
                 {
                     vector<int32_t> nodeList;
                     vector<float> distList;
@@ -272,52 +207,60 @@ AlgorithmLabelDilate::AlgorithmLabelDilate(ProgressObject* myProgObj, const Labe
                     int numInRange = (int)nodeList.size();
                     bool first = true;
                     float bestDist = -1.0f;
-                    int32_t bestLabel = unusedLabel;
+                    int32_t bestNode = -1;
                     for (int j = 0; j < numInRange; ++j)
                     {
-                        if (markArray[nodeList[j]] == 1)
+                        if (groupMark[nodeList[j]] == 1)
                         {
                             if (first || distList[j] < bestDist)
                             {
                                 first = false;
                                 bestDist = distList[j];
-                                bestLabel = myInputData[nodeList[j]];
+                                bestNode = nodeList[j];
                             }
                         }
                     }
-                    if (!first)
+                    if (first)
                     {
-                        colScratch[i] = bestLabel;
-                    } else {
                         nodeList = myTopoHelp->getNodeNeighbors(i);
                         nodeList.push_back(i);
                         myGeoHelp->getGeoToTheseNodes(i, nodeList, distList);//ok, its a little silly to do this
                         numInRange = (int)nodeList.size();
                         for (int j = 0; j < numInRange; ++j)
                         {
-                            if (markArray[nodeList[j]] == 1)
+                            if (groupMark[nodeList[j]] == 1)
                             {
                                 if (first || distList[j] < bestDist)
                                 {
                                     first = false;
                                     bestDist = distList[j];
-                                    bestLabel = myInputData[nodeList[j]];
+                                    bestNode = nodeList[j];
                                 }
                             }
                         }
-                        if (!first)
-                        {
-                            colScratch[i] = bestLabel;
-                        } else {
-                            colScratch[i] = unusedLabel;
-                        }
                     }
+                    sourceNode[i] = bestNode;
+                } else {
+                    sourceNode[i] = i;
+                }
+            }
+        }
+        const vector<int>& groupColumns = iter->second;
+        for (int j = 0; j < (int)groupColumns.size(); ++j)
+        {
+            const int32_t* myInputData = myLabel->getLabelKeyPointerForColumn(inputColumns[groupColumns[j]]);
+            for (int i = 0; i < numNodes; ++i)
+            {
+                if (sourceNode[i] == -1)
+                {
+                    colScratch[i] = unusedLabel;
                 } else {
-                    colScratch[i] = myInputData[i];
+                    colScratch[i] = myInputData[sourceNode[i]];
                 }
             }
+            myLabelOut->setColumnName(groupColumns[j], myLabel->getColumnName(inputColumns[groupColumns[j]]) + " dilated");
+            myLabelOut->setLabelKeysForColumn(groupColumns[j], colScratch.getArray());
         }
-        myLabelOut->setLabelKeysForColumn(0, colScratch.getArray());
     }
 }
 
@@ -28,6 +28,8 @@
 #include "SurfaceFile.h"
 #include "SurfaceResamplingHelper.h"
 
+#include <algorithm>
+
 using namespace caret;
 using namespace std;
 
@@ -187,7 +189,7 @@ AlgorithmLabelResample::AlgorithmLabelResample(ProgressObject* myProgObj, const
     labelOut->setStructure(labelIn->getStructure());
     *labelOut->getLabelTable() = *labelIn->getLabelTable();
     int32_t unusedLabel = labelIn->getLabelTable()->getUnassignedLabelKey();
-    vector<int32_t> colScratch(numNewNodes, unusedLabel);
+    vector<int32_t> colScratch((size_t)numNewNodes * min(numColumns, SurfaceResamplingHelper::getBatchSize()), unusedLabel);
     const float* roiCol = NULL;
     if (currentRoi != NULL) roiCol = currentRoi->getValuePointerForColumn(0);
     SurfaceResamplingHelper myHelp(myMethod, curSphere, newSphere, curAreaData, newAreaData, roiCol, allowNonSphere);
@@ -199,16 +201,29 @@ AlgorithmLabelResample::AlgorithmLabelResample(ProgressObject* myProgObj, const
         myHelp.getResampleValidROI(scratch.data());
         validRoiOut->setValuesForColumn(0, scratch.data());
     }
-    for (int i = 0; i < numColumns; ++i)
-    {
-        labelOut->setColumnName(i, labelIn->getColumnName(i));
+    const int batchSize = SurfaceResamplingHelper::getBatchSize();
+    for (int batchStart = 0; batchStart < numColumns; batchStart += batchSize)
+    {//resample several columns per pass over the weights
+        int batchCols = min(batchSize, numColumns - batchStart);
+        vector<const int32_t*> inputs(batchCols);
+        vector<int32_t*> outputs(batchCols);
+        for (int c = 0; c < batchCols; ++c)
+        {
+            inputs[c] = labelIn->getLabelKeyPointerForColumn(batchStart + c);
+            outputs[c] = colScratch.data() + (size_t)c * numNewNodes;
+        }
         if (largest)
         {
-            myHelp.resampleLargest(labelIn->getLabelKeyPointerForColumn(i), colScratch.data(), unusedLabel);
+            myHelp.resampleLargest(inputs, outputs, unusedLabel);
         } else {
-            myHelp.resamplePopular(labelIn->getLabelKeyPointerForColumn(i), colScratch.data(), unusedLabel);
+            myHelp.resamplePopular(inputs, outputs, unusedLabel);
+        }
+        for (int c = 0; c < batchCols; ++c)
+        {
+            int i = batchStart + c;
+            labelOut->setColumnName(i, labelIn->getColumnName(i));
+            labelOut->setLabelKeysForColumn(i, outputs[c]);
         }
-        labelOut->setLabelKeysForColumn(i, colScratch.data());
     }
 }
 
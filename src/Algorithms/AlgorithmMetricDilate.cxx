@@ -33,6 +33,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
 
 using namespace caret;
 using namespace std;
@@ -194,72 +195,94 @@ AlgorithmMetricDilate::AlgorithmMetricDilate(ProgressObject* myProgObj, const Me
         myAreas = corrAreas->getValuePointerForColumn(0);
     }
     bool linear = (myMethod == LINEAR), nearest = (myMethod == NEAREST);
-    FastStatistics spacingStats;
-    if (!linear && badNodeRoi != NULL)//if we know which nodes need to have their values replaced, then we can do the same thing at each vertex for each column
+    vector<int> inputColumns;//output column i is made from input column inputColumns[i]
+    if (columnNum == -1)
     {
-        if (nearest)
+        for (int thisCol = 0; thisCol < myMetric->getNumberOfColumns(); ++thisCol)
         {
-            precomputeNearest(myNearest, mySurf, badNodeRoi, dataRoi, corrAreas, distance);
-        } else {
-            precomputeStencils(myStencils, mySurf, myAreas, badNodeRoi, dataRoi, corrAreas, distance, exponent, legacyCutoff);
+            inputColumns.push_back(thisCol);
         }
     } else {
+        inputColumns.push_back(columnNum);
+    }
+    int numOutColumns = (int)inputColumns.size();
+    myMetricOut->setNumberOfNodesAndColumns(numNodes, numOutColumns);
+    for (int outCol = 0; outCol < numOutColumns; ++outCol)
+    {
+        *(myMetricOut->getMapPaletteColorMapping(outCol)) = *(myMetric->getMapPaletteColorMapping(inputColumns[outCol]));
+        myMetricOut->setColumnName(outCol, myMetric->getColumnName(inputColumns[outCol]));
+    }
+    if (linear)//linear depends on the data values, not just which vertices are bad, so it can't use a stencil
+    {
+        FastStatistics spacingStats;
         mySurf->getNodesSpacingStatistics(spacingStats);//use mean spacing to help set minimum stencil distance, since native surfaces might have a minimum of 0
+        for (int outCol = 0; outCol < numOutColumns; ++outCol)
+        {
+            processColumn(colScratch.data(), myMetric->getValuePointerForColumn(inputColumns[outCol]), mySurf, myAreas, badNodeRoi, dataRoi, corrAreas,
+                          distance, nearest, linear, exponent, legacyCutoff, spacingStats.getMean());
+            myMetricOut->setValuesForColumn(outCol, colScratch.data());
+        }
+        return;
     }
-    if (columnNum == -1)
+    //nearest and weighted only depend on which vertices are bad, so compute the stencils once per distinct set of bad vertices and apply them to every column with that set
+    map<vector<char>, vector<int> > maskGroups;//bad vertex mask to output columns using it
+    if (badNodeRoi != NULL)
     {
-        myMetricOut->setNumberOfNodesAndColumns(numNodes, myMetric->getNumberOfColumns());
-        for (int thisCol = 0; thisCol < myMetric->getNumberOfColumns(); ++thisCol)
+        vector<int>& allColumns = maskGroups[vector<char>()];
+        for (int outCol = 0; outCol < numOutColumns; ++outCol)
+        {
+            allColumns.push_back(outCol);
+        }
+    } else {
+        vector<char> colMask(numNodes);
+        for (int outCol = 0; outCol < numOutColumns; ++outCol)
         {
-            *(myMetricOut->getMapPaletteColorMapping(thisCol)) = *(myMetric->getMapPaletteColorMapping(thisCol));
-            const float* myInputData = myMetric->getValuePointerForColumn(thisCol);
-            myMetricOut->setColumnName(thisCol, myMetric->getColumnName(thisCol));
-            if (badNodeRoi == NULL)
+            const float* myInputData = myMetric->getValuePointerForColumn(inputColumns[outCol]);
+            for (int i = 0; i < numNodes; ++i)
             {
-                processColumn(colScratch.data(), myInputData, mySurf, myAreas, badNodeRoi, dataRoi, corrAreas, distance, nearest, linear, exponent, legacyCutoff, spacingStats.getMean());
-            } else {
-                switch (myMethod)
-                {
-                    case NEAREST:
-                        processColumn(colScratch.data(), numNodes, myInputData, myNearest);
-                        break;
-                    case WEIGHTED:
-                        processColumn(colScratch.data(), numNodes, myInputData, myStencils);
-                        break;
-                    case LINEAR:
-                        processColumn(colScratch.data(), myInputData, mySurf, myAreas, badNodeRoi, dataRoi, corrAreas, distance, nearest, linear, exponent, legacyCutoff, spacingStats.getMean());
-                        break;
-                }
+                colMask[i] = (myInputData[i] == 0.0f ? 1 : 0);
             }
-            myMetricOut->setValuesForColumn(thisCol, colScratch.data());
+            maskGroups[colMask].push_back(outCol);
         }
-    } else {
-        myMetricOut->setNumberOfNodesAndColumns(numNodes, 1);
-        *(myMetricOut->getMapPaletteColorMapping(0)) = *(myMetric->getMapPaletteColorMapping(columnNum));
-        const float* myInputData = myMetric->getValuePointerForColumn(columnNum);
-        myMetricOut->setColumnName(0, myMetric->getColumnName(columnNum));
+    }
+    MetricFile maskRoi;
+    for (map<vector<char>, vector<int> >::const_iterator iter = maskGroups.begin(); iter != maskGroups.end(); ++iter)
+    {
+        const MetricFile* groupBadRoi = badNodeRoi;
         if (badNodeRoi == NULL)
         {
-            processColumn(colScratch.data(), myInputData, mySurf, myAreas, badNodeRoi, dataRoi, corrAreas, distance, nearest, linear, exponent, legacyCutoff, spacingStats.getMean());
+            maskRoi.setNumberOfNodesAndColumns(numNodes, 1);
+            for (int i = 0; i < numNodes; ++i)
+            {
+                colScratch[i] = iter->first[i];
+            }
+            maskRoi.setValuesForColumn(0, colScratch.data());
+            groupBadRoi = &maskRoi;
+        }
+        if (nearest)
+        {
+            precomputeNearest(myNearest, mySurf, groupBadRoi, dataRoi, corrAreas, distance);
         } else {
-            switch (myMethod)
+            precomputeStencils(myStencils, mySurf, myAreas, groupBadRoi, dataRoi, corrAreas, distance, exponent, legacyCutoff);
+        }
+        const vector<int>& groupColumns = iter->second;
+        for (int j = 0; j < (int)groupColumns.size(); ++j)
+        {
+            const float* myInputData = myMetric->getValuePointerForColumn(inputColumns[groupColumns[j]]);
+            if (nearest)
             {
-                case NEAREST:
-                    processColumn(colScratch.data(), numNodes, myInputData, myNearest);
-                    break;
-                case WEIGHTED:
-                    processColumn(colScratch.data(), numNodes, myInputData, myStencils);
-                    break;
-                case LINEAR:
-                    processColumn(colScratch.data(), myInputData, mySurf, myAreas, badNodeRoi, dataRoi, corrAreas, distance, nearest, linear, exponent, legacyCutoff, spacingStats.getMean());
-                    break;
+                processColumn(colScratch.data(), numNodes, myInputData, myNearest);
+            } else {
+                processColumn(colScratch.data(), numNodes, myInputData, myStencils);
             }
+            myMetricOut->setValuesForColumn(groupColumns[j], colScratch.data());
         }
-        myMetricOut->setValuesForColumn(0, colScratch.data());
+        myNearest.clear();
+        myStencils.clear();
     }
 }
 
-void AlgorithmMetricDilate::processColumn(float* colScratch, const int& numNodes, const float* myInputData, vector<pair<int, int> > myNearest)
+void AlgorithmMetricDilate::processColumn(float* colScratch, const int& numNodes, const float* myInputData, const vector<pair<int, int> >& myNearest)
 {
     for (int i = 0; i < numNodes; ++i)
     {
@@ -280,7 +303,7 @@ void AlgorithmMetricDilate::processColumn(float* colScratch, const int& numNodes
     }
 }
 
-void AlgorithmMetricDilate::processColumn(float* colScratch, const int& numNodes, const float* myInputData, vector<pair<int, StencilElem> > myStencils)
+void AlgorithmMetricDilate::processColumn(float* colScratch, const int& numNodes, const float* myInputData, const vector<pair<int, StencilElem> >& myStencils)
 {
     for (int i = 0; i < numNodes; ++i)
     {
@@ -38,8 +38,8 @@ namespace caret {
                                 const float& distance, const float& exponent, const bool legacyCutoff);
         void precomputeNearest(std::vector<std::pair<int, int> >& myNearest, const SurfaceFile* mySurf,
                                const MetricFile* badNodeRoi, const MetricFile* dataRoi, const MetricFile* corrAreas, const float& distance);
-        void processColumn(float* colScratch, const int& numNodes, const float* myInputData, std::vector<std::pair<int, int> > myNearest);
-        void processColumn(float* colScratch, const int& numNodes, const float* myInputData, std::vector<std::pair<int, StencilElem> > myStencils);
+        void processColumn(float* colScratch, const int& numNodes, const float* myInputData, const std::vector<std::pair<int, int> >& myNearest);
+        void processColumn(float* colScratch, const int& numNodes, const float* myInputData, const std::vector<std::pair<int, StencilElem> >& myStencils);
         void processColumn(float* colScratch, const float* myInputData, const SurfaceFile* mySurf, const float* myAreas,
                            const MetricFile* badNodeRoi, const MetricFile* dataRoi, const MetricFile* corrAreas,
                            const float& distance, const bool& nearest, const bool& linear, const float& exponent, const bool legacyCutoff, const float meanSpacing);
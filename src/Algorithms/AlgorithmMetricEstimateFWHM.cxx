@@ -21,6 +21,8 @@
 #include "AlgorithmMetricEstimateFWHM.h"
 #include "AlgorithmException.h"
 
+#include "CaretAssert.h"
+#include "CaretOMP.h"
 #include "DescriptiveStatistics.h"
 #include "MetricFile.h"
 #include "SurfaceFile.h"
@@ -101,11 +103,11 @@ void AlgorithmMetricEstimateFWHM::useParameters(OperationParameters* myParams, P
     } else {
         if (columnNum == -1)
         {
+            vector<float> results = estimateFWHMEachColumn(mySurf, myMetric, roi);
             for (int i = 0; i < numColumns; ++i)
             {
-                float result = estimateFWHM(mySurf, myMetric, roi, i);
                 if (numColumns > 1) cout << "column " << i + 1 << " ";
-                cout << "FWHM: " << result << endl;
+                cout << "FWHM: " << results[i] << endl;
             }
         } else {
             float result = estimateFWHM(mySurf, myMetric, roi, columnNum);
@@ -115,62 +117,150 @@ void AlgorithmMetricEstimateFWHM::useParameters(OperationParameters* myParams, P
     }
 }
 
-float AlgorithmMetricEstimateFWHM::estimateFWHM(const SurfaceFile* mySurf, const MetricFile* input, const MetricFile* roi, const int64_t& column)
+namespace
 {
-    CaretAssert(column >= 0 && column < input->getNumberOfColumns());
-    int numNodes = input->getNumberOfNodes();
-    if (mySurf->getNumberOfNodes() != numNodes)
+    struct SurfaceEdges//in-roi vertices and in-roi neighbor pairs, so each column is just array lookups instead of topology queries
     {
-        throw AlgorithmException("surface has different number of vertices than the input data");
-    }
-    const float* inCol = input->getValuePointerForColumn(column);
-    const float* roiCol = NULL;
-    if (roi != NULL)
+        vector<int32_t> nodes, first, second;
+    };
+    
+    void getSurfaceEdges(const SurfaceFile* mySurf, const float* roiCol, SurfaceEdges& edgesOut)
     {
-        if (roi->getNumberOfNodes() != numNodes)
+        int numNodes = mySurf->getNumberOfNodes();
+        CaretPointer<TopologyHelper> myHelp = mySurf->getTopologyHelper();
+        for (int i = 0; i < numNodes; ++i)
         {
-            throw AlgorithmException("roi metric has a different number of vertices than the input metric");
+            if (roiCol == NULL || roiCol[i] > 0.0f)
+            {
+                edgesOut.nodes.push_back(i);
+                const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(i);
+                for (int j = 0; j < (int)neighbors.size(); ++j)
+                {
+                    if (neighbors[j] > i && (roiCol == NULL || roiCol[neighbors[j]] > 0.0f))//collect lopsided to get correct degrees of freedom (if n-1 denom is desired), mean is assumed zero so it works out
+                    {
+                        edgesOut.first.push_back(i);
+                        edgesOut.second.push_back(neighbors[j]);
+                    }
+                }
+            }
         }
-        roiCol = roi->getValuePointerForColumn(0);
     }
-    DescriptiveStatistics nodeSpacingStats;
-    mySurf->getNodesSpacingStatistics(nodeSpacingStats);//this will be slow since it recomputes - should change it to returning a const reference, and make it a lazy member
-    double globalAccum = 0.0, localAccum = 0.0;
-    int64_t globalCount = 0, localCount = 0;
-    CaretPointer<TopologyHelper> myHelp = mySurf->getTopologyHelper();
-    for (int i = 0; i < numNodes; ++i)//the local difference mean will be zero, as we don't have directionality, so don't bother collecting it
+    
+    struct ColumnStats
     {
-        if (roi == NULL || roiCol[i] > 0.0f)
+        double sum, sumSqDev, localAccum;//sumSqDev is around the mean of this column alone
+    };
+    
+    ColumnStats getColumnStats(const float* inCol, const double* meanImage, const SurfaceEdges& edges, vector<float>& scratch)
+    {
+        const int64_t numUsed = (int64_t)edges.nodes.size(), numEdges = (int64_t)edges.first.size();
+        const int32_t* nodes = edges.nodes.data();
+        if (meanImage != NULL)
         {
-            float center = inCol[i];
-            globalAccum += center;
-            ++globalCount;
+            scratch.resize(numUsed == 0 ? 0 : nodes[numUsed - 1] + 1);
+            for (int64_t i = 0; i < numUsed; ++i)
+            {
+                scratch[nodes[i]] = inCol[nodes[i]] - meanImage[nodes[i]];
+            }
+            inCol = scratch.data();
         }
+        ColumnStats ret;
+        ret.sum = 0.0;
+        for (int64_t i = 0; i < numUsed; ++i)
+        {
+            ret.sum += inCol[nodes[i]];
+        }
+        double colMean = ret.sum / numUsed;
+        ret.sumSqDev = 0.0;
+        for (int64_t i = 0; i < numUsed; ++i)
+        {
+            double tempd = inCol[nodes[i]] - colMean;
+            ret.sumSqDev += tempd * tempd;
+        }
+        ret.localAccum = 0.0;//the local difference mean will be zero, as we don't have directionality, so don't bother collecting it
+        const int32_t* first = edges.first.data(), *second = edges.second.data();
+        for (int64_t e = 0; e < numEdges; ++e)
+        {
+            float tempf = inCol[first[e]] - inCol[second[e]];
+            ret.localAccum += tempf * tempf;
+        }
+        return ret;
     }
-    float globalMean = globalAccum / globalCount;
-    globalAccum = 0.0;
-    for (int i = 0; i < numNodes; ++i)
+    
+    //columns are independent, so do them in parallel, order of combining stays fixed
+    void getAllColumnStats(const MetricFile* input, const double* meanImage, const SurfaceEdges& edges, vector<ColumnStats>& statsOut)
     {
-        if (roi == NULL || roiCol[i] > 0.0f)
+        int numCols = input->getNumberOfColumns();
+        statsOut.resize(numCols);
+#pragma omp CARET_PAR
         {
-            float center = inCol[i];
-            float tempf = center - globalMean;
-            globalAccum += tempf * tempf;//don't need to recalculate count
-            const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(i);
-            for (int j = 0; j < (int)neighbors.size(); ++j)
+            vector<float> scratch;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int j = 0; j < numCols; ++j)
             {
-                if (neighbors[j] > i && (roi == NULL || roiCol[neighbors[j]] > 0.0f))//collect lopsided to get correct degrees of freedom (if n-1 denom is desired), mean is assumed zero so it works out
-                {
-                    tempf = center - inCol[neighbors[j]];
-                    localAccum += tempf * tempf;
-                    ++localCount;
-                }
+                statsOut[j] = getColumnStats(input->getValuePointerForColumn(j), meanImage, edges, scratch);
             }
         }
     }
-    float globalVariance = globalAccum / globalCount;
-    float localVariance = localAccum / localCount;
-    float ret = nodeSpacingStats.getMean() * sqrt(-2.0f * log(2.0f) / log(1.0f - localVariance / (2.0f * globalVariance)));
+    
+    float fwhmFromVariances(const float meanSpacing, const float globalVariance, const float localVariance)
+    {
+        return meanSpacing * sqrt(-2.0f * log(2.0f) / log(1.0f - localVariance / (2.0f * globalVariance)));
+    }
+    
+    const float* getRoiColumn(const MetricFile* input, const MetricFile* roi)
+    {
+        if (roi == NULL) return NULL;
+        if (roi->getNumberOfNodes() != input->getNumberOfNodes())
+        {
+            throw AlgorithmException("roi metric has a different number of vertices than the input metric");
+        }
+        return roi->getValuePointerForColumn(0);
+    }
+}
+
+float AlgorithmMetricEstimateFWHM::estimateFWHM(const SurfaceFile* mySurf, const MetricFile* input, const MetricFile* roi, const int64_t& column)
+{
+    CaretAssert(column >= 0 && column < input->getNumberOfColumns());
+    int numNodes = input->getNumberOfNodes();
+    if (mySurf->getNumberOfNodes() != numNodes)
+    {
+        throw AlgorithmException("surface has different number of vertices than the input data");
+    }
+    const float* roiCol = getRoiColumn(input, roi);
+    DescriptiveStatistics nodeSpacingStats;
+    mySurf->getNodesSpacingStatistics(nodeSpacingStats);//this will be slow since it recomputes - should change it to returning a const reference, and make it a lazy member
+    SurfaceEdges edges;
+    getSurfaceEdges(mySurf, roiCol, edges);
+    vector<float> scratch;
+    ColumnStats stats = getColumnStats(input->getValuePointerForColumn(column), NULL, edges, scratch);
+    float globalVariance = stats.sumSqDev / edges.nodes.size();
+    float localVariance = stats.localAccum / edges.first.size();
+    return fwhmFromVariances(nodeSpacingStats.getMean(), globalVariance, localVariance);
+}
+
+vector<float> AlgorithmMetricEstimateFWHM::estimateFWHMEachColumn(const SurfaceFile* mySurf, const MetricFile* input, const MetricFile* roi)
+{
+    int numNodes = input->getNumberOfNodes();
+    if (mySurf->getNumberOfNodes() != numNodes)
+    {
+        throw AlgorithmException("surface has different number of vertices than the input data");
+    }
+    const float* roiCol = getRoiColumn(input, roi);
+    DescriptiveStatistics nodeSpacingStats;
+    mySurf->getNodesSpacingStatistics(nodeSpacingStats);//only once for all columns
+    SurfaceEdges edges;
+    getSurfaceEdges(mySurf, roiCol, edges);
+    vector<ColumnStats> stats;
+    getAllColumnStats(input, NULL, edges, stats);
+    int numCols = input->getNumberOfColumns();
+    vector<float> ret(numCols);
+    for (int j = 0; j < numCols; ++j)
+    {
+        float globalVariance = stats[j].sumSqDev / edges.nodes.size();
+        float localVariance = stats[j].localAccum / edges.first.size();
+        ret[j] = fwhmFromVariances(nodeSpacingStats.getMean(), globalVariance, localVariance);
+    }
     return ret;
 }
 
@@ -181,18 +271,13 @@ float AlgorithmMetricEstimateFWHM::estimateFWHMAllColumns(const SurfaceFile* myS
     {
         throw AlgorithmException("surface has different number of vertices than the input metric");
     }
-    const float* roiCol = NULL;
-    if (roi != NULL)
-    {
-        if (roi->getNumberOfNodes() != numNodes)
-        {
-            throw AlgorithmException("roi metric has a different number of vertices than the input metric");
-        }
-        roiCol = roi->getValuePointerForColumn(0);
-    }
+    const float* roiCol = getRoiColumn(input, roi);
     DescriptiveStatistics nodeSpacingStats;
     mySurf->getNodesSpacingStatistics(nodeSpacingStats);//this will be slow since it recomputes - should change it to returning a const reference, and make it a lazy member
+    SurfaceEdges edges;
+    getSurfaceEdges(mySurf, roiCol, edges);
     int numCols = input->getNumberOfColumns();
+    const int64_t numUsed = (int64_t)edges.nodes.size();
     vector<double> meanImage;
     if (demean)
     {
@@ -200,89 +285,33 @@ float AlgorithmMetricEstimateFWHM::estimateFWHMAllColumns(const SurfaceFile* myS
         for (int j = 0; j < numCols; ++j)
         {
             const float* inCol = input->getValuePointerForColumn(j);
-            for (int i = 0; i < numNodes; ++i)
+            for (int64_t i = 0; i < numUsed; ++i)//not that it matters, but only computing the mean inside the ROI reduces the working set somewhat
             {
-                if (roi == NULL || roiCol[i] > 0.0f)//not that it matters, but only computing the mean inside the ROI reduces the working set somewhat
-                {
-                    meanImage[i] += inCol[i];
-                }
+                meanImage[edges.nodes[i]] += inCol[edges.nodes[i]];
             }
         }
-        for (int i = 0; i < numNodes; ++i)
+        for (int64_t i = 0; i < numUsed; ++i)
         {
-            if (roi == NULL || roiCol[i] > 0.0f)
-            {
-                meanImage[i] /= numCols;
-            }
+            meanImage[edges.nodes[i]] /= numCols;
         }
     }
+    vector<ColumnStats> stats;
+    getAllColumnStats(input, (demean ? meanImage.data() : NULL), edges, stats);
     double globalAccum = 0.0, localAccum = 0.0;
-    int64_t globalCount = 0, localCount = 0;
-    CaretPointer<TopologyHelper> myHelp = mySurf->getTopologyHelper();
-    vector<float> demeaned;
-    if (demean) demeaned.resize(numNodes);
     for (int j = 0; j < numCols; ++j)
     {
-        const float* inCol = input->getValuePointerForColumn(j);
-        if (demean)
-        {
-            for (int i = 0; i < numNodes; ++i)
-            {
-                if (roi == NULL || roiCol[i] > 0.0f)
-                {
-                    demeaned[i] = inCol[i] - meanImage[i];
-                }
-            }
-            inCol = demeaned.data();
-        }
-        for (int i = 0; i < numNodes; ++i)//the local difference mean will be zero, as we don't have directionality, so don't bother collecting it
-        {
-            if (roi == NULL || roiCol[i] > 0.0f)
-            {
-                float center = inCol[i];
-                globalAccum += center;
-                ++globalCount;
-            }
-        }
+        globalAccum += stats[j].sum;
+        localAccum += stats[j].localAccum;
     }
-    float globalMean = globalAccum / globalCount;
+    int64_t globalCount = numUsed * numCols, localCount = (int64_t)edges.first.size() * numCols;
+    double globalMean = globalAccum / globalCount;
     globalAccum = 0.0;
-    for (int j = 0; j < numCols; ++j)
+    for (int j = 0; j < numCols; ++j)//combine the per-column deviations into the deviation around the mean of all columns
     {
-        const float* inCol = input->getValuePointerForColumn(j);
-        if (demean)
-        {
-            for (int i = 0; i < numNodes; ++i)
-            {
-                if (roi == NULL || roiCol[i] > 0.0f)
-                {
-                    demeaned[i] = inCol[i] - meanImage[i];
-                }
-            }
-            inCol = demeaned.data();
-        }
-        for (int i = 0; i < numNodes; ++i)
-        {
-            if (roi == NULL || roiCol[i] > 0.0f)
-            {
-                float center = inCol[i];
-                float tempf = center - globalMean;
-                globalAccum += tempf * tempf;//don't need to recalculate count
-                const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(i);
-                for (int j = 0; j < (int)neighbors.size(); ++j)
-                {
-                    if (neighbors[j] > i && (roi == NULL || roiCol[neighbors[j]] > 0.0f))//collect lopsided to get correct degrees of freedom (if n-1 denom is desired), mean is assumed zero so it works out
-                    {
-                        tempf = center - inCol[neighbors[j]];
-                        localAccum += tempf * tempf;
-                        ++localCount;
-                    }
-                }
-            }
-        }
+        double tempd = stats[j].sum / numUsed - globalMean;
+        globalAccum += stats[j].sumSqDev + numUsed * tempd * tempd;
     }
     float globalVariance = globalAccum / globalCount;
     float localVariance = localAccum / localCount;
-    float ret = nodeSpacingStats.getMean() * sqrt(-2.0f * log(2.0f) / log(1.0f - localVariance / (2.0f * globalVariance)));
-    return ret;
+    return fwhmFromVariances(nodeSpacingStats.getMean(), globalVariance, localVariance);
 }
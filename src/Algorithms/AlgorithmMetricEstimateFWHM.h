@@ -23,6 +23,8 @@
 
 #include "AbstractAlgorithm.h"
 
+#include <vector>
+
 namespace caret {
     
     class AlgorithmMetricEstimateFWHM : public AbstractOperation
@@ -34,6 +36,8 @@ namespace caret {
         static AString getShortDescription();
 
         static float estimateFWHM(const SurfaceFile* mySurf, const MetricFile* input, const MetricFile* roi = NULL, const int64_t& column = 0);
+        ///same as estimateFWHM on each column, but only does the per-surface work once, and does columns in parallel
+        static std::vector<float> estimateFWHMEachColumn(const SurfaceFile* mySurf, const MetricFile* input, const MetricFile* roi = NULL);
         static float estimateFWHMAllColumns(const SurfaceFile* mySurf, const MetricFile* input, const MetricFile* roi = NULL, const bool& demean = false);
     };
 
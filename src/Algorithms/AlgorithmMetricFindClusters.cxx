@@ -22,6 +22,8 @@
 #include "AlgorithmException.h"
 
 #include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "ConnectedComponentHelper.h"
 #include "GeodesicHelper.h"
 #include "MetricFile.h"
 #include "SurfaceFile.h"
@@ -155,10 +157,10 @@ namespace
     
     void processColumn(const float* data, const float* roiData, const float* nodeAreas, TopologyHelper* myTopoHelp, GeodesicHelper* myGeoHelp,
                        const float& threshVal, const float& minArea, const bool& lessThan, const float& areaRatio, const float& distanceCutoff,
-                       float* outData, int& markVal)
+                       vector<Cluster>& clusters)
     {
         int numNodes = myTopoHelp->getNumberOfNodes();
-        vector<int> marked(numNodes, 0);
+        vector<char> marked(numNodes, 0);
         if (lessThan)
         {
             for (int i = 0; i < numNodes; ++i)
@@ -177,41 +179,29 @@ namespace
                 }
             }
         }
-        vector<Cluster> clusters;
+        vector<int64_t> labels;
+        int64_t numComponents = ConnectedComponentHelper::labelSurface(myTopoHelp, marked.data(), labels);
+        vector<vector<int64_t> > members;
+        ConnectedComponentHelper::getMembers(labels, numComponents, members);
+        ConnectedComponentHelper::orderSurfaceMembersByFill(myTopoHelp, labels, members);//sum areas in the order the old flood fill did, so clusters right at the minimum area don't change
+        vector<double> areas;
+        ConnectedComponentHelper::sumPerComponent(members, nodeAreas, areas);
+        clusters.clear();
         float biggestSize = 0.0f;
         int biggestCluster = -1;
-        for (int i = 0; i < numNodes; ++i)
+        for (int64_t c = 0; c < numComponents; ++c)//components are numbered by lowest vertex, the same order the clusters used to be found in
         {
-            if (marked[i])
+            if (areas[c] > minArea)
             {
-                Cluster newCluster;
-                newCluster.members.push_back(i);
-                marked[i] = 0;//unmark it when added to list to prevent multiples
-                for (int index = 0; index < (int)newCluster.members.size(); ++index)//NOTE: vector grows inside loop
-                {
-                    int node = newCluster.members[index];//keep list around so we can put it into the output immediately if it is large enough
-                    newCluster.area += nodeAreas[node];
-                    const vector<int32_t>& neighbors = myTopoHelp->getNodeNeighbors(node);
-                    int numNeigh = (int)neighbors.size();
-                    for (int n = 0; n < numNeigh; ++n)
-                    {
-                        const int32_t& neighbor = neighbors[n];
-                        if (marked[neighbor])
-                        {
-                            newCluster.members.push_back(neighbor);
-                            marked[neighbor] = 0;
-                        }
-                    }
-                }
-                if (newCluster.area > minArea)
+                if (areas[c] > biggestSize)
                 {
-                    if (newCluster.area > biggestSize)
-                    {
-                        biggestSize = newCluster.area;
-                        biggestCluster = (int)clusters.size();
-                    }
-                    clusters.push_back(newCluster);
+                    biggestSize = areas[c];
+                    biggestCluster = (int)clusters.size();
                 }
+                clusters.push_back(Cluster());
+                Cluster& newCluster = clusters.back();
+                newCluster.area = areas[c];
+                newCluster.members.assign(members[c].begin(), members[c].end());
             }
         }
         vector<int32_t> pathScratch;
@@ -249,6 +239,11 @@ namespace
                 }
             }
         }
+    }
+    
+    //returns false if the cluster values can't be represented exactly
+    bool markClusters(const vector<Cluster>& clusters, float* outData, int& markVal)
+    {
         for (size_t i = 0; i < clusters.size(); ++i)
         {
             if (markVal == 0)
@@ -257,7 +252,7 @@ namespace
                 ++markVal;
             }
             float tempVal = markVal;
-            if ((int)tempVal != markVal) throw AlgorithmException("too many clusters, unable to mark them uniquely");
+            if ((int)tempVal != markVal) return false;
             int numMembers = (int)clusters[i].members.size();
             for (int index = 0; index < numMembers; ++index)
             {
@@ -265,6 +260,7 @@ namespace
             }
             ++markVal;
         }
+        return true;
     }
 }
 
@@ -303,42 +299,57 @@ AlgorithmMetricFindClusters::AlgorithmMetricFindClusters(ProgressObject* myProgO
     } else {
         nodeAreas = myAreas->getValuePointerForColumn(0);
     }
-    CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
-    CaretPointer<GeodesicHelper> myGeoHelp;
     CaretPointer<GeodesicHelperBase> myGeoBase;
-    if (distanceCutoff > 0.0f)//geodesic is only needed for distance cutoff
+    if (distanceCutoff > 0.0f && myAreas != NULL)//geodesic is only needed for distance cutoff
     {
-        if (myAreas == NULL)
-        {
-            myGeoHelp = mySurf->getGeodesicHelper();
-        } else {
-            myGeoBase.grabNew(new GeodesicHelperBase(mySurf, myAreas->getValuePointerForColumn(0)));
-            myGeoHelp.grabNew(new GeodesicHelper(myGeoBase));
-        }
+        myGeoBase.grabNew(new GeodesicHelperBase(mySurf, myAreas->getValuePointerForColumn(0)));
     }
-    vector<int> toSearch;
     int markVal = startVal;//give each cluster a different value, including across maps
+    bool markOverflow = false;
+    vector<int> outColumns;
     if (columnNum == -1)
     {
         myMetricOut->setNumberOfNodesAndColumns(numNodes, numCols);
-        myMetricOut->setStructure(mySurf->getStructure());
         for (int c = 0; c < numCols; ++c)
         {
-            myMetricOut->setColumnName(c, myMetric->getColumnName(c));
-            vector<float> outData(numNodes, 0.0f);
-            const float* data = myMetric->getValuePointerForColumn(c);
-            processColumn(data, roiData, nodeAreas, myTopoHelp, myGeoHelp, threshVal, minArea, lessThan, areaRatio, distanceCutoff, outData.data(), markVal);
-            myMetricOut->setValuesForColumn(c, outData.data());
+            outColumns.push_back(c);
         }
     } else {
         myMetricOut->setNumberOfNodesAndColumns(numNodes, 1);
-        myMetricOut->setStructure(mySurf->getStructure());
-        myMetricOut->setColumnName(0, myMetric->getColumnName(columnNum));
-        vector<float> outData(numNodes, 0.0f);
-        const float* data = myMetric->getValuePointerForColumn(columnNum);
-        processColumn(data, roiData, nodeAreas, myTopoHelp, myGeoHelp, threshVal, minArea, lessThan, areaRatio, distanceCutoff, outData.data(), markVal);
-        myMetricOut->setValuesForColumn(0, outData.data());
+        outColumns.push_back(columnNum);
+    }
+    myMetricOut->setStructure(mySurf->getStructure());
+    const int numOutCols = (int)outColumns.size();
+#pragma omp CARET_PAR if (numOutCols > 1)
+    {//with many maps, do whole maps in parallel, the component labeling is itself parallel for the single map case
+        CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
+        CaretPointer<GeodesicHelper> myGeoHelp;
+        if (distanceCutoff > 0.0f)
+        {
+            if (myAreas == NULL)
+            {
+                myGeoHelp = mySurf->getGeodesicHelper();
+            } else {
+                myGeoHelp.grabNew(new GeodesicHelper(myGeoBase));
+            }
+        }
+        vector<Cluster> clusters;
+        vector<float> outData(numNodes);
+#pragma omp CARET_FOR schedule(dynamic) ordered
+        for (int outCol = 0; outCol < numOutCols; ++outCol)
+        {
+            const float* data = myMetric->getValuePointerForColumn(outColumns[outCol]);
+            processColumn(data, roiData, nodeAreas, myTopoHelp, myGeoHelp, threshVal, minArea, lessThan, areaRatio, distanceCutoff, clusters);
+#pragma omp ordered
+            {//cluster values count up across maps, so mark them in map order
+                outData.assign(numNodes, 0.0f);
+                if (!markClusters(clusters, outData.data(), markVal)) markOverflow = true;
+                myMetricOut->setColumnName(outCol, myMetric->getColumnName(outColumns[outCol]));
+                myMetricOut->setValuesForColumn(outCol, outData.data());
+            }
+        }
     }
+    if (markOverflow) throw AlgorithmException("too many clusters, unable to mark them uniquely");
     if (endVal != NULL) *endVal = markVal;
 }
 
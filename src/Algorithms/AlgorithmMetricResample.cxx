@@ -27,6 +27,8 @@
 #include "SurfaceFile.h"
 #include "SurfaceResamplingHelper.h"
 
+#include <algorithm>
+
 using namespace caret;
 using namespace std;
 
@@ -187,7 +189,7 @@ AlgorithmMetricResample::AlgorithmMetricResample(ProgressObject* myProgObj, cons
     int numColumns = metricIn->getNumberOfColumns(), numNewNodes = newSphere->getNumberOfNodes();
     metricOut->setNumberOfNodesAndColumns(numNewNodes, numColumns);
     metricOut->setStructure(metricIn->getStructure());
-    vector<float> colScratch(numNewNodes, 0.0f);
+    vector<float> colScratch((size_t)numNewNodes * min(numColumns, SurfaceResamplingHelper::getBatchSize()), 0.0f);
     const float* roiCol = NULL;
     if (currentRoi != NULL) roiCol = currentRoi->getValuePointerForColumn(0);
     SurfaceResamplingHelper myHelp(myMethod, curSphere, newSphere, curAreaData, newAreaData, roiCol, allowNonSphere);
@@ -199,17 +201,30 @@ AlgorithmMetricResample::AlgorithmMetricResample(ProgressObject* myProgObj, cons
         myHelp.getResampleValidROI(scratch.data());
         validRoiOut->setValuesForColumn(0, scratch.data());
     }
-    for (int i = 0; i < numColumns; ++i)
-    {
-        metricOut->setColumnName(i, metricIn->getColumnName(i));
-        *metricOut->getPaletteColorMapping(i) = *metricIn->getPaletteColorMapping(i);
+    const int batchSize = SurfaceResamplingHelper::getBatchSize();
+    for (int batchStart = 0; batchStart < numColumns; batchStart += batchSize)
+    {//resample several columns per pass over the weights
+        int batchCols = min(batchSize, numColumns - batchStart);
+        vector<const float*> inputs(batchCols);
+        vector<float*> outputs(batchCols);
+        for (int c = 0; c < batchCols; ++c)
+        {
+            inputs[c] = metricIn->getValuePointerForColumn(batchStart + c);
+            outputs[c] = colScratch.data() + (size_t)c * numNewNodes;
+        }
         if (largest)
         {
-            myHelp.resampleLargest(metricIn->getValuePointerForColumn(i), colScratch.data());
+            myHelp.resampleLargest(inputs, outputs);
         } else {
-            myHelp.resampleNormal(metricIn->getValuePointerForColumn(i), colScratch.data());
+            myHelp.resampleNormal(inputs, outputs);
+        }
+        for (int c = 0; c < batchCols; ++c)
+        {
+            int i = batchStart + c;
+            metricOut->setColumnName(i, metricIn->getColumnName(i));
+            *metricOut->getPaletteColorMapping(i) = *metricIn->getPaletteColorMapping(i);
+            metricOut->setValuesForColumn(i, outputs[c]);
         }
-        metricOut->setValuesForColumn(i, colScratch.data());
     }
 }
 
@@ -22,12 +22,12 @@
 #include <cmath>
 
 #include "AlgorithmSurfaceInflation.h"
-#include "AlgorithmSurfaceSmoothing.h"
 #include "AlgorithmException.h"
 #include "BoundingBox.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
 #include "SurfaceFile.h"
+#include "SurfaceSmoothingHelper.h"
 
 using namespace caret;
 
@@ -138,20 +138,22 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
                                                      const float inflationFactorIn)
    : AbstractAlgorithm(myProgObj)
 {
-    std::vector<ProgressObject*> subAlgProgress;
-    if (myProgObj != NULL) {
-        subAlgProgress.resize(cycles);
-        for (int32_t i = 0; i < cycles; ++i)
-        {
-            subAlgProgress[i] = myProgObj->addAlgorithm(AlgorithmSurfaceSmoothing::getAlgorithmWeight());
-        }
+    if ((strength < 0.0)
+        || (strength > 1.0)) {
+        throw AlgorithmException("Invalid smoothing strength outside [0.0, 1.0]: "
+                                 + QString::number(strength, 'f', 5));
+    }
+    
+    if (iterations <= 0) {
+        throw AlgorithmException("Invalid iterations value [1, infinity]: "
+                                 + QString::number(iterations));
     }
     
     /*
      * Sets the algorithm up to use the progress object, and will
      * finish the progress object automatically when the algorithm terminates
      */
-    LevelProgress myProgress(myProgObj, 1.0f, 0.1f);//lower the internal weight
+    LevelProgress myProgress(myProgObj);
     
     const float inflationFactor = inflationFactorIn - 1.0;
     
@@ -163,50 +165,40 @@ AlgorithmSurfaceInflation::AlgorithmSurfaceInflation(ProgressObject* myProgObj,
     const float anatomicalRangeY = anatomicalBoundingBox->getDifferenceY();
     const float anatomicalRangeZ = anatomicalBoundingBox->getDifferenceZ();
     
-    const int32_t numberOfNodes = outputSurfaceFile->getNumberOfNodes();
+    if (outputSurfaceFile->getNumberOfNodes() <= 0) {
+        return;
+    }
+    
+    /*
+     * Coordinates stay in the smoothing helper for all of the
+     * cycles so that the neighbors are only packed once
+     */
+    SurfaceSmoothingHelper mySmoothHelp(outputSurfaceFile);
     
+    const float totalIterations = static_cast<float>(cycles) * iterations;
     for (int iCycle = 0; iCycle < cycles; iCycle++) {
         /*
          * Smooth
          */
-        ProgressObject* subProgress = NULL;
-        if (myProgObj != NULL)
-        {
-            subProgress = subAlgProgress[iCycle];
+        for (int32_t iter = 1; iter <= iterations; iter++) {
+            mySmoothHelp.smooth(strength);
+            myProgress.reportProgress((static_cast<float>(iCycle) * iterations + iter)
+                                      / totalIterations);
         }
-        AlgorithmSurfaceSmoothing(subProgress,
-                                  outputSurfaceFile,
-                                  outputSurfaceFile,
-                                  strength,
-                                  iterations);
         
         /*
          * Inflate
          */
-        float xyz[3];
-        for (int32_t iNode = 0; iNode < numberOfNodes; iNode++) {
-            outputSurfaceFile->getCoordinate(iNode,
-                                             xyz);
-            
-            const float x = xyz[0] / anatomicalRangeX;
-            const float y = xyz[1] / anatomicalRangeY;
-            const float z = xyz[2] / anatomicalRangeZ;
-            
-            const float radius = std::sqrt(x*x + y*y + z*z);
-            const float scale  = 1.0 + inflationFactor * (1.0 - radius);
-            
-            xyz[0] *= scale;
-            xyz[1] *= scale;
-            xyz[2] *= scale;
-            
-            outputSurfaceFile->setCoordinate(iNode,
-                                             xyz);
-        }
-        
-        myProgress.reportProgress(static_cast<float>(iCycle +1)
-                                  / static_cast<float>(cycles));
+        mySmoothHelp.inflate(anatomicalRangeX,
+                             anatomicalRangeY,
+                             anatomicalRangeZ,
+                             inflationFactor);
     }
     
+    std::vector<float> coords;
+    mySmoothHelp.getCoordinates(coords);
+    outputSurfaceFile->setCoordinates(&coords[0]);
+    
     outputSurfaceFile->computeNormals();
 }
 
@@ -219,7 +211,7 @@ AlgorithmSurfaceInflation::getAlgorithmInternalWeight()
     /*
      * override this if needed, if the progress bar isn't smooth
      */
-    return 0.1f;//all this does internally is rescale the coordinates, lower the internal weight
+    return 1.0f;//smoothing is done internally with the smoothing helper
 }
 
 /**
@@ -231,6 +223,7 @@ AlgorithmSurfaceInflation::getSubAlgorithmWeight()
     /*
      * If you use a subalgorithm
      */
-    return AlgorithmSurfaceSmoothing::getAlgorithmWeight();
+    //return AlgorithmInsertNameHere::getAlgorithmWeight()
+    return 0.0f;
 }
 
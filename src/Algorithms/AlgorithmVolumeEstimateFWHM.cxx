@@ -21,6 +21,8 @@
 #include "AlgorithmVolumeEstimateFWHM.h"
 #include "AlgorithmException.h"
 
+#include "CaretOMP.h"
+
 #include <cmath>
 #include <iostream>
 
@@ -99,11 +101,12 @@ void AlgorithmVolumeEstimateFWHM::useParameters(OperationParameters* myParams, P
     } else {
         if (subvolNum == -1)
         {
+            vector<Vector3D> results = estimateFWHMEachFrame(myVol, roiVol);
             for (int64_t s = 0; s < dims[3]; ++s)
             {
                 for (int64_t c = 0; c < dims[4]; ++c)
                 {
-                    Vector3D result = estimateFWHM(myVol, roiVol, s, c);
+                    const Vector3D& result = results[c * dims[3] + s];
                     if (dims[3] != 1) cout << "subvol " << s + 1 << " ";
                     if (dims[4] != 1) cout << "component " << c + 1 << " ";
                     cout << "FWHM: " << result[0] << ", " << result[1] << ", " << result[2] << endl;
@@ -121,129 +124,266 @@ void AlgorithmVolumeEstimateFWHM::useParameters(OperationParameters* myParams, P
     }
 }
 
-Vector3D AlgorithmVolumeEstimateFWHM::estimateFWHM(const VolumeFile* input, const VolumeFile* roi, const int64_t& brickIndex, const int64_t& component)
+namespace
 {
-    if (roi != NULL && !roi->matchesVolumeSpace(input))
+    //for derivation, see Forman, S.D., Cohen, J.D., Fitzgerald, M., Eddy, W.F., Mintun, M.A., Noll, D.C., 1995.
+    //Improved assessment of significant activation in functional magnetic resonance imaging (fMRI): use of a cluster-size threshold.
+    //Magn. Reson. Med. 33, 636–647.
+    struct VolumeEdges//in-roi voxels as runs along i, in-roi FORWARD neighbors are found by grid stride, so memory doesn't grow with voxels * neighbors
     {
-        throw AlgorithmException("roi volume does not match the space of the input volume");
-    }
-    vector<int64_t> dims;
-    input->getDimensions(dims);
-    double globalaccum = 0.0;
-    int64_t globalCount = 0;
-    double diraccum[3] = {0.0, 0.0, 0.0};
-    int64_t dirCount[3] = {0, 0, 0};
-    for (int64_t k = 0; k < dims[2]; ++k)//2 pass method, first find means of values and of FORWARD differences only - this removes global gradient effects
-    {//for derivation, see Forman, S.D., Cohen, J.D., Fitzgerald, M., Eddy, W.F., Mintun, M.A., Noll, D.C., 1995.
-        for (int64_t j = 0; j < dims[1]; ++j)//Improved assessment of significant activation in functional magnetic resonance imaging (fMRI): use of a cluster-size threshold. 
-        {//Magn. Reson. Med. 33, 636–647.
-            for (int64_t i = 0; i < dims[0]; ++i)
+        struct Run
+        {
+            int64_t start, length, j, k;//start is a frame index
+        };
+        vector<Run> runs;
+        vector<char> inRoi;//frame-sized, empty when there is no roi
+        int64_t dims[3], stride[3], numVoxels, numEdges[3];
+        //whether the forward neighbor along dir of voxel i in the run is also used
+        bool hasForward(const Run& run, const int64_t& i, const int& dir) const
+        {
+            switch (dir)
             {
-                if (roi == NULL || roi->getValue(i, j, k) > 0.0f)
+                case 0:
+                    return i + 1 < run.length;//runs end at the row end or the first voxel outside the roi
+                case 1:
+                    return run.j + 1 < dims[1] && (inRoi.empty() || inRoi[run.start + i + stride[1]] != 0);
+                default:
+                    return run.k + 1 < dims[2] && (inRoi.empty() || inRoi[run.start + i + stride[2]] != 0);
+            }
+        }
+    };
+    
+    void getVolumeEdges(const VolumeFile* input, const VolumeFile* roi, VolumeEdges& edgesOut)
+    {
+        vector<int64_t> dims;
+        input->getDimensions(dims);
+        for (int i = 0; i < 3; ++i)
+        {
+            edgesOut.dims[i] = dims[i];
+        }
+        edgesOut.stride[0] = 1;
+        edgesOut.stride[1] = dims[0];
+        edgesOut.stride[2] = dims[0] * dims[1];
+        edgesOut.runs.clear();
+        edgesOut.inRoi.clear();
+        if (roi != NULL)
+        {
+            edgesOut.inRoi.resize(dims[0] * dims[1] * dims[2]);
+            VolumeFramePin roiPin;
+            const float* roiFrame = roi->getFrame(0, 0, roiPin);
+            for (int64_t v = 0; v < (int64_t)edgesOut.inRoi.size(); ++v)
+            {
+                edgesOut.inRoi[v] = (roiFrame[v] > 0.0f ? 1 : 0);
+            }
+        }
+        for (int64_t k = 0; k < dims[2]; ++k)
+        {
+            for (int64_t j = 0; j < dims[1]; ++j)
+            {
+                const int64_t rowStart = input->getIndex((int64_t)0, j, k);
+                for (int64_t i = 0; i < dims[0]; ++i)
                 {
-                    float center = input->getValue(i, j, k, brickIndex, component);
-                    globalaccum += center;
-                    ++globalCount;
-                    if (i + 1 < dims[0] && (roi == NULL || roi->getValue(i + 1, j, k) > 0.0f))//use ONLY forward differences, to avoid double counting
-                    {
-                        float diff = center - input->getValue(i + 1, j, k, brickIndex, component);
-                        diraccum[0] += diff;
-                        ++dirCount[0];
-                    }
-                    if (j + 1 < dims[1] && (roi == NULL || roi->getValue(i, j + 1, k) > 0.0f))//use ONLY forward differences, to avoid double counting
+                    if (!edgesOut.inRoi.empty() && edgesOut.inRoi[rowStart + i] == 0) continue;
+                    if (i == 0 || edgesOut.runs.empty() || edgesOut.runs.back().start + edgesOut.runs.back().length != rowStart + i)
                     {
-                        float diff = center - input->getValue(i, j + 1, k, brickIndex, component);
-                        diraccum[1] += diff;
-                        ++dirCount[1];
-                    }
-                    if (k + 1 < dims[2] && (roi == NULL || roi->getValue(i, j, k + 1) > 0.0f))//use ONLY forward differences, to avoid double counting
-                    {
-                        float diff = center - input->getValue(i, j, k + 1, brickIndex, component);
-                        diraccum[2] += diff;
-                        ++dirCount[2];
+                        VolumeEdges::Run newRun = { rowStart + i, 0, j, k };
+                        edgesOut.runs.push_back(newRun);
                     }
+                    ++edgesOut.runs.back().length;
+                }
+            }
+        }
+        edgesOut.numVoxels = 0;
+        for (int dir = 0; dir < 3; ++dir)
+        {
+            edgesOut.numEdges[dir] = 0;
+        }
+        for (size_t r = 0; r < edgesOut.runs.size(); ++r)
+        {
+            const VolumeEdges::Run& thisRun = edgesOut.runs[r];
+            edgesOut.numVoxels += thisRun.length;
+            for (int64_t i = 0; i < thisRun.length; ++i)
+            {
+                for (int dir = 0; dir < 3; ++dir)
+                {
+                    if (edgesOut.hasForward(thisRun, i, dir)) ++edgesOut.numEdges[dir];
                 }
             }
         }
     }
-    if (globalCount == 0) throw AlgorithmException("ROI is empty or volume file has no voxels");
-    float dirmean[3];
-    for (int i = 0; i < 3; ++i)
+    
+    struct FrameStats
     {
-        dirmean[i] = diraccum[i] / dirCount[i];//we will fix NaNs later
-        diraccum[i] = 0.0;
-    }
-    float globalmean = globalaccum / globalCount;
-    globalaccum = 0;
-    for (int64_t k = 0; k < dims[2]; ++k)//now, find the variances
+        double sum, sumSqDev, dirSum[3], dirSqDev[3];//deviations are around the means of this frame alone
+    };
+    
+    FrameStats getFrameStats(const float* frame, const double* meanImage, const VolumeEdges& edges, vector<float>& scratch)
     {
-        for (int64_t j = 0; j < dims[1]; ++j)
+        const int64_t numUsed = edges.numVoxels;
+        const int64_t numRuns = (int64_t)edges.runs.size();
+        if (meanImage != NULL)
         {
-            for (int64_t i = 0; i < dims[0]; ++i)
+            scratch.resize(numRuns == 0 ? 0 : edges.runs.back().start + edges.runs.back().length);//runs are in increasing order
+            for (int64_t r = 0; r < numRuns; ++r)
             {
-                if (roi == NULL || roi->getValue(i, j, k) > 0.0f)
+                for (int64_t v = edges.runs[r].start; v < edges.runs[r].start + edges.runs[r].length; ++v)
                 {
-                    float center = input->getValue(i, j, k, brickIndex, component);
-                    float tempf = center - globalmean;
-                    globalaccum += tempf * tempf;
-                    if (i + 1 < dims[0] && (roi == NULL || roi->getValue(i + 1, j, k) > 0.0f))//use ONLY forward differences, to avoid double counting
-                    {
-                        float diff = center - input->getValue(i + 1, j, k, brickIndex, component);
-                        tempf = diff - dirmean[0];
-                        diraccum[0] += tempf * tempf;
-                    }
-                    if (j + 1 < dims[1] && (roi == NULL || roi->getValue(i, j + 1, k) > 0.0f))//use ONLY forward differences, to avoid double counting
-                    {
-                        float diff = center - input->getValue(i, j + 1, k, brickIndex, component);
-                        tempf = diff - dirmean[1];
-                        diraccum[1] += tempf * tempf;
-                    }
-                    if (k + 1 < dims[2] && (roi == NULL || roi->getValue(i, j, k + 1) > 0.0f))//use ONLY forward differences, to avoid double counting
-                    {
-                        float diff = center - input->getValue(i, j, k + 1, brickIndex, component);
-                        tempf = diff - dirmean[2];
-                        diraccum[2] += tempf * tempf;
-                    }
+                    scratch[v] = frame[v] - meanImage[v];
+                }
+            }
+            frame = scratch.data();
+        }
+        FrameStats ret;
+        ret.sum = 0.0;
+        for (int64_t r = 0; r < numRuns; ++r)
+        {
+            for (int64_t v = edges.runs[r].start; v < edges.runs[r].start + edges.runs[r].length; ++v)
+            {
+                ret.sum += frame[v];
+            }
+        }
+        double frameMean = ret.sum / numUsed;
+        ret.sumSqDev = 0.0;
+        for (int64_t r = 0; r < numRuns; ++r)
+        {
+            for (int64_t v = edges.runs[r].start; v < edges.runs[r].start + edges.runs[r].length; ++v)
+            {
+                double tempd = frame[v] - frameMean;
+                ret.sumSqDev += tempd * tempd;
+            }
+        }
+        for (int dir = 0; dir < 3; ++dir)//2 pass method, use the mean of the FORWARD differences only - this removes global gradient effects
+        {
+            const int64_t numEdges = edges.numEdges[dir], stride = edges.stride[dir];
+            ret.dirSum[dir] = 0.0;
+            for (int64_t r = 0; r < numRuns; ++r)
+            {
+                const VolumeEdges::Run& thisRun = edges.runs[r];
+                for (int64_t i = 0; i < thisRun.length; ++i)
+                {
+                    if (!edges.hasForward(thisRun, i, dir)) continue;
+                    const int64_t v = thisRun.start + i;
+                    ret.dirSum[dir] += frame[v] - frame[v + stride];
+                }
+            }
+            ret.dirSqDev[dir] = 0.0;
+            if (numEdges == 0) continue;
+            double dirMean = ret.dirSum[dir] / numEdges;
+            for (int64_t r = 0; r < numRuns; ++r)
+            {
+                const VolumeEdges::Run& thisRun = edges.runs[r];
+                for (int64_t i = 0; i < thisRun.length; ++i)
+                {
+                    if (!edges.hasForward(thisRun, i, dir)) continue;
+                    const int64_t v = thisRun.start + i;
+                    double tempd = (frame[v] - frame[v + stride]) - dirMean;
+                    ret.dirSqDev[dir] += tempd * tempd;
                 }
             }
         }
+        return ret;
     }
-    float dirvariance[3];
-    float fwhms[3];
-    float globalvariance = globalaccum / globalCount;
-    const VolumeSpace& volSpace = input->getVolumeSpace();
-    Vector3D spacingVecs[4];
-    volSpace.getSpacingVectors(spacingVecs[0], spacingVecs[1], spacingVecs[2], spacingVecs[3]);
-    for (int i = 0; i < 3; ++i)
+    
+    //frames are independent, so do them in parallel, order of combining stays fixed
+    void getAllFrameStats(const VolumeFile* input, const vector<vector<double> >& meanImage, const VolumeEdges& edges, vector<FrameStats>& statsOut)
     {
-        if (dirCount[i] > 0)
+        vector<int64_t> dims;
+        input->getDimensions(dims);
+        int64_t numFrames = dims[3] * dims[4];
+        statsOut.resize(numFrames);
+#pragma omp CARET_PAR
         {
-            dirvariance[i] = diraccum[i] / dirCount[i];
-        } else {
-            dirvariance[i] = 0.0;//avoid NaN for variance...however, 0 directional variance means the formula will become NaN...
+            vector<float> scratch;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t f = 0; f < numFrames; ++f)
+            {
+                int64_t component = f / dims[3], brickIndex = f % dims[3];
+                const double* componentMean = (meanImage.empty() ? NULL : meanImage[component].data());
+                VolumeFramePin framePin;//other threads are loading frames too
+                statsOut[f] = getFrameStats(input->getFrame(brickIndex, component, framePin), componentMean, edges, scratch);
+            }
         }
-        fwhms[i] = spacingVecs[i].length() * sqrt(-2.0f * log(2.0f) / log(1.0f - dirvariance[i] / (2.0f * globalvariance)));
     }
-    Vector3D ret;
-    VolumeSpace::OrientTypes myorient[3];
-    volSpace.getOrientation(myorient);
-    for (int i = 0; i < 3; ++i)
+    
+    Vector3D fwhmFromVariances(const VolumeSpace& volSpace, const float globalvariance, const float dirvariance[3])
     {
-        switch (myorient[i])
+        float fwhms[3];
+        Vector3D spacingVecs[4];
+        volSpace.getSpacingVectors(spacingVecs[0], spacingVecs[1], spacingVecs[2], spacingVecs[3]);
+        for (int i = 0; i < 3; ++i)
         {
-            case VolumeSpace::LEFT_TO_RIGHT:
-            case VolumeSpace::RIGHT_TO_LEFT:
-                ret[0] = fwhms[i];
-                break;
-            case VolumeSpace::POSTERIOR_TO_ANTERIOR:
-            case VolumeSpace::ANTERIOR_TO_POSTERIOR:
-                ret[1] = fwhms[i];
-                break;
-            case VolumeSpace::INFERIOR_TO_SUPERIOR:
-            case VolumeSpace::SUPERIOR_TO_INFERIOR:
-                ret[2] = fwhms[i];
-                break;
+            fwhms[i] = spacingVecs[i].length() * sqrt(-2.0f * log(2.0f) / log(1.0f - dirvariance[i] / (2.0f * globalvariance)));
         }
+        Vector3D ret;
+        VolumeSpace::OrientTypes myorient[3];
+        volSpace.getOrientation(myorient);
+        for (int i = 0; i < 3; ++i)
+        {
+            switch (myorient[i])
+            {
+                case VolumeSpace::LEFT_TO_RIGHT:
+                case VolumeSpace::RIGHT_TO_LEFT:
+                    ret[0] = fwhms[i];
+                    break;
+                case VolumeSpace::POSTERIOR_TO_ANTERIOR:
+                case VolumeSpace::ANTERIOR_TO_POSTERIOR:
+                    ret[1] = fwhms[i];
+                    break;
+                case VolumeSpace::INFERIOR_TO_SUPERIOR:
+                case VolumeSpace::SUPERIOR_TO_INFERIOR:
+                    ret[2] = fwhms[i];
+                    break;
+            }
+        }
+        return ret;
+    }
+    
+    Vector3D fwhmFromFrameStats(const VolumeSpace& volSpace, const FrameStats& stats, const VolumeEdges& edges)
+    {
+        float dirvariance[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            if (edges.numEdges[i] != 0)
+            {
+                dirvariance[i] = stats.dirSqDev[i] / edges.numEdges[i];
+            } else {
+                dirvariance[i] = 0.0;//avoid NaN for variance...however, 0 directional variance means the formula will become NaN...
+            }
+        }
+        return fwhmFromVariances(volSpace, stats.sumSqDev / edges.numVoxels, dirvariance);
+    }
+}
+
+Vector3D AlgorithmVolumeEstimateFWHM::estimateFWHM(const VolumeFile* input, const VolumeFile* roi, const int64_t& brickIndex, const int64_t& component)
+{
+    if (roi != NULL && !roi->matchesVolumeSpace(input))
+    {
+        throw AlgorithmException("roi volume does not match the space of the input volume");
+    }
+    VolumeEdges edges;
+    getVolumeEdges(input, roi, edges);
+    if (edges.numVoxels == 0) throw AlgorithmException("ROI is empty or volume file has no voxels");
+    vector<float> scratch;
+    VolumeFramePin framePin;
+    FrameStats stats = getFrameStats(input->getFrame(brickIndex, component, framePin), NULL, edges, scratch);
+    return fwhmFromFrameStats(input->getVolumeSpace(), stats, edges);
+}
+
+vector<Vector3D> AlgorithmVolumeEstimateFWHM::estimateFWHMEachFrame(const VolumeFile* input, const VolumeFile* roi)
+{
+    if (roi != NULL && !roi->matchesVolumeSpace(input))
+    {
+        throw AlgorithmException("roi volume does not match the space of the input volume");
+    }
+    VolumeEdges edges;
+    getVolumeEdges(input, roi, edges);
+    if (edges.numVoxels == 0) throw AlgorithmException("ROI is empty or volume file has no voxels");
+    vector<FrameStats> stats;
+    getAllFrameStats(input, vector<vector<double> >(), edges, stats);
+    vector<Vector3D> ret(stats.size());
+    for (size_t f = 0; f < stats.size(); ++f)
+    {
+        ret[f] = fwhmFromFrameStats(input->getVolumeSpace(), stats[f], edges);
     }
     return ret;
 }
@@ -254,11 +394,13 @@ Vector3D AlgorithmVolumeEstimateFWHM::estimateFWHMAllFrames(const VolumeFile* in
     {
         throw AlgorithmException("roi volume does not match the space of the input volume");
     }
-    const float* roiFrame = NULL;
-    if (roi != NULL) roiFrame = roi->getFrame();
     vector<int64_t> dims;
     input->getDimensions(dims);
     int64_t frameSize = dims[0] * dims[1] * dims[2];
+    VolumeEdges edges;
+    getVolumeEdges(input, roi, edges);
+    if (edges.numVoxels == 0) throw AlgorithmException("ROI is empty or volume file has no voxels");
+    const int64_t numUsed = edges.numVoxels;
     vector<vector<double> > meanimage;
     if (demean)
     {
@@ -267,177 +409,66 @@ Vector3D AlgorithmVolumeEstimateFWHM::estimateFWHMAllFrames(const VolumeFile* in
         {
             for (int64_t brickIndex = 0; brickIndex < dims[3]; ++brickIndex)
             {
-                const float* frame = input->getFrame(brickIndex, component);
-                for (int64_t i = 0; i < frameSize; ++i)
+                VolumeFramePin framePin;
+                const float* frame = input->getFrame(brickIndex, component, framePin);
+                for (size_t r = 0; r < edges.runs.size(); ++r)//only computing the mean image inside the ROI reduces the working set
                 {
-                    if (roiFrame == NULL || roiFrame[i] > 0.0f)
-                    {//only computing the mean image inside the ROI reduces the working set
-                        meanimage[component][i] += frame[i];
+                    for (int64_t v = edges.runs[r].start; v < edges.runs[r].start + edges.runs[r].length; ++v)
+                    {
+                        meanimage[component][v] += frame[v];
                     }
                 }
             }
-            for (int64_t i = 0; i < frameSize; ++i)
+            for (size_t r = 0; r < edges.runs.size(); ++r)
             {
-                if (roiFrame == NULL || roiFrame[i] > 0.0f)
+                for (int64_t v = edges.runs[r].start; v < edges.runs[r].start + edges.runs[r].length; ++v)
                 {
-                    meanimage[component][i] /= dims[3];
+                    meanimage[component][v] /= dims[3];
                 }
             }
         }
     }
+    vector<FrameStats> stats;
+    getAllFrameStats(input, meanimage, edges, stats);
+    int64_t numFrames = (int64_t)stats.size();
     double globalaccum = 0.0;
-    int64_t globalCount = 0;
     double diraccum[3] = {0.0, 0.0, 0.0};
-    int64_t dirCount[3] = {0, 0, 0};
-    vector<float> demeaned;//less reallocation
-    if (demean) demeaned.resize(frameSize);
-    for (int64_t component = 0; component < dims[4]; ++component)
+    for (int64_t f = 0; f < numFrames; ++f)
     {
-        for (int64_t brickIndex = 0; brickIndex < dims[3]; ++brickIndex)
+        globalaccum += stats[f].sum;
+        for (int i = 0; i < 3; ++i)
         {
-            const float* frame = input->getFrame(brickIndex, component);
-            if (demean)
-            {
-                for (int64_t i = 0; i < frameSize; ++i)
-                {
-                    if (roiFrame == NULL || roiFrame[i] > 0.0f)
-                    {//again, to keep working set down
-                        demeaned[i] = frame[i] - meanimage[component][i];
-                    }
-                }
-                frame = demeaned.data();
-            }
-            for (int64_t k = 0; k < dims[2]; ++k)
-            {
-                for (int64_t j = 0; j < dims[1]; ++j)
-                {
-                    for (int64_t i = 0; i < dims[0]; ++i)
-                    {
-                        if (roi == NULL || roi->getValue(i, j, k) > 0.0f)
-                        {
-                            float center = frame[input->getIndex(i, j, k)];
-                            globalaccum += center;
-                            ++globalCount;
-                            if (i + 1 < dims[0] && (roi == NULL || roi->getValue(i + 1, j, k) > 0.0f))//use ONLY forward differences, to avoid double counting
-                            {
-                                float diff = center - frame[input->getIndex(i + 1, j, k)];
-                                diraccum[0] += diff;
-                                ++dirCount[0];
-                            }
-                            if (j + 1 < dims[1] && (roi == NULL || roi->getValue(i, j + 1, k) > 0.0f))//use ONLY forward differences, to avoid double counting
-                            {
-                                float diff = center - frame[input->getIndex(i, j + 1, k)];
-                                diraccum[1] += diff;
-                                ++dirCount[1];
-                            }
-                            if (k + 1 < dims[2] && (roi == NULL || roi->getValue(i, j, k + 1) > 0.0f))//use ONLY forward differences, to avoid double counting
-                            {
-                                float diff = center - frame[input->getIndex(i, j, k + 1)];
-                                diraccum[2] += diff;
-                                ++dirCount[2];
-                            }
-                        }
-                    }
-                }
-            }
+            diraccum[i] += stats[f].dirSum[i];
         }
     }
-    if (globalCount == 0) throw AlgorithmException("ROI is empty or volume file has no voxels");
-    float dirmean[3];
+    double globalmean = globalaccum / (numUsed * numFrames), dirmean[3];
     for (int i = 0; i < 3; ++i)
     {
-        dirmean[i] = diraccum[i] / dirCount[i];//we will fix NaNs later
+        dirmean[i] = diraccum[i] / (edges.numEdges[i] * numFrames);//we will fix NaNs later
         diraccum[i] = 0.0;
     }
-    float globalmean = globalaccum / globalCount;
     globalaccum = 0.0;
-    for (int64_t component = 0; component < dims[4]; ++component)
+    for (int64_t f = 0; f < numFrames; ++f)//combine the per-frame deviations into deviations around the means of all frames
     {
-        for (int64_t brickIndex = 0; brickIndex < dims[3]; ++brickIndex)
+        double tempd = stats[f].sum / numUsed - globalmean;
+        globalaccum += stats[f].sumSqDev + numUsed * tempd * tempd;
+        for (int i = 0; i < 3; ++i)
         {
-            const float* frame = input->getFrame(brickIndex, component);
-            if (demean)
-            {
-                for (int64_t i = 0; i < frameSize; ++i)
-                {
-                    if (roiFrame == NULL || roiFrame[i] > 0.0f)
-                    {
-                        demeaned[i] = frame[i] - meanimage[component][i];
-                    }
-                }
-                frame = demeaned.data();
-            }
-            for (int64_t k = 0; k < dims[2]; ++k)//now, find the variances
-            {
-                for (int64_t j = 0; j < dims[1]; ++j)
-                {
-                    for (int64_t i = 0; i < dims[0]; ++i)
-                    {
-                        if (roi == NULL || roi->getValue(i, j, k) > 0.0f)
-                        {
-                            float center = frame[input->getIndex(i, j, k)];
-                            float tempf = center - globalmean;
-                            globalaccum += tempf * tempf;
-                            if (i + 1 < dims[0] && (roi == NULL || roi->getValue(i + 1, j, k) > 0.0f))//use ONLY forward differences, to avoid double counting
-                            {
-                                float diff = center - frame[input->getIndex(i + 1, j, k)];
-                                tempf = diff - dirmean[0];
-                                diraccum[0] += tempf * tempf;
-                            }
-                            if (j + 1 < dims[1] && (roi == NULL || roi->getValue(i, j + 1, k) > 0.0f))//use ONLY forward differences, to avoid double counting
-                            {
-                                float diff = center - frame[input->getIndex(i, j + 1, k)];
-                                tempf = diff - dirmean[1];
-                                diraccum[1] += tempf * tempf;
-                            }
-                            if (k + 1 < dims[2] && (roi == NULL || roi->getValue(i, j, k + 1) > 0.0f))//use ONLY forward differences, to avoid double counting
-                            {
-                                float diff = center - frame[input->getIndex(i, j, k + 1)];
-                                tempf = diff - dirmean[2];
-                                diraccum[2] += tempf * tempf;
-                            }
-                        }
-                    }
-                }
-            }
+            int64_t dirCount = edges.numEdges[i];
+            if (dirCount == 0) continue;
+            tempd = stats[f].dirSum[i] / dirCount - dirmean[i];
+            diraccum[i] += stats[f].dirSqDev[i] + dirCount * tempd * tempd;
         }
     }
     float dirvariance[3];
-    float fwhms[3];
-    float globalvariance = globalaccum / globalCount;
-    const VolumeSpace& volSpace = input->getVolumeSpace();
-    Vector3D spacingVecs[4];
-    volSpace.getSpacingVectors(spacingVecs[0], spacingVecs[1], spacingVecs[2], spacingVecs[3]);
     for (int i = 0; i < 3; ++i)
     {
-        if (dirCount[i] > 0)
+        if (edges.numEdges[i] != 0)
         {
-            dirvariance[i] = diraccum[i] / dirCount[i];
+            dirvariance[i] = diraccum[i] / (edges.numEdges[i] * numFrames);
         } else {
             dirvariance[i] = 0.0;
         }
-        fwhms[i] = spacingVecs[i].length() * sqrt(-2.0f * log(2.0f) / log(1.0f - dirvariance[i] / (2.0f * globalvariance)));
-    }
-    Vector3D ret;
-    VolumeSpace::OrientTypes myorient[3];
-    volSpace.getOrientation(myorient);
-    for (int i = 0; i < 3; ++i)
-    {
-        switch (myorient[i])
-        {
-            case VolumeSpace::LEFT_TO_RIGHT:
-            case VolumeSpace::RIGHT_TO_LEFT:
-                ret[0] = fwhms[i];
-                break;
-            case VolumeSpace::POSTERIOR_TO_ANTERIOR:
-            case VolumeSpace::ANTERIOR_TO_POSTERIOR:
-                ret[1] = fwhms[i];
-                break;
-            case VolumeSpace::INFERIOR_TO_SUPERIOR:
-            case VolumeSpace::SUPERIOR_TO_INFERIOR:
-                ret[2] = fwhms[i];
-                break;
-        }
     }
-    return ret;
+    return fwhmFromVariances(input->getVolumeSpace(), globalaccum / (numUsed * numFrames), dirvariance);
 }
@@ -26,6 +26,8 @@
 #include "Vector3D.h"
 #include "VolumeFile.h"
 
+#include <vector>
+
 namespace caret {
     
     class AlgorithmVolumeEstimateFWHM : public AbstractAlgorithm
@@ -37,6 +39,8 @@ namespace caret {
         static AString getShortDescription();
         
         static Vector3D estimateFWHM(const VolumeFile* input, const VolumeFile* roi = NULL, const int64_t& brickIndex = 0, const int64_t& component = 0);
+        ///same as estimateFWHM on each frame, but only finds the roi neighbors once, and does frames in parallel, indexed by component * numSubvols + subvol
+        static std::vector<Vector3D> estimateFWHMEachFrame(const VolumeFile* input, const VolumeFile* roi = NULL);
         static Vector3D estimateFWHMAllFrames(const VolumeFile* input, const VolumeFile* roi = NULL, bool demean = false);
     };
 
@@ -23,10 +23,11 @@
 
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 #include "CaretPointLocator.h"
+#include "ConnectedComponentHelper.h"
 #include "VolumeFile.h"
-#include "VoxelIJK.h"
 
 #include <cmath>
 #include <vector>
@@ -136,23 +137,23 @@ void AlgorithmVolumeFindClusters::useParameters(OperationParameters* myParams, P
 
 namespace
 {
-    void processSubvol(const float* inFrame, VolumeFile* volOut, const int64_t& outSubvol, const int64_t& outComponent, const float& threshValue, const float& minVolume,
-                       const bool& lessThan, const float* roiFrame, const float& sizeRatio, const float& distanceCutoff, int& markVal)
+    void indexToIJK(const int64_t& index, const vector<int64_t>& dims, int64_t ijkOut[3])
     {
-        vector<int64_t> dims = volOut->getDimensions();
+        ijkOut[0] = index % dims[0];
+        ijkOut[1] = (index / dims[0]) % dims[1];
+        ijkOut[2] = index / (dims[0] * dims[1]);
+    }
+    
+    void processSubvol(const float* inFrame, const VolumeSpace& mySpace, const float& threshValue, const float& minVolume,
+                       const bool& lessThan, const float* roiFrame, const float& sizeRatio, const float& distanceCutoff, vector<vector<int64_t> >& clusters)
+    {
+        const int64_t* dimsPtr = mySpace.getDims();
+        vector<int64_t> dims(dimsPtr, dimsPtr + 3);
         int64_t frameSize = dims[0] * dims[1] * dims[2];
-        const VolumeSpace& mySpace = volOut->getVolumeSpace();
         Vector3D ivec, jvec, kvec, origin;
         mySpace.getSpacingVectors(ivec, jvec, kvec, origin);
         float voxelVolume = abs(ivec.dot(jvec.cross(kvec)));
         int64_t minVoxels = (int64_t)ceil(minVolume / voxelVolume);
-        vector<VoxelIJK> neighbors;
-        neighbors.push_back(VoxelIJK(1, 0, 0));
-        neighbors.push_back(VoxelIJK(-1, 0, 0));
-        neighbors.push_back(VoxelIJK(0, 1, 0));
-        neighbors.push_back(VoxelIJK(0, -1, 0));
-        neighbors.push_back(VoxelIJK(0, 0, 1));
-        neighbors.push_back(VoxelIJK(0, 0, -1));
         vector<char> marked(frameSize, 0);
         if (lessThan)
         {
@@ -172,51 +173,24 @@ namespace
                 }
             }
         }
-        vector<vector<VoxelIJK> > clusters;
+        vector<int64_t> labels;
+        int64_t numComponents = ConnectedComponentHelper::labelVolume(dimsPtr, 6, marked.data(), labels);//face neighbors only
+        vector<vector<int64_t> > members;
+        ConnectedComponentHelper::getMembers(labels, numComponents, members);
+        clusters.clear();
         size_t biggestCount = 0;
         int64_t biggestCluster = -1;
-        for (int64_t k = 0; k < dims[2]; ++k)
+        for (int64_t c = 0; c < numComponents; ++c)//components are numbered by lowest voxel index, the same order the clusters used to be found in
         {
-            for (int64_t j = 0; j < dims[1]; ++j)
+            if ((int64_t)members[c].size() >= minVoxels)
             {
-                for (int64_t i = 0; i < dims[0]; ++i)
+                if (members[c].size() > biggestCount)
                 {
-                    int64_t myIndex = mySpace.getIndex(i, j, k);
-                    if (marked[myIndex])
-                    {
-                        vector<VoxelIJK> voxelList;
-                        voxelList.push_back(VoxelIJK(i, j, k));
-                        marked[myIndex] = 0;//don't let voxels get duplicated in the list
-                        for (int64_t index = 0; index < (int64_t)voxelList.size(); ++index)//NOTE: vector grows inside loop
-                        {
-                            const VoxelIJK& thisVoxel = voxelList[index];
-                            for (int n = 0; n < (int)neighbors.size(); ++n)
-                            {
-                                VoxelIJK neighVox(thisVoxel.m_ijk[0] + neighbors[n].m_ijk[0],
-                                                    thisVoxel.m_ijk[1] + neighbors[n].m_ijk[1],
-                                                    thisVoxel.m_ijk[2] + neighbors[n].m_ijk[2]);
-                                if (mySpace.indexValid(neighVox.m_ijk))
-                                {
-                                    int64_t neighIndex = mySpace.getIndex(neighVox.m_ijk);
-                                    if (marked[neighIndex])
-                                    {
-                                        voxelList.push_back(neighVox);
-                                        marked[neighIndex] = 0;
-                                    }
-                                }
-                            }
-                        }
-                        if ((int64_t)voxelList.size() >= minVoxels)
-                        {
-                            if (voxelList.size() > biggestCount)
-                            {
-                                biggestCount = voxelList.size();
-                                biggestCluster = (int64_t)clusters.size();
-                            }
-                            clusters.push_back(voxelList);
-                        }
-                    }
+                    biggestCount = members[c].size();
+                    biggestCluster = (int64_t)clusters.size();
                 }
+                clusters.push_back(vector<int64_t>());
+                clusters.back().swap(members[c]);
             }
         }
         if (!clusters.empty()) CaretAssert(biggestCluster != -1);
@@ -229,8 +203,10 @@ namespace
                 biggestCoords.reserve(biggestCount * 3);
                 for (size_t i = 0; i < clusters[biggestCluster].size(); ++i)
                 {
+                    int64_t thisIJK[3];
                     float thisCoord[3];
-                    mySpace.indexToSpace(clusters[biggestCluster][i].m_ijk, thisCoord);
+                    indexToIJK(clusters[biggestCluster][i], dims, thisIJK);
+                    mySpace.indexToSpace(thisIJK, thisCoord);
                     biggestCoords.push_back(thisCoord[0]);
                     biggestCoords.push_back(thisCoord[1]);
                     biggestCoords.push_back(thisCoord[2]);
@@ -251,8 +227,10 @@ namespace
                         erase = true;//erase unless we find a point close enough to the biggest cluster
                         for (size_t j = 0; j < clusters[i].size(); ++j)
                         {
+                            int64_t thisIJK[3];
                             float thisCoord[3];
-                            mySpace.indexToSpace(clusters[i][j].m_ijk, thisCoord);
+                            indexToIJK(clusters[i][j], dims, thisIJK);
+                            mySpace.indexToSpace(thisIJK, thisCoord);
                             int32_t ret = myLocator->closestPointLimited(thisCoord, distanceCutoff);
                             if (ret == -1)
                             {
@@ -270,6 +248,11 @@ namespace
                 }
             }
         }
+    }
+    
+    //returns false if the cluster values can't be represented exactly
+    bool markClusters(const vector<vector<int64_t> >& clusters, float* outFrame, int& markVal)
+    {
         for (size_t i = 0; i < clusters.size(); ++i)
         {
             if (markVal == 0)
@@ -278,13 +261,14 @@ namespace
                 ++markVal;
             }
             float tempVal = markVal;
-            if ((int)tempVal != markVal) throw AlgorithmException("too many clusters, unable to mark them uniquely");
+            if ((int)tempVal != markVal) return false;
             for (size_t index = 0; index < clusters[i].size(); ++index)
             {
-                volOut->setValue(tempVal, clusters[i][index].m_ijk, outSubvol, outComponent);
+                outFrame[clusters[i][index]] = tempVal;
             }
             ++markVal;
         }
+        return true;
     }
 }
 
@@ -299,36 +283,44 @@ AlgorithmVolumeFindClusters::AlgorithmVolumeFindClusters(ProgressObject* myProgO
     }
     const VolumeSpace& mySpace = volIn->getVolumeSpace();
     const float* roiFrame = NULL;
+    VolumeFramePin roiPin;//the roi frame is used for every frame
     if (myRoi != NULL)
     {
         if (!mySpace.matches(myRoi->getVolumeSpace())) throw AlgorithmException("roi volume space does not match input");
-        roiFrame = myRoi->getFrame();
+        roiFrame = myRoi->getFrame(0, 0, roiPin);
     }
     vector<int64_t> dims = volIn->getDimensions();
     int markVal = startVal;
-    if (subvolNum == -1)
+    bool markOverflow = false;
+    vector<int64_t> outDims = volIn->getOriginalDimensions();
+    int64_t numSubvols = dims[3];
+    if (subvolNum != -1)
     {
-        volOut->reinitialize(volIn->getOriginalDimensions(), volIn->getSform(), dims[4], SubvolumeAttributes::ANATOMY, volIn->m_header);
-        volOut->setValueAllVoxels(0.0f);
-        for (int64_t c = 0; c < dims[4]; ++c)
-        {
-            for (int64_t s = 0; s < dims[3]; ++s)
-            {
-                const float* inFrame = volIn->getFrame(s, c);
-                processSubvol(inFrame, volOut, s, c, threshValue, minVolume, lessThan, roiFrame, sizeRatio, distanceCutoff, markVal);
-            }
-        }
-    } else {
-        vector<int64_t> outDims = volIn->getOriginalDimensions();
         outDims.resize(3);
-        volOut->reinitialize(outDims, volIn->getSform(), dims[4], SubvolumeAttributes::ANATOMY, volIn->m_header);
-        volOut->setValueAllVoxels(0.0f);
-        for (int64_t c = 0; c < dims[4]; ++c)
+        numSubvols = 1;
+    }
+    volOut->reinitialize(outDims, volIn->getSform(), dims[4], SubvolumeAttributes::ANATOMY, volIn->m_header);
+    const int64_t frameSize = dims[0] * dims[1] * dims[2], numFrames = numSubvols * dims[4];
+#pragma omp CARET_PAR if (numFrames > 1)
+    {//with many frames, do whole frames in parallel, the component labeling is itself parallel for the single frame case
+        vector<vector<int64_t> > clusters;
+        vector<float> outFrame(frameSize);
+#pragma omp CARET_FOR schedule(dynamic) ordered
+        for (int64_t frame = 0; frame < numFrames; ++frame)
         {
-            const float* inFrame = volIn->getFrame(subvolNum, c);
-            processSubvol(inFrame, volOut, 0, c, threshValue, minVolume, lessThan, roiFrame, sizeRatio, distanceCutoff, markVal);
+            const int64_t c = frame / numSubvols, s = frame % numSubvols;//same order as looping over components, then subvolumes
+            VolumeFramePin framePin;//frames are processed in parallel
+            const float* inFrame = volIn->getFrame((subvolNum == -1 ? s : subvolNum), c, framePin);
+            processSubvol(inFrame, mySpace, threshValue, minVolume, lessThan, roiFrame, sizeRatio, distanceCutoff, clusters);
+#pragma omp ordered
+            {//cluster values count up across frames, so mark them in frame order
+                outFrame.assign(frameSize, 0.0f);
+                if (!markClusters(clusters, outFrame.data(), markVal)) markOverflow = true;
+                volOut->setFrame(outFrame.data(), s, c);
+            }
         }
     }
+    if (markOverflow) throw AlgorithmException("too many clusters, unable to mark them uniquely");
     if (endVal != NULL) *endVal = markVal;
 }
 
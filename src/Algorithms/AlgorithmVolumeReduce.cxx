@@ -98,23 +98,16 @@ AlgorithmVolumeReduce::AlgorithmVolumeReduce(ProgressObject* myProgObj, const Vo
         *(volumeOut->getMapLabelTable(0)) = *(volumeIn->getMapLabelTable(0));
     }
     int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
-    vector<float> scratchArray(myDims[3]), outFrame(frameSize);
+    vector<const float*> frames(myDims[3]);//reduce across the frames directly, rather than copying out each voxel's values
+    vector<VolumeFramePin> framePins(myDims[3]);//keeps every frame loaded when reading on demand
+    vector<float> outFrame(frameSize);
     for (int c = 0; c < myDims[4]; ++c)
     {
-        for (int64_t i = 0; i < frameSize; ++i)
+        for (int b = 0; b < myDims[3]; ++b)
         {
-            for (int b = 0; b < myDims[3]; ++b)
-            {
-                const float* tempFrame = volumeIn->getFrame(b, c);
-                scratchArray[b] = tempFrame[i];
-            }
-            if (onlyNumeric)
-            {
-                outFrame[i] = ReductionOperation::reduceOnlyNumeric(scratchArray.data(), myDims[3], myReduce);
-            } else {
-                outFrame[i] = ReductionOperation::reduce(scratchArray.data(), myDims[3], myReduce);
-            }
+            frames[b] = volumeIn->getFrame(b, c, framePins[b]);
         }
+        ReductionOperation::reduceAcross(frames, frameSize, myReduce, outFrame.data(), onlyNumeric);
         volumeOut->setFrame(outFrame.data(), 0, c);
     }
 }
@@ -132,18 +125,16 @@ AlgorithmVolumeReduce::AlgorithmVolumeReduce(ProgressObject* myProgObj, const Vo
         *(volumeOut->getMapLabelTable(0)) = *(volumeIn->getMapLabelTable(0));
     }
     int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
-    vector<float> scratchArray(myDims[3]), outFrame(frameSize);
+    vector<const float*> frames(myDims[3]);
+    vector<VolumeFramePin> framePins(myDims[3]);
+    vector<float> outFrame(frameSize);
     for (int c = 0; c < myDims[4]; ++c)
     {
-        for (int64_t i = 0; i < frameSize; ++i)
+        for (int b = 0; b < myDims[3]; ++b)
         {
-            for (int b = 0; b < myDims[3]; ++b)
-            {
-                const float* tempFrame = volumeIn->getFrame(b, c);
-                scratchArray[b] = tempFrame[i];
-            }
-            outFrame[i] = ReductionOperation::reduceExcludeDev(scratchArray.data(), myDims[3], myReduce, sigmaBelow, sigmaAbove);
+            frames[b] = volumeIn->getFrame(b, c, framePins[b]);
         }
+        ReductionOperation::reduceAcrossExcludeDev(frames, frameSize, myReduce, sigmaBelow, sigmaAbove, outFrame.data());
         volumeOut->setFrame(outFrame.data(), 0, c);
     }
 }
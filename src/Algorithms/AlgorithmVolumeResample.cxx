@@ -25,7 +25,9 @@
 #include "AffineSeriesFile.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "NiftiIO.h"
+#include "VolumeSpline.h"
 #include "WarpfieldFile.h"
 
 using namespace caret;
@@ -166,6 +168,158 @@ void AlgorithmVolumeResample::useParameters(OperationParameters* myParams, Progr
     AlgorithmVolumeResample(myProgObj, inVol, myStack, refSpace, myMethod, outVol);
 }
 
+namespace
+{
+    ///where each output voxel samples the input, computed from the transforms without looking at voxel values, so it can be reused for every frame
+    struct ResampleTable
+    {
+        enum SampleStatus
+        {
+            XFM_INVALID,//transform failed (outside warpfield), gets INVALID_INTERP_VALUE
+            OUTSIDE_INPUT,//gets INVALID_INTERP_VALUE, or the unassigned key for labels
+            VALID
+        };
+        VolumeFile::InterpType m_method;
+        std::vector<char> m_status;
+        std::vector<int64_t> m_index;//enclosing voxel, or lowest corner for trilinear
+        std::vector<float> m_weights;//3 per voxel: trilinear weights of the high corner, or the index space coordinate for cubic
+    };
+    
+    void buildTable(ResampleTable& table, const VolumeFile* inVol, const XfmStack& myStack, const VolumeFile::InterpType& myMethod, const int64_t& frame, const VolumeFile* outVol)
+    {
+        const int64_t* inDims = inVol->getDimensionsPtr();
+        const int64_t* outDims = outVol->getDimensionsPtr();
+        const int64_t outFrameSize = outDims[0] * outDims[1] * outDims[2];
+        table.m_method = myMethod;
+        if (inDims[0] == 1 || inDims[1] == 1 || inDims[2] == 1)
+        {//same as VolumeFile::interpolateValue, cubic and trilinear need 2 voxels along each axis
+            table.m_method = VolumeFile::ENCLOSING_VOXEL;
+        }
+        table.m_status.resize(outFrameSize);
+        table.m_index.resize(outFrameSize);
+        table.m_weights.resize(outFrameSize * 3);
+#pragma omp CARET_PARFOR schedule(guided, 10)
+        for (int64_t k = 0; k < outDims[2]; ++k)
+        {
+            for (int64_t j = 0; j < outDims[1]; ++j)
+            {
+                for (int64_t i = 0; i < outDims[0]; ++i)
+                {
+                    const int64_t outIndex = outVol->getIndex(i, j, k);
+                    Vector3D outCoord;
+                    outVol->indexToSpace(i, j, k, outCoord);//start with the coords of the output voxel
+                    bool validCoord = false;
+                    Vector3D inCoord = myStack.xfmPoint(outCoord, frame, &validCoord);//put it through the inverse transforms that are in reverse order
+                    if (!validCoord)
+                    {
+                        table.m_status[outIndex] = ResampleTable::XFM_INVALID;
+                        continue;
+                    }
+                    table.m_status[outIndex] = ResampleTable::OUTSIDE_INPUT;
+                    if (table.m_method == VolumeFile::ENCLOSING_VOXEL)
+                    {
+                        int64_t inIndex[3];
+                        inVol->enclosingVoxel(inCoord, inIndex);
+                        if (inVol->indexValid(inIndex))
+                        {
+                            table.m_status[outIndex] = ResampleTable::VALID;
+                            table.m_index[outIndex] = inVol->getIndex(inIndex);
+                        }
+                        continue;
+                    }
+                    float index[3];
+                    inVol->spaceToIndex(inCoord, index);
+                    int64_t checkLow[3], checkHigh[3];
+                    for (int axis = 0; axis < 3; ++axis)
+                    {//allow some rounding error for ONLY sanity checking
+                        checkLow[axis] = floor(index[axis] + 0.01f);
+                        checkHigh[axis] = ceil(index[axis] - 0.01f);
+                    }
+                    if (!inVol->indexValid(checkLow) || !inVol->indexValid(checkHigh)) continue;
+                    table.m_status[outIndex] = ResampleTable::VALID;
+                    float* weights = table.m_weights.data() + outIndex * 3;
+                    if (table.m_method == VolumeFile::CUBIC)
+                    {
+                        weights[0] = index[0];
+                        weights[1] = index[1];
+                        weights[2] = index[2];
+                    } else {
+                        int64_t low[3];
+                        for (int axis = 0; axis < 3; ++axis)
+                        {
+                            low[axis] = min(max(int64_t(floor(index[axis])), int64_t(0)), inDims[axis] - 2);
+                            weights[axis] = index[axis] - low[axis];
+                        }
+                        table.m_index[outIndex] = inVol->getIndex(low);
+                    }
+                }
+            }
+        }
+    }
+    
+    //returns whether the spline ignored non-numeric values, so the caller can warn outside of any parallel section
+    bool resampleFrame(const ResampleTable& table, const VolumeFile* inVol, const int64_t& brick, const int64_t& component, const float& outsideValue, float* frameOut)
+    {
+        const int64_t* inDims = inVol->getDimensionsPtr();
+        const int64_t rowSize = inDims[0], sliceSize = inDims[0] * inDims[1];
+        VolumeFramePin framePin;//frames may be resampled in parallel
+        const float* inFrame = inVol->getFrame(brick, component, framePin);
+        VolumeSpline mySpline;
+        if (table.m_method == VolumeFile::CUBIC)
+        {
+            mySpline = VolumeSpline(inFrame, inDims);//deconvolution is parallel, unless frames are already being done in parallel
+        }
+        const int64_t outFrameSize = (int64_t)table.m_status.size();
+#pragma omp CARET_PARFOR schedule(guided, 1000)
+        for (int64_t v = 0; v < outFrameSize; ++v)
+        {
+            switch (table.m_status[v])
+            {
+                case ResampleTable::XFM_INVALID:
+                    frameOut[v] = VolumeFile::INVALID_INTERP_VALUE;
+                    break;
+                case ResampleTable::OUTSIDE_INPUT:
+                    frameOut[v] = outsideValue;
+                    break;
+                default:
+                {
+                    const float* weights = table.m_weights.data() + v * 3;
+                    switch (table.m_method)
+                    {
+                        case VolumeFile::ENCLOSING_VOXEL:
+                            frameOut[v] = inFrame[table.m_index[v]];
+                            break;
+                        case VolumeFile::TRILINEAR:
+                        {//same operation order as VolumeFile::interpolateValue
+                            const float* corner = inFrame + table.m_index[v];
+                            float xhighWeight = weights[0];
+                            float xlowWeight = 1.0f - xhighWeight;
+                            float xinterp[2][2];
+                            xinterp[0][0] = xlowWeight * corner[0] + xhighWeight * corner[1];
+                            xinterp[1][0] = xlowWeight * corner[rowSize] + xhighWeight * corner[rowSize + 1];
+                            xinterp[0][1] = xlowWeight * corner[sliceSize] + xhighWeight * corner[sliceSize + 1];
+                            xinterp[1][1] = xlowWeight * corner[sliceSize + rowSize] + xhighWeight * corner[sliceSize + rowSize + 1];
+                            float yhighWeight = weights[1];
+                            float ylowWeight = 1.0f - yhighWeight;
+                            float yinterp[2];
+                            yinterp[0] = ylowWeight * xinterp[0][0] + yhighWeight * xinterp[1][0];
+                            yinterp[1] = ylowWeight * xinterp[0][1] + yhighWeight * xinterp[1][1];
+                            float zhighWeight = weights[2];
+                            float zlowWeight = 1.0f - zhighWeight;
+                            frameOut[v] = zlowWeight * yinterp[0] + zhighWeight * yinterp[1];
+                            break;
+                        }
+                        case VolumeFile::CUBIC:
+                            frameOut[v] = mySpline.sample(weights);
+                            break;
+                    }
+                }
+            }
+        }
+        return (table.m_method == VolumeFile::CUBIC && mySpline.ignoredNonNumeric());
+    }
+}
+
 AlgorithmVolumeResample::AlgorithmVolumeResample(ProgressObject* myProgObj, const VolumeFile* inVol, const XfmStack& myStack, const VolumeSpace refSpace,
                                                  const VolumeFile::InterpType& myMethod, VolumeFile* outVol) : AbstractAlgorithm(myProgObj)
 {
@@ -178,7 +332,8 @@ AlgorithmVolumeResample::AlgorithmVolumeResample(ProgressObject* myProgObj, cons
     outDims[2] = refDims[2];
     int64_t numMaps = inVol->getNumberOfMaps(), numComponents = inVol->getNumberOfComponents();
     outVol->reinitialize(outDims, refSpace.getSform(), numComponents, inVol->getType(), inVol->m_header);
-    vector<float> scratchFrame(outDims[0] * outDims[1] * outDims[2], 0.0f);
+    const int64_t outFrameSize = outDims[0] * outDims[1] * outDims[2];
+    vector<float> outsideValues(numMaps, VolumeFile::INVALID_INTERP_VALUE);
     if (inVol->isMappedWithLabelTable())
     {
         if (myMethod != VolumeFile::ENCLOSING_VOXEL)
@@ -188,46 +343,59 @@ AlgorithmVolumeResample::AlgorithmVolumeResample(ProgressObject* myProgObj, cons
         for (int64_t i = 0; i < numMaps; ++i)
         {
             *(outVol->getMapLabelTable(i)) = *(inVol->getMapLabelTable(i));
+            outsideValues[i] = inVol->getMapLabelTable(i)->getUnassignedLabelKey();
         }
     }
     for (int64_t i = 0; i < numMaps; ++i)
     {
         outVol->setMapName(i, inVol->getMapName(i));
     }
-    for (int64_t c = 0; c < numComponents; ++c)
+    const bool perFrameTable = myStack.dependsOnFrame();
+    ResampleTable sharedTable;
+    if (!perFrameTable)
+    {//warpfield lookups and coordinate math are the same for every frame, do them once
+        buildTable(sharedTable, inVol, myStack, myMethod, 0, outVol);
+    }
+    const int64_t numFrames = numMaps * numComponents;
+    bool frameParallel = false;
+#ifdef CARET_OMP
+    frameParallel = (numFrames >= omp_get_max_threads());//otherwise, each frame is done in parallel instead
+#endif
+    vector<char> ignoredNonNumeric(numFrames, 0);
+    if (frameParallel)
     {
-        for (int64_t b = 0; b < numMaps; ++b)
+#pragma omp CARET_PAR
         {
-            if (myMethod == VolumeFile::CUBIC)
-            {
-                inVol->validateSpline(b, c);//because deconvolve is parallel, but won't execute parallel if we are already in a parallel section
-            }
-#pragma omp CARET_PARFOR schedule(guided, 10)
-            for (int64_t k = 0; k < outDims[2]; ++k)
+            ResampleTable frameTable;
+            vector<float> scratchFrame(outFrameSize);
+#pragma omp CARET_FOR schedule(dynamic) ordered
+            for (int64_t f = 0; f < numFrames; ++f)
             {
-                for (int64_t j = 0; j < outDims[1]; ++j)
+                const int64_t b = f % numMaps, c = f / numMaps;
+                if (perFrameTable) buildTable(frameTable, inVol, myStack, myMethod, b, outVol);
+                ignoredNonNumeric[f] = resampleFrame(perFrameTable ? frameTable : sharedTable, inVol, b, c, outsideValues[b], scratchFrame.data());
+#pragma omp ordered
                 {
-                    for (int64_t i = 0; i < outDims[0]; ++i)
-                    {
-                        Vector3D outCoord;
-                        outVol->indexToSpace(i, j, k, outCoord);//start with the coords of the output voxel
-                        bool validCoord = false;
-                        Vector3D inCoord = myStack.xfmPoint(outCoord, b, &validCoord);//put it through the inverse transforms that are in reverse order
-                        if (validCoord)
-                        {
-                            float interpVal = inVol->interpolateValue(inCoord, myMethod, NULL, b, c);
-                            scratchFrame[outVol->getIndex(i, j, k)] = interpVal;
-                        } else {
-                            scratchFrame[outVol->getIndex(i, j, k)] = VolumeFile::INVALID_INTERP_VALUE;
-                        }
-                    }
+                    outVol->setFrame(scratchFrame.data(), b, c);
                 }
             }
+        }
+    } else {
+        ResampleTable frameTable;
+        vector<float> scratchFrame(outFrameSize);
+        for (int64_t f = 0; f < numFrames; ++f)
+        {
+            const int64_t b = f % numMaps, c = f / numMaps;
+            if (perFrameTable) buildTable(frameTable, inVol, myStack, myMethod, b, outVol);
+            ignoredNonNumeric[f] = resampleFrame(perFrameTable ? frameTable : sharedTable, inVol, b, c, outsideValues[b], scratchFrame.data());
             outVol->setFrame(scratchFrame.data(), b, c);
-            if (myMethod == VolumeFile::CUBIC)
-            {
-                inVol->freeSpline(b, c);//release memory we no longer need, if we allocated it
-            }
+        }
+    }
+    for (int64_t f = 0; f < numFrames; ++f)
+    {
+        if (ignoredNonNumeric[f])
+        {
+            CaretLogWarning("ignored non-numeric input value when calculating cubic splines in volume '" + inVol->getFileName() + "', frame #" + AString::number(f % numMaps + 1));
         }
     }
 }
@@ -312,6 +480,15 @@ Vector3D WarpfieldXfm::xfmPoint(const Vector3D& coordIn, const int64_t /*frame*/
     return offset + coordIn;
 }
 
+bool XfmStack::dependsOnFrame() const
+{
+    for (auto& xfm : m_xfmStack)
+    {
+        if (xfm->dependsOnFrame()) return true;
+    }
+    return false;
+}
+
 void XfmStack::push_back(CaretPointer<const XfmBase> nextXfm)
 {
     m_xfmStack.push_back(nextXfm);
@@ -52,6 +52,8 @@ namespace caret {
     struct XfmBase
     {
         virtual Vector3D xfmPoint(const Vector3D& coordIn, const int64_t frame, bool* validCoord = NULL) const = 0;
+        ///whether xfmPoint can give different results for different frames, otherwise the sampling can be computed once for all frames
+        virtual bool dependsOnFrame() const { return false; }
         virtual ~XfmBase() {};
     };
 
@@ -69,6 +71,7 @@ namespace caret {
     public:
         AffineSeriesXfm(const std::vector<FloatMatrix>& xfmList);
         Vector3D xfmPoint(const Vector3D& coordIn, const int64_t frame, bool* validCoord = NULL) const;
+        bool dependsOnFrame() const { return true; }
     };
 
     class WarpfieldXfm : public XfmBase
@@ -84,6 +87,7 @@ namespace caret {
         std::vector<CaretPointer<const XfmBase> > m_xfmStack;
     public:
         Vector3D xfmPoint(const Vector3D& coordIn, const int64_t frame, bool* validCoord = NULL) const;
+        bool dependsOnFrame() const;
         void push_back(CaretPointer<const XfmBase> nextXfm);
     };
 
@@ -947,7 +947,9 @@ BrainOpenGLChartTwoDrawingFixedPipeline::drawHistogramOrLineChart(const ChartTwo
                     }
                 }
                 else {
-                    GraphicsEngineDataOpenGL::draw(lineChart.m_chartTwoCartesianData->getGraphicsPrimitive());
+                    GraphicsEngineDataOpenGL::draw(lineChart.m_chartTwoCartesianData->getGraphicsPrimitiveForDrawing(xMinBottomTop,
+                                                                                                                    xMaxBottomTop,
+                                                                                                                    chartGraphicsDrawingViewport[2]));
                 }
                 
                 /*
@@ -1128,7 +1130,9 @@ BrainOpenGLChartTwoDrawingFixedPipeline::drawHistogramOrLineChart(const ChartTwo
                                       : 0.1);
                 lineChart.m_chartTwoCartesianData->setLineWidth(lineWidth);
 
-                GraphicsEngineDataOpenGL::draw(lineChart.m_chartTwoCartesianData->getGraphicsPrimitive());
+                GraphicsEngineDataOpenGL::draw(lineChart.m_chartTwoCartesianData->getGraphicsPrimitiveForDrawing(xMin,
+                                                                                                                xMax,
+                                                                                                                chartGraphicsDrawingViewport[2]));
                 
                 bool showCircleFlag(false);
                 bool showRingFlag(false);
@@ -5923,6 +5923,38 @@ BrainOpenGLFixedPipeline::drawAllFiberOrientations(const FiberOrientationDisplay
         sortFiberOrientationsByDepth();
     }
     
+    /*
+     * All symbols are added to one primitive (cones as triangles or
+     * lines) and drawn with a single draw call.  Symbols are added in
+     * the sorted order so that blending is the same as when each
+     * symbol was drawn individually.
+     */
+    std::unique_ptr<GraphicsPrimitiveV3fN3fC4f> conesPrimitive;
+    std::unique_ptr<GraphicsPrimitiveV3fC4f> linesPrimitive;
+    switch (fodi->symbolType) {
+        case FiberOrientationSymbolTypeEnum::FIBER_SYMBOL_FANS:
+            conesPrimitive.reset(GraphicsPrimitive::newPrimitiveV3fN3fC4f(GraphicsPrimitive::PrimitiveType::OPENGL_TRIANGLES));
+            break;
+        case FiberOrientationSymbolTypeEnum::FIBER_SYMBOL_LINES:
+            linesPrimitive.reset(GraphicsPrimitive::newPrimitiveV3fC4f(GraphicsPrimitive::PrimitiveType::OPENGL_LINES));
+            linesPrimitive->setLineWidth(GraphicsPrimitive::LineWidthType::PIXELS,
+                                         2.0f);
+            break;
+    }
+    
+    int64_t maximumNumberOfSymbols(0);
+    for (const auto fiberOrientation : m_fiberOrientationsForDrawing) {
+        maximumNumberOfSymbols += fiberOrientation->m_numberOfFibers;
+    }
+    if (conesPrimitive) {
+        conesPrimitive->reserveForNumberOfVertices(static_cast<int32_t>(maximumNumberOfSymbols
+                                                   * 2
+                                                   * m_shapeCone->getNumberOfTriangleVertices()));
+    }
+    if (linesPrimitive) {
+        linesPrimitive->reserveForNumberOfVertices(static_cast<int32_t>(maximumNumberOfSymbols * 2));
+    }
+    
     for (std::list<FiberOrientation*>::const_iterator iter = m_fiberOrientationsForDrawing.begin();
          iter != m_fiberOrientationsForDrawing.end();
          iter++) {
@@ -6043,30 +6075,18 @@ BrainOpenGLFixedPipeline::drawAllFiberOrientations(const FiberOrientationDisplay
                                 const int32_t indx = j % 3;
                                 switch (indx) {
                                     case 0: /* use RED */
-                                        glColor4f(BrainOpenGLFixedPipeline::COLOR_RED[0],
-                                                  BrainOpenGLFixedPipeline::COLOR_RED[1],
-                                                  BrainOpenGLFixedPipeline::COLOR_RED[2],
-                                                  alpha);
                                         fiberRGBA[0] = BrainOpenGLFixedPipeline::COLOR_RED[0];
                                         fiberRGBA[1] = BrainOpenGLFixedPipeline::COLOR_RED[1];
                                         fiberRGBA[2] = BrainOpenGLFixedPipeline::COLOR_RED[2];
                                         fiberRGBA[3] = alpha;
                                         break;
                                     case 1: /* use BLUE */
-                                        glColor4f(BrainOpenGLFixedPipeline::COLOR_BLUE[0],
-                                                  BrainOpenGLFixedPipeline::COLOR_BLUE[1],
-                                                  BrainOpenGLFixedPipeline::COLOR_BLUE[2],
-                                                  alpha);
                                         fiberRGBA[0] = BrainOpenGLFixedPipeline::COLOR_BLUE[0];
                                         fiberRGBA[1] = BrainOpenGLFixedPipeline::COLOR_BLUE[1];
                                         fiberRGBA[2] = BrainOpenGLFixedPipeline::COLOR_BLUE[2];
                                         fiberRGBA[3] = alpha;
                                         break;
                                     case 2: /* use GREEN */
-                                        glColor4f(BrainOpenGLFixedPipeline::COLOR_GREEN[0],
-                                                  BrainOpenGLFixedPipeline::COLOR_GREEN[1],
-                                                  BrainOpenGLFixedPipeline::COLOR_GREEN[2],
-                                                  alpha);
                                         fiberRGBA[0] = BrainOpenGLFixedPipeline::COLOR_GREEN[0];
                                         fiberRGBA[1] = BrainOpenGLFixedPipeline::COLOR_GREEN[1];
                                         fiberRGBA[2] = BrainOpenGLFixedPipeline::COLOR_GREEN[2];
@@ -6080,10 +6100,6 @@ BrainOpenGLFixedPipeline::drawAllFiberOrientations(const FiberOrientationDisplay
                                 CaretAssert((fiber->m_directionUnitVectorRGB[1] >= 0.0) && (fiber->m_directionUnitVectorRGB[1] <= 1.0));
                                 CaretAssert((fiber->m_directionUnitVectorRGB[2] >= 0.0) && (fiber->m_directionUnitVectorRGB[2] <= 1.0));
                                 CaretAssert((alpha >= 0.0) && (alpha <= 1.0));
-                                glColor4f(fiber->m_directionUnitVectorRGB[0],
-                                          fiber->m_directionUnitVectorRGB[1],
-                                          fiber->m_directionUnitVectorRGB[2],
-                                          alpha);
                                 fiberRGBA[0] = fiber->m_directionUnitVectorRGB[0];
                                 fiberRGBA[1] = fiber->m_directionUnitVectorRGB[1];
                                 fiberRGBA[2] = fiber->m_directionUnitVectorRGB[2];
@@ -6095,10 +6111,6 @@ BrainOpenGLFixedPipeline::drawAllFiberOrientations(const FiberOrientationDisplay
                     {
                         const CaretColorEnum::Enum caretColor = fodi->colorSource->getCaretColor();
                         const float* rgb = CaretColorEnum::toRGBA(caretColor);
-                        glColor4f(rgb[0],
-                                  rgb[1],
-                                  rgb[2],
-                                  alpha);
                         fiberRGBA[0] = rgb[0];
                         fiberRGBA[1] = rgb[1];
                         fiberRGBA[2] = rgb[2];
@@ -6126,44 +6138,66 @@ BrainOpenGLFixedPipeline::drawAllFiberOrientations(const FiberOrientationDisplay
                                                           * fodi->fanMultiplier),
                                                          vectorLength);
                         
+                        /*
+                         * Transforms replace the translate/rotate/scale used
+                         * when each cone was drawn individually.  Normal vectors
+                         * use the rotations and the cofactors of the scaling
+                         * (inverse transpose without division so that a
+                         * zero scale does not cause a problem).
+                         */
+                        const float scaleX = majorAxis * 2.0;
+                        const float scaleY = minorAxis * 2.0;
+                        const float scaleZ = vectorLength;
+                        const float phiDegrees   = fiber->m_phi * radiansToDegrees;
+                        const float thetaDegrees = fiber->m_theta * radiansToDegrees;
+                        const float psiDegrees   = fiber->m_psi * radiansToDegrees;
+                        
                         /*
                          * First cone
                          */
-                        glPushMatrix();
-                        glTranslatef(startXYZ[0], startXYZ[1], startXYZ[2]);
-                        glRotatef(-fiber->m_phi * radiansToDegrees, 0.0, 0.0, 1.0);
-                        glRotatef(-fiber->m_theta * radiansToDegrees, 0.0, 1.0, 0.0);
-                        glRotatef(-fiber->m_psi * radiansToDegrees, 0.0, 0.0, 1.0);
-                        glScalef(majorAxis * 2.0,
-                                 minorAxis * 2.0,
-                                 vectorLength);
-                        m_shapeCone->draw(fiberRGBA);
-                        glPopMatrix();
+                        Matrix4x4 coneMatrix;
+                        coneMatrix.scale(scaleX, scaleY, scaleZ);
+                        coneMatrix.rotateZ(-psiDegrees);
+                        coneMatrix.rotateY(-thetaDegrees);
+                        coneMatrix.rotateZ(-phiDegrees);
+                        coneMatrix.translate(startXYZ);
+                        Matrix4x4 normalMatrix;
+                        normalMatrix.scale(scaleY * scaleZ, scaleX * scaleZ, scaleX * scaleY);
+                        normalMatrix.rotateZ(-psiDegrees);
+                        normalMatrix.rotateY(-thetaDegrees);
+                        normalMatrix.rotateZ(-phiDegrees);
+                        m_shapeCone->addTrianglesToPrimitive(coneMatrix,
+                                                             normalMatrix,
+                                                             fiberRGBA,
+                                                             conesPrimitive.get());
                         
                         /*
                          * Second cone but pointing in opposite direction
                          */
-                        glPushMatrix();
-                        glTranslatef(startXYZ[0], startXYZ[1], startXYZ[2]);
-                        glRotatef(-fiber->m_phi * radiansToDegrees, 0.0, 0.0, 1.0);
-                        glRotatef(180.0 -fiber->m_theta * radiansToDegrees, 0.0, 1.0, 0.0);
-                        glRotatef(fiber->m_psi * radiansToDegrees, 0.0, 0.0, 1.0);
-                        glScalef(majorAxis * 2.0,
-                                 minorAxis * 2.0,
-                                 vectorLength);
-                        m_shapeCone->draw(fiberRGBA);
-                        glPopMatrix();
+                        Matrix4x4 oppositeConeMatrix;
+                        oppositeConeMatrix.scale(scaleX, scaleY, scaleZ);
+                        oppositeConeMatrix.rotateZ(psiDegrees);
+                        oppositeConeMatrix.rotateY(180.0 - thetaDegrees);
+                        oppositeConeMatrix.rotateZ(-phiDegrees);
+                        oppositeConeMatrix.translate(startXYZ);
+                        Matrix4x4 oppositeNormalMatrix;
+                        oppositeNormalMatrix.scale(scaleY * scaleZ, scaleX * scaleZ, scaleX * scaleY);
+                        oppositeNormalMatrix.rotateZ(psiDegrees);
+                        oppositeNormalMatrix.rotateY(180.0 - thetaDegrees);
+                        oppositeNormalMatrix.rotateZ(-phiDegrees);
+                        m_shapeCone->addTrianglesToPrimitive(oppositeConeMatrix,
+                                                             oppositeNormalMatrix,
+                                                             fiberRGBA,
+                                                             conesPrimitive.get());
                         
                     }
                         break;
                     case FiberOrientationSymbolTypeEnum::FIBER_SYMBOL_LINES:
                     {
-                        const float radius = 2.0;
-                        setLineWidth(radius);
-                        glBegin(GL_LINES);
-                        glVertex3fv(startXYZ);
-                        glVertex3fv(endXYZ);
-                        glEnd();
+                        linesPrimitive->addVertex(startXYZ,
+                                                  fiberRGBA);
+                        linesPrimitive->addVertex(endXYZ,
+                                                  fiberRGBA);
                     }
                         break;
                 }
@@ -6171,6 +6205,17 @@ BrainOpenGLFixedPipeline::drawAllFiberOrientations(const FiberOrientationDisplay
         }
     }
     
+    if (conesPrimitive) {
+        if (conesPrimitive->isValid()) {
+            GraphicsEngineDataOpenGL::draw(conesPrimitive.get());
+        }
+    }
+    if (linesPrimitive) {
+        if (linesPrimitive->isValid()) {
+            GraphicsEngineDataOpenGL::draw(linesPrimitive.get());
+        }
+    }
+    
     /*
      * Now clear the list of fiber orientations for drawing.
      */
@@ -19,6 +19,7 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <cmath>
 
 #define __BRAIN_OPEN_GL_SHAPE_CONE_DECLARE__
@@ -26,7 +27,9 @@
 #undef __BRAIN_OPEN_GL_SHAPE_CONE_DECLARE__
 
 #include "CaretAssert.h"
+#include "GraphicsPrimitiveV3fN3fC4f.h"
 #include "MathFunctions.h"
+#include "Matrix4x4.h"
 
 using namespace caret;
 
@@ -238,6 +241,117 @@ BrainOpenGLShapeCone::~BrainOpenGLShapeCone()
     
 }
 
+/**
+ * @return Number of vertices added to a primitive by each call to
+ * addTrianglesToPrimitive().  Use to reserve space in the primitive
+ * when many cones are added to the same primitive.
+ */
+int32_t
+BrainOpenGLShapeCone::getNumberOfTriangleVertices() const
+{
+    const int32_t numSideTriangles = std::max(static_cast<int32_t>(m_sidesTriangleFan.size()) - 2, 0);
+    const int32_t numCapTriangles  = std::max(static_cast<int32_t>(m_capTriangleFan.size()) - 2, 0);
+    return ((numSideTriangles + numCapTriangles) * 3);
+}
+
+/**
+ * Add the cone, as independent triangles, to a primitive so that many cones
+ * may be drawn with one draw call instead of one draw call (and matrix
+ * push/pop) for each cone.
+ *
+ * @param coordinateTransform
+ *    Transforms the cone's coordinates (replaces the OpenGL
+ *    translate/rotate/scale that is used when drawing a single cone).
+ * @param normalTransform
+ *    Transforms the cone's normal vectors (the inverse transpose of the
+ *    coordinate transform, scaling need not be uniform).  Normal vectors
+ *    are normalized after transformation.
+ * @param rgba
+ *    Color for the cone.
+ * @param primitive
+ *    Primitive, type must be OPENGL_TRIANGLES, to which triangles are added.
+ */
+void
+BrainOpenGLShapeCone::addTrianglesToPrimitive(const Matrix4x4& coordinateTransform,
+                                              const Matrix4x4& normalTransform,
+                                              const float rgba[4],
+                                              GraphicsPrimitiveV3fN3fC4f* primitive) const
+{
+    CaretAssert(primitive);
+    addTriangleFanToPrimitive(m_sidesTriangleFan,
+                              m_sideNormals,
+                              coordinateTransform,
+                              normalTransform,
+                              rgba,
+                              primitive);
+    addTriangleFanToPrimitive(m_capTriangleFan,
+                              m_capNormals,
+                              coordinateTransform,
+                              normalTransform,
+                              rgba,
+                              primitive);
+}
+
+/**
+ * Add a triangle fan, converted to independent triangles, to a primitive.
+ *
+ * @param triangleFan
+ *    Indices of the triangle fan.
+ * @param normals
+ *    Normal vectors for the triangle fan.
+ * @param coordinateTransform
+ *    Transforms the coordinates.
+ * @param normalTransform
+ *    Transforms the normal vectors.
+ * @param rgba
+ *    Color for the triangles.
+ * @param primitive
+ *    Primitive to which triangles are added.
+ */
+void
+BrainOpenGLShapeCone::addTriangleFanToPrimitive(const std::vector<GLuint>& triangleFan,
+                                                const std::vector<GLfloat>& normals,
+                                                const Matrix4x4& coordinateTransform,
+                                                const Matrix4x4& normalTransform,
+                                                const float rgba[4],
+                                                GraphicsPrimitiveV3fN3fC4f* primitive) const
+{
+    const int32_t numFanIndices = static_cast<int32_t>(triangleFan.size());
+    if (numFanIndices < 3) {
+        return;
+    }
+    
+    /*
+     * Transform each vertex in the fan once
+     */
+    std::vector<float> xyz(numFanIndices * 3);
+    std::vector<float> normalXYZ(numFanIndices * 3);
+    for (int32_t i = 0; i < numFanIndices; i++) {
+        const int32_t i3 = i * 3;
+        const int32_t vertexOffset = triangleFan[i] * 3;
+        CaretAssertVectorIndex(m_coordinates, vertexOffset + 2);
+        CaretAssertVectorIndex(normals, vertexOffset + 2);
+        for (int32_t k = 0; k < 3; k++) {
+            xyz[i3 + k]       = m_coordinates[vertexOffset + k];
+            normalXYZ[i3 + k] = normals[vertexOffset + k];
+        }
+        coordinateTransform.multiplyPoint3(&xyz[i3]);
+        normalTransform.multiplyPoint3X3(&normalXYZ[i3]);
+        MathFunctions::normalizeVector(&normalXYZ[i3]);
+    }
+    
+    /*
+     * First index in fan is shared by all triangles
+     */
+    for (int32_t i = 1; i < (numFanIndices - 1); i++) {
+        const int32_t i3 = i * 3;
+        const int32_t next3 = (i + 1) * 3;
+        primitive->addVertex(&xyz[0], &normalXYZ[0], rgba);
+        primitive->addVertex(&xyz[i3], &normalXYZ[i3], rgba);
+        primitive->addVertex(&xyz[next3], &normalXYZ[next3], rgba);
+    }
+}
+
 void
 BrainOpenGLShapeCone::setupOpenGLForShape(const BrainOpenGL::DrawMode drawMode)
 {
@@ -27,6 +27,9 @@
 
 namespace caret {
 
+    class GraphicsPrimitiveV3fN3fC4f;
+    class Matrix4x4;
+    
     class BrainOpenGLShapeCone : public BrainOpenGLShape {
         
     public:
@@ -41,6 +44,13 @@ namespace caret {
         
     public:
 
+        void addTrianglesToPrimitive(const Matrix4x4& coordinateTransform,
+                                     const Matrix4x4& normalTransform,
+                                     const float rgba[4],
+                                     GraphicsPrimitiveV3fN3fC4f* primitive) const;
+        
+        int32_t getNumberOfTriangleVertices() const;
+        
         // ADD_NEW_METHODS_HERE
 
     protected:
@@ -53,7 +63,13 @@ namespace caret {
         void setupOpenGLForShape(const BrainOpenGL::DrawMode drawMode);
         
     private:
-
+        void addTriangleFanToPrimitive(const std::vector<GLuint>& triangleFan,
+                                       const std::vector<GLfloat>& normals,
+                                       const Matrix4x4& coordinateTransform,
+                                       const Matrix4x4& normalTransform,
+                                       const float rgba[4],
+                                       GraphicsPrimitiveV3fN3fC4f* primitive) const;
+        
         // ADD_NEW_MEMBERS_HERE
         
         const int32_t m_numberOfSides;
@@ -38,6 +38,7 @@
 #include "ScenePrimitiveArray.h"
 #include "Surface.h"
 #include "SurfaceFile.h"
+#include "TopologyHelper.h"
 
 using namespace caret;
 
@@ -272,6 +273,7 @@ CiftiConnectivityMatrixDataFileManager::loadDataForSurfaceNode(Brain* brain,
                                         ciftiMatrixFiles);
     
     
+    std::vector<int32_t> neighborNodeIndices;
     bool haveData = false;
     for (std::vector<CiftiMappableConnectivityMatrixDataFile*>::iterator iter = ciftiMatrixFiles.begin();
          iter != ciftiMatrixFiles.end();
@@ -291,6 +293,19 @@ CiftiConnectivityMatrixDataFileManager::loadDataForSurfaceNode(Brain* brain,
             haveData = true;
             
             if (rowIndex >= 0) {
+                /*
+                 * User is likely to select a nearby vertex next
+                 * so read rows for neighboring vertices in the background
+                 */
+                if (neighborNodeIndices.empty()) {
+                    surfaceFile->getTopologyHelper()->getNodeNeighborsToDepth(nodeIndex,
+                                                                              2,
+                                                                              neighborNodeIndices);
+                }
+                cmf->prefetchMapDataForSurfaceNodes(surfaceFile->getNumberOfNodes(),
+                                                    surfaceFile->getStructure(),
+                                                    neighborNodeIndices);
+                
                 /*
                  * Get row/column info for node
                  */
@@ -23,6 +23,7 @@
 #include "ChartTwoDataCartesian.h"
 #undef __CHART_TWO_DATA_CARTESIAN_DECLARE__
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -227,6 +228,7 @@ ChartTwoDataCartesian::clone(const Matrix4x4Interface& matrix) const
     ChartTwoDataCartesian* cloneCopy = new ChartTwoDataCartesian(*this);
     GraphicsPrimitiveV3f* primitive = cloneCopy->getGraphicsPrimitive();
     primitive->transformVerticesFloatXYZ(matrix);
+    cloneCopy->invalidateDecimation();
     return cloneCopy;
 }
 
@@ -277,6 +279,7 @@ ChartTwoDataCartesian::copyHelperChartTwoDataCartesian(const ChartTwoDataCartesi
     m_dataAxisUnitsY = obj.m_dataAxisUnitsY;
 
     m_graphicsPrimitive.reset(dynamic_cast<GraphicsPrimitiveV3f*>(obj.m_graphicsPrimitive->clone()));
+    invalidateDecimation();
     
     m_caretColor              = obj.m_caretColor;
     m_lineWidth               = obj.m_lineWidth;
@@ -298,6 +301,219 @@ ChartTwoDataCartesian::getGraphicsPrimitive() const
     return m_graphicsPrimitive.get();
 }
 
+/**
+ * Get the graphics primitive for drawing the visible part of the cartesian data.
+ * When there are many more visible points than pixels, the visible points are
+ * split into groups of about one per pixel column, and only the first and last
+ * points and the points with the minimum and maximum Y in each group are drawn.
+ * This keeps the vertical extent of the line in each group and the connections
+ * between groups, but it is not identical to drawing every point.
+ * Identification must use getGraphicsPrimitive() since its vertex indices
+ * are point indices.
+ *
+ * WARNING: Points MUST be ordered in ascending order by the X-coordinate.  If not,
+ * behavior is undefined.
+ *
+ * @param xMinimum
+ *    Minimum X-coordinate that is visible.
+ * @param xMaximum
+ *    Maximum X-coordinate that is visible.
+ * @param widthInPixels
+ *    Width of the chart in pixels.
+ * @return
+ *    Graphics primitive for drawing.
+ */
+GraphicsPrimitiveV3f*
+ChartTwoDataCartesian::getGraphicsPrimitiveForDrawing(const float xMinimum,
+                                                      const float xMaximum,
+                                                      const int32_t widthInPixels) const
+{
+    const int32_t numPoints = m_graphicsPrimitive->getNumberOfVertices();
+    const int32_t maximumPointsDrawn = std::max(widthInPixels, 1) * 2;
+    if (numPoints <= maximumPointsDrawn) {
+        return getGraphicsPrimitive();
+    }
+    
+    /*
+     * Range of visible points including the point on each side
+     * so that the line extends to the edges of the chart
+     */
+    const std::vector<float>& xyz = m_graphicsPrimitive->getFloatXYZ();
+    int32_t left(0);
+    int32_t right(numPoints);
+    while (left < right) {
+        const int32_t middle = left + (right - left) / 2;
+        if (xyz[middle * 3] < xMinimum) {
+            left = middle + 1;
+        }
+        else {
+            right = middle;
+        }
+    }
+    const int32_t firstPointIndex = std::max(left - 1, 0);
+    right = numPoints;
+    while (left < right) {
+        const int32_t middle = left + (right - left) / 2;
+        if (xyz[middle * 3] <= xMaximum) {
+            left = middle + 1;
+        }
+        else {
+            right = middle;
+        }
+    }
+    const int32_t lastPointIndex = std::min(left, numPoints - 1);
+    if (lastPointIndex <= firstPointIndex) {
+        return getGraphicsPrimitive();
+    }
+    
+    if (m_decimationCoordinatesModifiedCount != m_graphicsPrimitive->getCoordinatesModifiedCount()) {
+        createDecimationLevels();
+    }
+    
+    /*
+     * Level -1 is all visible points.  Level 'L' draws about
+     * (numVisiblePoints / 2^L) points.
+     */
+    const int32_t numVisiblePoints = lastPointIndex - firstPointIndex + 1;
+    const int32_t numLevels = static_cast<int32_t>(m_decimationLevels.size());
+    int32_t level(-1);
+    if (numVisiblePoints > maximumPointsDrawn) {
+        level = 0;
+        while (((numVisiblePoints >> level) > maximumPointsDrawn)
+               && (level < (numLevels - 1))) {
+            ++level;
+        }
+    }
+    const int32_t firstIndex = ((level >= 0)
+                                ? (firstPointIndex >> (level + 1))
+                                : firstPointIndex);
+    const int32_t lastIndex  = ((level >= 0)
+                                ? (lastPointIndex >> (level + 1))
+                                : lastPointIndex);
+    
+    if (( ! m_decimatedGraphicsPrimitive)
+        || (level != m_decimatedLevel)
+        || (firstIndex != m_decimatedFirstIndex)
+        || (lastIndex != m_decimatedLastIndex)) {
+        std::array<uint8_t, 4> rgba = m_caretColor.getRGBA();
+        m_decimatedGraphicsPrimitive.reset(GraphicsPrimitive::newPrimitiveV3f(m_graphicsPrimitiveType,
+                                                                              rgba.data()));
+        if (level < 0) {
+            m_decimatedGraphicsPrimitive->reserveForNumberOfVertices(lastIndex - firstIndex + 1);
+            for (int32_t i = firstIndex; i <= lastIndex; i++) {
+                m_decimatedGraphicsPrimitive->addVertex(&xyz[i * 3]);
+            }
+        }
+        else {
+            /*
+             * The first, minimum, maximum, and last points in each
+             * bucket are added in their original order
+             */
+            const std::vector<int32_t>& buckets = m_decimationLevels[level];
+            const int32_t bucketSize = (1 << (level + 1));
+            m_decimatedGraphicsPrimitive->reserveForNumberOfVertices((lastIndex - firstIndex + 1) * 4);
+            for (int32_t i = firstIndex; i <= lastIndex; i++) {
+                CaretAssertVectorIndex(buckets, i * 2 + 1);
+                const int32_t bucketFirstIndex = i * bucketSize;
+                int32_t indices[4] = {
+                    bucketFirstIndex,
+                    buckets[i * 2],
+                    buckets[i * 2 + 1],
+                    std::min(bucketFirstIndex + bucketSize, numPoints) - 1
+                };
+                std::sort(indices, indices + 4);
+                for (int32_t j = 0; j < 4; j++) {
+                    if ((j == 0)
+                        || (indices[j] != indices[j - 1])) {
+                        m_decimatedGraphicsPrimitive->addVertex(&xyz[indices[j] * 3]);
+                    }
+                }
+            }
+        }
+        m_decimatedLevel      = level;
+        m_decimatedFirstIndex = firstIndex;
+        m_decimatedLastIndex  = lastIndex;
+    }
+    
+    m_decimatedGraphicsPrimitive->setLineWidth(GraphicsPrimitive::LineWidthType::PERCENTAGE_VIEWPORT_HEIGHT,
+                                               m_lineWidth);
+    return m_decimatedGraphicsPrimitive.get();
+}
+
+/**
+ * Create the min/max pyramid used for drawing many points.
+ * Each level halves the number of buckets of the level below it.
+ */
+void
+ChartTwoDataCartesian::createDecimationLevels() const
+{
+    m_decimationLevels.clear();
+    m_decimatedGraphicsPrimitive.reset();
+    m_decimationCoordinatesModifiedCount = m_graphicsPrimitive->getCoordinatesModifiedCount();
+    
+    const std::vector<float>& xyz = m_graphicsPrimitive->getFloatXYZ();
+    const int32_t numPoints = m_graphicsPrimitive->getNumberOfVertices();
+    if (numPoints < 2) {
+        return;
+    }
+    
+    std::vector<int32_t> buckets;
+    buckets.reserve(numPoints + 1);
+    for (int32_t i = 0; i < numPoints; i += 2) {
+        int32_t minIndex(i);
+        int32_t maxIndex(i);
+        if ((i + 1) < numPoints) {
+            if (xyz[(i + 1) * 3 + 1] < xyz[i * 3 + 1]) {
+                minIndex = i + 1;
+            }
+            else {
+                maxIndex = i + 1;
+            }
+        }
+        buckets.push_back(minIndex);
+        buckets.push_back(maxIndex);
+    }
+    m_decimationLevels.push_back(buckets);
+    
+    while (m_decimationLevels.back().size() > 2) {
+        const std::vector<int32_t>& previous = m_decimationLevels.back();
+        const int32_t numPrevious = static_cast<int32_t>(previous.size() / 2);
+        std::vector<int32_t> next;
+        next.reserve(numPrevious + 1);
+        for (int32_t i = 0; i < numPrevious; i += 2) {
+            int32_t minIndex = previous[i * 2];
+            int32_t maxIndex = previous[i * 2 + 1];
+            if ((i + 1) < numPrevious) {
+                const int32_t otherMinIndex = previous[(i + 1) * 2];
+                const int32_t otherMaxIndex = previous[(i + 1) * 2 + 1];
+                if (xyz[otherMinIndex * 3 + 1] < xyz[minIndex * 3 + 1]) {
+                    minIndex = otherMinIndex;
+                }
+                if (xyz[otherMaxIndex * 3 + 1] > xyz[maxIndex * 3 + 1]) {
+                    maxIndex = otherMaxIndex;
+                }
+            }
+            next.push_back(minIndex);
+            next.push_back(maxIndex);
+        }
+        m_decimationLevels.push_back(std::move(next));
+    }
+}
+
+/**
+ * Invalidate the min/max pyramid after the graphics primitive is replaced.
+ */
+void
+ChartTwoDataCartesian::invalidateDecimation()
+{
+    m_decimationLevels.clear();
+    m_decimationCoordinatesModifiedCount = -1;
+    m_decimatedGraphicsPrimitive.reset();
+    m_decimatedLevel = -1;
+    m_decimatedFirstIndex = -1;
+    m_decimatedLastIndex  = -1;
+}
+
 /**
  * @return The selection status
  */
@@ -469,6 +685,9 @@ ChartTwoDataCartesian::setColor(const CaretColor& color)
     if (m_graphicsPrimitive != NULL) {
         m_graphicsPrimitive->replaceAllVertexSolidByteRGBA(m_caretColor.getRGBA().data());
     }
+    if (m_decimatedGraphicsPrimitive != NULL) {
+        m_decimatedGraphicsPrimitive->replaceAllVertexSolidByteRGBA(m_caretColor.getRGBA().data());
+    }
 }
 
 /**
@@ -716,6 +935,7 @@ ChartTwoDataCartesian::restoreFromScene(const SceneAttributes* sceneAttributes,
         return;
     }
     m_graphicsPrimitive = createGraphicsPrimitive();
+    invalidateDecimation();
     
     m_sceneAssistant->restoreMembers(sceneAttributes, sceneClass);
     
@@ -65,6 +65,10 @@ namespace caret {
         
         GraphicsPrimitiveV3f* getGraphicsPrimitive() const;
         
+        GraphicsPrimitiveV3f* getGraphicsPrimitiveForDrawing(const float xMinimum,
+                                                             const float xMaximum,
+                                                             const int32_t widthInPixels) const;
+        
         const MapFileDataSelector* getMapFileDataSelector() const;
         
         void setMapFileDataSelector(const MapFileDataSelector& mapFileDataSelector);
@@ -126,6 +130,10 @@ namespace caret {
         std::unique_ptr<GraphicsPrimitiveV3f> createGraphicsPrimitive();
         
         int32_t getLineSegmentIndexContainingX(const float x) const;
+        
+        void invalidateDecimation();
+        
+        void createDecimationLevels() const;
 
         std::unique_ptr<MapFileDataSelector> m_mapFileDataSelector;
         
@@ -155,6 +163,25 @@ namespace caret {
         
         SceneClassAssistant* m_sceneAssistant;
         
+        /**
+         * Min/max pyramid of the points.  Level 'L' contains, for each bucket of
+         * 2^(L+1) consecutive points, the index of the point with the minimum Y
+         * followed by the index of the point with the maximum Y.
+         */
+        mutable std::vector<std::vector<int32_t>> m_decimationLevels;
+        
+        /** Coordinates modified count of m_graphicsPrimitive when m_decimationLevels was created */
+        mutable int64_t m_decimationCoordinatesModifiedCount = -1;
+        
+        /** Visible points from m_decimationLevels, drawn when there are many more points than pixels */
+        mutable std::unique_ptr<GraphicsPrimitiveV3f> m_decimatedGraphicsPrimitive;
+        
+        mutable int32_t m_decimatedLevel = -1;
+        
+        mutable int32_t m_decimatedFirstIndex = -1;
+        
+        mutable int32_t m_decimatedLastIndex = -1;
+        
         // ADD_NEW_MEMBERS_HERE
 
     };
@@ -30,6 +30,7 @@
 #include "CaretCommandLine.h"
 #include "CaretLogger.h"
 #include "CommandOperationManager.h"
+#include "CommandServer.h"
 #include "ProgramParameters.h"
 #include "SessionManager.h"
 #include "SystemUtilities.h"
@@ -38,7 +39,7 @@
 using namespace caret;
 using namespace std;
 
-static int runCommand(int argc, char* argv[]) {
+static int runCommand(int argc, char* argv[], const bool keepCommandManager = false) {
     
     ProgramParameters parameters(argc, argv);
     caret_global_commandLine_init(parameters);
@@ -81,12 +82,56 @@ static int runCommand(int argc, char* argv[]) {
         throw;//rethrow, the runtime might print the type
     }
     
-    if (commandManager != NULL) {
+    if (commandManager != NULL && !keepCommandManager) {
         CommandOperationManager::deleteCommandOperationManager();
     }
     return ret;
 }
 
+//server mode keeps the commands registered between command lines
+static int runServerCommand(int argc, char* argv[]) {
+    return runCommand(argc, argv, true);
+}
+
+static int runServer(int argc, char* argv[])
+{
+    if (argc < 3 || argc > 4)
+    {
+        cerr << "usage: wb_command -server <socket> [<cache-MB>]" << endl;
+        return 1;
+    }
+    int64_t cacheMB = 1024;
+    if (argc == 4)
+    {
+        bool ok = false;
+        cacheMB = AString::fromLocal8Bit(argv[3]).toLongLong(&ok);
+        if (!ok || cacheMB < 0)
+        {
+            cerr << "ERROR: cache size must be a non-negative number of megabytes" << endl;
+            return 1;
+        }
+    }
+    int ret = CommandServer::runServer(AString::fromLocal8Bit(argv[2]), cacheMB * 1048576, runServerCommand);
+    CommandOperationManager::deleteCommandOperationManager();
+    return ret;
+}
+
+static int runClient(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        cerr << "usage: wb_command -client <socket> <command> [arguments...]" << endl;
+        return 1;
+    }
+    vector<AString> arguments;
+    arguments.push_back(AString::fromLocal8Bit(argv[0]));
+    for (int i = 3; i < argc; ++i)
+    {
+        arguments.push_back(AString::fromLocal8Bit(argv[i]));
+    }
+    return CommandServer::runClient(AString::fromLocal8Bit(argv[2]), arguments);
+}
+
 static int doCompletion(int argc, char* argv[])
 {
     //we don't handle any interactive arguments in this file (only completion related arguments, which should never be used interactively)
@@ -123,6 +168,12 @@ int main(int argc, char* argv[]) {
     {
         return doCompletion(argc, argv);
     }
+    //the client only forwards the command line, so it also skips initialization
+    if (argc > 1 && AString::fromLocal8Bit(argv[1]) == "-client")
+    {
+        QCoreApplication myApp(argc, argv);
+        return runClient(argc, argv);
+    }
     int result = 0;
     {
         /*
@@ -144,7 +195,12 @@ int main(int argc, char* argv[]) {
         
         QCoreApplication myApp(argc, argv);//so that it doesn't need to link against gui
         
-        result = runCommand(argc, argv);
+        if (argc > 1 && AString::fromLocal8Bit(argv[1]) == "-server")
+        {
+            result = runServer(argc, argv);
+        } else {
+            result = runCommand(argc, argv);
+        }
         
         /*
          * Delete the session manager.
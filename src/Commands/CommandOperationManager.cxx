@@ -19,6 +19,7 @@
 /*LICENSE_END*/
 
 #include <map>
+#include <new>
 
 #define __COMMAND_OPERATION_MANAGER_DEFINE__
 #include "CommandOperationManager.h"
@@ -239,8 +240,11 @@
 
 #include "AlgorithmException.h"
 #include "ApplicationInformation.h"
+#include "CaretCommandLine.h"
 #include "CommandParser.h"
+#include "CommandServer.h"
 #include "OperationException.h"
+#include "OperationPipelineFiles.h"
 
 #include "CommandClassAddMember.h"
 #include "CommandClassCreate.h"
@@ -252,15 +256,82 @@
 #include "ProgramParameters.h"
 
 #include "CaretLogger.h"
+#include "CaretProfiler.h"
 #include "dot_wrapper.h"
 #include "CaretCommandGlobalOptions.h"
 
+#include <QFile>
+#include <QTextStream>
+
+#include <exception>
 #include <iostream>
 #include <map>
+#include <new>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    //splits a pipeline script line into arguments like a shell does for simple cases: whitespace separates arguments,
+    //single quotes are literal, double quotes allow backslash escapes, a '#' that starts an argument starts a comment
+    vector<AString> splitPipelineLine(const AString& line, const int& lineNumber)
+    {
+        vector<AString> ret;
+        AString current;
+        bool inArgument = false;
+        QChar quote;
+        const int length = line.length();
+        for (int i = 0; i < length; ++i)
+        {
+            const QChar c = line[i];
+            if (quote == '\'')
+            {
+                if (c == '\'')
+                {
+                    quote = QChar();
+                } else {
+                    current += c;
+                }
+            } else if (quote == '"') {
+                if (c == '"')
+                {
+                    quote = QChar();
+                } else if (c == '\\' && i + 1 < length) {
+                    current += line[++i];
+                } else {
+                    current += c;
+                }
+            } else if (c.isSpace()) {
+                if (inArgument)
+                {
+                    ret.push_back(current);
+                    current = "";
+                    inArgument = false;
+                }
+            } else if (c == '#' && !inArgument) {
+                break;
+            } else {
+                inArgument = true;
+                if (c == '\'' || c == '"')
+                {
+                    quote = c;
+                } else if (c == '\\' && i + 1 < length) {
+                    current += line[++i];
+                } else {
+                    current += c;
+                }
+            }
+        }
+        if (!quote.isNull())
+        {
+            throw CommandException("unmatched quote on pipeline script line " + AString::number(lineNumber));
+        }
+        if (inArgument) ret.push_back(current);
+        return ret;
+    }
+}
+
 /**
  * Get the command operation manager.
  *
@@ -562,6 +633,14 @@ namespace
         }
         return iter->second;
     }
+    
+    //writes the profile when runCommand exits, including when the command throws, as the partial trace shows where it failed
+    struct ProfileFinisher
+    {
+        bool m_started;
+        ProfileFinisher() { m_started = false; }
+        ~ProfileFinisher() { if (m_started) CaretProfiler::finish(); }
+    };
 }
 
 /**
@@ -629,6 +708,17 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
     {
         caret_global_command_options.m_ciftiReadMemory = true;
     }
+    ProfileFinisher profileFinisher;
+    if (getGlobalOption(parameters, "-profile", 1, globalOptionArgs))
+    {
+        try
+        {
+            CaretProfiler::start(globalOptionArgs[0]);
+        } catch (CaretException& e) {
+            throw CommandException(e.whatString());
+        }
+        profileFinisher.m_started = true;
+    }
 
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
@@ -658,6 +748,12 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
         printVolumeHelp();
     } else if (commandSwitch == "-parallel-help") {
         printParallelHelp(myProgramName);
+    } else if (commandSwitch == "-pipeline-help") {
+        printPipelineHelp();
+    } else if (commandSwitch == "-pipeline") {
+        runPipeline(parameters);
+    } else if (commandSwitch == "-server-help") {
+        cout << CommandServer::getServerHelp();
     } else if (commandSwitch == "-version") {
         printVersionInfo();
     } else if (commandSwitch == "-list-commands") {
@@ -783,7 +879,12 @@ AString CommandOperationManager::doCompletion(ProgramParameters& parameters, con
         return "";
     }
     /*OptionInfo ciftiReadMemInfo = */parseGlobalOption(parameters, "-cifti-read-memory", 0, globalOptionArgs, true);
-    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range\\ -nifti-output-datatype\\ -nifti-output-range\\ -cifti-read-memory";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
+    OptionInfo profileInfo = parseGlobalOption(parameters, "-profile", 1, globalOptionArgs, true);
+    if (profileInfo.specified && !profileInfo.complete)
+    {//output file name
+        return "";
+    }
+    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range\\ -nifti-output-datatype\\ -nifti-output-range\\ -cifti-read-memory\\ -profile";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
     if (!parameters.hasNext())
@@ -1031,6 +1132,9 @@ void CommandOperationManager::printHelpInfo()
     cout << "   -arguments-help             explain the format of subcommand help info" << endl;
     cout << "   -global-options             display options that can be added to any command" << endl;
     cout << "   -parallel-help              details on how wb_command uses parallelization" << endl;
+    cout << "   -server-help                running wb_command as a server for many commands" << endl;
+    cout << "   -pipeline-help              running several commands without intermediate" << endl;
+    cout << "                                  files" << endl;
     cout << "   -cifti-help                 explain the cifti file format and related terms" << endl;
     cout << "   -gifti-help                 explain the gifti file format (metric, surface)" << endl;
     cout << "   -volume-help                explain volume files, including label volumes" << endl;
@@ -1182,6 +1286,15 @@ void CommandOperationManager::printGlobalOptions()
     cout << "                                        avoid hitting limits on number of open" << endl;
     cout << "                                        files" << endl;
     cout << endl;
+    cout << "   -profile <file>                   write a timing trace of the command to" << endl;
+    cout << "                                        <file>, in chrome trace-event json" << endl;
+    cout << "                                        format (open it in chrome://tracing or" << endl;
+    cout << "                                        ui.perfetto.dev), with spans for" << endl;
+    cout << "                                        reading and writing files (with byte" << endl;
+    cout << "                                        counts), algorithms and their" << endl;
+    cout << "                                        subalgorithms, and cpu time to show" << endl;
+    cout << "                                        thread usage" << endl;
+    cout << endl;
     cout << "   -cifti-output-datatype <type>     deprecated, only affects cifti outputs" << endl;
     cout << "   -cifti-output-range <min> <max>   deprecated, only affects cifti outputs" << endl;
     cout << endl;
@@ -1343,6 +1456,123 @@ void CommandOperationManager::printParallelHelp(const AString& programName)
     cout << endl;//guide for wrap, assuming 80 columns:                                     |
 }
 
+void CommandOperationManager::printPipelineHelp()
+{
+    //guide for wrap, assuming 80 columns:                                                  |
+    cout << "   Several commands can be run in one wb_command process by putting them in a" << endl;
+    cout << "   script file, one command per line, without 'wb_command' at the start:" << endl;
+    cout << endl;
+    cout << "      wb_command -pipeline <script>" << endl;
+    cout << endl;
+    cout << "   Inside a pipeline, an output file name starting with '" << OperationPipelineFiles::PREFIX << "' keeps the file" << endl;
+    cout << "   in memory instead of writing it, and later commands use that name as an" << endl;
+    cout << "   input to get the file from memory.  Only outputs with normal file names are" << endl;
+    cout << "   written.  For example:" << endl;
+    cout << endl;
+    cout << "      -cifti-separate data.dtseries.nii COLUMN -metric CORTEX_LEFT @left" << endl;
+    cout << "      -metric-smoothing left.surf.gii @left 2 @left_smooth" << endl;
+    cout << "      -metric-resample @left_smooth ... left_resampled.func.gii" << endl;
+    cout << endl;
+    cout << "   Arguments are separated by whitespace and may be quoted, lines ending in a" << endl;
+    cout << "   backslash continue on the next line, and text after a '#' that starts an" << endl;
+    cout << "   argument is a comment.  Global options given before -pipeline apply to" << endl;
+    cout << "   every command, and global options on a line apply only to that command." << endl;
+    cout << "   The pipeline stops at the first command that fails." << endl;
+    cout << endl;
+}
+
+/**
+ * Run the commands in a pipeline script, keeping intermediate files in memory.
+ *
+ * @param parameters
+ *    Parameters after the -pipeline switch.
+ */
+void CommandOperationManager::runPipeline(ProgramParameters& parameters)
+{
+    if (!parameters.hasNext())
+    {
+        printPipelineHelp();
+        return;
+    }
+    const AString scriptName = parameters.nextString("pipeline script");
+    parameters.verifyAllParametersProcessed();
+    QFile scriptFile(scriptName);
+    if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        throw CommandException("unable to open pipeline script '" + scriptName + "': " + scriptFile.errorString());
+    }
+    vector<pair<int, AString> > steps;//line number and text, with continued lines joined
+    QTextStream scriptStream(&scriptFile);
+    int lineNumber = 0;
+    AString continued;
+    int continuedLineNumber = 0;
+    while (!scriptStream.atEnd())
+    {
+        AString line = scriptStream.readLine();
+        ++lineNumber;
+        if (continued.isEmpty()) continuedLineNumber = lineNumber;
+        if (line.endsWith("\\"))
+        {
+            line.chop(1);
+            continued += line + " ";
+            continue;
+        }
+        steps.push_back(make_pair(continuedLineNumber, continued + line));
+        continued = "";
+    }
+    if (!continued.isEmpty()) steps.push_back(make_pair(continuedLineNumber, continued));
+
+    const CommandGlobalOptions pipelineOptions = caret_global_command_options;
+    const AString pipelineCommandLine = caret_global_commandLine;
+    OperationPipelineFiles::beginPipeline();
+    try
+    {
+        for (size_t i = 0; i < steps.size(); ++i)
+        {
+            const vector<AString> arguments = splitPipelineLine(steps[i].second, steps[i].first);
+            if (arguments.empty()) continue;
+            if (arguments[0] == "-pipeline")
+            {
+                throw CommandException("pipelines can't be nested, on pipeline script line " + AString::number(steps[i].first));
+            }
+            vector<QByteArray> argBytes(1, QByteArray("wb_command"));
+            for (size_t j = 0; j < arguments.size(); ++j)
+            {
+                argBytes.push_back(arguments[j].toLocal8Bit());
+            }
+            vector<const char*> argv;
+            for (size_t j = 0; j < argBytes.size(); ++j)
+            {
+                argv.push_back(argBytes[j].constData());
+            }
+            ProgramParameters stepParameters(argv.size(), argv.data());
+            caret_global_commandLine_init(stepParameters);//provenance of each output shows the command that made it
+            caret_global_command_options = pipelineOptions;
+            CaretLogFine("pipeline line " + AString::number(steps[i].first) + ": " + caret_global_commandLine);
+            CaretProfileSpan stepSpan("pipeline line " + AString::number(steps[i].first), "pipeline");
+            const AString stepDescription = "pipeline script line " + AString::number(steps[i].first) + " (" + arguments[0] + ")";
+            try
+            {
+                runCommand(stepParameters);
+            } catch (CaretException& e) {
+                throw CommandException(stepDescription + ": " + e.whatString());
+            } catch (bad_alloc& e) {
+                throw CommandException(stepDescription + ": out of memory (" + AString(e.what()) + ")");
+            } catch (exception& e) {
+                throw CommandException(stepDescription + ": " + AString(e.what()));
+            }
+        }
+    } catch (...) {
+        OperationPipelineFiles::endPipeline();
+        caret_global_commandLine = pipelineCommandLine;
+        caret_global_command_options = pipelineOptions;
+        throw;
+    }
+    OperationPipelineFiles::endPipeline();
+    caret_global_commandLine = pipelineCommandLine;
+    caret_global_command_options = pipelineOptions;
+}
+
 void CommandOperationManager::printVersionInfo()
 {
     ApplicationInformation myInfo;
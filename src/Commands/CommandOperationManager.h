@@ -77,6 +77,10 @@ namespace caret {
         
         void printParallelHelp(const AString& programName);
         
+        void printPipelineHelp();
+        
+        void runPipeline(ProgramParameters& parameters);
+        
         void printVersionInfo();
         
         bool getGlobalOption(ProgramParameters& parameters, const AString& optionString, const int& numArgs, std::vector<AString>& arguments);
@@ -29,6 +29,7 @@
 #include "CaretCommandGlobalOptions.h"
 #include "CaretDataFileHelper.h"
 #include "CaretLogger.h"
+#include "CaretProfiler.h"
 #include "CiftiFile.h"
 #include "DataFileException.h"
 #include "FileInformation.h"
@@ -37,6 +38,8 @@
 #include "LabelFile.h"
 #include "MetricFile.h"
 #include "OperationException.h"
+#include "OperationPipelineFiles.h"
+#include "ProgressObject.h"
 #include "SurfaceFile.h"
 #include "VolumeFile.h"
 
@@ -77,6 +80,7 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     myProvHelp.m_doProvenance = m_doProvenance;
     myProvHelp.m_workingDir = QDir::currentPath();//get the current path, in case some stupid command changes the working directory
     //these get set on output files during provenanceAfterOperation (and for on-disk in OperationParameters)
+    CaretProfileSpan commandSpan(getCommandLineSwitch(), "command"), stepSpan("parse arguments", "command");//these do nothing unless -profile was given
     parseComponent(myAlgParams.getPointer(), parameters, myOutAssoc);//parsing block
     parameters.verifyAllParametersProcessed();
     checkOnDiskOutputCollision(myOutAssoc);//check for input on-disk files used as output on-disk files
@@ -89,6 +93,7 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
         myProvHelp.m_versionProvenance += versionInfo[i] + "\n";
     }
     myAlgParams->prepareProvenance(&myProvHelp);
+    stepSpan.begin("read inputs", "command");
     //virtually all commands will NOT do lazy file reading, as it needs to be careful to request all inputs before any outputs
     if (m_autoOper->lazyFileReading())
     {
@@ -96,7 +101,14 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     } else {
         myAlgParams->openAllInputFiles();//this completes the provenance info when executed
     }
-    m_autoOper->useParameters(myAlgParams.getPointer(), NULL);//TODO: progress status for caret_command? would probably get messed up by any command info output
+    stepSpan.begin("run", "command");
+    if (CaretProfiler::isEnabled())
+    {//a progress object is only needed to time the algorithm and its subalgorithms, nothing displays its progress
+        ProgressObject rootProgress(1.0f);
+        m_autoOper->useParameters(myAlgParams.getPointer(), &rootProgress);
+    } else {
+        m_autoOper->useParameters(myAlgParams.getPointer(), NULL);//TODO: progress status for caret_command? would probably get messed up by any command info output
+    }
     vector<AString> uncheckedWarnings = myAlgParams->findUncheckedParams("the command");
     for (size_t i = 0; i < uncheckedWarnings.size(); ++i)
     {
@@ -104,6 +116,7 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     }
     //myOutAssoc (in fact, most of the parameter tree) is not smart pointers and won't keep the output files allocated
     myAlgParams->closeAllInputFiles();
+    stepSpan.begin("write outputs", "command");
     if (m_doProvenance) provenanceAfterOperation(myOutAssoc, myProvHelp);
     writeOutput(myOutAssoc);
 }
@@ -187,7 +200,7 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
             {
                 ((CiftiParameter*)myComponent->m_paramList[i])->m_filename = nextArg;
                 FileInformation myInfo(nextArg);
-                if (!caret_global_command_options.m_ciftiReadMemory)
+                if (!caret_global_command_options.m_ciftiReadMemory && !OperationPipelineFiles::isPipelineName(nextArg))
                 {
                     m_inputCiftiOnDiskMap[myInfo.getCanonicalFilePath()] = (CiftiParameter*)myComponent->m_paramList[i];//track name and parameter, to additionally check file size to avoid warning for small files
                 }
@@ -318,6 +331,10 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
             case OperationParametersEnum::CIFTI:
             {
                 ((CiftiParameter*)(myComponent->m_outputList[i]))->m_filename = nextArg;
+                if (OperationPipelineFiles::isPipelineName(nextArg))
+                {
+                    ((CiftiParameter*)(myComponent->m_outputList[i]))->m_doOnDiskWrite = false;//keep it in memory for later pipeline steps
+                }
                 break;
             }
             case OperationParametersEnum::FOCI:
@@ -795,11 +812,59 @@ void CommandParser::checkOnDiskOutputCollision(const vector<OutputAssoc>& outAss
     }
 }
 
+void CommandParser::keepPipelineOutput(const OutputAssoc& outAssociation)
+{
+    AbstractParameter* myParam = outAssociation.m_param;
+    const AString& myName = outAssociation.m_fileName;
+    switch (myParam->getType())
+    {
+        case OperationParametersEnum::ANNOTATION:
+            ((AnnotationParameter*)myParam)->lazyGet();//this should have already been done by the operation, but don't store a null file if it didn't
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((AnnotationParameter*)myParam)->m_parameter);
+            break;
+        case OperationParametersEnum::BORDER:
+            ((BorderParameter*)myParam)->lazyGet();
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((BorderParameter*)myParam)->m_parameter);
+            break;
+        case OperationParametersEnum::CIFTI:
+            ((CiftiParameter*)myParam)->lazyGet();
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((CiftiParameter*)myParam)->m_parameter);
+            break;
+        case OperationParametersEnum::FOCI:
+            ((FociParameter*)myParam)->lazyGet();
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((FociParameter*)myParam)->m_parameter);
+            break;
+        case OperationParametersEnum::LABEL:
+            ((LabelParameter*)myParam)->lazyGet();
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((LabelParameter*)myParam)->m_parameter);
+            break;
+        case OperationParametersEnum::METRIC:
+            ((MetricParameter*)myParam)->lazyGet();
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((MetricParameter*)myParam)->m_parameter);
+            break;
+        case OperationParametersEnum::SURFACE:
+            ((SurfaceParameter*)myParam)->lazyGet();
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((SurfaceParameter*)myParam)->m_parameter);
+            break;
+        case OperationParametersEnum::VOLUME:
+            ((VolumeParameter*)myParam)->lazyGet();
+            OperationPipelineFiles::setFile(myName, myParam->getType(), ((VolumeParameter*)myParam)->m_parameter);
+            break;
+        default:
+            throw CommandException("output '" + myParam->m_shortName + "' is not a file, it can't be kept as pipeline file '" + myName + "'");
+    }
+}
+
 void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
 {
     for (uint32_t i = 0; i < outAssociation.size(); ++i)
     {
         AbstractParameter* myParam = outAssociation[i].m_param;
+        if (OperationPipelineFiles::isPipelineName(outAssociation[i].m_fileName))
+        {//intermediate file of a pipeline, later steps use it from memory
+            keepPipelineOutput(outAssociation[i]);
+            continue;
+        }
         switch (myParam->getType())
         {
             case OperationParametersEnum::BOOL://ignores the name you give the output for now, but what gives primitive type output and how is it used?
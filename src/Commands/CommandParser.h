@@ -59,6 +59,7 @@ namespace caret {
         void provenanceAfterOperation(const std::vector<OutputAssoc>& outAssociation, ProvenanceHelper& provHelp);
         void checkOnDiskOutputCollision(const std::vector<OutputAssoc>& outAssociation);//ensures on-disk inputs aren't used as on-disk outputs, keeping outputs in-memory when needed
         void writeOutput(const std::vector<OutputAssoc>& outAssociation);
+        void keepPipelineOutput(const OutputAssoc& outAssociation);
         AString getIndentString(int desired);
         void addHelpComponent(AString& info, ParameterComponent* myComponent, int curIndent);
         void addHelpOptions(AString& info, ParameterComponent* myAlgParams, int curIndent);
@@ -0,0 +1,285 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CommandServer.h"
+
+#include "CaretCommandGlobalOptions.h"
+#include "CaretLogger.h"
+#include "OperationInputFileCache.h"
+
+#include <QDir>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <iostream>
+#include <sstream>
+
+using namespace caret;
+using namespace std;
+
+const AString CommandServer::STOP_SWITCH = "-server-stop";
+const AString CommandServer::STATUS_SWITCH = "-server-status";
+
+namespace
+{
+    //a message is a count of strings, then each string as a length and its bytes, all integers are 4 byte big-endian
+    const int REQUEST_TIMEOUT_MS = 30000;
+    const int PROBE_TIMEOUT_MS = 1000;//checking for a running server before starting one
+
+    void appendUInt32(QByteArray& data, const quint32 value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            data.append((char)((value >> shift) & 0xFF));
+        }
+    }
+
+    quint32 toUInt32(const QByteArray& data)
+    {
+        quint32 ret = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            ret = (ret << 8) | (quint32)(unsigned char)data[i];
+        }
+        return ret;
+    }
+
+    bool writeMessage(QLocalSocket* socket, const vector<QByteArray>& message)
+    {
+        QByteArray data;
+        appendUInt32(data, message.size());
+        for (size_t i = 0; i < message.size(); ++i)
+        {
+            appendUInt32(data, message[i].size());
+            data.append(message[i]);
+        }
+        if (socket->write(data) != data.size()) return false;
+        socket->flush();
+        while (socket->bytesToWrite() > 0)
+        {
+            if (!socket->waitForBytesWritten(REQUEST_TIMEOUT_MS)) return false;
+        }
+        return true;
+    }
+
+    bool readBytes(QLocalSocket* socket, const qint64 numBytes, const int timeoutMS, QByteArray& bytesOut)
+    {
+        while (socket->bytesAvailable() < numBytes)
+        {
+            if (!socket->waitForReadyRead(timeoutMS)) return false;
+        }
+        bytesOut = socket->read(numBytes);
+        return (bytesOut.size() == numBytes);
+    }
+
+    bool readMessage(QLocalSocket* socket, const int timeoutMS, vector<QByteArray>& messageOut)
+    {
+        messageOut.clear();
+        QByteArray lengthBytes;
+        if (!readBytes(socket, 4, timeoutMS, lengthBytes)) return false;
+        const quint32 count = toUInt32(lengthBytes);
+        for (quint32 i = 0; i < count; ++i)
+        {
+            if (!readBytes(socket, 4, timeoutMS, lengthBytes)) return false;
+            QByteArray item;
+            if (!readBytes(socket, toUInt32(lengthBytes), timeoutMS, item)) return false;
+            messageOut.push_back(item);
+        }
+        return true;
+    }
+
+    //runs one command line from a client, with output captured, returns the message to send back: exit code, standard output, standard error
+    vector<QByteArray> runRequest(const vector<QByteArray>& request, CommandServer::RunCommandFunction runCommandFunction)
+    {
+        vector<QByteArray> argBytes(request.begin() + 1, request.end());//first item is the working directory
+        vector<char*> argv;
+        for (size_t i = 0; i < argBytes.size(); ++i)
+        {
+            argv.push_back(argBytes[i].data());
+        }
+        argv.push_back(NULL);
+
+        const QString serverDir = QDir::currentPath();
+        const LogLevelEnum::Enum serverLogLevel = CaretLogger::getLogger()->getLevel();
+        caret_global_command_options = CommandGlobalOptions();//global options are set again by each command line
+        ostringstream outCapture, errCapture;
+        streambuf* serverOut = cout.rdbuf(outCapture.rdbuf());
+        streambuf* serverErr = cerr.rdbuf(errCapture.rdbuf());
+        int ret = -1;
+        if (QDir::setCurrent(AString::fromUtf8(request[0])))
+        {
+            try
+            {
+                ret = runCommandFunction((int)argBytes.size(), argv.data());
+            } catch (...) {//the run function reports errors before rethrowing unknown exceptions, keep serving other commands
+                ret = -1;
+            }
+        } else {
+            cerr << "\nERROR: unable to change to working directory '" << request[0].constData() << "'" << endl << endl;
+        }
+        cout.flush();
+        cerr.flush();
+        cout.rdbuf(serverOut);
+        cerr.rdbuf(serverErr);
+        QDir::setCurrent(serverDir);
+        CaretLogger::getLogger()->setLevel(serverLogLevel);
+
+        vector<QByteArray> response;
+        response.push_back(QByteArray::number(ret));
+        response.push_back(QByteArray(outCapture.str().c_str(), outCapture.str().size()));
+        response.push_back(QByteArray(errCapture.str().c_str(), errCapture.str().size()));
+        return response;
+    }
+}
+
+/**
+ * Listen for command lines from clients until a client sends STOP_SWITCH.
+ *
+ * @param serverName
+ *    Name of the local socket, a file path is used as is, otherwise it goes in the temporary directory.
+ * @param cacheBytes
+ *    Maximum size of the input file cache, zero disables the cache.
+ * @param runCommandFunction
+ *    Runs each command line in this process.
+ * @return
+ *    Exit code for the server process.
+ */
+int CommandServer::runServer(const AString& serverName, const int64_t& cacheBytes, RunCommandFunction runCommandFunction)
+{
+    QLocalServer myServer;
+    myServer.setSocketOptions(QLocalServer::UserAccessOption);//don't run commands for other users
+    {//only remove the socket if no server answers on it, it may belong to a running server
+        QLocalSocket probeSocket;
+        probeSocket.connectToServer(serverName);
+        if (probeSocket.waitForConnected(PROBE_TIMEOUT_MS))
+        {
+            probeSocket.disconnectFromServer();
+            cerr << "ERROR: a wb_command server is already running on '" << serverName.toLocal8Bit().constData() << "'" << endl;
+            return 1;
+        }
+    }
+    QLocalServer::removeServer(serverName);//remove a socket left by a server that didn't exit cleanly
+    if (!myServer.listen(serverName))
+    {
+        cerr << "ERROR: unable to listen on '" << serverName.toLocal8Bit().constData() << "': " << myServer.errorString().toLocal8Bit().constData() << endl;
+        return 1;
+    }
+    if (cacheBytes > 0)
+    {
+        OperationInputFileCache::enable(cacheBytes);
+    }
+    CaretLogInfo("wb_command server listening on '" + myServer.fullServerName() + "'");
+    bool keepRunning = true;
+    while (keepRunning)
+    {
+        if (!myServer.waitForNewConnection(-1)) break;
+        QLocalSocket* mySocket = myServer.nextPendingConnection();
+        if (mySocket == NULL) continue;
+        vector<QByteArray> request;
+        if (readMessage(mySocket, REQUEST_TIMEOUT_MS, request) && request.size() >= 2)
+        {
+            vector<QByteArray> response;
+            if (request.size() == 3 && request[2] == STOP_SWITCH.toUtf8())
+            {
+                keepRunning = false;
+                response.push_back("0");
+                response.push_back("wb_command server stopped\n");
+                response.push_back("");
+            } else if (request.size() == 3 && request[2] == STATUS_SWITCH.toUtf8()) {
+                response.push_back("0");
+                response.push_back((OperationInputFileCache::getStatistics() + "\n").toUtf8());
+                response.push_back("");
+            } else {
+                response = runRequest(request, runCommandFunction);
+            }
+            writeMessage(mySocket, response);
+        } else {
+            CaretLogWarning("wb_command server received an incomplete request");
+        }
+        mySocket->disconnectFromServer();
+        delete mySocket;
+    }
+    myServer.close();
+    OperationInputFileCache::disable();
+    return 0;
+}
+
+/**
+ * Send a command line to a running server and print its output.
+ *
+ * @param serverName
+ *    Name of the server's local socket.
+ * @param arguments
+ *    The command line, starting with the program name.
+ * @return
+ *    Exit code of the command.
+ */
+int CommandServer::runClient(const AString& serverName, const vector<AString>& arguments)
+{
+    QLocalSocket mySocket;
+    mySocket.connectToServer(serverName);
+    if (!mySocket.waitForConnected(REQUEST_TIMEOUT_MS))
+    {
+        cerr << "ERROR: unable to connect to wb_command server '" << serverName.toLocal8Bit().constData() << "': " << mySocket.errorString().toLocal8Bit().constData() << endl;
+        return 1;
+    }
+    vector<QByteArray> request;
+    request.push_back(QDir::currentPath().toUtf8());
+    for (size_t i = 0; i < arguments.size(); ++i)
+    {
+        request.push_back(arguments[i].toUtf8());
+    }
+    vector<QByteArray> response;
+    if (!writeMessage(&mySocket, request) || !readMessage(&mySocket, -1, response) || response.size() != 3)
+    {//commands can take a long time, so wait for the response without a timeout
+        cerr << "ERROR: lost connection to wb_command server '" << serverName.toLocal8Bit().constData() << "'" << endl;
+        return 1;
+    }
+    cout.write(response[1].constData(), response[1].size());
+    cout.flush();
+    cerr.write(response[2].constData(), response[2].size());
+    cerr.flush();
+    return response[0].toInt();
+}
+
+/**
+ * @return Help information for the server and client modes.
+ */
+AString CommandServer::getServerHelp()
+{
+    //guide for wrap, assuming 80 columns:                                                  |
+    return AString("   wb_command can run as a server that keeps running between commands, to\n") +
+                   "   avoid startup costs and re-reading the same input files in scripts that run\n" +
+                   "   many short commands.  Start the server with:\n" +
+                   "\n" +
+                   "      wb_command -server <socket> [<cache-MB>]\n" +
+                   "\n" +
+                   "   <socket> is the path of the local socket to create, and <cache-MB> is the\n" +
+                   "   maximum size of the input file cache in megabytes (default 1024, 0 disables\n" +
+                   "   the cache).  Surface, metric, label and cifti inputs are cached, and are\n" +
+                   "   reread when the file on disk changes.  Then run commands with:\n" +
+                   "\n" +
+                   "      wb_command -client <socket> <command> [arguments...]\n" +
+                   "\n" +
+                   "   Commands run one at a time in the server, in the client's current\n" +
+                   "   directory, and their output and exit code are returned by the client.  Use\n" +
+                   "   '" + STATUS_SWITCH + "' as the command to show cache statistics, and\n" +
+                   "   '" + STOP_SWITCH + "' to stop the server.\n";
+}
@@ -0,0 +1,61 @@
+#ifndef __COMMAND_SERVER_H__
+#define __COMMAND_SERVER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace caret {
+
+    /// Runs wb_command as a persistent server on a local socket, and the thin client that sends it command lines.
+    ///
+    /// The server keeps the command operations registered and keeps input files in
+    /// OperationInputFileCache between commands, so that scripts running many short
+    /// commands on the same inputs don't pay for startup and file reading on every call.
+    /// Commands are run one at a time, in the working directory of the client, with
+    /// their standard output and error sent back to the client.
+    class CommandServer {
+    public:
+        /// function that runs a command line, in the same form as main() receives it
+        typedef int (*RunCommandFunction)(int argc, char* argv[]);
+
+        static int runServer(const AString& serverName,
+                             const int64_t& cacheBytes,
+                             RunCommandFunction runCommandFunction);
+
+        static int runClient(const AString& serverName,
+                             const std::vector<AString>& arguments);
+
+        static AString getServerHelp();
+
+        /// argument sent by the client to stop the server
+        static const AString STOP_SWITCH;
+
+        /// argument sent by the client to show the server's cache statistics
+        static const AString STATUS_SWITCH;
+    };
+
+} // namespace
+
+#endif // __COMMAND_SERVER_H__
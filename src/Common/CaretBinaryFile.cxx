@@ -32,6 +32,7 @@
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include "zlib.h"
 
 #include <cstdio>
@@ -86,12 +87,14 @@ CaretBinaryFile::ImplInterface::~ImplInterface()
 
 CaretBinaryFile::CaretBinaryFile(const QString& filename, const OpenMode& fileMode)
 {
+    m_curMode = NONE;
     open(filename, fileMode);
 }
 
 void CaretBinaryFile::close()
 {
     m_curMode = NONE;
+    finishProfileSpan();
     if (m_impl == NULL) return;
     m_impl->close();
     m_impl.grabNew(NULL);
@@ -129,12 +132,39 @@ void CaretBinaryFile::open(const QString& filename, const OpenMode& opmode)
     }
     m_impl->open(filename, opmode);
     m_curMode = opmode;
+    if (CaretProfiler::isEnabled())
+    {
+        m_profileSpan.begin(QFileInfo(filename).fileName(), "io");
+        m_profileSpan.addArg("file", filename);
+        m_profileBytesRead = 0;
+        m_profileBytesWritten = 0;
+        m_profileIOMicroseconds = 0;
+    }
+}
+
+void CaretBinaryFile::finishProfileSpan()
+{//one span per open file rather than per call, as some readers make many small reads
+    if (!m_profileSpan.isActive()) return;
+    m_profileSpan.addArg("bytes_read", m_profileBytesRead);
+    m_profileSpan.addArg("bytes_written", m_profileBytesWritten);
+    m_profileSpan.addArg("io_ms", m_profileIOMicroseconds / 1000.0);
+    m_profileSpan.end();
 }
 
 void CaretBinaryFile::read(void* dataOut, const int64_t& count, int64_t* numRead)
 {
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForRead()) throw DataFileException("file is not open for reading");
+    if (m_profileSpan.isActive())
+    {
+        const int64_t start = CaretProfiler::getTimeMicroseconds();
+        int64_t myNumRead = count;
+        m_impl->read(dataOut, count, (numRead == NULL ? NULL : &myNumRead));
+        m_profileIOMicroseconds += CaretProfiler::getTimeMicroseconds() - start;
+        m_profileBytesRead += myNumRead;
+        if (numRead != NULL) *numRead = myNumRead;
+        return;
+    }
     m_impl->read(dataOut, count, numRead);
 }
 
@@ -161,6 +191,14 @@ void CaretBinaryFile::write(const void* dataIn, const int64_t& count)
 {
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForWrite()) throw DataFileException("file is not open for writing");
+    if (m_profileSpan.isActive())
+    {
+        const int64_t start = CaretProfiler::getTimeMicroseconds();
+        m_impl->write(dataIn, count);
+        m_profileIOMicroseconds += CaretProfiler::getTimeMicroseconds() - start;
+        m_profileBytesWritten += count;
+        return;
+    }
     m_impl->write(dataIn, count);
 }
 
@@ -22,6 +22,7 @@
 /*LICENSE_END*/
 
 #include "CaretPointer.h"
+#include "CaretProfiler.h"
 
 #include <QString>
 
@@ -43,7 +44,8 @@ namespace caret {
             WRITE_TRUNCATE = 6,//ditto
             READ_WRITE_TRUNCATE = 7//ditto
         };
-        CaretBinaryFile() { }
+        CaretBinaryFile() { m_curMode = NONE; }
+        ~CaretBinaryFile() { finishProfileSpan(); }
         ///constructor that opens file
         CaretBinaryFile(const QString& filename, const OpenMode& fileMode = READ);
         void open(const QString& filename, const OpenMode& opmode = READ);
@@ -74,6 +76,9 @@ namespace caret {
     private:
         CaretPointer<ImplInterface> m_impl;
         OpenMode m_curMode;//so implementation classes don't have to track it
+        CaretProfileSpan m_profileSpan;//from open to close, only active when profiling
+        int64_t m_profileBytesRead, m_profileBytesWritten, m_profileIOMicroseconds;
+        void finishProfileSpan();
     };
 } //namespace caret
 
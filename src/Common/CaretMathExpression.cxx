@@ -22,12 +22,69 @@
 #include "CaretException.h"
 #include "CaretLogger.h"
 #include "CaretMathExpression.h"
+#include "CaretOMP.h"
 
 #include <cmath>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{//functions that need more than a single call, shared between the tree and compiled evaluation
+    double asinhValue(const double& arg)
+    {
+        //return asinh(arg);//will work, and be preferred, when we use c++11, but doesn't work on windows with previous standard
+        if (arg > 0)
+        {
+            return log(arg + sqrt(arg * arg + 1));
+        } else {
+            return -log(-arg + sqrt(arg * arg + 1));//special case negative for stability in large negatives
+        }
+    }
+    
+    double acoshValue(const double& arg)
+    {
+        return log(arg + sqrt(arg * arg - 1));
+    }
+    
+    double atanhValue(const double& arg)
+    {
+        return 0.5 * log((1 + arg) / (1 - arg));
+    }
+    
+    double sincValue(const double& arg)
+    {
+        if (arg == 0.0)//assume sin(x) behaves well for very small x
+        {
+            return 1.0;
+        }
+        return sin(arg) / arg;
+    }
+    
+    double roundValue(const double& arg)
+    {//windows doesn't use c99 when compiling c++ earlier than c++11, so implement manually
+        if (arg > 0.0)
+        {
+            return floor(arg + 0.5);
+        }
+        return ceil(arg - 0.5);
+    }
+    
+    double modValue(const double& first, const double& second)
+    {
+        if (second == 0.0)
+        {
+            return 0.0;
+        }
+        return first - second * floor(first / second);
+    }
+    
+    float equalTolerance(const double& first, const double& second)
+    {//because == doesn't always work as expected, include a fudge factor based on the approximate precision of float
+        return min(abs(first), abs(second)) / 1000000;
+    }
+}
+
 CaretMathExpression::CaretMathExpression(const AString& expression)
 {
     m_input = expression;
@@ -39,6 +96,7 @@ CaretMathExpression::CaretMathExpression(const AString& expression)
         throw CaretException("extra characters on end of expression: '" + m_input.mid(m_position) + "'");
     }
     CaretLogFiner("parsed '" + expression + "' as '" + toString() + "'");
+    compile();
 }
 
 double CaretMathExpression::evaluate(const vector<float>& variableValues) const
@@ -47,6 +105,337 @@ double CaretMathExpression::evaluate(const vector<float>& variableValues) const
     return m_root->eval(variableValues);
 }
 
+void CaretMathExpression::evaluate(const vector<const float*>& variableData, float* dataOut, const int64_t& numElements) const
+{
+    CaretAssert(variableData.size() == m_varNames.size());
+    const int64_t numBlocks = (numElements + BLOCK_SIZE - 1) / BLOCK_SIZE;
+#pragma omp CARET_PAR if (numBlocks > 1)
+    {
+        vector<double> registers(m_numRegisters * BLOCK_SIZE);
+        for (int i = 0; i < (int)m_constRegisters.size(); ++i)
+        {
+            double* constReg = registers.data() + m_constRegisters[i].first * BLOCK_SIZE;
+            for (int j = 0; j < BLOCK_SIZE; ++j)
+            {
+                constReg[j] = m_constRegisters[i].second;
+            }
+        }
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t block = 0; block < numBlocks; ++block)
+        {
+            const int64_t start = block * BLOCK_SIZE;
+            const int count = (int)min((int64_t)BLOCK_SIZE, numElements - start);
+            evaluateBlock(variableData, start, count, registers.data(), dataOut);
+        }
+    }
+}
+
+void CaretMathExpression::evaluateBlock(const vector<const float*>& variableData, const int64_t& start, const int& count, double* registers, float* dataOut) const
+{
+    for (int step = 0; step < (int)m_program.size(); ++step)
+    {
+        const MathInstruction& instr = m_program[step];
+        double* out = registers + instr.m_out * BLOCK_SIZE;
+        if (instr.m_op == MathInstruction::LOADVAR)
+        {
+            CaretAssertVectorIndex(variableData, instr.m_args[0]);
+            const float* varData = variableData[instr.m_args[0]] + start;
+            for (int i = 0; i < count; ++i) out[i] = varData[i];
+            continue;
+        }
+        const double* a = registers + instr.m_args[0] * BLOCK_SIZE;
+        const double* b = (instr.m_args[1] < 0 ? NULL : registers + instr.m_args[1] * BLOCK_SIZE);
+        switch (instr.m_op)
+        {
+            case MathInstruction::LOADVAR:
+                break;//handled above
+            case MathInstruction::ADD:
+                for (int i = 0; i < count; ++i) out[i] = a[i] + b[i];
+                break;
+            case MathInstruction::SUB:
+                for (int i = 0; i < count; ++i) out[i] = a[i] - b[i];
+                break;
+            case MathInstruction::MULT:
+                for (int i = 0; i < count; ++i) out[i] = a[i] * b[i];
+                break;
+            case MathInstruction::DIV:
+                for (int i = 0; i < count; ++i) out[i] = a[i] / b[i];
+                break;
+            case MathInstruction::POW:
+                for (int i = 0; i < count; ++i) out[i] = pow(a[i], b[i]);
+                break;
+            case MathInstruction::NEGATE:
+                for (int i = 0; i < count; ++i) out[i] = -a[i];
+                break;
+            case MathInstruction::NOT:
+                for (int i = 0; i < count; ++i) out[i] = (a[i] > 0.0) ? 0.0 : 1.0;
+                break;
+            case MathInstruction::OR://no lazy evaluation, but there are no side effects, so the result is the same
+                for (int i = 0; i < count; ++i) out[i] = (a[i] > 0.0 || b[i] > 0.0) ? 1.0 : 0.0;
+                break;
+            case MathInstruction::AND:
+                for (int i = 0; i < count; ++i) out[i] = (a[i] > 0.0 && b[i] > 0.0) ? 1.0 : 0.0;
+                break;
+            case MathInstruction::EQUAL:
+                for (int i = 0; i < count; ++i)
+                {
+                    float adjust = equalTolerance(a[i], b[i]);
+                    out[i] = (a[i] >= b[i] - adjust && a[i] <= b[i] + adjust) ? 1.0 : 0.0;
+                }
+                break;
+            case MathInstruction::NOTEQUAL:
+                for (int i = 0; i < count; ++i)
+                {
+                    float adjust = equalTolerance(a[i], b[i]);
+                    out[i] = (a[i] >= b[i] - adjust && a[i] <= b[i] + adjust) ? 0.0 : 1.0;
+                }
+                break;
+            case MathInstruction::GREATER:
+                for (int i = 0; i < count; ++i) out[i] = (a[i] > b[i]) ? 1.0 : 0.0;
+                break;
+            case MathInstruction::LESS:
+                for (int i = 0; i < count; ++i) out[i] = (a[i] < b[i]) ? 1.0 : 0.0;
+                break;
+            case MathInstruction::GREATEREQUAL:
+                for (int i = 0; i < count; ++i) out[i] = (a[i] >= b[i] - equalTolerance(a[i], b[i])) ? 1.0 : 0.0;
+                break;
+            case MathInstruction::LESSEQUAL:
+                for (int i = 0; i < count; ++i) out[i] = (a[i] <= b[i] + equalTolerance(a[i], b[i])) ? 1.0 : 0.0;
+                break;
+            case MathInstruction::FUNC:
+                switch (instr.m_function)
+                {
+                    case MathFunctionEnum::SIN:
+                        for (int i = 0; i < count; ++i) out[i] = sin(a[i]);
+                        break;
+                    case MathFunctionEnum::COS:
+                        for (int i = 0; i < count; ++i) out[i] = cos(a[i]);
+                        break;
+                    case MathFunctionEnum::TAN:
+                        for (int i = 0; i < count; ++i) out[i] = tan(a[i]);
+                        break;
+                    case MathFunctionEnum::ASIN:
+                        for (int i = 0; i < count; ++i) out[i] = asin(a[i]);
+                        break;
+                    case MathFunctionEnum::ACOS:
+                        for (int i = 0; i < count; ++i) out[i] = acos(a[i]);
+                        break;
+                    case MathFunctionEnum::ATAN:
+                        for (int i = 0; i < count; ++i) out[i] = atan(a[i]);
+                        break;
+                    case MathFunctionEnum::SINH:
+                        for (int i = 0; i < count; ++i) out[i] = sinh(a[i]);
+                        break;
+                    case MathFunctionEnum::COSH:
+                        for (int i = 0; i < count; ++i) out[i] = cosh(a[i]);
+                        break;
+                    case MathFunctionEnum::TANH:
+                        for (int i = 0; i < count; ++i) out[i] = tanh(a[i]);
+                        break;
+                    case MathFunctionEnum::ASINH:
+                        for (int i = 0; i < count; ++i) out[i] = asinhValue(a[i]);
+                        break;
+                    case MathFunctionEnum::ACOSH:
+                        for (int i = 0; i < count; ++i) out[i] = acoshValue(a[i]);
+                        break;
+                    case MathFunctionEnum::ATANH:
+                        for (int i = 0; i < count; ++i) out[i] = atanhValue(a[i]);
+                        break;
+                    case MathFunctionEnum::SINC:
+                        for (int i = 0; i < count; ++i) out[i] = sincValue(a[i]);
+                        break;
+                    case MathFunctionEnum::LN:
+                        for (int i = 0; i < count; ++i) out[i] = log(a[i]);
+                        break;
+                    case MathFunctionEnum::EXP:
+                        for (int i = 0; i < count; ++i) out[i] = exp(a[i]);
+                        break;
+                    case MathFunctionEnum::LOG:
+                        for (int i = 0; i < count; ++i) out[i] = log10(a[i]);
+                        break;
+                    case MathFunctionEnum::LOG2:
+                        for (int i = 0; i < count; ++i) out[i] = log2(a[i]);
+                        break;
+                    case MathFunctionEnum::SQRT:
+                        for (int i = 0; i < count; ++i) out[i] = sqrt(a[i]);
+                        break;
+                    case MathFunctionEnum::ABS:
+                        for (int i = 0; i < count; ++i) out[i] = abs(a[i]);
+                        break;
+                    case MathFunctionEnum::FLOOR:
+                        for (int i = 0; i < count; ++i) out[i] = floor(a[i]);
+                        break;
+                    case MathFunctionEnum::ROUND:
+                        for (int i = 0; i < count; ++i) out[i] = roundValue(a[i]);
+                        break;
+                    case MathFunctionEnum::CEIL:
+                        for (int i = 0; i < count; ++i) out[i] = ceil(a[i]);
+                        break;
+                    case MathFunctionEnum::ATAN2:
+                        for (int i = 0; i < count; ++i) out[i] = atan2(a[i], b[i]);
+                        break;
+                    case MathFunctionEnum::MIN:
+                        for (int i = 0; i < count; ++i) out[i] = (a[i] > b[i]) ? b[i] : a[i];
+                        break;
+                    case MathFunctionEnum::MAX:
+                        for (int i = 0; i < count; ++i) out[i] = (a[i] < b[i]) ? b[i] : a[i];
+                        break;
+                    case MathFunctionEnum::MOD:
+                        for (int i = 0; i < count; ++i) out[i] = modValue(a[i], b[i]);
+                        break;
+                    case MathFunctionEnum::CLAMP:
+                    {
+                        const double* c = registers + instr.m_args[2] * BLOCK_SIZE;
+                        for (int i = 0; i < count; ++i)
+                        {
+                            double temp = a[i];
+                            if (temp < b[i]) temp = b[i];
+                            if (temp > c[i]) temp = c[i];
+                            out[i] = temp;
+                        }
+                        break;
+                    }
+                    case MathFunctionEnum::INVALID:
+                        CaretAssertMessage(0, "MathInstruction is type FUNC but INVALID function");
+                        throw CaretException("parsing problem in CaretMathExpression");
+                }
+                break;
+        }
+    }
+    const double* result = registers + m_resultRegister * BLOCK_SIZE;
+    float* blockOut = dataOut + start;
+    for (int i = 0; i < count; ++i) blockOut[i] = (float)result[i];
+}
+
+void CaretMathExpression::compile()
+{
+    m_program.clear();
+    m_constRegisters.clear();
+    m_numRegisters = 0;
+    vector<int> freeRegisters;
+    vector<bool> isConstRegister;
+    m_resultRegister = compileNode(m_root, freeRegisters, isConstRegister);
+}
+
+int CaretMathExpression::allocateRegister(vector<int>& freeRegisters, vector<bool>& isConstRegister)
+{
+    if (!freeRegisters.empty())
+    {
+        int ret = freeRegisters.back();
+        freeRegisters.pop_back();
+        return ret;
+    }
+    isConstRegister.push_back(false);
+    return m_numRegisters++;
+}
+
+int CaretMathExpression::compileNode(const MathNode* node, vector<int>& freeRegisters, vector<bool>& isConstRegister)
+{//arguments are compiled first, each step writes over its first argument when it is a temporary, and releases its other temporary arguments
+    switch (node->m_type)
+    {
+        case MathNode::CONST:
+        {
+            int ret = m_numRegisters++;//always a fresh register, the value is only filled in once before the program runs, so a freed temporary would get overwritten
+            isConstRegister.push_back(true);//never reuse
+            m_constRegisters.push_back(make_pair(ret, node->m_constVal));
+            return ret;
+        }
+        case MathNode::VAR:
+        {
+            int ret = allocateRegister(freeRegisters, isConstRegister);
+            MathInstruction instr(MathInstruction::LOADVAR, ret);
+            instr.m_args[0] = node->m_varIndex;
+            m_program.push_back(instr);
+            return ret;
+        }
+        case MathNode::INVALID:
+            CaretAssertMessage(0, "parsing left INVALID MathNode");
+            throw CaretException("parsing problem in CaretMathExpression");
+        default:
+            break;
+    }
+    const int numArgs = (int)node->m_arguments.size();
+    CaretAssert(numArgs > 0 && (numArgs < 4 || node->m_type != MathNode::FUNC));
+    int current = compileNode(node->m_arguments[0], freeRegisters, isConstRegister);
+    if (node->m_type == MathNode::FUNC)
+    {
+        vector<int> argRegs(1, current);
+        for (int i = 1; i < numArgs; ++i)
+        {
+            argRegs.push_back(compileNode(node->m_arguments[i], freeRegisters, isConstRegister));
+        }
+        int out = argRegs[0];
+        if (isConstRegister[out]) out = allocateRegister(freeRegisters, isConstRegister);
+        MathInstruction instr(MathInstruction::FUNC, out);
+        instr.m_function = node->m_function;
+        for (int i = 0; i < numArgs; ++i)
+        {
+            instr.m_args[i] = argRegs[i];
+        }
+        m_program.push_back(instr);
+        for (int i = 1; i < numArgs; ++i)
+        {
+            if (!isConstRegister[argRegs[i]]) freeRegisters.push_back(argRegs[i]);
+        }
+        return out;
+    }
+    if (node->m_type == MathNode::NOT || node->m_type == MathNode::NEGATE)
+    {
+        int out = current;
+        if (isConstRegister[out]) out = allocateRegister(freeRegisters, isConstRegister);
+        MathInstruction instr(node->m_type == MathNode::NOT ? MathInstruction::NOT : MathInstruction::NEGATE, out);
+        instr.m_args[0] = current;
+        m_program.push_back(instr);
+        return out;
+    }
+    for (int i = 1; i < numArgs; ++i)
+    {
+        int other = compileNode(node->m_arguments[i], freeRegisters, isConstRegister);
+        MathInstruction::OpCode op = MathInstruction::ADD;
+        switch (node->m_type)
+        {
+            case MathNode::OR:
+                op = MathInstruction::OR;
+                break;
+            case MathNode::AND:
+                op = MathInstruction::AND;
+                break;
+            case MathNode::EQUAL:
+                op = (node->m_invert[i] ? MathInstruction::NOTEQUAL : MathInstruction::EQUAL);
+                break;
+            case MathNode::GREATERLESS:
+                if (node->m_inclusive[i])
+                {
+                    op = (node->m_invert[i] ? MathInstruction::LESSEQUAL : MathInstruction::GREATEREQUAL);
+                } else {
+                    op = (node->m_invert[i] ? MathInstruction::LESS : MathInstruction::GREATER);
+                }
+                break;
+            case MathNode::ADDSUB:
+                op = (node->m_invert[i] ? MathInstruction::SUB : MathInstruction::ADD);
+                break;
+            case MathNode::MULTDIV:
+                op = (node->m_invert[i] ? MathInstruction::DIV : MathInstruction::MULT);
+                break;
+            case MathNode::POW:
+                op = MathInstruction::POW;
+                break;
+            default:
+                CaretAssertMessage(0, "unhandled MathNode type in compile");
+                throw CaretException("parsing problem in CaretMathExpression");
+        }
+        int out = current;
+        if (isConstRegister[out]) out = allocateRegister(freeRegisters, isConstRegister);
+        MathInstruction instr(op, out);
+        instr.m_args[0] = current;
+        instr.m_args[1] = other;
+        m_program.push_back(instr);
+        if (!isConstRegister[other]) freeRegisters.push_back(other);
+        current = out;
+    }
+    return current;
+}
+
 vector<AString> CaretMathExpression::getVarNames() const
 {
     vector<AString> ret(m_varNames.size());
@@ -125,8 +514,8 @@ double CaretMathExpression::MathNode::eval(const vector<float>& values) const
             for (int i = 1; i < end; ++i)
             {
                 double temp = m_arguments[i]->eval(values);
-                float adjust = min(abs(ret), abs(temp)) / 1000000;//because == doesn't always work as expected, include a fudge factor based on the approximate precision of float
-                bool equal = (ret >= m_arguments[i]->eval(values) - adjust) && (ret <= m_arguments[i]->eval(values) + adjust);
+                float adjust = equalTolerance(ret, temp);
+                bool equal = (ret >= temp - adjust) && (ret <= temp + adjust);
                 if (m_invert[i])
                 {
                     ret = equal ? 0.0 : 1.0;
@@ -148,7 +537,7 @@ double CaretMathExpression::MathNode::eval(const vector<float>& values) const
                 double temp = m_arguments[i]->eval(values);
                 if (m_inclusive[i])
                 {
-                    float adjust = min(abs(ret), abs(temp)) / 1000000;//because == doesn't always work as expected, include a fudge factor based on the approximate precision of float
+                    float adjust = equalTolerance(ret, temp);
                     if (m_invert[i])
                     {
                         ret = (ret <= temp + adjust ? 1.0 : 0.0);//don't trust booleans to cast to 0 and 1, just because
@@ -255,46 +644,21 @@ double CaretMathExpression::MathNode::eval(const vector<float>& values) const
                     ret = tanh(m_arguments[0]->eval(values));
                     break;
                 case MathFunctionEnum::ASINH:
-                {
                     CaretAssert(m_arguments.size() == 1);
-                    //ret = asinh(m_arguments[0].eval(values));//will work, and be preferred, when we use c++11, but doesn't work on windows with previous standard
-                    double arg = m_arguments[0]->eval(values);
-                    if (arg > 0)
-                    {
-                        ret = log(arg + sqrt(arg * arg + 1));
-                    } else {
-                        ret = -log(-arg + sqrt(arg * arg + 1));//special case negative for stability in large negatives
-                    }
+                    ret = asinhValue(m_arguments[0]->eval(values));
                     break;
-                }
                 case MathFunctionEnum::ACOSH:
-                {
                     CaretAssert(m_arguments.size() == 1);
-                    //ret = acosh(m_arguments[0].eval(values));
-                    double arg = m_arguments[0]->eval(values);
-                    ret = log(arg + sqrt(arg * arg - 1));
+                    ret = acoshValue(m_arguments[0]->eval(values));
                     break;
-                }
                 case MathFunctionEnum::ATANH:
-                {
                     CaretAssert(m_arguments.size() == 1);
-                    //ret = atanh(m_arguments[0].eval(values));
-                    double arg = m_arguments[0]->eval(values);
-                    ret = 0.5 * log((1 + arg) / (1 - arg));
+                    ret = atanhValue(m_arguments[0]->eval(values));
                     break;
-                }
                 case MathFunctionEnum::SINC:
-                {
                     CaretAssert(m_arguments.size() == 1);
-                    double arg = m_arguments[0]->eval(values);
-                    if (arg == 0.0)//assume sin(x) behaves well for very small x
-                    {
-                        ret = 1.0;
-                    } else {
-                        ret = sin(arg) / arg;
-                    }
+                    ret = sincValue(m_arguments[0]->eval(values));
                     break;
-                }
                 case MathFunctionEnum::LN:
                     CaretAssert(m_arguments.size() == 1);
                     ret = log(m_arguments[0]->eval(values));
@@ -324,17 +688,9 @@ double CaretMathExpression::MathNode::eval(const vector<float>& values) const
                     ret = floor(m_arguments[0]->eval(values));
                     break;
                 case MathFunctionEnum::ROUND:
-                {
                     CaretAssert(m_arguments.size() == 1);
-                    double temp = m_arguments[0]->eval(values);//windows doesn't use c99 when compiling c++ earlier than c++11, so implement manually
-                    if (temp > 0.0)
-                    {
-                        ret = floor(temp + 0.5);
-                    } else {
-                        ret = ceil(temp - 0.5);
-                    }
+                    ret = roundValue(m_arguments[0]->eval(values));
                     break;
-                }
                 case MathFunctionEnum::CEIL:
                     CaretAssert(m_arguments.size() == 1);
                     ret = ceil(m_arguments[0]->eval(values));
@@ -360,18 +716,9 @@ double CaretMathExpression::MathNode::eval(const vector<float>& values) const
                     break;
                 }
                 case MathFunctionEnum::MOD:
-                {
                     CaretAssert(m_arguments.size() == 2);
-                    double second = m_arguments[1]->eval(values);
-                    if (second == 0.0)
-                    {
-                        ret = 0.0;
-                    } else {
-                        double first = m_arguments[0]->eval(values);
-                        ret = first - second * floor(first / second);
-                    }
+                    ret = modValue(m_arguments[0]->eval(values), m_arguments[1]->eval(values));
                     break;
-                }
                 case MathFunctionEnum::CLAMP:
                 {
                     CaretAssert(m_arguments.size() == 3);
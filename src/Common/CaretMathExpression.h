@@ -63,6 +63,43 @@ class CaretMathExpression
         double eval(const std::vector<float>& values) const;
         AString toString(const std::vector<AString>& varNames, bool addParens = true) const;
     };
+    ///one step of the compiled form of the expression, operates on a block of elements in registers, n-ary nodes become chains of binary steps
+    struct MathInstruction
+    {
+        enum OpCode
+        {
+            LOADVAR,
+            ADD,
+            SUB,
+            MULT,
+            DIV,
+            POW,
+            NEGATE,
+            NOT,
+            OR,
+            AND,
+            EQUAL,
+            NOTEQUAL,
+            GREATER,
+            LESS,
+            GREATEREQUAL,
+            LESSEQUAL,
+            FUNC
+        };
+        OpCode m_op;
+        MathFunctionEnum::Enum m_function;
+        int m_out;//register for the result
+        int m_args[3];//registers for the arguments, or variable index for LOADVAR
+        MathInstruction(const OpCode& op, const int& out) { m_op = op; m_function = MathFunctionEnum::INVALID; m_out = out; m_args[0] = -1; m_args[1] = -1; m_args[2] = -1; }
+    };
+    static const int BLOCK_SIZE = 1024;//elements per register
+    std::vector<MathInstruction> m_program;
+    std::vector<std::pair<int, double> > m_constRegisters;//registers filled with a constant before evaluation
+    int m_numRegisters, m_resultRegister;
+    void compile();
+    int compileNode(const MathNode* node, std::vector<int>& freeRegisters, std::vector<bool>& isConstRegister);
+    int allocateRegister(std::vector<int>& freeRegisters, std::vector<bool>& isConstRegister);
+    void evaluateBlock(const std::vector<const float*>& variableData, const int64_t& start, const int& count, double* registers, float* dataOut) const;
     std::map<AString, int> m_varNames;
     AString m_input;
     int m_position, m_end;
@@ -87,6 +124,8 @@ public:
     static bool getNamedConstant(const AString& name, double& valueOut);
     CaretMathExpression(const AString& expression);
     double evaluate(const std::vector<float>& variableValues) const;
+    ///evaluate for many elements at once, variableData[i] points to the values of variable i for all elements, uses multiple threads
+    void evaluate(const std::vector<const float*>& variableData, float* dataOut, const int64_t& numElements) const;
     std::vector<AString> getVarNames() const;
     AString toString() const;//the expression, with a lot of parentheses added
 };
@@ -106,6 +106,12 @@ CaretPreferences::CaretPreferences()
                                                       CaretPreferenceDataValue::SavedInScene::SAVE_NO,
                                                       s_defaultCziDimension));
     
+    m_connectivityRowCacheMegabytes.reset(new CaretPreferenceDataValue(this->qSettings,
+                                                                       "connectivityRowCacheMegabytes",
+                                                                       CaretPreferenceDataValue::DataType::INTEGER,
+                                                                       CaretPreferenceDataValue::SavedInScene::SAVE_NO,
+                                                                       s_defaultConnectivityRowCacheMegabytes));
+    
     m_identificationStereotaxicDistance.reset(new CaretPreferenceDataValue(this->qSettings,
                                                                                 "m_identificationStereotaxicDistance",
                                                                                 CaretPreferenceDataValue::DataType::FLOAT,
@@ -1773,6 +1779,38 @@ CaretPreferences::setCziDimension(const int32_t dimension)
     m_cziDimension->setValue(dimension);
 }
 
+/**
+ * @return Maximum size, in megabytes, of the rows from connectivity matrix
+ * files that are kept in memory to speed interactive loading of connectivity.
+ */
+int32_t
+CaretPreferences::getConnectivityRowCacheMegabytes() const
+{
+    return m_connectivityRowCacheMegabytes->getValue().toInt();
+}
+
+/**
+ * Set the maximum size, in megabytes, of the rows from connectivity matrix
+ * files that are kept in memory.  Zero disables caching of rows.
+ * @param megabytes
+ *    New maximum size
+ */
+void
+CaretPreferences::setConnectivityRowCacheMegabytes(const int32_t megabytes)
+{
+    m_connectivityRowCacheMegabytes->setValue(megabytes);
+}
+
+/**
+ * @return Default maximum size, in megabytes, of the rows from connectivity
+ * matrix files that are kept in memory.
+ */
+int32_t
+CaretPreferences::getDefaultConnectivityRowCacheMegabytes()
+{
+    return s_defaultConnectivityRowCacheMegabytes;
+}
+
 /**
  * Get supported dimensions for CZI images as both integers and text
  * @param supportedValuesOut
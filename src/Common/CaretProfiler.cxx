@@ -0,0 +1,231 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretProfiler.h"
+
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CaretOMP.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <thread>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    struct TraceEvent
+    {
+        AString m_name, m_category;
+        int64_t m_start, m_duration;
+        int m_thread;
+        CaretProfiler::ArgList m_args;
+    };
+
+    CaretMutex g_profileMutex;
+    atomic<bool> g_profileEnabled(false);//written under the mutex, but isEnabled() reads it without locking, set last in start() so g_profileStart is visible first
+    AString g_profileFilename;
+    ofstream g_profileStream;
+    chrono::steady_clock::time_point g_profileStart;
+    vector<TraceEvent> g_profileEvents;
+    map<thread::id, int> g_profileThreads;//small numbers are easier to read in the viewer than native thread ids
+
+    AString jsonString(const AString& input)
+    {
+        AString ret = "\"";
+        for (int i = 0; i < input.size(); ++i)
+        {
+            const ushort code = input[i].unicode();
+            switch (code)
+            {
+                case '"':
+                    ret += "\\\"";
+                    break;
+                case '\\':
+                    ret += "\\\\";
+                    break;
+                case '\n':
+                    ret += "\\n";
+                    break;
+                case '\t':
+                    ret += "\\t";
+                    break;
+                default:
+                    if (code < 0x20)
+                    {
+                        ret += "\\u" + AString::number(code, 16).rightJustified(4, '0');
+                    } else {
+                        ret += input[i];
+                    }
+            }
+        }
+        return ret + "\"";
+    }
+
+    //call with the mutex held
+    int getThreadIndex()
+    {
+        map<thread::id, int>::iterator iter = g_profileThreads.find(this_thread::get_id());
+        if (iter != g_profileThreads.end()) return iter->second;
+        const int ret = (int)g_profileThreads.size();
+        g_profileThreads[this_thread::get_id()] = ret;
+        return ret;
+    }
+}
+
+void CaretProfiler::start(const AString& filename)
+{
+    CaretMutexLocker locked(&g_profileMutex);
+    if (g_profileEnabled) throw CaretException("profiling has already been started, writing to '" + g_profileFilename + "'");
+    g_profileStream.clear();
+    g_profileStream.open(filename.toLocal8Bit().constData(), ios_base::out | ios_base::trunc);
+    if (!g_profileStream) throw CaretException("unable to open profile output file '" + filename + "'");
+    g_profileFilename = filename;
+    g_profileEvents.clear();
+    g_profileThreads.clear();
+    getThreadIndex();//the starting thread is thread 0
+    g_profileStart = chrono::steady_clock::now();
+    g_profileEnabled = true;
+}
+
+bool CaretProfiler::finish()
+{
+    CaretMutexLocker locked(&g_profileMutex);
+    if (!g_profileEnabled) return true;
+    g_profileEnabled = false;
+    int maxThreads = 1;
+#ifdef CARET_OMP
+    maxThreads = omp_get_max_threads();
+#endif
+    g_profileStream << "{\"traceEvents\":[" << endl;
+    g_profileStream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"wb_command\"}}";
+    for (map<thread::id, int>::const_iterator iter = g_profileThreads.begin(); iter != g_profileThreads.end(); ++iter)
+    {
+        const AString threadName = (iter->second == 0 ? AString("main") : "thread " + AString::number(iter->second));
+        g_profileStream << "," << endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << iter->second
+            << ",\"args\":{\"name\":" << jsonString(threadName).toStdString() << "}}";
+    }
+    for (size_t i = 0; i < g_profileEvents.size(); ++i)
+    {
+        const TraceEvent& myEvent = g_profileEvents[i];
+        g_profileStream << "," << endl << "{\"name\":" << jsonString(myEvent.m_name).toStdString() << ",\"cat\":" << jsonString(myEvent.m_category).toStdString()
+            << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << myEvent.m_thread << ",\"ts\":" << myEvent.m_start << ",\"dur\":" << myEvent.m_duration;
+        if (!myEvent.m_args.empty())
+        {
+            g_profileStream << ",\"args\":{";
+            for (size_t j = 0; j < myEvent.m_args.size(); ++j)
+            {
+                if (j != 0) g_profileStream << ",";
+                g_profileStream << jsonString(myEvent.m_args[j].first).toStdString() << ":" << myEvent.m_args[j].second.toStdString();
+            }
+            g_profileStream << "}";
+        }
+        g_profileStream << "}";
+    }
+    g_profileStream << endl << "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"omp_max_threads\":" << maxThreads << "}}" << endl;
+    g_profileStream.close();
+    g_profileEvents.clear();
+    g_profileThreads.clear();
+    if (!g_profileStream)
+    {
+        CaretLogWarning("error writing profile output file '" + g_profileFilename + "'");
+        return false;
+    }
+    return true;
+}
+
+bool CaretProfiler::isEnabled()
+{
+    return g_profileEnabled;
+}
+
+int64_t CaretProfiler::getTimeMicroseconds()
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - g_profileStart).count();
+}
+
+void CaretProfiler::addCompleteEvent(const AString& name, const AString& category, const int64_t& startMicroseconds, const int64_t& durationMicroseconds, const ArgList& args)
+{
+    CaretMutexLocker locked(&g_profileMutex);
+    if (!g_profileEnabled) return;
+    TraceEvent newEvent;
+    newEvent.m_name = name;
+    newEvent.m_category = category;
+    newEvent.m_start = startMicroseconds;
+    newEvent.m_duration = durationMicroseconds;
+    newEvent.m_thread = getThreadIndex();
+    newEvent.m_args = args;
+    g_profileEvents.push_back(newEvent);
+}
+
+CaretProfileSpan::CaretProfileSpan(const AString& name, const AString& category)
+{
+    m_active = false;
+    begin(name, category);
+}
+
+CaretProfileSpan::~CaretProfileSpan()
+{
+    end();
+}
+
+void CaretProfileSpan::begin(const AString& name, const AString& category)
+{
+    end();
+    if (!CaretProfiler::isEnabled()) return;
+    m_name = name;
+    m_category = category;
+    m_args.clear();
+    m_active = true;
+    m_cpuStart = clock();
+    m_start = CaretProfiler::getTimeMicroseconds();
+}
+
+void CaretProfileSpan::end()
+{
+    if (!m_active) return;
+    const int64_t duration = CaretProfiler::getTimeMicroseconds() - m_start;
+    const double cpuSeconds = double(clock() - m_cpuStart) / CLOCKS_PER_SEC;
+    addArg("cpu_ms", cpuSeconds * 1000.0);
+    if (duration > 0)
+    {//average number of busy threads, shows whether the openmp regions in the span scaled
+        addArg("busy_threads", cpuSeconds * 1000000.0 / duration);
+    }
+    m_active = false;
+    CaretProfiler::addCompleteEvent(m_name, m_category, m_start, duration, m_args);
+    m_args.clear();
+}
+
+void CaretProfileSpan::addArg(const AString& name, const double& value)
+{
+    if (!m_active) return;
+    m_args.push_back(make_pair(name, AString::number(value, 'g', 12)));
+}
+
+void CaretProfileSpan::addArg(const AString& name, const AString& value)
+{
+    if (!m_active) return;
+    m_args.push_back(make_pair(name, jsonString(value)));
+}
@@ -0,0 +1,78 @@
+#ifndef __CARET_PROFILER_H__
+#define __CARET_PROFILER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+#include <ctime>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace caret {
+
+    ///records timed spans while a command runs, and writes them as chrome trace-event json (viewable in chrome://tracing or perfetto)
+    ///disabled unless start() is called, so that the hooks in progress objects and file reading cost almost nothing normally
+    class CaretProfiler
+    {
+    public:
+        ///opens the output file now so a bad path is an error before doing any work, throws CaretException on failure
+        static void start(const AString& filename);
+
+        ///writes the trace and disables recording, does not throw so it can be used during stack unwinding, returns false on write failure
+        static bool finish();
+
+        static bool isEnabled();
+
+        ///microseconds since start()
+        static int64_t getTimeMicroseconds();
+
+        ///name and already-formatted json value
+        typedef std::vector<std::pair<AString, AString> > ArgList;
+
+        static void addCompleteEvent(const AString& name, const AString& category, const int64_t& startMicroseconds, const int64_t& durationMicroseconds, const ArgList& args);
+    };
+
+    ///one timed span, begun explicitly or by the constructor, recorded when ended or destroyed
+    ///cpu time of the whole process during the span is also recorded, so the ratio to wall time shows how many threads were busy in openmp regions
+    class CaretProfileSpan
+    {
+        AString m_name, m_category;
+        int64_t m_start;
+        std::clock_t m_cpuStart;
+        bool m_active;
+        CaretProfiler::ArgList m_args;
+    public:
+        CaretProfileSpan() { m_active = false; }
+        ///does nothing if the profiler is disabled
+        CaretProfileSpan(const AString& name, const AString& category);
+        ~CaretProfileSpan();
+        void begin(const AString& name, const AString& category);
+        void end();
+        bool isActive() const { return m_active; }
+        void addArg(const AString& name, const double& value);
+        void addArg(const AString& name, const AString& value);
+    };
+
+}
+
+#endif //__CARET_PROFILER_H__
@@ -20,6 +20,8 @@
 /*LICENSE_END*/
 
 #include "FastStatistics.h"
+#include "CaretAssert.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 
 #include <algorithm>
@@ -259,6 +261,230 @@ void FastStatistics::update(const float* data, const int64_t& dataCount, const f
     }
 }
 
+void FastStatistics::update(const int64_t& numChunks, const Histogram::ChunkReader& chunkReader)
+{
+    reset();
+    double sum = 0.0;
+    int64_t dataCount = 0;
+    bool first = true;
+    vector<double> chunkSums(numChunks, 0.0), chunkSums2(numChunks, 0.0);//floating point sums are kept per chunk and added in chunk order, so they don't depend on thread scheduling
+#pragma omp CARET_PAR
+    {//first pass: counts, ranges, and sum for the mean, each thread accumulates into its own object
+        vector<float> chunkData;
+        FastStatistics threadStats;
+        int64_t threadCount = 0;
+        bool threadFirst = true;
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            chunkReader(chunk, chunkData);
+            threadCount += (int64_t)chunkData.size();
+            threadStats.accumulateCountsAndRanges(chunkData.data(), (int64_t)chunkData.size(), chunkSums[chunk], threadFirst);
+        }
+#pragma omp critical
+        {//counts and ranges don't depend on merge order
+            mergeCountsAndRanges(threadStats, threadFirst, first);
+            dataCount += threadCount;
+        }
+    }
+    for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        sum += chunkSums[chunk];
+    }
+    int64_t totalGood = (m_negCount + m_zeroCount + m_posCount);
+    m_mean = sum / totalGood;
+    const int usebuckets = (int)min(NUM_BUCKETS_PERCENTILE_HIST, dataCount);
+    const float mean = m_mean;
+    const float posSize = (m_mostPos - m_leastPos) / usebuckets, negSize = (m_leastNeg - m_mostNeg) / usebuckets, absSize = (m_mostAbs - m_leastAbs) / usebuckets;
+    const float leastPos = m_leastPos, mostNeg = m_mostNeg, leastAbs = m_leastAbs;
+    double sum2 = 0.0;
+    vector<int64_t> posBuckets(max(usebuckets, 1), 0), negBuckets(max(usebuckets, 1), 0), absBuckets(max(usebuckets, 1), 0);
+#pragma omp CARET_PAR
+    {//second pass: sum of squared deviations, and the percentile histograms using the ranges from the first pass
+        vector<float> chunkData;
+        vector<int64_t> threadPos(posBuckets.size(), 0), threadNeg(negBuckets.size(), 0), threadAbs(absBuckets.size(), 0);
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            chunkReader(chunk, chunkData);
+            const float* data = chunkData.data();
+            const int64_t chunkCount = (int64_t)chunkData.size();
+            double& chunkSum2 = chunkSums2[chunk];
+            for (int64_t i = 0; i < chunkCount; ++i)
+            {
+                if (data[i] != data[i]) continue;//skip NaNs
+                if (data[i] < -1.0f && (data[i] * 2.0f == data[i])) continue;//exclude -inf
+                if (data[i] > 1.0f && (data[i] * 2.0f == data[i])) continue;//exclude inf
+                float tempf = data[i] - mean;
+                chunkSum2 += tempf * tempf;
+                if (data[i] == 0.0f) continue;
+                int bucket;
+                if (data[i] < 0.0f)
+                {
+                    if (negSize > 0.0f)
+                    {
+                        bucket = (int)((data[i] - mostNeg) / negSize);
+                        if (bucket < 0) bucket = 0;
+                        if (bucket >= usebuckets) bucket = usebuckets - 1;
+                        ++threadNeg[bucket];
+                    }
+                    if (absSize > 0.0f)
+                    {
+                        bucket = (int)((-data[i] - leastAbs) / absSize);
+                        if (bucket < 0) bucket = 0;
+                        if (bucket >= usebuckets) bucket = usebuckets - 1;
+                        ++threadAbs[bucket];
+                    }
+                } else {
+                    if (posSize > 0.0f)
+                    {
+                        bucket = (int)((data[i] - leastPos) / posSize);
+                        if (bucket < 0) bucket = 0;
+                        if (bucket >= usebuckets) bucket = usebuckets - 1;
+                        ++threadPos[bucket];
+                    }
+                    if (absSize > 0.0f)
+                    {
+                        bucket = (int)((data[i] - leastAbs) / absSize);
+                        if (bucket < 0) bucket = 0;
+                        if (bucket >= usebuckets) bucket = usebuckets - 1;
+                        ++threadAbs[bucket];
+                    }
+                }
+            }
+        }
+#pragma omp critical
+        {
+            for (size_t i = 0; i < posBuckets.size(); ++i)
+            {
+                posBuckets[i] += threadPos[i];
+                negBuckets[i] += threadNeg[i];
+                absBuckets[i] += threadAbs[i];
+            }
+        }
+    }
+    for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        sum2 += chunkSums2[chunk];
+    }
+    if (totalGood > 0)
+    {
+        m_stdDevPop = sqrt(sum2 / totalGood);
+        if (totalGood > 1)
+        {
+            m_stdDevSample = sqrt(sum2 / (totalGood - 1));
+        }
+    }
+    if (usebuckets > 0)
+    {
+        setPercentileHistogram(m_negPercentHist, negBuckets, m_mostNeg, m_leastNeg, m_negCount);
+        setPercentileHistogram(m_posPercentHist, posBuckets, m_leastPos, m_mostPos, m_posCount);
+        setPercentileHistogram(m_absPercentHist, absBuckets, m_leastAbs, m_mostAbs, m_absCount);
+    }
+    
+    if (m_negCount <= 0)
+    {
+        m_leastNeg = 0.0;
+        m_mostNeg  = 0.0;
+    }
+    if (m_posCount <= 0)
+    {
+        m_leastPos = 0.0;
+        m_mostPos  = 0.0;
+    }
+    if (m_absCount <= 0)
+    {
+        m_leastAbs = 0.0;
+        m_mostAbs  = 0.0;
+    }
+}
+
+void FastStatistics::accumulateCountsAndRanges(const float* data, const int64_t& dataCount, double& sum, bool& first)
+{//same as the first loop of update(), but without making copies of the data
+    for (int64_t i = 0; i < dataCount; ++i)
+    {
+        if (data[i] != data[i])
+        {
+            ++m_nanCount;
+            continue;//skip NaNs
+        }
+        if (data[i] == 0.0f)
+        {
+            ++m_zeroCount;
+        } else {
+            if (data[i] < 0.0f)
+            {
+                if (data[i] * 2.0f == data[i])
+                {
+                    ++m_negInfCount;
+                    continue;//skip neg infs
+                }
+                ++m_negCount;
+                if (data[i] > m_leastNeg) m_leastNeg = data[i];
+                if (data[i] < m_mostNeg) m_mostNeg = data[i];
+                if (-data[i] > m_mostAbs) m_mostAbs = -data[i];
+                if (-data[i] < m_leastAbs) m_leastAbs = -data[i];
+            } else {
+                if (data[i] * 2.0f == data[i])
+                {
+                    ++m_infCount;
+                    continue;//skip infs
+                }
+                ++m_posCount;
+                if (data[i] > m_mostPos) m_mostPos = data[i];
+                if (data[i] < m_leastPos) m_leastPos = data[i];
+                if (data[i] > m_mostAbs) m_mostAbs = data[i];
+                if (data[i] < m_leastAbs) m_leastAbs = data[i];
+            }
+            ++m_absCount;
+        }
+        if (data[i] > m_max || first) m_max = data[i];
+        if (data[i] < m_min || first) m_min = data[i];
+        sum += data[i];
+        first = false;
+    }
+}
+
+void FastStatistics::mergeCountsAndRanges(const FastStatistics& other, const bool& otherFirst, bool& first)
+{
+    m_posCount += other.m_posCount;
+    m_zeroCount += other.m_zeroCount;
+    m_negCount += other.m_negCount;
+    m_infCount += other.m_infCount;
+    m_negInfCount += other.m_negInfCount;
+    m_nanCount += other.m_nanCount;
+    m_absCount += other.m_absCount;
+    if (other.m_mostPos > m_mostPos) m_mostPos = other.m_mostPos;
+    if (other.m_leastPos < m_leastPos) m_leastPos = other.m_leastPos;
+    if (other.m_leastNeg > m_leastNeg) m_leastNeg = other.m_leastNeg;
+    if (other.m_mostNeg < m_mostNeg) m_mostNeg = other.m_mostNeg;
+    if (other.m_mostAbs > m_mostAbs) m_mostAbs = other.m_mostAbs;
+    if (other.m_leastAbs < m_leastAbs) m_leastAbs = other.m_leastAbs;
+    if (!otherFirst)
+    {
+        if (other.m_max > m_max || first) m_max = other.m_max;
+        if (other.m_min < m_min || first) m_min = other.m_min;
+        first = false;
+    }
+}
+
+void FastStatistics::setPercentileHistogram(Histogram& histogram, const vector<int64_t>& buckets, const float& bucketMin, const float& bucketMax, const int64_t& valueCount)
+{//equivalent to Histogram::update() on the values whose range and bucket counts were found by the caller
+    const int numBuckets = (int)buckets.size();
+    histogram.resize(numBuckets);
+    histogram.reset();
+    if (valueCount <= 0) return;//no values, histogram is all zeros
+    histogram.m_bucketMin = bucketMin;
+    histogram.m_bucketMax = bucketMax;
+    if (bucketMin == bucketMax)
+    {
+        histogram.setBucketsSingleValue(valueCount);
+        return;
+    }
+    histogram.m_buckets = buckets;
+    histogram.computeCumulativeAndDisplay((bucketMax - bucketMin) / numBuckets);
+}
+
 float FastStatistics::getApproxNegativePercentile(const float& percent) const
 {
     float rank = percent / 100.0f * m_negCount;//translate to rank
@@ -38,6 +38,12 @@ namespace caret
         void reset();
         
         static float getValuePercentileHelper(const Histogram& histogram, const float numberOfDataValues, const bool negativeDataFlag, const float value);
+        
+        void accumulateCountsAndRanges(const float* data, const int64_t& dataCount, double& sum, bool& first);
+        
+        void mergeCountsAndRanges(const FastStatistics& other, const bool& otherFirst, bool& first);
+        
+        static void setPercentileHistogram(Histogram& histogram, const std::vector<int64_t>& buckets, const float& bucketMin, const float& bucketMax, const int64_t& valueCount);
 
     public:
         FastStatistics();
@@ -49,6 +55,10 @@ namespace caret
         ///statistics and display are really not that related, so for now, only include a continuous clipping range, excluding the middle from data will do weird things to standard deviation
         void update(const float* data, const int64_t& dataCount, const float& minThreshInclusive, const float& maxThreshInclusive);
         
+        ///compute from data that is read in pieces (chunks), such as the rows or maps of a file, chunks are processed in parallel so the reader must be thread safe
+        ///sums are added per chunk in chunk order, so results are the same for any number of threads, but mean and standard deviation can differ from the single array update() in the last bits
+        void update(const int64_t& numChunks, const Histogram::ChunkReader& chunkReader);
+        
         float getApproxPositivePercentile(const float& percent) const;
         
         float getApproxNegativePercentile(const float& percent) const;
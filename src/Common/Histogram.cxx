@@ -21,6 +21,7 @@
 
 #include "Histogram.h"
 #include "CaretAssert.h"
+#include "CaretOMP.h"
 #include <cmath>
 
 using namespace caret;
@@ -140,24 +141,7 @@ void Histogram::update(const float* data, const int64_t& dataCount)
     }
     if (m_bucketMin == m_bucketMax)
     {
-        int64_t totalValid = m_negCount + m_posCount + m_zeroCount;
-        for (int i = 0; i < numBuckets - 1; ++i)
-        {
-            m_cumulative[i] = (i + 1) * totalValid / numBuckets;//so, its not particularly useful if our range is zero, but split them evenly among buckets just for kicks
-            if (i == 0)
-            {
-                m_buckets[i] = m_cumulative[i];
-            } else {
-                m_buckets[i] = m_cumulative[i] - m_cumulative[i - 1];
-            }
-        }//display is already zeroed, so just return
-        m_cumulative[numBuckets - 1] = totalValid;//make sure the last one has all of them
-        if (numBuckets > 1)
-        {
-            m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1] - m_cumulative[numBuckets - 2];
-        } else {
-            m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1];
-        }
+        setBucketsSingleValue(m_negCount + m_posCount + m_zeroCount);
         return;
     }
     float bucketsize = (m_bucketMax - m_bucketMin) / numBuckets;
@@ -172,15 +156,7 @@ void Histogram::update(const float* data, const int64_t& dataCount)
         CaretAssertVectorIndex(m_buckets, bucket);
         ++m_buckets[bucket];
     }
-    computeCumulative();
-    m_displayHeightMax = 0.0;
-    for (int i = 0; i < numBuckets; ++i)
-    {//compute display values by normalizing by bucket size
-        m_display[i] = m_buckets[i] / bucketsize;
-        if (m_display[i] > m_displayHeightMax) {
-            m_displayHeightMax = m_display[i];
-        }
-    }
+    computeCumulativeAndDisplay(bucketsize);
 }
 
 void Histogram::update(const int32_t& numBuckets,
@@ -255,23 +231,7 @@ void Histogram::update(const float* data, const int64_t& dataCount, float mostPo
                     m_posCount = equalCount;
                 }
             }
-            for (int i = 0; i < numBuckets - 1; ++i)
-            {
-                m_cumulative[i] = (i + 1) * equalCount / numBuckets;//so, its not particularly useful if our range is zero, but split them evenly among buckets just for kicks
-                if (i == 0)
-                {
-                    m_buckets[i] = m_cumulative[i];
-                } else {
-                    m_buckets[i] = m_cumulative[i] - m_cumulative[i - 1];
-                }
-            }//display is already zeroed, so just return
-            m_cumulative[numBuckets - 1] = equalCount;//make sure the last one has all of them
-            if (numBuckets > 1)
-            {
-                m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1] - m_cumulative[numBuckets - 2];
-            } else {
-                m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1];
-            }
+            setBucketsSingleValue(equalCount);
         }
         return;
     }
@@ -315,6 +275,175 @@ void Histogram::update(const float* data, const int64_t& dataCount, float mostPo
         CaretAssertVectorIndex(m_buckets, bucket);
         ++m_buckets[bucket];
     }
+    computeCumulativeAndDisplay(bucketsize);
+}
+
+void Histogram::update(const int& numBuckets, const int64_t& numChunks, const ChunkReader& chunkReader)
+{
+    resize(numBuckets);
+    reset();
+    bool first = true;
+#pragma omp CARET_PAR
+    {//first pass: count value classes and find the range, each thread keeps its own counts
+        std::vector<float> chunkData;
+        int64_t posCount = 0, zeroCount = 0, negCount = 0, infCount = 0, negInfCount = 0, nanCount = 0;
+        float myMin = 0.0f, myMax = 0.0f;
+        bool myFirst = true;
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            chunkReader(chunk, chunkData);
+            const float* data = chunkData.data();
+            const int64_t dataCount = (int64_t)chunkData.size();
+            for (int64_t i = 0; i < dataCount; ++i)
+            {
+                if (data[i] != data[i])
+                {
+                    ++nanCount;
+                    continue;//skip NaNs
+                }
+                if (data[i] == 0.0f)
+                {
+                    ++zeroCount;
+                } else {
+                    if (data[i] * 2.0f == data[i])
+                    {
+                        if (data[i] < 0.0f)
+                        {
+                            ++negInfCount;
+                        } else {
+                            ++infCount;
+                        }
+                        continue;//skip infs
+                    }
+                    if (data[i] < 0.0f)
+                    {
+                        ++negCount;
+                    } else {
+                        ++posCount;
+                    }
+                }
+                if (myFirst)
+                {
+                    myFirst = false;
+                    myMin = data[i];
+                    myMax = data[i];
+                } else {
+                    if (data[i] > myMax) myMax = data[i];
+                    if (data[i] < myMin) myMin = data[i];
+                }
+            }
+        }
+#pragma omp critical
+        {
+            m_posCount += posCount;
+            m_zeroCount += zeroCount;
+            m_negCount += negCount;
+            m_infCount += infCount;
+            m_negInfCount += negInfCount;
+            m_nanCount += nanCount;
+            if (!myFirst)
+            {
+                if (first)
+                {
+                    first = false;
+                    m_bucketMin = myMin;
+                    m_bucketMax = myMax;
+                } else {
+                    if (myMax > m_bucketMax) m_bucketMax = myMax;
+                    if (myMin < m_bucketMin) m_bucketMin = myMin;
+                }
+            }
+        }
+    }
+    if (first)
+    {
+        m_bucketMin = m_bucketMax = 0.0f;
+        return;//our arrays are already zeroed, so just return if no valid data
+    }
+    if (m_bucketMin == m_bucketMax)
+    {
+        setBucketsSingleValue(m_negCount + m_posCount + m_zeroCount);
+        return;
+    }
+    const float bucketMin = m_bucketMin;
+    const float bucketsize = (m_bucketMax - m_bucketMin) / numBuckets;
+#pragma omp CARET_PAR
+    {//second pass: each thread fills its own buckets, which are then added together
+        std::vector<float> chunkData;
+        std::vector<int64_t> buckets(numBuckets, 0);
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            chunkReader(chunk, chunkData);
+            const float* data = chunkData.data();
+            const int64_t dataCount = (int64_t)chunkData.size();
+            for (int64_t i = 0; i < dataCount; ++i)
+            {
+                if (data[i] != data[i]) continue;//exclude NaN
+                if (data[i] < -1.0f && (data[i] * 2.0f == data[i])) continue;//exclude -inf
+                if (data[i] > 1.0f && (data[i] * 2.0f == data[i])) continue;//exclude inf
+                int bucket = (int)((data[i] - bucketMin) / bucketsize);
+                if (bucket < 0) bucket = 0;
+                if (bucket >= numBuckets) bucket = numBuckets - 1;
+                CaretAssertVectorIndex(buckets, bucket);
+                ++buckets[bucket];
+            }
+        }
+#pragma omp critical
+        {
+            for (int i = 0; i < numBuckets; ++i)
+            {
+                m_buckets[i] += buckets[i];
+            }
+        }
+    }
+    computeCumulativeAndDisplay(bucketsize);
+}
+
+void Histogram::update(const int32_t& numBuckets, const int64_t& numChunks, const ChunkReader& chunkReader,
+                       float mostPositiveValueInclusive, float leastPositiveValueInclusive,
+                       float leastNegativeValueInclusive, float mostNegativeValueInclusive,
+                       const bool& includeZeroValues)
+{
+    resize(numBuckets);
+    update(NULL, 0, mostPositiveValueInclusive,//the range does not depend on the data, so this sets the range (and zeros everything else)
+           leastPositiveValueInclusive, leastNegativeValueInclusive,
+           mostNegativeValueInclusive, includeZeroValues);
+#pragma omp CARET_PAR
+    {//since the range is fixed, each chunk can be done separately, and the counts added together
+        std::vector<float> chunkData;
+        Histogram chunkHistogram(numBuckets), threadHistogram(numBuckets);
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            chunkReader(chunk, chunkData);
+            if (chunkData.empty()) continue;
+            chunkHistogram.update(chunkData.data(), (int64_t)chunkData.size(), mostPositiveValueInclusive,
+                                  leastPositiveValueInclusive, leastNegativeValueInclusive,
+                                  mostNegativeValueInclusive, includeZeroValues);
+            threadHistogram.merge(chunkHistogram);
+        }
+#pragma omp critical
+        {
+            merge(threadHistogram);
+        }
+    }
+    float sanity = m_bucketMax + m_bucketMin;
+    if (m_bucketMax <= m_bucketMin || sanity != sanity)
+    {
+        if (m_bucketMax == m_bucketMin)
+        {//redo the even split with the total count, rather than adding the splits of each chunk
+            setBucketsSingleValue(m_negCount + m_posCount + m_zeroCount);
+        }
+        return;
+    }
+    computeCumulativeAndDisplay((m_bucketMax - m_bucketMin) / numBuckets);
+}
+
+void Histogram::computeCumulativeAndDisplay(const float& bucketsize)
+{
+    int numBuckets = (int)m_buckets.size();
     computeCumulative();
     m_displayHeightMax = 0.0;
     for (int i = 0; i < numBuckets; ++i)
@@ -326,6 +455,44 @@ void Histogram::update(const float* data, const int64_t& dataCount, float mostPo
     }
 }
 
+void Histogram::setBucketsSingleValue(const int64_t& valueCount)
+{
+    int numBuckets = (int)m_buckets.size();
+    for (int i = 0; i < numBuckets - 1; ++i)
+    {
+        m_cumulative[i] = (i + 1) * valueCount / numBuckets;//so, its not particularly useful if our range is zero, but split them evenly among buckets just for kicks
+        if (i == 0)
+        {
+            m_buckets[i] = m_cumulative[i];
+        } else {
+            m_buckets[i] = m_cumulative[i] - m_cumulative[i - 1];
+        }
+    }//display is left as zeros
+    m_cumulative[numBuckets - 1] = valueCount;//make sure the last one has all of them
+    if (numBuckets > 1)
+    {
+        m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1] - m_cumulative[numBuckets - 2];
+    } else {
+        m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1];
+    }
+}
+
+void Histogram::merge(const Histogram& other)
+{//only adds the counts, caller must make sure the ranges match, and compute cumulative and display afterwards
+    CaretAssert(m_buckets.size() == other.m_buckets.size());
+    int numBuckets = (int)m_buckets.size();
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_posCount += other.m_posCount;
+    m_zeroCount += other.m_zeroCount;
+    m_negCount += other.m_negCount;
+    m_infCount += other.m_infCount;
+    m_negInfCount += other.m_negInfCount;
+    m_nanCount += other.m_nanCount;
+}
+
 void Histogram::computeCumulative()
 {
     int numBuckets = (int)m_buckets.size();
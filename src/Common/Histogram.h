@@ -21,6 +21,7 @@
  */
 /*LICENSE_END*/
 
+#include <functional>
 #include <vector>
 #include "stdint.h"
 
@@ -43,6 +44,12 @@ namespace caret
         
         void computeCumulative();
         
+        void computeCumulativeAndDisplay(const float& bucketsize);
+        
+        void setBucketsSingleValue(const int64_t& valueCount);
+        
+        void merge(const Histogram& other);
+        
         void update(const float* data,
                     const int64_t& dataCount,
                     float mostPositiveValueInclusive,
@@ -54,6 +61,9 @@ namespace caret
         void update(const float* data, const int64_t& dataCount);
         
     public:
+        ///provides one piece (chunk) of data, such as a row or map of a file, may be called from several threads at once
+        typedef std::function<void(const int64_t& chunkIndex, std::vector<float>& chunkDataOut)> ChunkReader;
+        
         Histogram(const int& numBuckets = 100);
         
         Histogram(const float* data, const int64_t& dataCount);//NOTE: automatically determines number of buckets by square root of dataCount, but with set minimum and maximum
@@ -71,6 +81,18 @@ namespace caret
                     float mostNegativeValueInclusive,
                     const bool& includeZeroValues);
         
+        ///same as the above, but data is read in pieces (chunks) that are processed in parallel, so the data never needs to all be in memory at once
+        void update(const int& numBuckets, const int64_t& numChunks, const ChunkReader& chunkReader);
+        
+        void update(const int32_t& numBuckets,
+                    const int64_t& numChunks,
+                    const ChunkReader& chunkReader,
+                    float mostPositiveValueInclusive,
+                    float leastPositiveValueInclusive,
+                    float leastNegativeValueInclusive,
+                    float mostNegativeValueInclusive,
+                    const bool& includeZeroValues);
+        
         ///get raw counts (useful mathematically)
         const std::vector<int64_t>& getHistogramCounts() const { return m_buckets; }
         
@@ -112,6 +134,8 @@ namespace caret
             histMin = m_bucketMin;
             histMax = m_bucketMax;
         }
+        
+        friend class FastStatistics;
     };
 
 }
@@ -0,0 +1,274 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "NumericTextReader.h"
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretOMP.h"
+
+#include <cstdlib>
+#include <limits>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    inline bool isSpace(const char& c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+    
+    inline bool isDigit(const char& c)
+    {
+        return c >= '0' && c <= '9';
+    }
+    
+    //more than the significant digits of any value halfway between two floats, keeping this many digits plus a nonzero digit for any that are dropped gives the same rounding as all of them
+    const int MAX_FLOAT_DIGITS = 120;
+}
+
+NumericTextReader::NumericTextReader(const QString& filename, const int64_t& chunkSize)
+{
+    m_data = NULL;
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        throw CaretException("failed to open file '" + filename + "' for reading");
+    }
+    m_size = m_file.size();
+    m_chunkStarts.push_back(0);
+    if (m_size > 0)
+    {
+        m_data = (const char*)m_file.map(0, m_size);
+        if (m_data == NULL)
+        {
+            throw CaretException("failed to memory map file '" + filename + "'");
+        }
+        int64_t next = chunkSize;
+        while (next < m_size)
+        {
+            while (next < m_size && m_data[next - 1] != '\n') ++next;//a chunk starts just after a newline
+            if (next >= m_size) break;
+            m_chunkStarts.push_back(next);
+            next += chunkSize;
+        }
+        m_chunkStarts.push_back(m_size);
+    }
+}
+
+NumericTextReader::~NumericTextReader()
+{
+    if (m_data != NULL)
+    {
+        m_file.unmap((uchar*)m_data);
+    }
+}
+
+void NumericTextReader::getChunk(const int64_t& chunk, const char*& beginOut, const char*& endOut) const
+{
+    CaretAssertVectorIndex(m_chunkStarts, chunk + 1);
+    beginOut = m_data + m_chunkStarts[chunk];
+    endOut = m_data + m_chunkStarts[chunk + 1];
+}
+
+bool NumericTextReader::atEnd(const char* pos, const char* end)
+{
+    while (pos < end && isSpace(*pos)) ++pos;
+    return pos == end;
+}
+
+bool NumericTextReader::parseInt(const char*& pos, const char* end, int64_t& valueOut)
+{
+    const char* cur = pos;
+    while (cur < end && isSpace(*cur)) ++cur;
+    bool negative = false;
+    if (cur < end && (*cur == '-' || *cur == '+'))
+    {
+        negative = (*cur == '-');
+        ++cur;
+    }
+    if (cur == end || !isDigit(*cur)) return false;
+    const uint64_t limit = (uint64_t)numeric_limits<int64_t>::max() + (negative ? 1 : 0);
+    uint64_t value = 0;
+    while (cur < end && isDigit(*cur))
+    {
+        const uint64_t digit = (uint64_t)(*cur - '0');
+        if (value > (limit - digit) / 10) return false;//out of range, stream extraction also fails
+        value = value * 10 + digit;
+        ++cur;
+    }
+    if (negative)
+    {
+        valueOut = (value == limit ? numeric_limits<int64_t>::min() : -(int64_t)value);
+    } else {
+        valueOut = (int64_t)value;
+    }
+    pos = cur;
+    return true;
+}
+
+bool NumericTextReader::parseFloat(const char*& pos, const char* end, float& valueOut)
+{//the text isn't null terminated, so copy the significant digits with an adjusted exponent and no decimal point (which strtof would read with the locale's decimal point)
+    const char* cur = pos;
+    while (cur < end && isSpace(*cur)) ++cur;
+    char buffer[MAX_FLOAT_DIGITS + 32];
+    int length = 0;
+    if (cur < end && (*cur == '-' || *cur == '+'))
+    {
+        if (*cur == '-') buffer[length++] = '-';
+        ++cur;
+    }
+    int numDigits = 0;
+    int exponent = 0;
+    bool haveDigits = false, droppedNonzero = false;
+    while (cur < end && isDigit(*cur))
+    {
+        haveDigits = true;
+        if (numDigits < MAX_FLOAT_DIGITS)
+        {
+            if (numDigits != 0 || *cur != '0')//skip leading zeros
+            {
+                buffer[length++] = *cur;
+                ++numDigits;
+            }
+        } else {
+            ++exponent;
+            if (*cur != '0') droppedNonzero = true;
+        }
+        ++cur;
+    }
+    if (cur < end && *cur == '.')
+    {
+        ++cur;
+        while (cur < end && isDigit(*cur))
+        {
+            haveDigits = true;
+            if (numDigits < MAX_FLOAT_DIGITS)
+            {
+                if (numDigits != 0 || *cur != '0')
+                {
+                    buffer[length++] = *cur;
+                    ++numDigits;
+                }
+                --exponent;
+            } else {
+                if (*cur != '0') droppedNonzero = true;
+            }
+            ++cur;
+        }
+    }
+    if (!haveDigits) return false;
+    if (cur < end && (*cur == 'e' || *cur == 'E'))
+    {//only consume the exponent if it is well formed, otherwise leave it for the next token like stream extraction would
+        const char* expCur = cur + 1;
+        bool expNegative = false;
+        if (expCur < end && (*expCur == '-' || *expCur == '+'))
+        {
+            expNegative = (*expCur == '-');
+            ++expCur;
+        }
+        if (expCur < end && isDigit(*expCur))
+        {
+            int expValue = 0;
+            while (expCur < end && isDigit(*expCur))
+            {
+                if (expValue < 10000) expValue = expValue * 10 + (*expCur - '0');//far outside float range either way
+                ++expCur;
+            }
+            exponent += (expNegative ? -expValue : expValue);
+            cur = expCur;
+        }
+    }
+    if (numDigits == 0)
+    {
+        valueOut = (length != 0 ? -0.0f : 0.0f);//length is nonzero only if there is a minus sign
+        pos = cur;
+        return true;
+    }
+    if (droppedNonzero)
+    {//any nonzero digit past the kept ones only matters for breaking a tie
+        buffer[length++] = '1';
+        --exponent;
+    }
+    buffer[length++] = 'e';
+    if (exponent < 0)
+    {
+        buffer[length++] = '-';
+        exponent = -exponent;
+    }
+    char expDigits[16];
+    int numExpDigits = 0;
+    do
+    {
+        expDigits[numExpDigits++] = (char)('0' + exponent % 10);
+        exponent /= 10;
+    } while (exponent != 0);
+    while (numExpDigits > 0) buffer[length++] = expDigits[--numExpDigits];
+    buffer[length] = '\0';
+    valueOut = strtof(buffer, NULL);
+    pos = cur;
+    return true;
+}
+
+QString NumericTextReader::getLineText(const char* pos) const
+{
+    CaretAssert(pos >= m_data && pos <= m_data + m_size);
+    const char* lineStart = pos, *lineEnd = pos;
+    while (lineStart > m_data && lineStart[-1] != '\n') --lineStart;
+    while (lineEnd < m_data + m_size && *lineEnd != '\n' && *lineEnd != '\r') ++lineEnd;
+    return QString::fromUtf8(lineStart, lineEnd - lineStart);
+}
+
+bool NumericTextReader::readAllIntegers(vector<int64_t>& valuesOut, QString& badLineOut) const
+{
+    const int64_t numChunks = getNumberOfChunks();
+    vector<vector<int64_t> > chunkValues(numChunks);
+    vector<const char*> chunkStop(numChunks, (const char*)NULL);//where parsing stopped if the chunk wasn't complete
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const char* pos, *end;
+        getChunk(chunk, pos, end);
+        int64_t value;
+        while (parseInt(pos, end, value))
+        {
+            chunkValues[chunk].push_back(value);
+        }
+        if (!atEnd(pos, end))
+        {
+            while (isSpace(*pos)) ++pos;//not at end, so there is a token
+            chunkStop[chunk] = pos;
+        }
+    }
+    valuesOut.clear();
+    badLineOut = "";
+    for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        valuesOut.insert(valuesOut.end(), chunkValues[chunk].begin(), chunkValues[chunk].end());
+        if (chunkStop[chunk] != NULL)
+        {//stop at the first failure, like stream extraction
+            badLineOut = getLineText(chunkStop[chunk]);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef __NUMERIC_TEXT_READER_H__
+#define __NUMERIC_TEXT_READER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <QFile>
+#include <QString>
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret {
+    
+    ///fast reading of whitespace separated numbers from large text files, the file is memory mapped and split into chunks that start at the beginning of a line, so chunks can be parsed in parallel
+    class NumericTextReader
+    {
+        QFile m_file;
+        const char* m_data;
+        int64_t m_size;
+        std::vector<int64_t> m_chunkStarts;//last element is the file size
+        NumericTextReader(const NumericTextReader&);
+        NumericTextReader& operator=(const NumericTextReader&);
+    public:
+        ///opens and maps the file, throws if it can't
+        NumericTextReader(const QString& filename, const int64_t& chunkSize = 16 * 1024 * 1024);
+        ~NumericTextReader();
+        int64_t getNumberOfChunks() const { return (int64_t)m_chunkStarts.size() - 1; }
+        void getChunk(const int64_t& chunk, const char*& beginOut, const char*& endOut) const;
+        
+        ///skip whitespace and parse an integer, pos is moved past the number on success, like stream extraction, it fails if the next token doesn't start with a number or is out of range
+        static bool parseInt(const char*& pos, const char* end, int64_t& valueOut);
+        ///skip whitespace and parse a decimal floating point number (with optional exponent), as above, the token is scanned here and converted by strtof so rounding is correct
+        static bool parseFloat(const char*& pos, const char* end, float& valueOut);
+        ///true if only whitespace remains
+        static bool atEnd(const char* pos, const char* end);
+        
+        ///the text of the line containing pos, without the newline
+        QString getLineText(const char* pos) const;
+        
+        ///read integers from the whole file, stops at the first token that isn't an integer (like stream extraction), returns true if the entire file was read, otherwise badLineOut is the line that couldn't be read
+        bool readAllIntegers(std::vector<int64_t>& valuesOut, QString& badLineOut) const;
+    };
+    
+} //namespace caret
+
+#endif //__NUMERIC_TEXT_READER_H__
@@ -62,6 +62,15 @@ void ProgressObject::algorithmStartSentinel()
         m_disabled = true;//if it hits start twice (passed through an algorithm without interaction), disable it
     } else {
         m_sentinelPassed = true;
+        if (CaretProfiler::isEnabled())
+        {//the parent's current task is usually the best name available for a subalgorithm
+            AString spanName = "algorithm";
+            if (m_parent != NULL)
+            {
+                spanName = m_parent->m_description.isEmpty() ? AString("sub-algorithm") : m_parent->m_description;
+            }
+            m_profileSpan.begin(spanName, "algorithm");
+        }
     }
 }
 
@@ -70,6 +79,7 @@ void ProgressObject::finishLevel()
     if (m_finished) return;//don't finish twice
     m_currentProgress = m_totalWeight;
     m_finished = true;
+    m_profileSpan.end();
     if (m_parent != NULL)
     {
         m_parent->m_children[m_parentIndex].completed = true;
@@ -232,6 +242,7 @@ void LevelProgress::reportProgress(const float currentTotal)
 void LevelProgress::setTask(const AString& taskDescription)
 {//maybe this should be in a setter in m_progObjRef, here for coherence with progress reporting
     if (m_progObjRef == NULL) return;
+    m_taskSpan.begin(taskDescription, "task");//also ends the previous task
     m_progObjRef->m_description = taskDescription;
     EventProgressUpdate myUpdate(m_progObjRef);
     myUpdate.m_textUpdate = true;
@@ -241,5 +252,6 @@ void LevelProgress::setTask(const AString& taskDescription)
 LevelProgress::~LevelProgress()
 {
     if (m_progObjRef == NULL) return;
+    m_taskSpan.end();
     m_progObjRef->finishLevel();//finish level on destruction of the object, for automatic detection of algorithm finishing
 }
@@ -24,6 +24,7 @@
 #include "stdint.h"
 #include <vector>
 #include "AString.h"
+#include "CaretProfiler.h"
 
 namespace caret {
    
@@ -52,6 +53,7 @@ namespace caret {
       bool m_sentinelPassed;
       bool m_disabled;//disables itself if sentinel called twice
       bool m_finished;
+      CaretProfileSpan m_profileSpan;//from algorithm start to finish, only active when profiling
       void updateProgress();//used by LevelProgress to report changes
       void finishLevel();//moves this progress object to 100%, then updates parent if not NULL
       void setInternalWeight(const float& myInternalWeight);//used by LevelProgress when you start a level
@@ -97,6 +99,7 @@ namespace caret {
       float m_lastReported;
       float m_internalResolution;
       ProgressObject* m_progObjRef;
+      CaretProfileSpan m_taskSpan;//from one setTask to the next, only active when profiling
       LevelProgress();
    public:
       LevelProgress(ProgressObject* myProgObj, const float finishedProgress = 1.0f, const float internalWeight = 1.0f, const float internalResolution = ProgressObject::MAX_INTERNAL_RESOLUTION);
@@ -21,16 +21,103 @@
 #include "ReductionOperation.h"
 #include "CaretAssert.h"
 #include "CaretException.h"
+#include "CaretOMP.h"
 #include "MathFunctions.h"
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <limits>
 #include <vector>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    //same update everywhere, so reducing a contiguous array and reducing across arrays give identical results
+    inline void welfordUpdate(const float value, const double count, double& mean, double& residsqr)
+    {
+        double delta = value - mean;
+        mean += delta / count;
+        residsqr += delta * (value - mean);
+    }
+    
+    float finishMoments(const ReductionEnum::Enum& type, const double& mean, const double& residsqr, const int64_t& numElems)
+    {
+        switch (type)
+        {
+            case ReductionEnum::STDEV:
+                return sqrt(residsqr / numElems);
+            case ReductionEnum::SAMPSTDEV:
+                return sqrt(residsqr / (numElems - 1));
+            case ReductionEnum::VARIANCE:
+                return residsqr / numElems;
+            case ReductionEnum::TSNR:
+                return mean / sqrt(residsqr / (numElems - 1));
+            case ReductionEnum::COV:
+                return sqrt(residsqr / (numElems - 1)) / mean;
+            default:
+                CaretAssertMessage(0, "unhandled type in moment-based reduction");
+                return 0.0f;
+        }
+    }
+    
+    float medianInPlace(float* data, const int64_t& numElems)
+    {//selection instead of a full sort
+        float* middle = data + numElems / 2;
+        nth_element(data, middle, data + numElems);
+        if ((numElems & 1) == 0)//if even, average middle two
+        {
+            return (*max_element(data, middle) + *middle) / 2.0f;//everything before middle is <= it, so the largest of them is the other middle element
+        } else {
+            return *middle;//otherwise, take the center
+        }
+    }
+    
+    float modeInPlace(float* data, const int64_t& numElems)
+    {
+        sort(data, data + numElems);//sort to put same-value next to each other, a hash based map could be faster for large arrays, but oh well
+        int bestCount = 0, curCount = 1;
+        float bestval = -1.0f, curval = data[0];
+        for (int64_t i = 1; i < numElems; ++i)//search for largest contiguous region
+        {
+            if (data[i] == curval)
+            {
+                ++curCount;
+            } else {
+                if (curCount > bestCount)
+                {
+                    bestval = curval;
+                    bestCount = curCount;
+                }
+                curval = data[i];
+                curCount = 1;
+            }
+        }
+        if (curCount > bestCount)
+        {
+            bestval = curval;
+            bestCount = curCount;
+        }
+        return bestval;
+    }
+    
+    //for callers that already made a copy, so order statistics don't need another one
+    float reduceInPlace(float* data, const int64_t& numElems, const ReductionEnum::Enum& type)
+    {
+        switch (type)
+        {
+            case ReductionEnum::MEDIAN:
+                return medianInPlace(data, numElems);
+            case ReductionEnum::MODE:
+                return modeInPlace(data, numElems);
+            default:
+                return ReductionOperation::reduce(data, numElems, type);
+        }
+    }
+}
+
 float ReductionOperation::reduce(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type)
 {
     CaretAssert(numElems > 0);
@@ -38,51 +125,25 @@ float ReductionOperation::reduce(const float* data, const int64_t& numElems, con
     {
         case ReductionEnum::INVALID:
             throw CaretException("reduction requested with 'INVALID' method");
-        case ReductionEnum::SAMPSTDEV://all of these start by taking the average, for stability
+        case ReductionEnum::SAMPSTDEV:
         case ReductionEnum::TSNR:
         case ReductionEnum::COV:
             if (numElems < 2) throw CaretException("taking the sample standard deviation of 1 element would require dividing by zero");
         //fallthrough
-        case ReductionEnum::MEAN:
         case ReductionEnum::STDEV:
         case ReductionEnum::VARIANCE:
+        {
+            double mean = 0.0, residsqr = 0.0;
+            for (int64_t i = 0; i < numElems; ++i) welfordUpdate(data[i], i + 1, mean, residsqr);//single pass, but still stable
+            return finishMoments(type, mean, residsqr, numElems);
+        }
+        case ReductionEnum::MEAN:
         case ReductionEnum::SUM:
         {
             double sum = 0.0;
             for (int64_t i = 0; i < numElems; ++i) sum += data[i];
-            switch (type)
-            {
-                case ReductionEnum::SUM:
-                    return sum;
-                case ReductionEnum::MEAN:
-                    return sum / numElems;
-                default:
-                {
-                    double mean = sum / numElems;
-                    double residsqr = 0.0;
-                    for (int64_t i = 0; i < numElems; ++i)
-                    {
-                        double tempf = data[i] - mean;
-                        residsqr += tempf * tempf;
-                    }
-                    switch(type)
-                    {
-                        case ReductionEnum::STDEV:
-                            return sqrt(residsqr / numElems);
-                        case ReductionEnum::SAMPSTDEV:
-                            return sqrt(residsqr / (numElems - 1));
-                        case ReductionEnum::VARIANCE:
-                            return residsqr / numElems;
-                        case ReductionEnum::TSNR:
-                            return mean / sqrt(residsqr / (numElems - 1));
-                        case ReductionEnum::COV:
-                            return sqrt(residsqr / (numElems - 1)) / mean;
-                        default:
-                            CaretAssertMessage(0, "unhandled type in sum-based reduction");
-                            return 0.0f;
-                    }
-                }
-            }
+            if (type == ReductionEnum::SUM) return sum;
+            return sum / numElems;
         }
         case ReductionEnum::L2NORM:
         {
@@ -137,45 +198,10 @@ float ReductionOperation::reduce(const float* data, const int64_t& numElems, con
             return index + 1;
         }
         case ReductionEnum::MEDIAN:
-        {
-            vector<float> dataCopy(numElems);
-            for (int64_t i = 0; i < numElems; ++i) dataCopy[i] = data[i];
-            sort(dataCopy.begin(), dataCopy.end());
-            if ((numElems & 1) == 0)//if even, average middle two
-            {
-                return (dataCopy[numElems / 2 - 1] + dataCopy[numElems / 2]) / 2.0f;
-            } else {
-                return dataCopy[numElems / 2];//otherwise, take the center
-            }
-        }
         case ReductionEnum::MODE:
         {
-            vector<float> dataCopy(numElems);
-            for (int64_t i = 0; i < numElems; ++i) dataCopy[i] = data[i];
-            sort(dataCopy.begin(), dataCopy.end());//sort to put same-value next to each other, a hash based map could be faster for large arrays, but oh well
-            int bestCount = 0, curCount = 1;
-            float bestval = -1.0f, curval = dataCopy[0];
-            for (int64_t i = 1; i < numElems; ++i)//search for largest contiguous region
-            {
-                if (dataCopy[i] == curval)
-                {
-                    ++curCount;
-                } else {
-                    if (curCount > bestCount)
-                    {
-                        bestval = curval;
-                        bestCount = curCount;
-                    }
-                    curval = dataCopy[i];
-                    curCount = 1;
-                }
-            }
-            if (curCount > bestCount)
-            {
-                bestval = curval;
-                bestCount = curCount;
-            }
-            return bestval;
+            vector<float> dataCopy(data, data + numElems);
+            return reduceInPlace(dataCopy.data(), numElems, type);
         }
         case ReductionEnum::COUNT_NONZERO:
         {
@@ -197,27 +223,17 @@ float ReductionOperation::reduce(const float* data, const int64_t& numElems, con
 float ReductionOperation::reduceExcludeDev(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove)
 {
     CaretAssert(numElems > 0);
-    double sum = 0.0;
+    double mean = 0.0, residsqr = 0.0;
     int64_t validNum = 0;
     for (int64_t i = 0; i < numElems; ++i)
     {
         if (MathFunctions::isNumeric(data[i]))
         {
             ++validNum;
-            sum += data[i];
+            welfordUpdate(data[i], validNum, mean, residsqr);
         }
     }
     if (validNum == 0) throw CaretException("all input values to reduceExcludeDev were non-numeric");
-    double mean = sum / validNum;
-    double residsqr = 0.0;
-    for (int64_t i = 0; i < numElems; ++i)
-    {
-        if (MathFunctions::isNumeric(data[i]))
-        {
-            double tempf = data[i] - mean;
-            residsqr += tempf * tempf;
-        }
-    }
     double stdev = sqrt(residsqr / validNum);
     float low = mean - numDevBelow * stdev, high = mean + numDevAbove * stdev;
     switch (type)//special case things that use indices
@@ -265,7 +281,7 @@ float ReductionOperation::reduceExcludeDev(const float* data, const int64_t& num
     }
     if (included.size() == 0) throw CaretException("exclusion parameters to reduceExcludeDev resulted in no usable data");
     if (type == ReductionEnum::SAMPSTDEV && included.size() < 2) throw CaretException("SAMPSTDEV requested in reduceExcludeDev when only 1 element passed the exclusion parameters");
-    return reduce(included.data(), included.size(), type);
+    return reduceInPlace(included.data(), included.size(), type);
 }
 
 float ReductionOperation::reduceOnlyNumeric(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type)
@@ -318,7 +334,7 @@ float ReductionOperation::reduceOnlyNumeric(const float* data, const int64_t& nu
     }
     if (excluded.size() < 1) throw CaretException("all input values to reduceOnlyNumeric were non-numeric");
     if (type == ReductionEnum::SAMPSTDEV && excluded.size() < 2) throw CaretException("SAMPSTDEV requested in reduceOnlyNumeric when only 1 element is numeric");
-    return reduce(excluded.data(), excluded.size(), type);
+    return reduceInPlace(excluded.data(), excluded.size(), type);
 }
 
 namespace
@@ -554,6 +570,341 @@ float ReductionOperation::reduceWeightedExcludeDev(const float* data, const floa
     return reduceWeighted(excluded.data(), exweights.data(), excluded.size(), type);
 }
 
+namespace
+{
+    struct ReduceSettings
+    {
+        ReductionEnum::Enum type;
+        bool onlyNumeric, excludeDev;
+        float numDevBelow, numDevAbove;
+        ReduceSettings(const ReductionEnum::Enum& typeIn, const bool& onlyNumericIn)
+        {
+            type = typeIn;
+            onlyNumeric = onlyNumericIn;
+            excludeDev = false;
+            numDevBelow = 0.0f;
+            numDevAbove = 0.0f;
+        }
+        ReduceSettings(const ReductionEnum::Enum& typeIn, const float& numDevBelowIn, const float& numDevAboveIn)
+        {
+            type = typeIn;
+            onlyNumeric = false;
+            excludeDev = true;
+            numDevBelow = numDevBelowIn;
+            numDevAbove = numDevAboveIn;
+        }
+        float reduce(const float* data, const int64_t& numElems) const
+        {
+            if (excludeDev) return ReductionOperation::reduceExcludeDev(data, numElems, type, numDevBelow, numDevAbove);
+            if (onlyNumeric) return ReductionOperation::reduceOnlyNumeric(data, numElems, type);
+            return ReductionOperation::reduce(data, numElems, type);
+        }
+    };
+    
+    //exceptions can't leave an openmp region, so the parallel loops record the exception from the lowest index and rethrow it afterwards
+    struct ParallelError
+    {
+        int64_t index;
+        exception_ptr error;
+        ParallelError() { index = -1; }
+        void record(const int64_t& where)//call only from inside a catch block
+        {
+            exception_ptr current = current_exception();
+#pragma omp critical
+            {
+                if (index == -1 || where < index)
+                {
+                    index = where;
+                    error = current;
+                }
+            }
+        }
+        void check() const
+        {
+            if (index != -1) rethrow_exception(error);//keeps the original type, such as bad_alloc
+        }
+    };
+    
+    const int64_t ACROSS_CHUNK_SIZE = 1024;//elements per parallel work unit when reducing across arrays, small enough that the per-element state stays in cache
+    
+    bool isAccumulable(const ReductionEnum::Enum& type)
+    {
+        switch (type)
+        {
+            case ReductionEnum::SUM:
+            case ReductionEnum::MEAN:
+            case ReductionEnum::STDEV:
+            case ReductionEnum::SAMPSTDEV:
+            case ReductionEnum::VARIANCE:
+            case ReductionEnum::TSNR:
+            case ReductionEnum::COV:
+            case ReductionEnum::L2NORM:
+            case ReductionEnum::PRODUCT:
+            case ReductionEnum::MAX:
+            case ReductionEnum::MIN:
+            case ReductionEnum::INDEXMAX:
+            case ReductionEnum::INDEXMIN:
+            case ReductionEnum::COUNT_NONZERO:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    struct AccumulatorScratch
+    {
+        vector<double> first, second;
+        vector<float> best;
+        vector<int64_t> index;
+    };
+    
+    //same operations in the same order as ReductionOperation::reduce, but over a chunk of elements at once, so the inner loops are contiguous
+    void accumulateChunk(const vector<const float*>& arrays, const int64_t& start, const int64_t& chunkLength, const ReductionEnum::Enum& type,
+                         float* resultsOut, AccumulatorScratch& scratch)
+    {
+        const int64_t numArrays = (int64_t)arrays.size();
+        float* results = resultsOut + start;
+        switch (type)
+        {
+            case ReductionEnum::SUM:
+            case ReductionEnum::MEAN:
+            case ReductionEnum::L2NORM:
+            case ReductionEnum::COUNT_NONZERO:
+            {
+                scratch.first.assign(chunkLength, 0.0);
+                double* sum = scratch.first.data();
+                for (int64_t j = 0; j < numArrays; ++j)
+                {
+                    const float* data = arrays[j] + start;
+                    switch (type)
+                    {
+                        case ReductionEnum::L2NORM:
+                            for (int64_t i = 0; i < chunkLength; ++i) sum[i] += data[i] * data[i];
+                            break;
+                        case ReductionEnum::COUNT_NONZERO:
+                            for (int64_t i = 0; i < chunkLength; ++i) if (data[i] != 0.0f) sum[i] += 1.0;
+                            break;
+                        default:
+                            for (int64_t i = 0; i < chunkLength; ++i) sum[i] += data[i];
+                            break;
+                    }
+                }
+                for (int64_t i = 0; i < chunkLength; ++i)
+                {
+                    switch (type)
+                    {
+                        case ReductionEnum::MEAN:
+                            results[i] = sum[i] / numArrays;
+                            break;
+                        case ReductionEnum::L2NORM:
+                            results[i] = sqrt(sum[i]);
+                            break;
+                        default:
+                            results[i] = sum[i];
+                            break;
+                    }
+                }
+                break;
+            }
+            case ReductionEnum::PRODUCT:
+            {
+                scratch.first.assign(chunkLength, 1.0);
+                double* prod = scratch.first.data();
+                for (int64_t j = 0; j < numArrays; ++j)
+                {
+                    const float* data = arrays[j] + start;
+                    for (int64_t i = 0; i < chunkLength; ++i) prod[i] *= data[i];
+                }
+                for (int64_t i = 0; i < chunkLength; ++i) results[i] = prod[i];
+                break;
+            }
+            case ReductionEnum::STDEV:
+            case ReductionEnum::SAMPSTDEV:
+            case ReductionEnum::VARIANCE:
+            case ReductionEnum::TSNR:
+            case ReductionEnum::COV:
+            {
+                scratch.first.assign(chunkLength, 0.0);
+                scratch.second.assign(chunkLength, 0.0);
+                double* mean = scratch.first.data(), *residsqr = scratch.second.data();
+                for (int64_t j = 0; j < numArrays; ++j)
+                {
+                    const float* data = arrays[j] + start;
+                    const double count = j + 1;
+                    for (int64_t i = 0; i < chunkLength; ++i) welfordUpdate(data[i], count, mean[i], residsqr[i]);
+                }
+                for (int64_t i = 0; i < chunkLength; ++i) results[i] = finishMoments(type, mean[i], residsqr[i], numArrays);
+                break;
+            }
+            case ReductionEnum::MAX:
+            case ReductionEnum::MIN:
+            case ReductionEnum::INDEXMAX:
+            case ReductionEnum::INDEXMIN:
+            {
+                const bool useMax = (type == ReductionEnum::MAX || type == ReductionEnum::INDEXMAX);
+                scratch.best.assign(arrays[0] + start, arrays[0] + start + chunkLength);
+                scratch.index.assign(chunkLength, 0);
+                float* best = scratch.best.data();
+                int64_t* index = scratch.index.data();
+                for (int64_t j = 1; j < numArrays; ++j)
+                {
+                    const float* data = arrays[j] + start;
+                    if (useMax)
+                    {
+                        for (int64_t i = 0; i < chunkLength; ++i)
+                        {
+                            if (data[i] > best[i])
+                            {
+                                best[i] = data[i];
+                                index[i] = j;
+                            }
+                        }
+                    } else {
+                        for (int64_t i = 0; i < chunkLength; ++i)
+                        {
+                            if (data[i] < best[i])
+                            {
+                                best[i] = data[i];
+                                index[i] = j;
+                            }
+                        }
+                    }
+                }
+                for (int64_t i = 0; i < chunkLength; ++i)
+                {
+                    if (type == ReductionEnum::INDEXMAX || type == ReductionEnum::INDEXMIN)
+                    {
+                        results[i] = index[i] + 1;//1-based, to match gui and column arguments
+                    } else {
+                        results[i] = best[i];
+                    }
+                }
+                break;
+            }
+            default:
+                CaretAssertMessage(false, "unhandled type in accumulated reduction");
+                break;
+        }
+    }
+    
+    void reduceRowsImpl(const float* data, const int64_t& numRows, const int64_t& rowLength, const ReduceSettings& settings, float* resultsOut)
+    {
+        CaretAssert(rowLength > 0);
+        ParallelError myError;
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t row = 0; row < numRows; ++row)
+        {
+            try
+            {
+                resultsOut[row] = settings.reduce(data + row * rowLength, rowLength);
+            } catch (std::exception&) {
+                myError.record(row);
+            }
+        }
+        myError.check();
+    }
+    
+    void reduceAcrossImpl(const vector<const float*>& arrays, const int64_t& length, const ReduceSettings& settings, float* resultsOut)
+    {
+        const int64_t numArrays = (int64_t)arrays.size();
+        CaretAssert(numArrays > 0);
+        const int64_t numChunks = (length + ACROSS_CHUNK_SIZE - 1) / ACROSS_CHUNK_SIZE;
+        if (!settings.onlyNumeric && !settings.excludeDev && isAccumulable(settings.type))
+        {
+            switch (settings.type)
+            {
+                case ReductionEnum::SAMPSTDEV:
+                case ReductionEnum::TSNR:
+                case ReductionEnum::COV:
+                    if (numArrays < 2) throw CaretException("taking the sample standard deviation of 1 element would require dividing by zero");
+                    break;
+                default:
+                    break;
+            }
+            ParallelError myError;
+#pragma omp CARET_PAR
+            {
+                AccumulatorScratch scratch;
+#pragma omp CARET_FOR schedule(dynamic)
+                for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+                {
+                    int64_t start = chunk * ACROSS_CHUNK_SIZE;
+                    try
+                    {
+                        accumulateChunk(arrays, start, min(ACROSS_CHUNK_SIZE, length - start), settings.type, resultsOut, scratch);
+                    } catch (std::exception&) {//scratch allocation
+                        myError.record(start);
+                    }
+                }
+            }
+            myError.check();
+        } else {//order statistics and exclusions need all values of an element together, so gather them one chunk at a time
+            ParallelError myError;
+#pragma omp CARET_PAR
+            {
+                vector<float> gathered;
+#pragma omp CARET_FOR schedule(dynamic)
+                for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+                {
+                    int64_t start = chunk * ACROSS_CHUNK_SIZE, chunkLength = min(ACROSS_CHUNK_SIZE, length - start);
+                    try
+                    {
+                        gathered.resize(chunkLength * numArrays);
+                    } catch (std::exception&) {
+                        myError.record(start);
+                        continue;
+                    }
+                    for (int64_t j = 0; j < numArrays; ++j)
+                    {
+                        const float* data = arrays[j] + start;
+                        for (int64_t i = 0; i < chunkLength; ++i)
+                        {
+                            gathered[i * numArrays + j] = data[i];
+                        }
+                    }
+                    for (int64_t i = 0; i < chunkLength; ++i)
+                    {
+                        try
+                        {
+                            if (!settings.onlyNumeric && !settings.excludeDev)
+                            {
+                                resultsOut[start + i] = reduceInPlace(gathered.data() + i * numArrays, numArrays, settings.type);//gathered copy is ours to reorder
+                            } else {
+                                resultsOut[start + i] = settings.reduce(gathered.data() + i * numArrays, numArrays);
+                            }
+                        } catch (std::exception&) {//reductions throw CaretException for bad input, and the exclusion versions allocate
+                            myError.record(start + i);
+                        }
+                    }
+                }
+            }
+            myError.check();
+        }
+    }
+}
+
+void ReductionOperation::reduceRows(const float* data, const int64_t& numRows, const int64_t& rowLength, const ReductionEnum::Enum& type, float* resultsOut, const bool& onlyNumeric)
+{
+    reduceRowsImpl(data, numRows, rowLength, ReduceSettings(type, onlyNumeric), resultsOut);
+}
+
+void ReductionOperation::reduceRowsExcludeDev(const float* data, const int64_t& numRows, const int64_t& rowLength, const ReductionEnum::Enum& type,
+                                              const float& numDevBelow, const float& numDevAbove, float* resultsOut)
+{
+    reduceRowsImpl(data, numRows, rowLength, ReduceSettings(type, numDevBelow, numDevAbove), resultsOut);
+}
+
+void ReductionOperation::reduceAcross(const vector<const float*>& arrays, const int64_t& length, const ReductionEnum::Enum& type, float* resultsOut, const bool& onlyNumeric)
+{
+    reduceAcrossImpl(arrays, length, ReduceSettings(type, onlyNumeric), resultsOut);
+}
+
+void ReductionOperation::reduceAcrossExcludeDev(const vector<const float*>& arrays, const int64_t& length, const ReductionEnum::Enum& type,
+                                                const float& numDevBelow, const float& numDevAbove, float* resultsOut)
+{
+    reduceAcrossImpl(arrays, length, ReduceSettings(type, numDevBelow, numDevAbove), resultsOut);
+}
+
 bool ReductionOperation::isLengthOneReasonable(const ReductionEnum::Enum& type)
 {
     switch(type)
@@ -24,6 +24,8 @@
 #include "AString.h"
 #include "ReductionEnum.h"
 
+#include <vector>
+
 namespace caret {
     
     class ReductionOperation
@@ -37,6 +39,14 @@ namespace caret {
         static float reduceWeighted(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type);
         static float reduceWeightedExcludeDev(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove);
         static float reduceWeightedOnlyNumeric(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type);
+        ///reduce each of numRows contiguous rows in parallel, resultsOut must have numRows elements
+        static void reduceRows(const float* data, const int64_t& numRows, const int64_t& rowLength, const ReductionEnum::Enum& type, float* resultsOut, const bool& onlyNumeric = false);
+        static void reduceRowsExcludeDev(const float* data, const int64_t& numRows, const int64_t& rowLength, const ReductionEnum::Enum& type,
+                                         const float& numDevBelow, const float& numDevAbove, float* resultsOut);
+        ///reduce across equal length arrays element by element in parallel, without transposing, resultsOut[i] is the reduction of arrays[j][i] over all j
+        static void reduceAcross(const std::vector<const float*>& arrays, const int64_t& length, const ReductionEnum::Enum& type, float* resultsOut, const bool& onlyNumeric = false);
+        static void reduceAcrossExcludeDev(const std::vector<const float*>& arrays, const int64_t& length, const ReductionEnum::Enum& type,
+                                           const float& numDevBelow, const float& numDevAbove, float* resultsOut);
         static bool isLengthOneReasonable(const ReductionEnum::Enum& type);
         static AString getHelpInfo();
     };
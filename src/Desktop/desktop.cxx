@@ -65,6 +65,7 @@
 #include "SceneDialog.h"
 #include "SessionManager.h"
 #include "SystemUtilities.h"
+#include "VolumeFile.h"
 #include "WorkbenchQtMessageHandler.h"
 #include "WuQMessageBox.h"
 #include "WuQtUtilities.h"
@@ -757,6 +758,13 @@ void printHelp(const AString& progName)
     << "    -spec-load-all" << endl
     << "        load all files in the given spec file, don't show spec file dialog" << endl
     << endl
+    << "    -volume-frame-cache <megabytes>" << endl
+    << "        Read frames of large, uncompressed volume files from" << endl
+    << "        disk as they are viewed, instead of reading the entire" << endl
+    << "        file when it is opened, keeping at most this much" << endl
+    << "        frame data in memory.  Allows viewing timeseries that" << endl
+    << "        are larger than the available memory." << endl
+    << endl
     << "    -window-size  <X Y>" << endl
     << "        Set the size of the browser window" << endl
     << endl
@@ -890,6 +898,21 @@ void parseCommandLine(const AString& progName, ProgramParameters* myParams, Prog
                         cerr << "Missing Y sizes for graphics" << endl;
                         hasFatalError = true;
                     }
+                } else if (thisParam == "-volume-frame-cache") {
+                    if (myParams->hasNext()) {
+                        const int megabytes = myParams->nextInt("Volume Frame Cache Megabytes");
+                        if (megabytes > 0) {
+                            VolumeFile::setOnDemandFrameCacheBytes(int64_t(megabytes) * 1024 * 1024);
+                        }
+                        else {
+                            cerr << "Volume frame cache size must be positive for \"-volume-frame-cache\" option" << endl;
+                            hasFatalError = true;
+                        }
+                    }
+                    else {
+                        cerr << "Missing size for \"-volume-frame-cache\" option" << endl;
+                        hasFatalError = true;
+                    }
                 } else if (thisParam == "-window-size") {
                     if (myParams->hasNext()) {
                         myState.windowSizeXY[0] = myParams->nextInt("Window Size X");
@@ -319,13 +319,11 @@ CiftiConnectivityMatrixDenseDynamicFile::getConnectivityCorrelationTwo() const
 {
     if ( ! m_connectivityCorrelationFailedFlag) {
         /**
-         * Need to recreate correlation algorithm if settins have changed
+         * Update correlation algorithm if settings have changed
          */
         if (m_connectivityCorrelationTwo != NULL) {
             if (*m_correlationSettings != *m_connectivityCorrelationTwo->getSettings()) {
-                m_connectivityCorrelationTwo.reset();
-                CaretLogFine("Recreating correlation algorithm for "
-                             + getFileName());
+                m_connectivityCorrelationTwo->setSettings(*m_correlationSettings);
             }
         }
         if (m_connectivityCorrelationTwo == NULL) {
@@ -337,26 +335,26 @@ CiftiConnectivityMatrixDenseDynamicFile::getConnectivityCorrelationTwo() const
             CaretAssert(m_numberOfBrainordinates >= 2);
             const int64_t numData(m_numberOfBrainordinates
                                   * m_numberOfTimePoints);
-            m_dataSeriesMatrixData.resize(numData);
+            std::vector<float> dataSeriesMatrixData(numData);
             
-            std::vector<const float*> rowDataPointers;
             CaretAssert(m_parentDataSeriesCiftiFile);
             for (int64_t iRow = 0; iRow < m_numberOfBrainordinates; iRow++) {
                 const int64_t offset(iRow * m_numberOfTimePoints);
-                CaretAssertVectorIndex(m_dataSeriesMatrixData,
+                CaretAssertVectorIndex(dataSeriesMatrixData,
                                        (offset + (m_numberOfTimePoints - 1)));
-                m_parentDataSeriesCiftiFile->getRow(&m_dataSeriesMatrixData[offset],
+                m_parentDataSeriesCiftiFile->getRow(&dataSeriesMatrixData[offset],
                                                     iRow);
-                rowDataPointers.push_back(&m_dataSeriesMatrixData[offset]);
             }
             
-            const int64_t nextTimePointStride(1);
+            /*
+             * Data is moved into the correlation algorithm
+             */
             AString errorMessage;
             ConnectivityCorrelationTwo* cc = ConnectivityCorrelationTwo::newInstance(getFileName(),
                                                                                      *m_correlationSettings,
-                                                                                     rowDataPointers,
+                                                                                     dataSeriesMatrixData,
+                                                                                     m_numberOfBrainordinates,
                                                                                      m_numberOfTimePoints,
-                                                                                     nextTimePointStride,
                                                                                      errorMessage);
             if (cc != NULL) {
                 m_connectivityCorrelationTwo.reset(cc);
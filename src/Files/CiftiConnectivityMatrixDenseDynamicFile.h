@@ -96,8 +96,6 @@ namespace caret {
         
         mutable bool m_connectivityCorrelationFailedFlag = false;
         
-        mutable std::vector<float> m_dataSeriesMatrixData;
-
         mutable std::unique_ptr<ConnectivityCorrelationSettings> m_correlationSettings;
         
         // ADD_NEW_MEMBERS_HERE
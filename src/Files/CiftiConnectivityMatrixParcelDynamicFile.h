@@ -113,8 +113,6 @@ namespace caret {
 
         mutable std::unique_ptr<ConnectivityCorrelationSettings> m_correlationSettings;
                 
-        mutable std::vector<float> m_dataSeriesMatrixData;
-        
         bool m_testConnectivityCorrelationFlag = true;
         
         // ADD_NEW_MEMBERS_HERE
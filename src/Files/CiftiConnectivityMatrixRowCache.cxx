@@ -0,0 +1,439 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __CIFTI_CONNECTIVITY_MATRIX_ROW_CACHE_DECLARE__
+#include "CiftiConnectivityMatrixRowCache.h"
+#undef __CIFTI_CONNECTIVITY_MATRIX_ROW_CACHE_DECLARE__
+
+#include <algorithm>
+#include <deque>
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CiftiFile.h"
+
+using namespace caret;
+
+
+namespace caret {
+    /**
+     * Reads rows into the cache on a separate thread.  The thread opens its
+     * own copy of the CIFTI file so that it never shares file state (such as
+     * the current file position) with the file used by the GUI thread.
+     */
+    class CiftiConnectivityMatrixRowCache::PrefetchThread : public QThread
+    {
+    public:
+        PrefetchThread(CiftiConnectivityMatrixRowCache* rowCache,
+                       const AString& fileName)
+        : QThread(),
+        m_rowCache(rowCache),
+        m_fileName(fileName),
+        m_stopFlag(false) { }
+
+        ~PrefetchThread() {
+            {
+                QMutexLocker locker(&m_queueMutex);
+                m_stopFlag = true;
+                m_rowIndicesQueue.clear();
+            }
+            m_queueCondition.wakeAll();
+            wait();
+        }
+
+        /**
+         * Replace any rows waiting to be read with the given rows.  Rows
+         * requested previously are discarded since they were for a prior
+         * selection that the user has moved away from.
+         */
+        void setRowIndices(const std::vector<int64_t>& rowIndices) {
+            {
+                QMutexLocker locker(&m_queueMutex);
+                m_rowIndicesQueue.assign(rowIndices.begin(),
+                                         rowIndices.end());
+            }
+            m_queueCondition.wakeAll();
+        }
+
+        void run() override {
+            CiftiFile ciftiFile;
+            try {
+                ciftiFile.openFile(m_fileName);
+            }
+            catch (const CaretException& e) {
+                CaretLogInfo("Prefetching of connectivity rows disabled for "
+                             + m_fileName
+                             + ": "
+                             + e.whatString());
+                return;
+            }
+
+            const int64_t rowLength(ciftiFile.getNumberOfColumns());
+            const int64_t numberOfRows(ciftiFile.getNumberOfRows());
+
+            while (true) {
+                int64_t rowIndex(-1);
+                {
+                    QMutexLocker locker(&m_queueMutex);
+                    while (( ! m_stopFlag)
+                           && m_rowIndicesQueue.empty()) {
+                        m_queueCondition.wait(&m_queueMutex);
+                    }
+                    if (m_stopFlag) {
+                        return;
+                    }
+                    rowIndex = m_rowIndicesQueue.front();
+                    m_rowIndicesQueue.pop_front();
+                }
+
+                if ((rowIndex < 0)
+                    || (rowIndex >= numberOfRows)) {
+                    continue;
+                }
+                if (m_rowCache->isRowCached(rowIndex)) {
+                    continue;
+                }
+
+                RowData rowData(new std::vector<float>(rowLength));
+                try {
+                    ciftiFile.getRow(rowData->data(),
+                                     rowIndex);
+                }
+                catch (const CaretException& e) {
+                    CaretLogInfo("Prefetching of connectivity rows stopped for "
+                                 + m_fileName
+                                 + ": "
+                                 + e.whatString());
+                    return;
+                }
+                m_rowCache->addRow(rowIndex,
+                                   rowData);
+            }
+        }
+
+    private:
+        CiftiConnectivityMatrixRowCache* m_rowCache;
+
+        const AString m_fileName;
+
+        QMutex m_queueMutex;
+
+        QWaitCondition m_queueCondition;
+
+        std::deque<int64_t> m_rowIndicesQueue;
+
+        bool m_stopFlag;
+    };
+}
+
+/**
+ * \class caret::CiftiConnectivityMatrixRowCache
+ * \brief Least recently used cache of rows from a CIFTI connectivity matrix file
+ * \ingroup Files
+ *
+ * Interactive loading of connectivity (clicking or dragging across a surface,
+ * yoked tabs) often reads the same rows repeatedly and, when the file is on
+ * a slow or network mounted disk, each read is noticeable.  Rows are kept in
+ * memory up to a maximum size and rows that are likely to be requested next
+ * (such as those for vertices neighboring the selected vertex) may be read
+ * in advance on a background thread.
+ */
+
+/**
+ * Constructor.
+ * @param ciftiFile
+ *    The CIFTI file whose rows are cached.  Rows that are not in the cache
+ *    are read from this file on the calling thread.
+ * @param prefetchFileName
+ *    Name of file opened by the prefetch thread.  If empty, prefetching
+ *    is disabled.
+ * @param maximumBytes
+ *    Maximum size of rows kept in the cache (at least one row is kept).
+ */
+CiftiConnectivityMatrixRowCache::CiftiConnectivityMatrixRowCache(const CiftiFile* ciftiFile,
+                                                                 const AString& prefetchFileName,
+                                                                 const int64_t maximumBytes)
+: CaretObject(),
+m_ciftiFile(ciftiFile),
+m_prefetchFileName(prefetchFileName),
+m_rowLength(0),
+m_hitCount(0),
+m_missCount(0)
+{
+    CaretAssert(ciftiFile);
+    m_rowLength = ciftiFile->getNumberOfColumns();
+    setMaximumBytes(maximumBytes);
+}
+
+/**
+ * Destructor.
+ */
+CiftiConnectivityMatrixRowCache::~CiftiConnectivityMatrixRowCache()
+{
+    /*
+     * Stop the thread before the rows are destroyed
+     */
+    m_prefetchThread.reset();
+}
+
+/**
+ * @return The CIFTI file whose rows are cached.
+ */
+const CiftiFile*
+CiftiConnectivityMatrixRowCache::getCiftiFile() const
+{
+    return m_ciftiFile;
+}
+
+/**
+ * Get data for a row from the cache or, if it is not in the cache,
+ * read it from the file and add it to the cache.
+ *
+ * @param dataOut
+ *    Output with data, must contain space for a row.
+ * @param rowIndex
+ *    Index of the row.
+ * @throw DataFileException
+ *    If an error occurs reading the file.
+ */
+void
+CiftiConnectivityMatrixRowCache::getRow(float* dataOut,
+                                        const int64_t rowIndex)
+{
+    if (getCachedRow(dataOut,
+                     rowIndex)) {
+        return;
+    }
+
+    RowData rowData(new std::vector<float>(m_rowLength));
+    m_ciftiFile->getRow(rowData->data(),
+                        rowIndex);
+    std::copy(rowData->begin(),
+              rowData->end(),
+              dataOut);
+    addRow(rowIndex,
+           rowData);
+}
+
+/**
+ * Request that the given rows be read into the cache on a background
+ * thread.  Any rows from a previous request that have not yet been read
+ * are discarded.
+ *
+ * @param rowIndices
+ *    Indices of the rows, in the order they should be read.
+ */
+void
+CiftiConnectivityMatrixRowCache::prefetchRows(const std::vector<int64_t>& rowIndices)
+{
+    if (m_prefetchFileName.isEmpty()) {
+        return;
+    }
+
+    std::vector<int64_t> rowsToRead;
+    {
+        CaretMutexLocker locker(&m_rowsMutex);
+
+        /*
+         * Do not request more rows than the cache holds or rows
+         * read first would be removed by rows read later.
+         */
+        for (const auto rowIndex : rowIndices) {
+            if (static_cast<int64_t>(rowsToRead.size()) >= (m_maximumNumberOfRows - 1)) {
+                break;
+            }
+            if (m_rows.find(rowIndex) == m_rows.end()) {
+                rowsToRead.push_back(rowIndex);
+            }
+        }
+    }
+
+    if (rowsToRead.empty()) {
+        return;
+    }
+
+    if ( ! m_prefetchThread) {
+        m_prefetchThread.reset(new PrefetchThread(this,
+                                                  m_prefetchFileName));
+        m_prefetchThread->start(QThread::LowPriority);
+    }
+    m_prefetchThread->setRowIndices(rowsToRead);
+}
+
+/**
+ * @return Maximum number of rows held by the cache.
+ */
+int64_t
+CiftiConnectivityMatrixRowCache::getMaximumNumberOfRows() const
+{
+    CaretMutexLocker locker(&m_rowsMutex);
+    return m_maximumNumberOfRows;
+}
+
+/**
+ * Set the maximum size of the cache.  If the cache is larger than
+ * the new size, the least recently used rows are removed.
+ *
+ * @param maximumBytes
+ *    Maximum size of rows kept in the cache (at least one row is kept).
+ */
+void
+CiftiConnectivityMatrixRowCache::setMaximumBytes(const int64_t maximumBytes)
+{
+    CaretMutexLocker locker(&m_rowsMutex);
+
+    const int64_t rowBytes(std::max(m_rowLength, static_cast<int64_t>(1)) * static_cast<int64_t>(sizeof(float)));
+    m_maximumNumberOfRows = std::max(maximumBytes / rowBytes,
+                                     static_cast<int64_t>(1));
+    removeLeastRecentlyUsedRows();
+}
+
+/**
+ * Copy a row's data from the cache.  Must NOT be called with the
+ * rows mutex locked.
+ *
+ * @param dataOut
+ *    Output with data, must contain space for a row.
+ * @param rowIndex
+ *    Index of the row.
+ * @return
+ *    True if the row was in the cache and copied, else false.
+ */
+bool
+CiftiConnectivityMatrixRowCache::getCachedRow(float* dataOut,
+                                              const int64_t rowIndex)
+{
+    RowData rowData;
+    {
+        CaretMutexLocker locker(&m_rowsMutex);
+
+        auto iter = m_rows.find(rowIndex);
+        if (iter == m_rows.end()) {
+            ++m_missCount;
+            return false;
+        }
+        ++m_hitCount;
+
+        /*
+         * Move row to front of least recently used list
+         */
+        m_leastRecentlyUsedRows.splice(m_leastRecentlyUsedRows.begin(),
+                                       m_leastRecentlyUsedRows,
+                                       iter->second.m_lruIterator);
+        rowData = iter->second.m_data;
+    }
+
+    /*
+     * Copying is performed outside of the lock, the shared pointer
+     * keeps the data valid if the row is removed from the cache.
+     */
+    CaretAssert(rowData);
+    std::copy(rowData->begin(),
+              rowData->end(),
+              dataOut);
+    return true;
+}
+
+/**
+ * @return True if the row is in the cache.
+ * @param rowIndex
+ *    Index of the row.
+ */
+bool
+CiftiConnectivityMatrixRowCache::isRowCached(const int64_t rowIndex)
+{
+    CaretMutexLocker locker(&m_rowsMutex);
+    return (m_rows.find(rowIndex) != m_rows.end());
+}
+
+/**
+ * Add a row to the cache as the most recently used row.
+ *
+ * @param rowIndex
+ *    Index of the row.
+ * @param rowData
+ *    Data for the row.
+ */
+void
+CiftiConnectivityMatrixRowCache::addRow(const int64_t rowIndex,
+                                        RowData& rowData)
+{
+    CaretAssert(rowData);
+    CaretAssert(static_cast<int64_t>(rowData->size()) == m_rowLength);
+
+    CaretMutexLocker locker(&m_rowsMutex);
+
+    auto iter = m_rows.find(rowIndex);
+    if (iter != m_rows.end()) {
+        /*
+         * Row may have been read by both threads
+         */
+        m_leastRecentlyUsedRows.splice(m_leastRecentlyUsedRows.begin(),
+                                       m_leastRecentlyUsedRows,
+                                       iter->second.m_lruIterator);
+        return;
+    }
+
+    m_leastRecentlyUsedRows.push_front(rowIndex);
+    RowEntry entry;
+    entry.m_data = rowData;
+    entry.m_lruIterator = m_leastRecentlyUsedRows.begin();
+    m_rows.insert(std::make_pair(rowIndex,
+                                 entry));
+
+    removeLeastRecentlyUsedRows();
+}
+
+/**
+ * Remove least recently used rows until the cache is no larger
+ * than its maximum size.  Rows mutex MUST be locked by caller.
+ */
+void
+CiftiConnectivityMatrixRowCache::removeLeastRecentlyUsedRows()
+{
+    while (static_cast<int64_t>(m_rows.size()) > m_maximumNumberOfRows) {
+        CaretAssert( ! m_leastRecentlyUsedRows.empty());
+        m_rows.erase(m_leastRecentlyUsedRows.back());
+        m_leastRecentlyUsedRows.pop_back();
+    }
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+CiftiConnectivityMatrixRowCache::toString() const
+{
+    CaretMutexLocker locker(&m_rowsMutex);
+    return ("CiftiConnectivityMatrixRowCache maximum rows="
+            + AString::number(m_maximumNumberOfRows)
+            + " hits="
+            + AString::number(m_hitCount)
+            + " misses="
+            + AString::number(m_missCount));
+}
+
@@ -0,0 +1,119 @@
+#ifndef __CIFTI_CONNECTIVITY_MATRIX_ROW_CACHE_H__
+#define __CIFTI_CONNECTIVITY_MATRIX_ROW_CACHE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "CaretMutex.h"
+#include "CaretObject.h"
+
+namespace caret {
+
+    class CiftiFile;
+
+    class CiftiConnectivityMatrixRowCache : public CaretObject {
+
+    public:
+        CiftiConnectivityMatrixRowCache(const CiftiFile* ciftiFile,
+                                        const AString& prefetchFileName,
+                                        const int64_t maximumBytes);
+
+        virtual ~CiftiConnectivityMatrixRowCache();
+
+        CiftiConnectivityMatrixRowCache(const CiftiConnectivityMatrixRowCache&) = delete;
+
+        CiftiConnectivityMatrixRowCache& operator=(const CiftiConnectivityMatrixRowCache&) = delete;
+
+        const CiftiFile* getCiftiFile() const;
+
+        void getRow(float* dataOut,
+                    const int64_t rowIndex);
+
+        void prefetchRows(const std::vector<int64_t>& rowIndices);
+
+        int64_t getMaximumNumberOfRows() const;
+
+        void setMaximumBytes(const int64_t maximumBytes);
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        class PrefetchThread;
+
+        typedef std::shared_ptr<std::vector<float>> RowData;
+
+        /** An entry in the cache, the row's data and its position in the least recently used list */
+        struct RowEntry {
+            RowData m_data;
+            std::list<int64_t>::iterator m_lruIterator;
+        };
+
+        bool getCachedRow(float* dataOut,
+                          const int64_t rowIndex);
+
+        bool isRowCached(const int64_t rowIndex);
+
+        void addRow(const int64_t rowIndex,
+                    RowData& rowData);
+
+        void removeLeastRecentlyUsedRows();
+
+        const CiftiFile* m_ciftiFile;
+
+        const AString m_prefetchFileName;
+
+        int64_t m_rowLength;
+
+        int64_t m_maximumNumberOfRows;
+
+        /** Row indices with the most recently used row at the front */
+        std::list<int64_t> m_leastRecentlyUsedRows;
+
+        std::map<int64_t, RowEntry> m_rows;
+
+        /** Protects rows and the least recently used list, which are accessed by the prefetch thread */
+        mutable CaretMutex m_rowsMutex;
+
+        std::unique_ptr<PrefetchThread> m_prefetchThread;
+
+        /** Statistics, protected by the rows mutex */
+        int64_t m_hitCount;
+
+        int64_t m_missCount;
+
+        // ADD_NEW_MEMBERS_HERE
+
+        friend class PrefetchThread;
+    };
+
+#ifdef __CIFTI_CONNECTIVITY_MATRIX_ROW_CACHE_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __CIFTI_CONNECTIVITY_MATRIX_ROW_CACHE_DECLARE__
+
+} // namespace
+#endif  //__CIFTI_CONNECTIVITY_MATRIX_ROW_CACHE_H__
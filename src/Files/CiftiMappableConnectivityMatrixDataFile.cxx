@@ -24,12 +24,15 @@
 #undef __CIFTI_MAPPABLE_CONNECTIVITY_MATRIX_DATA_FILE_DECLARE__
 
 #include "CaretAssert.h"
+#include "CaretPreferences.h"
+#include "CiftiConnectivityMatrixRowCache.h"
 #include "CiftiFile.h"
 #include "CaretLogger.h"
 #include "ChartableMatrixParcelInterface.h"
 #include "ConnectivityDataLoaded.h"
 #include "DataFileException.h"
 #include "ElapsedTimer.h"
+#include "EventCaretPreferencesGet.h"
 #include "EventManager.h"
 #include "EventProgressUpdate.h"
 #include "SceneClass.h"
@@ -94,6 +97,8 @@ CiftiMappableConnectivityMatrixDataFile::clear()
 void
 CiftiMappableConnectivityMatrixDataFile::clearPrivate()
 {
+    m_rowCache.reset();
+    m_rowCacheMaximumBytes = -1;
     m_loadedRowData.clear();
     m_rowLoadedTextForMapName = "";
     m_rowLoadedText = "";
@@ -598,8 +603,17 @@ CiftiMappableConnectivityMatrixDataFile::getDataForColumn(float* dataOut, const
 void
 CiftiMappableConnectivityMatrixDataFile::getDataForRow(float* dataOut, const int64_t& index) const
 {
-    m_ciftiFile->getRow(dataOut,
-                        index);
+    CaretAssert(dataOut);
+    CaretAssert(m_ciftiFile);
+    CiftiConnectivityMatrixRowCache* rowCache = getRowCache();
+    if (rowCache != NULL) {
+        rowCache->getRow(dataOut,
+                         index);
+    }
+    else {
+        m_ciftiFile->getRow(dataOut,
+                            index);
+    }
 }
 
 /**
@@ -632,8 +646,80 @@ CiftiMappableConnectivityMatrixDataFile::getProcessedDataForColumn(float* dataOu
 void
 CiftiMappableConnectivityMatrixDataFile::getProcessedDataForRow(std::vector<float>& dataOut, const int64_t& index) const
 {
-    m_ciftiFile->getRow(&dataOut[0],
-                        index);
+    CaretAssert( ! dataOut.empty());
+    CaretAssert(m_ciftiFile);
+    CiftiConnectivityMatrixRowCache* rowCache = getRowCache();
+    if (rowCache != NULL) {
+        rowCache->getRow(&dataOut[0],
+                         index);
+    }
+    else {
+        m_ciftiFile->getRow(&dataOut[0],
+                            index);
+    }
+}
+
+/**
+ * Get the cache for rows read from the file.  The cache is only used
+ * when the file's data is read from disk as needed (a file read into
+ * memory gains nothing from a cache) and its size is limited by the
+ * connectivity row cache size in the preferences.  The preference is
+ * read when the cache is first needed, not for every row.
+ *
+ * @return Pointer to the row cache or NULL if rows are not cached.
+ */
+CiftiConnectivityMatrixRowCache*
+CiftiMappableConnectivityMatrixDataFile::getRowCache() const
+{
+    if (m_ciftiFile == NULL) {
+        m_rowCache.reset();
+        return NULL;
+    }
+    if (m_ciftiFile->isInMemory()) {
+        m_rowCache.reset();
+        return NULL;
+    }
+    
+    if (m_rowCacheMaximumBytes < 0) {
+        int64_t megabytes = CaretPreferences::getDefaultConnectivityRowCacheMegabytes();
+        EventCaretPreferencesGet prefsEvent;
+        EventManager::get()->sendEvent(prefsEvent.getPointer());
+        CaretPreferences* prefs = prefsEvent.getCaretPreferences();
+        if (prefs != NULL) {
+            megabytes = prefs->getConnectivityRowCacheMegabytes();
+        }
+        if (megabytes < 0) {
+            megabytes = 0;
+        }
+        m_rowCacheMaximumBytes = megabytes * (1024 * 1024);
+    }
+    if (m_rowCacheMaximumBytes <= 0) {
+        m_rowCache.reset();
+        return NULL;
+    }
+    
+    if (m_rowCache) {
+        if (m_rowCache->getCiftiFile() != m_ciftiFile.getPointer()) {
+            m_rowCache.reset();
+        }
+    }
+    
+    if ( ! m_rowCache) {
+        /*
+         * Prefetching opens the file a second time so it is not
+         * available for files that were opened from a URL.
+         */
+        AString prefetchFileName;
+        const AString ciftiFileName = m_ciftiFile->getFileName();
+        if ( ! DataFile::isFileOnNetwork(ciftiFileName)) {
+            prefetchFileName = ciftiFileName;
+        }
+        m_rowCache.reset(new CiftiConnectivityMatrixRowCache(m_ciftiFile.getPointer(),
+                                                             prefetchFileName,
+                                                             m_rowCacheMaximumBytes));
+    }
+    
+    return m_rowCache.get();
 }
 
 /**
@@ -897,6 +983,66 @@ CiftiMappableConnectivityMatrixDataFile::loadMapDataForSurfaceNode(const int32_t
     CaretLogFine(msg);
 }
 
+/**
+ * Read, on a background thread, the rows for the given surface nodes so that
+ * they are available immediately if the user selects one of the nodes.
+ * Typically the nodes are neighbors of the node that was just loaded.
+ * Nothing is done if the file is not read from disk as needed or if the
+ * file is loaded by column.
+ *
+ * @param surfaceNumberOfNodes
+ *    Number of nodes in surface.
+ * @param structure
+ *    Surface's structure.
+ * @param nodeIndices
+ *    Indices of the nodes, in order of priority.
+ */
+void
+CiftiMappableConnectivityMatrixDataFile::prefetchMapDataForSurfaceNodes(const int32_t surfaceNumberOfNodes,
+                                                                        const StructureEnum::Enum structure,
+                                                                        const std::vector<int32_t>& nodeIndices)
+{
+    if ( ! isEnabledAsLayer()) {
+        return;
+    }
+    if ( ! m_dataLoadingEnabled) {
+        return;
+    }
+    
+    switch (getDataFileType()) {
+        case DataFileTypeEnum::CONNECTIVITY_DENSE_DYNAMIC:
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL_DYNAMIC:
+            /*
+             * Rows are computed, not read
+             */
+            return;
+        default:
+            break;
+    }
+    
+    CiftiConnectivityMatrixRowCache* rowCache = getRowCache();
+    if (rowCache == NULL) {
+        return;
+    }
+    
+    std::vector<int64_t> rowIndices;
+    rowIndices.reserve(nodeIndices.size());
+    for (const auto nodeIndex : nodeIndices) {
+        int64_t rowIndex = -1;
+        int64_t columnIndex = -1;
+        getRowColumnIndexForNodeWhenLoading(structure,
+                                            surfaceNumberOfNodes,
+                                            nodeIndex,
+                                            rowIndex,
+                                            columnIndex);
+        if (rowIndex >= 0) {
+            rowIndices.push_back(rowIndex);
+        }
+    }
+    
+    rowCache->prefetchRows(rowIndices);
+}
+
 
 
 /**
@@ -21,6 +21,7 @@
  */
 /*LICENSE_END*/
 
+#include <memory>
 #include <set>
 
 #include "BrainConstants.h"
@@ -30,6 +31,7 @@
 
 namespace caret {
 
+    class CiftiConnectivityMatrixRowCache;
     class ConnectivityDataLoaded;
     class SceneClassAssistant;
     
@@ -59,6 +61,10 @@ namespace caret {
                                                        const StructureEnum::Enum structure,
                                                        const std::vector<int32_t>& nodeIndices);
         
+        void prefetchMapDataForSurfaceNodes(const int32_t surfaceNumberOfNodes,
+                                            const StructureEnum::Enum structure,
+                                            const std::vector<int32_t>& nodeIndices);
+        
         virtual void loadMapDataForVoxelAtCoordinate(const int32_t mapIndex,
                                                      const float xyz[3],
                                                      int64_t& rowIndexOut,
@@ -170,6 +176,8 @@ namespace caret {
         
         int32_t getCifitDirectionForLoadingRowOrColumn();
         
+        CiftiConnectivityMatrixRowCache* getRowCache() const;
+        
         // ADD_NEW_MEMBERS_HERE
         
         SceneClassAssistant* m_sceneAssistant;
@@ -184,6 +192,12 @@ namespace caret {
         
         ConnectivityDataLoaded* m_connectivityDataLoaded;
         
+        /** Cache of rows read from the file, only used when the file is read from disk as needed */
+        mutable std::unique_ptr<CiftiConnectivityMatrixRowCache> m_rowCache;
+        
+        /** Maximum size of the row cache from the preferences, negative until read when the cache is first needed */
+        mutable int64_t m_rowCacheMaximumBytes;
+        
         /*
          * This is really a member of parcel file since it the parcel
          * file is the only file that can load by row or column.
@@ -29,6 +29,7 @@
 #include "BoundingBox.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "CaretPreferences.h"
 #include "ChartDataCartesian.h"
 #include "CiftiBrainordinateLabelFile.h"
@@ -57,6 +58,7 @@
 #include "GiftiMetaData.h"
 #include "GraphicsPrimitiveV3fC4f.h"
 #include "GraphicsPrimitiveV3fT2f.h"
+#include "GraphicsTexturePyramid.h"
 #include "GraphicsTextureRectangle.h"
 #include "GraphicsUtilitiesOpenGL.h"
 #include "GroupAndNameHierarchyModel.h"
@@ -70,6 +72,29 @@
 
 using namespace caret;
 
+/*
+ * Copy RGBA color components that range 0.0 to 1.0 into
+ * matrix coloring that is either float or byte.
+ */
+static inline void
+copyMatrixCellRGBA(const float* rgbaIn,
+                   float* rgbaOut)
+{
+    rgbaOut[0] = rgbaIn[0];
+    rgbaOut[1] = rgbaIn[1];
+    rgbaOut[2] = rgbaIn[2];
+    rgbaOut[3] = rgbaIn[3];
+}
+
+static inline void
+copyMatrixCellRGBA(const float* rgbaIn,
+                   uint8_t* rgbaOut)
+{
+    rgbaOut[0] = static_cast<uint8_t>(rgbaIn[0] * 255.0);
+    rgbaOut[1] = static_cast<uint8_t>(rgbaIn[1] * 255.0);
+    rgbaOut[2] = static_cast<uint8_t>(rgbaIn[2] * 255.0);
+    rgbaOut[3] = static_cast<uint8_t>(rgbaIn[3] * 255.0);
+}
 
     
 /**
@@ -1582,6 +1607,13 @@ CiftiMappableDataFile::setMapData(const int32_t mapIndex,
     
     m_forceUpdateOfGroupAndNameHierarchy = true;
     
+    /*
+     * File statistics and histograms are cached until the data is modified
+     */
+    m_fileFastStatistics.grabNew(NULL);
+    m_fileHistogram.grabNew(NULL);
+    m_fileHistorgramLimitedValues.grabNew(NULL);
+    
     m_mapContent[mapIndex]->updateForChangeInMapData();
 }
 
@@ -1661,6 +1693,36 @@ CiftiMappableDataFile::getFileData(std::vector<float>& data) const
     }
 }
 
+/**
+ * Get the data for one row of the file.  Used when computing
+ * statistics and histograms for the file one row at a time
+ * and may be called from multiple threads.
+ *
+ * @param rowIndex
+ *    Index of the row.
+ * @param rowDataOut
+ *    Output containing data for the row.
+ */
+void
+CiftiMappableDataFile::getFileDataRow(const int64_t rowIndex,
+                                      std::vector<float>& rowDataOut) const
+{
+    CaretAssert(m_ciftiFile);
+    rowDataOut.resize(m_ciftiFile->getNumberOfColumns());
+    if (m_ciftiFile->isInMemory()) {
+        m_ciftiFile->getRow(&rowDataOut[0],
+                            rowIndex);
+    }
+    else {
+        /*
+         * Reading from disk uses a single file so only one thread may read at a time
+         */
+#pragma omp critical
+        m_ciftiFile->getRow(&rowDataOut[0],
+                            rowIndex);
+    }
+}
+
 /**
  * Get the RGBA mapped version of the file's data matrix.
  *
@@ -1751,12 +1813,12 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
                                           "Matrix dim("
                                           + AString::number(numMatrixRows)
                                           + ", "
-                                          + AString::number(numMatrixColumns));
-                        CaretLogSevere(msg);
+                                          + AString::number(numMatrixColumns)
+                                          + ").  Matrix is displayed at a reduced level of detail.");
+                        CaretLogInfo(msg);
                     }
                     
-                    /** Matrix too big to draw */
-                    return NULL;
+                    /** Matrix too big, createMatrixPrimitive() will use reduced level of detail */
                 }
             }
             else {
@@ -1826,12 +1888,25 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
         matrixPrimitive = NULL;
     }
     
-    if (matrixPrimitive == NULL) {
+    if ((matrixPrimitive == NULL)
+        && (gridMode == MatrixGridMode::FILLED_TEXTURE)) {
+        /*
+         * Texture is colored with bytes, avoiding a float RGBA copy of the matrix
+         */
+        matrixTexturePrimitive = createMatrixTexturePrimitive(matrixViewMode,
+                                                              opacity);
+        if (matrixTexturePrimitive == NULL) {
+            return NULL;
+        }
+        matrixPrimitive = matrixTexturePrimitive;
+        matrixPrimitive->setUsageTypeAll(GraphicsPrimitive::UsageType::MODIFIED_ONCE_DRAWN_MANY_TIMES);
+        matrixPrimitive->setReleaseInstanceDataMode(GraphicsPrimitive::ReleaseInstanceDataMode::ENABLED);
+    }
+    else if (matrixPrimitive == NULL) {
         int32_t numberOfRows = 0;
         int32_t numberOfColumns = 0;
         std::vector<float> matrixRGBA;
         if (getMatrixForChartingRGBA(numberOfRows, numberOfColumns, matrixRGBA)) {
-            std::vector<uint8_t> matrixTextureRGBA;
             const int32_t numberOfCells = numberOfRows * numberOfColumns;
             if (numberOfCells > 0) {
                 switch (gridMode) {
@@ -1841,8 +1916,8 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
                         matrixPrimitive = matrixTrianglePrimitive;
                         break;
                     case MatrixGridMode::FILLED_TEXTURE:
-                        /* NOTE: Primitive created after texture RGBA is filled */
-                        matrixTextureRGBA.resize(matrixRGBA.size(), 0);
+                        /* NOTE: Texture primitive is created by createMatrixTexturePrimitive() */
+                        CaretAssert(0);
                         break;
                     case MatrixGridMode::OUTLINE:
                         /* Lines are used around each cell to simplify upper/lower triangular options */
@@ -1902,65 +1977,11 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
                         rgba[3] = opacity;
                         rgbaOffset += 4;
                         
-                        bool drawCellFlag = true;
-                        if (matrixViewMode != ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL) {
-                            if (numberOfRows == numberOfColumns) {
-                                drawCellFlag = false;
-                                switch (matrixViewMode) {
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
-                                        break;
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
-                                        if (rowIndex != columnIndex) {
-                                            drawCellFlag = true;
-                                        }
-                                        break;
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
-                                        if (rowIndex > columnIndex) {
-                                            drawCellFlag = true;
-                                        }
-                                        break;
-                                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
-                                        if (rowIndex < columnIndex) {
-                                            drawCellFlag = true;
-                                        }
-                                        break;
-                                }
-                            }
-                            else {
-                                drawCellFlag = true;
-                                
-                                /*
-                                 * Diagonals for non-square matrices not allowed
-                                 */
-                                const bool allowNonSquareMatrixDiagonalsFlag = false;
-                                if (allowNonSquareMatrixDiagonalsFlag) {
-                                    drawCellFlag = false;
-                                    const float slope = static_cast<float>(numberOfRows) / static_cast<float>(numberOfColumns);
-                                    const int32_t diagonalRow = static_cast<int32_t>(slope * columnIndex);
-                                    
-                                    switch (matrixViewMode) {
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
-                                            drawCellFlag = true;
-                                            break;
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
-                                            if (rowIndex != diagonalRow) {
-                                                drawCellFlag = true;
-                                            }
-                                            break;
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
-                                            if (rowIndex > diagonalRow) {
-                                                drawCellFlag = true;
-                                            }
-                                            break;
-                                        case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
-                                            if (rowIndex < diagonalRow) {
-                                                drawCellFlag = true;
-                                            }
-                                            break;
-                                    }
-                                }
-                            }
-                        }
+                        const bool drawCellFlag = isMatrixCellDrawn(matrixViewMode,
+                                                                    rowIndex,
+                                                                    columnIndex,
+                                                                    numberOfRows,
+                                                                    numberOfColumns);
                         
                         const float cellLeft(xAxisStart + (xAxisStep * indexX));
                         const float cellRight(cellLeft + xAxisStep);
@@ -1980,15 +2001,6 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
                             }
                                 break;
                             case MatrixGridMode::FILLED_TEXTURE:
-                            {
-                                const float* cellRGBA = (drawCellFlag ? rgba : cellNotDrawRGBA);
-                                int32_t cellOffset = ((indexY * numberOfColumns * 4)
-                                                      + (indexX * 4));
-                                for (int32_t k = 0; k < 4; k++) {
-                                    CaretAssertVectorIndex(matrixTextureRGBA, cellOffset + 3);
-                                    matrixTextureRGBA[cellOffset + k] = static_cast<uint32_t>(cellRGBA[k] * 255.0);
-                                }
-                            }
                                 break;
                             case MatrixGridMode::OUTLINE:
                             {
@@ -2013,32 +2025,6 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
                     
                     indexY -= indexStepY;
                 }
-                
-                switch (gridMode) {
-                    case MatrixGridMode::FILLED_TRIANGLES:
-                        break;
-                    case MatrixGridMode::FILLED_TEXTURE:
-                    {
-                        /*
-                         * 0 to N+1 matches grid outline
-                         */
-                        const float matrixLeft(xAxisStart);
-                        const float matrixRight(matrixLeft + (xAxisStep * (numberOfColumns)));
-                        const float matrixBottom(yAxisStart);
-                        const float matrixTop(matrixBottom + (yAxisStep * (numberOfRows)));
-                        matrixTexturePrimitive = createMatrixPrimitive(matrixTextureRGBA,
-                                                                       numberOfColumns,
-                                                                       numberOfRows,
-                                                                       matrixLeft,
-                                                                       matrixRight,
-                                                                       matrixBottom,
-                                                                       matrixTop);
-                        matrixPrimitive = matrixTexturePrimitive;
-                    }
-                        break;
-                    case MatrixGridMode::OUTLINE:
-                        break;
-                }
             }
         }
 
@@ -2078,9 +2064,188 @@ CiftiMappableDataFile::getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTr
 }
 
 /**
- * Create a matrix graphics primitive
+ * @return True if a matrix cell is drawn for the given triangular viewing mode.
+ * Cells that are not drawn still receive coloring (alpha is zero) since it
+ * simplifies identification.
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param rowIndex
+ *     Index of the cell's row
+ * @param columnIndex
+ *     Index of the cell's column
+ * @param numberOfRows
+ *     Number of rows in the matrix
+ * @param numberOfColumns
+ *     Number of columns in the matrix
+ */
+bool
+CiftiMappableDataFile::isMatrixCellDrawn(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                         const int32_t rowIndex,
+                                         const int32_t columnIndex,
+                                         const int32_t numberOfRows,
+                                         const int32_t numberOfColumns)
+{
+    bool drawCellFlag = true;
+    if (matrixViewMode != ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL) {
+        if (numberOfRows == numberOfColumns) {
+            drawCellFlag = false;
+            switch (matrixViewMode) {
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
+                    break;
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
+                    if (rowIndex != columnIndex) {
+                        drawCellFlag = true;
+                    }
+                    break;
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
+                    if (rowIndex > columnIndex) {
+                        drawCellFlag = true;
+                    }
+                    break;
+                case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
+                    if (rowIndex < columnIndex) {
+                        drawCellFlag = true;
+                    }
+                    break;
+            }
+        }
+        else {
+            drawCellFlag = true;
+                                
+            /*
+             * Diagonals for non-square matrices not allowed
+             */
+            const bool allowNonSquareMatrixDiagonalsFlag = false;
+            if (allowNonSquareMatrixDiagonalsFlag) {
+                drawCellFlag = false;
+                const float slope = static_cast<float>(numberOfRows) / static_cast<float>(numberOfColumns);
+                const int32_t diagonalRow = static_cast<int32_t>(slope * columnIndex);
+                                    
+                switch (matrixViewMode) {
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL:
+                        drawCellFlag = true;
+                        break;
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_FULL_NO_DIAGONAL:
+                        if (rowIndex != diagonalRow) {
+                            drawCellFlag = true;
+                        }
+                        break;
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_LOWER_NO_DIAGONAL:
+                        if (rowIndex > diagonalRow) {
+                            drawCellFlag = true;
+                        }
+                        break;
+                    case ChartTwoMatrixTriangularViewingModeEnum::MATRIX_VIEW_UPPER_NO_DIAGONAL:
+                        if (rowIndex < diagonalRow) {
+                            drawCellFlag = true;
+                        }
+                        break;
+                }
+            }
+        }
+    }
+    
+    return drawCellFlag;
+}
+
+/**
+ * Create the texture primitive for drawing the matrix.  The matrix is colored
+ * with bytes, about one quarter of the memory of float coloring, and the
+ * texture is filled in place.
+ *
+ * @param matrixViewMode
+ *     The matrix visualization mode (upper/lower).
+ * @param opacity
+ *     Opacity of the matrix
+ * @return
+ *     The texture primitive or NULL if the matrix is not valid.
+ */
+GraphicsPrimitiveV3fT2f*
+CiftiMappableDataFile::createMatrixTexturePrimitive(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                    const float opacity) const
+{
+    int32_t numberOfRows(0);
+    int32_t numberOfColumns(0);
+    std::vector<uint8_t> matrixRGBA;
+    if ( ! getMatrixForChartingRGBA(numberOfRows, numberOfColumns, matrixRGBA)) {
+        return NULL;
+    }
+    if ((numberOfRows <= 0)
+        || (numberOfColumns <= 0)) {
+        return NULL;
+    }
+    
+    /*
+     * Texture origin is bottom left so the first row in the matrix is the
+     * last row in the texture.  Rows are swapped in place and then the
+     * opacity and triangular viewing mode are applied.  Cells that
+     * are not drawn are transparent black.
+     */
+    const uint8_t opacityByte(static_cast<uint8_t>(opacity * 255.0));
+    const int64_t rowLength(static_cast<int64_t>(numberOfColumns) * 4);
+    const int32_t halfNumberOfRows((numberOfRows + 1) / 2);
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int32_t iRow = 0; iRow < halfNumberOfRows; iRow++) {
+        const int32_t otherRow(numberOfRows - 1 - iRow);
+        uint8_t* firstRowRGBA(&matrixRGBA[iRow * rowLength]);
+        uint8_t* otherRowRGBA(&matrixRGBA[otherRow * rowLength]);
+        if (otherRow != iRow) {
+            std::swap_ranges(firstRowRGBA,
+                             firstRowRGBA + rowLength,
+                             otherRowRGBA);
+        }
+        
+        for (int32_t iCol = 0; iCol < numberOfColumns; iCol++) {
+            uint8_t* cellRGBA(&otherRowRGBA[iCol * 4]);
+            if (isMatrixCellDrawn(matrixViewMode, iRow, iCol, numberOfRows, numberOfColumns)) {
+                cellRGBA[3] = opacityByte;
+            }
+            else {
+                std::fill(cellRGBA, cellRGBA + 4, 0);
+            }
+            if (otherRow != iRow) {
+                cellRGBA = &firstRowRGBA[iCol * 4];
+                if (isMatrixCellDrawn(matrixViewMode, otherRow, iCol, numberOfRows, numberOfColumns)) {
+                    cellRGBA[3] = opacityByte;
+                }
+                else {
+                    std::fill(cellRGBA, cellRGBA + 4, 0);
+                }
+            }
+        }
+    }
+    
+    CaretUnitsTypeEnum::Enum unusedUnits;
+    float xAxisStart(0.0), xAxisStep(0.0);
+    float yAxisStart(0.0), yAxisStep(0.0);
+    getDimensionUnits(CiftiXML::ALONG_ROW, unusedUnits, xAxisStart, xAxisStep);
+    getDimensionUnits(CiftiXML::ALONG_COLUMN, unusedUnits, yAxisStart, yAxisStep);
+    
+    /*
+     * 0 to N+1 matches grid outline
+     */
+    const float matrixLeft(xAxisStart);
+    const float matrixRight(matrixLeft + (xAxisStep * (numberOfColumns)));
+    const float matrixBottom(yAxisStart);
+    const float matrixTop(matrixBottom + (yAxisStep * (numberOfRows)));
+    return createMatrixPrimitive(matrixRGBA,
+                                 numberOfColumns,
+                                 numberOfRows,
+                                 matrixLeft,
+                                 matrixRight,
+                                 matrixBottom,
+                                 matrixTop);
+}
+
+/**
+ * Create a matrix graphics primitive.  If the matrix is too large for an
+ * OpenGL texture, a reduced level of detail is used.  Levels of detail
+ * are also used as mip maps so that the matrix is filtered, rather than
+ * sampled, when it is zoomed out.
  * @param matrixRGBA
- *    The matrix RGBA color components (one per cell)
+ *    The matrix RGBA color components (one per cell).  Content is
+ *    moved into a texture pyramid and 'matrixRGBA' is empty upon exit.
  * @param numberOfColumns
  *    Number of columns in the matrix
  * @param numberOfRows
@@ -2105,9 +2270,28 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
 {
     GraphicsPrimitiveV3fT2f* primitiveOut(NULL);
 
+    GraphicsTexturePyramid texturePyramid(matrixRGBA,
+                                          numberOfColumns,
+                                          numberOfRows);
+    int32_t level(0);
+    while ((level < (texturePyramid.getNumberOfLevels() - 1))
+           && isMatrixTooLargeForOpenGL(texturePyramid.getLevelHeight(level),
+                                        texturePyramid.getLevelWidth(level))) {
+        level++;
+    }
+    const int64_t levelWidth(texturePyramid.getLevelWidth(level));
+    const int64_t levelHeight(texturePyramid.getLevelHeight(level));
+    std::shared_ptr<uint8_t> levelRGBA(texturePyramid.getLevelRGBA(level));
+    
+    /*
+     * Scale texel coordinates of the level to the matrix coordinates
+     */
+    const float xScale((xRight - xLeft) / static_cast<float>(levelWidth));
+    const float yScale((yTop - yBottom) / static_cast<float>(levelHeight));
+
     const int32_t maximumWidthHeight = GraphicsUtilitiesOpenGL::getTextureWidthHeightMaximumDimension();
-    const bool columnsTooBigFlag(numberOfColumns > maximumWidthHeight);
-    const bool rowsTooBigFlag(numberOfRows > maximumWidthHeight);
+    const bool columnsTooBigFlag(levelWidth > maximumWidthHeight);
+    const bool rowsTooBigFlag(levelHeight > maximumWidthHeight);
     
     if (columnsTooBigFlag
         && rowsTooBigFlag) {
@@ -2120,14 +2304,14 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
          * OpenGL maximum texture is square and there are too many columns to fit
          * in the square so rearrange the rectangle by moving pieces of it into the square
          */
-        const int32_t numPieces(std::ceil(static_cast<double>(numberOfColumns)
+        const int32_t numPieces(std::ceil(static_cast<double>(levelWidth)
                                           / static_cast<double>(maximumWidthHeight)));
         const int32_t textureWidth(maximumWidthHeight);
-        const int32_t textureHeight(numberOfRows * numPieces);
+        const int32_t textureHeight(levelHeight * numPieces);
         
-        const GraphicsTextureRectangle sourceRectangle(&matrixRGBA[0],
-                                                       numberOfColumns,
-                                                       numberOfRows);
+        const GraphicsTextureRectangle sourceRectangle(levelRGBA.get(),
+                                                       levelWidth,
+                                                       levelHeight);
         /*
          * Put the memory in a shared pointer, memory must remain valid,
          * Shared pointer is passed to primitive
@@ -2143,16 +2327,16 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
         
         int64_t sourceX(0);
         int64_t sourceY(0);
-        const int64_t height(numberOfRows);
+        const int64_t height(levelHeight);
         for (int32_t k = 0; k < numPieces; k++) {
             sourceX = (k * maximumWidthHeight);
-            int64_t width(numberOfColumns - sourceX);
+            int64_t width(levelWidth - sourceX);
             if (width > maximumWidthHeight) {
                 width = maximumWidthHeight;
             }
             
             const int64_t destX(0);
-            const int64_t destY(k * numberOfRows);
+            const int64_t destY(k * levelHeight);
             
             std::vector<Vector3D> xyz;
             std::vector<Vector3D> str;
@@ -2201,7 +2385,10 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
             CaretAssertVectorIndex(triangleSTR, i);
             const Vector3D& xyz = triangleXYZ[i];
             const Vector3D& str = triangleSTR[i];
-            primitiveOut->addVertex(xyz[0], xyz[1], str[0], str[1]);
+            primitiveOut->addVertex(xLeft + (xyz[0] * xScale),
+                                    yBottom + (xyz[1] * yScale),
+                                    str[0],
+                                    str[1]);
         }
     }
     else if (rowsTooBigFlag) {
@@ -2209,14 +2396,14 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
          * OpenGL maximum texture is square and there are too many rows to fit
          * in the square so rearrange the rectangle by moving pieces of it into the square
          */
-        const int32_t numPieces(std::ceil(static_cast<double>(numberOfRows)
+        const int32_t numPieces(std::ceil(static_cast<double>(levelHeight)
                                           / static_cast<double>(maximumWidthHeight)));
         const int32_t textureHeight(maximumWidthHeight);
-        const int32_t textureWidth(numberOfColumns * numPieces);
+        const int32_t textureWidth(levelWidth * numPieces);
         
-        const GraphicsTextureRectangle sourceRectangle(&matrixRGBA[0],
-                                                       numberOfColumns,
-                                                       numberOfRows);
+        const GraphicsTextureRectangle sourceRectangle(levelRGBA.get(),
+                                                       levelWidth,
+                                                       levelHeight);
         
         /*
          * Put the memory in a shared pointer, memory must remain valid,
@@ -2233,15 +2420,15 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
         
         int64_t sourceX(0);
         int64_t sourceY(0);
-        const int64_t width(numberOfColumns);
+        const int64_t width(levelWidth);
         for (int32_t k = 0; k < numPieces; k++) {
             sourceY = (k * maximumWidthHeight);
-            int64_t height(numberOfRows - sourceY);
+            int64_t height(levelHeight - sourceY);
             if (height > maximumWidthHeight) {
                 height = maximumWidthHeight;
             }
             
-            const int64_t destX(k * numberOfColumns);
+            const int64_t destX(k * levelWidth);
             const int64_t destY(0);
             
             std::vector<Vector3D> xyz;
@@ -2291,33 +2478,34 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
             CaretAssertVectorIndex(triangleSTR, i);
             const Vector3D& xyz = triangleXYZ[i];
             const Vector3D& str = triangleSTR[i];
-            primitiveOut->addVertex(xyz[0], xyz[1], str[0], str[1]);
+            primitiveOut->addVertex(xLeft + (xyz[0] * xScale),
+                                    yBottom + (xyz[1] * yScale),
+                                    str[0],
+                                    str[1]);
         }
     }
     else {
         /*
-         * Put the memory in a shared pointer, memory must remain valid,
-         * Shared pointer is passed to primitive
+         * The level's memory is in a shared pointer that is passed to
+         * the primitive so it remains valid.  Remaining levels of
+         * the pyramid are the mip maps.
          */
-        const int64_t numBytes(matrixRGBA.size());
-        uint8_t* textureRGBA = new uint8_t[numBytes];
-        std::copy(matrixRGBA.begin(), matrixRGBA.end(), textureRGBA);
-        std::shared_ptr<uint8_t> textureSharedPtrRGBA(textureRGBA);
-
         const std::array<float, 4> textureBorderColorRGBA { 0.0, 0.0, 0.0, 0.0 };
-        GraphicsTextureSettings textureSettings(textureSharedPtrRGBA,
-                                                numberOfColumns,
-                                                numberOfRows,
+        GraphicsTextureSettings textureSettings(levelRGBA,
+                                                levelWidth,
+                                                levelHeight,
                                                 1, /* slices */
                                                 GraphicsTextureSettings::DimensionType::FLOAT_STR_2D,
                                                 GraphicsTextureSettings::PixelFormatType::RGBA,
                                                 GraphicsTextureSettings::PixelOrigin::BOTTOM_LEFT,
                                                 GraphicsTextureSettings::WrappingType::CLAMP,
-                                                GraphicsTextureSettings::MipMappingType::DISABLED,
+                                                GraphicsTextureSettings::MipMappingType::ENABLED,
                                                 GraphicsTextureSettings::CompressionType::DISABLED,
                                                 GraphicsTextureMagnificationFilterEnum::NEAREST,
-                                                GraphicsTextureMinificationFilterEnum::NEAREST,
+                                                GraphicsTextureMinificationFilterEnum::LINEAR_MIPMAP_LINEAR,
                                                 textureBorderColorRGBA);
+        texturePyramid.addMipMapLevelsToTextureSettings(level,
+                                                        textureSettings);
         
         primitiveOut = GraphicsPrimitive::newPrimitiveV3fT2f(GraphicsPrimitive::PrimitiveType::OPENGL_TRIANGLE_STRIP,
                                                              textureSettings);
@@ -2340,15 +2528,16 @@ CiftiMappableDataFile::createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
  * @param numberOfColumnsOut
  *    Number of rows in the coloring matrix.
  * @param rgbaOut
- *    RGBA coloring output with number of elements
+ *    RGBA coloring output (float or byte) with number of elements
  *    (numberOfRowsOut * numberOfColumnsOut * 4).
  * @return
  *    True if data output data is valid, else false.
  */
+template <typename T>
 bool
-CiftiMappableDataFile::getMatrixForChartingRGBA(int32_t& numberOfRowsOut,
-                                             int32_t& numberOfColumnsOut,
-                                             std::vector<float>& rgbaOut) const
+CiftiMappableDataFile::helpGetMatrixForChartingRGBA(int32_t& numberOfRowsOut,
+                                                    int32_t& numberOfColumnsOut,
+                                                    std::vector<T>& rgbaOut) const
 {
     bool useMapFileHelperFlag = false;
     bool useMatrixFileHelperFlag = false;
@@ -2549,6 +2738,54 @@ CiftiMappableDataFile::getMatrixForChartingRGBA(int32_t& numberOfRowsOut,
     return validDataFlag;
 }
 
+/**
+ * Get the matrix RGBA coloring for this matrix data creator.
+ *
+ * @param numberOfRowsOut
+ *    Number of rows in the coloring matrix.
+ * @param numberOfColumnsOut
+ *    Number of rows in the coloring matrix.
+ * @param rgbaOut
+ *    RGBA coloring output (0.0 to 1.0) with number of elements
+ *    (numberOfRowsOut * numberOfColumnsOut * 4).
+ * @return
+ *    True if data output data is valid, else false.
+ */
+bool
+CiftiMappableDataFile::getMatrixForChartingRGBA(int32_t& numberOfRowsOut,
+                                                int32_t& numberOfColumnsOut,
+                                                std::vector<float>& rgbaOut) const
+{
+    return helpGetMatrixForChartingRGBA(numberOfRowsOut,
+                                        numberOfColumnsOut,
+                                        rgbaOut);
+}
+
+/**
+ * Get the matrix RGBA coloring for this matrix data creator as bytes.
+ * Uses one quarter of the memory of the float version which is
+ * important for very large matrices that are drawn as textures.
+ *
+ * @param numberOfRowsOut
+ *    Number of rows in the coloring matrix.
+ * @param numberOfColumnsOut
+ *    Number of rows in the coloring matrix.
+ * @param rgbaOut
+ *    RGBA coloring output (0 to 255) with number of elements
+ *    (numberOfRowsOut * numberOfColumnsOut * 4).
+ * @return
+ *    True if data output data is valid, else false.
+ */
+bool
+CiftiMappableDataFile::getMatrixForChartingRGBA(int32_t& numberOfRowsOut,
+                                                int32_t& numberOfColumnsOut,
+                                                std::vector<uint8_t>& rgbaOut) const
+{
+    return helpGetMatrixForChartingRGBA(numberOfRowsOut,
+                                        numberOfColumnsOut,
+                                        rgbaOut);
+}
+
 /**
  * Get the dimensions of the file (rows and columns).
  *
@@ -2737,12 +2974,18 @@ const FastStatistics*
 CiftiMappableDataFile::getFileFastStatistics()
 {
     if (m_fileFastStatistics == NULL) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        if ( ! fileData.empty()) {
+        CaretAssert(m_ciftiFile);
+        if ((m_ciftiFile->getNumberOfRows() > 0)
+            && (m_ciftiFile->getNumberOfColumns() > 0)) {
+            /*
+             * Rows are processed in parallel so that the
+             * entire file is never copied into memory
+             */
             m_fileFastStatistics.grabNew(new FastStatistics());
-            m_fileFastStatistics->update(&fileData[0],
-                                         fileData.size());
+            m_fileFastStatistics->update(m_ciftiFile->getNumberOfRows(),
+                                         [this](const int64_t& rowIndex, std::vector<float>& rowDataOut) {
+                                             getFileDataRow(rowIndex, rowDataOut);
+                                         });
         }
     }
     
@@ -2772,16 +3015,17 @@ CiftiMappableDataFile::getFileHistogram()
         updateHistogramFlag = true;
     }
     if (updateHistogramFlag) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        
-        if ( ! fileData.empty()) {
+        CaretAssert(m_ciftiFile);
+        if ((m_ciftiFile->getNumberOfRows() > 0)
+            && (m_ciftiFile->getNumberOfColumns() > 0)) {
             if (m_fileHistogram == NULL) {
                 m_fileHistogram.grabNew(new Histogram(numberOfBuckets));
             }
             m_fileHistogram->update(numberOfBuckets,
-                                    &fileData[0],
-                                    fileData.size());
+                                    m_ciftiFile->getNumberOfRows(),
+                                    [this](const int64_t& rowIndex, std::vector<float>& rowDataOut) {
+                                        getFileDataRow(rowIndex, rowDataOut);
+                                    });
             m_fileHistogramNumberOfBuckets = numberOfBuckets;
         }
     }
@@ -2831,15 +3075,17 @@ CiftiMappableDataFile::getFileHistogram(const float mostPositiveValueInclusive,
     }
     
     if (updateHistogramFlag) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        if ( ! fileData.empty()) {
+        CaretAssert(m_ciftiFile);
+        if ((m_ciftiFile->getNumberOfRows() > 0)
+            && (m_ciftiFile->getNumberOfColumns() > 0)) {
             if (m_fileHistorgramLimitedValues == NULL) {
                 m_fileHistorgramLimitedValues.grabNew(new Histogram());
             }
             m_fileHistorgramLimitedValues->update(numberOfBuckets,
-                                                  &fileData[0],
-                                                  fileData.size(),
+                                                  m_ciftiFile->getNumberOfRows(),
+                                                  [this](const int64_t& rowIndex, std::vector<float>& rowDataOut) {
+                                                      getFileDataRow(rowIndex, rowDataOut);
+                                                  },
                                                   mostPositiveValueInclusive,
                                                   leastPositiveValueInclusive,
                                                   leastNegativeValueInclusive,
@@ -7966,15 +8212,16 @@ CiftiMappableDataFile::isMatrixTooLargeForOpenGL(const int64_t numberOfRows,
  * @param rowIndicesIn
  *    Indices of rows inserted into matrix.
  * @param rgbaOut
- *    RGBA matrix (number of elements is rows * columns * 4).
+ *    RGBA matrix, float or byte (number of elements is rows * columns * 4).
  * @return
  *    True if output data is valid, else false.
  */
+template <typename T>
 bool
 CiftiMappableDataFile::helpMapFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsOut,
                                                           int32_t& numberOfColumnsOut,
                                                           const std::vector<int32_t>& rowIndicesIn,
-                                                          std::vector<float>& rgbaOut) const
+                                                          std::vector<T>& rgbaOut) const
 {
     CaretAssert(m_ciftiFile);
 
@@ -7983,7 +8230,7 @@ CiftiMappableDataFile::helpMapFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsO
      */
     numberOfRowsOut    = m_ciftiFile->getNumberOfRows();
     numberOfColumnsOut = m_ciftiFile->getNumberOfColumns();
-    const int32_t numberOfData = numberOfRowsOut * numberOfColumnsOut;
+    const int64_t numberOfData = static_cast<int64_t>(numberOfRowsOut) * numberOfColumnsOut;
     if (numberOfData <= 0) {
         return false;
     }
@@ -8048,7 +8295,7 @@ CiftiMappableDataFile::helpMapFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsO
     /*
      * Allocate rgba output
      */
-    const int32_t numberOfRgba = numberOfData * 4;
+    const int64_t numberOfRgba = numberOfData * 4;
     rgbaOut.resize(numberOfRgba);
 
     /*
@@ -8085,21 +8332,22 @@ CiftiMappableDataFile::helpMapFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsO
         }
 
         for (int32_t iRow = 0; iRow < numberOfRowsOut; iRow++) {
-            const int32_t rgbaOffset = (((iRow * numberOfColumnsOut)
+            const int64_t rgbaOffset = (((static_cast<int64_t>(iRow) * numberOfColumnsOut)
                                         + iCol) * 4);
             CaretAssertVectorIndex(rgbaOut, rgbaOffset + 3);
             const int32_t columnRgbaOffset = (iRow * 4);
             CaretAssertVectorIndex(columnRGBA, columnRgbaOffset + 3);
-            rgbaOut[rgbaOffset] = columnRGBA[columnRgbaOffset];
-            rgbaOut[rgbaOffset+1] = columnRGBA[columnRgbaOffset+1];
-            rgbaOut[rgbaOffset+2] = columnRGBA[columnRgbaOffset+2];
-            rgbaOut[rgbaOffset+3] = columnRGBA[columnRgbaOffset+3];
+            copyMatrixCellRGBA(&columnRGBA[columnRgbaOffset],
+                               &rgbaOut[rgbaOffset]);
         }
     }
         
     return true;
 }
 
+template bool CiftiMappableDataFile::helpMapFileLoadChartDataMatrixRGBA(int32_t&, int32_t&, const std::vector<int32_t>&, std::vector<float>&) const;
+template bool CiftiMappableDataFile::helpMapFileLoadChartDataMatrixRGBA(int32_t&, int32_t&, const std::vector<int32_t>&, std::vector<uint8_t>&) const;
+
 /**
  * Help load matrix chart data and order in the given row indices
  * for a connectivity matrix file where one palette is used
@@ -8112,15 +8360,16 @@ CiftiMappableDataFile::helpMapFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsO
  * @param rowIndicesIn
  *    Indices of rows inserted into matrix.
  * @param rgbaOut
- *    RGBA matrix (number of elements is rows * columns * 4).
+ *    RGBA matrix, float or byte (number of elements is rows * columns * 4).
  * @return
  *    True if output data is valid, else false.
  */
+template <typename T>
 bool
 CiftiMappableDataFile::helpMatrixFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsOut,
                                                              int32_t& numberOfColumnsOut,
                                                              const std::vector<int32_t>& rowIndicesIn,
-                                                             std::vector<float>& rgbaOut) const
+                                                             std::vector<T>& rgbaOut) const
 {
     CaretAssert(m_ciftiFile);
     
@@ -8129,7 +8378,7 @@ CiftiMappableDataFile::helpMatrixFileLoadChartDataMatrixRGBA(int32_t& numberOfRo
      */
     numberOfRowsOut    = m_ciftiFile->getNumberOfRows();
     numberOfColumnsOut = m_ciftiFile->getNumberOfColumns();
-    const int32_t numberOfData = numberOfRowsOut * numberOfColumnsOut;
+    const int64_t numberOfData = static_cast<int64_t>(numberOfRowsOut) * numberOfColumnsOut;
     if (numberOfData <= 0) {
         return false;
     }
@@ -8151,19 +8400,6 @@ CiftiMappableDataFile::helpMatrixFileLoadChartDataMatrixRGBA(int32_t& numberOfRo
         }
     }
     
-    /*
-     * Get the data.
-     */
-    std::vector<float> data(numberOfData);
-    for (int32_t iRow = 0; iRow < numberOfRowsOut; iRow++) {
-        CaretAssertVectorIndex(rowIndices, iRow);
-        const int32_t rowIndex = rowIndices[iRow];
-        const int32_t rowOffset = rowIndex * numberOfColumnsOut;
-        CaretAssertVectorIndex(data, rowOffset + numberOfColumnsOut - 1);
-        m_ciftiFile->getRow(&data[rowOffset],
-                            iRow);
-    }
-    
     /*
      * Get palette for color mapping.
      */
@@ -8181,17 +8417,33 @@ CiftiMappableDataFile::helpMatrixFileLoadChartDataMatrixRGBA(int32_t& numberOfRo
         const FastStatistics* fileFastStats = nonConstMapFile->getFileFastStatistics();
 
         /*
-         * Color the data.
+         * Read and color one row at a time so that the data and
+         * its float coloring are never held for the entire matrix.
          */
-        const int32_t numRGBA = numberOfData * 4;
+        const int64_t numRGBA = numberOfData * 4;
         rgbaOut.resize(numRGBA);
-        NodeAndVoxelColoring::colorScalarsWithPalette(fileFastStats,
-                                                      pcm,
-                                                      &data[0],
-                                                      pcm,
-                                                      &data[0],
-                                                      numberOfData,
-                                                      &rgbaOut[0]);
+        std::vector<float> rowData(numberOfColumnsOut);
+        std::vector<float> rowRGBA(numberOfColumnsOut * 4);
+        for (int32_t iRow = 0; iRow < numberOfRowsOut; iRow++) {
+            CaretAssertVectorIndex(rowIndices, iRow);
+            const int64_t rowIndex = rowIndices[iRow];
+            const int64_t rowOffset = rowIndex * numberOfColumnsOut;
+            CaretAssertVectorIndex(rgbaOut, (rowOffset + numberOfColumnsOut) * 4 - 1);
+            m_ciftiFile->getRow(&rowData[0],
+                                iRow);
+            NodeAndVoxelColoring::colorScalarsWithPalette(fileFastStats,
+                                                          pcm,
+                                                          &rowData[0],
+                                                          pcm,
+                                                          &rowData[0],
+                                                          numberOfColumnsOut,
+                                                          &rowRGBA[0]);
+            T* rowRgbaOut = &rgbaOut[rowOffset * 4];
+            for (int32_t iCol = 0; iCol < numberOfColumnsOut; iCol++) {
+                copyMatrixCellRGBA(&rowRGBA[iCol * 4],
+                                   &rowRgbaOut[iCol * 4]);
+            }
+        }
         
         return true;
     }
@@ -8202,6 +8454,9 @@ CiftiMappableDataFile::helpMatrixFileLoadChartDataMatrixRGBA(int32_t& numberOfRo
     return false;
 }
 
+template bool CiftiMappableDataFile::helpMatrixFileLoadChartDataMatrixRGBA(int32_t&, int32_t&, const std::vector<int32_t>&, std::vector<float>&) const;
+template bool CiftiMappableDataFile::helpMatrixFileLoadChartDataMatrixRGBA(int32_t&, int32_t&, const std::vector<int32_t>&, std::vector<uint8_t>&) const;
+
 /**
  * Get data from the file as requested in the given map file data selector.
  *
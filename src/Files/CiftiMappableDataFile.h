@@ -569,6 +569,10 @@ namespace caret {
                                       int32_t& numberOfColumnsOut,
                                       std::vector<float>& rgbaOut) const;
         
+        bool getMatrixForChartingRGBA(int32_t& numberOfRowsOut,
+                                      int32_t& numberOfColumnsOut,
+                                      std::vector<uint8_t>& rgbaOut) const;
+        
         GraphicsPrimitive* getMatrixChartingGraphicsPrimitive(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
                                                               const MatrixGridMode gridMode,
                                                               const float opacity) const;
@@ -602,15 +606,19 @@ namespace caret {
         void helpMapFileGetMatrixDimensions(int32_t& numberOfRowsOut,
                                             int32_t& numberOfColumnsOut) const;
         
+        /* T is float (0.0 to 1.0) or uint8_t (0 to 255) */
+        template <typename T>
         bool helpMapFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsOut,
                                                 int32_t& numberOfColumnsOut,
                                                 const std::vector<int32_t>& rowIndicesIn,
-                                                std::vector<float>& rgbaOut) const;
+                                                std::vector<T>& rgbaOut) const;
         
+        /* T is float (0.0 to 1.0) or uint8_t (0 to 255) */
+        template <typename T>
         bool helpMatrixFileLoadChartDataMatrixRGBA(int32_t& numberOfRowsOut,
                                                    int32_t& numberOfColumnsOut,
                                                    const std::vector<int32_t>& rowIndicesIn,
-                                                   std::vector<float>& rgbaOut) const;
+                                                   std::vector<T>& rgbaOut) const;
         
     private:
         class MapContent : public CaretObjectTracksModification {
@@ -743,6 +751,9 @@ namespace caret {
         
         void clearPrivate();
         
+        void getFileDataRow(const int64_t rowIndex,
+                            std::vector<float>& rowDataOut) const;
+        
     protected:
         void initializeAfterReading(const AString& filename);
         
@@ -770,6 +781,20 @@ namespace caret {
 
         const CiftiBrainModelsMap* getBrainordinateMapping() const;
         
+        template <typename T>
+        bool helpGetMatrixForChartingRGBA(int32_t& numberOfRowsOut,
+                                          int32_t& numberOfColumnsOut,
+                                          std::vector<T>& rgbaOut) const;
+        
+        static bool isMatrixCellDrawn(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                      const int32_t rowIndex,
+                                      const int32_t columnIndex,
+                                      const int32_t numberOfRows,
+                                      const int32_t numberOfColumns);
+        
+        GraphicsPrimitiveV3fT2f* createMatrixTexturePrimitive(const ChartTwoMatrixTriangularViewingModeEnum::Enum matrixViewMode,
+                                                              const float opacity) const;
+        
         GraphicsPrimitiveV3fT2f* createMatrixPrimitive(std::vector<uint8_t>& matrixRGBA,
                                                        const int64_t numberOfColumns,
                                                        const int64_t numberOfRows,
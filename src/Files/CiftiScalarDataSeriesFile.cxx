@@ -690,7 +690,7 @@ CiftiScalarDataSeriesFile::readFile(const AString& ciftiMapFileName)
                      + AString::number(numMatrixColumns)
                      + ".  OpenGL maximum dimension="
                      + AString::number(maximumWidthHeight)
-                     + ".  While this file is selectable as an overlay, it will not be displayed as a matrix.");
+                     + ".  The matrix will be displayed at a reduced level of detail.");
         addFileReadWarning(text);
     }
 }
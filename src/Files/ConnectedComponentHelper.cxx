@@ -0,0 +1,264 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "ConnectedComponentHelper.h"
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretOMP.h"
+#include "TopologyHelper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    typedef vector<atomic<int64_t> > ParentArray;
+    
+    //path halving, a stale grandparent is still an ancestor, so losing a race only costs some compression
+    int64_t findRoot(ParentArray& parents, int64_t node)
+    {
+        while (true)
+        {
+            int64_t next = parents[node].load();
+            if (next == node) return node;
+            int64_t grand = parents[next].load();
+            if (grand != next) parents[node].compare_exchange_weak(next, grand);
+            node = grand;
+        }
+    }
+    
+    //only roots are ever modified by linking, and a root always links to a lower root, so there are no cycles
+    void unite(ParentArray& parents, int64_t first, int64_t second)
+    {
+        while (true)
+        {
+            first = findRoot(parents, first);
+            second = findRoot(parents, second);
+            if (first == second) return;
+            if (first < second) swap(first, second);
+            int64_t expected = first;
+            if (parents[first].compare_exchange_strong(expected, second)) return;
+        }//lost a race on the higher root, it has been linked elsewhere, so find the roots again
+    }
+    
+    void initParents(ParentArray& parents)
+    {
+        const int64_t size = (int64_t)parents.size();
+#pragma omp CARET_PARFOR schedule(static)
+        for (int64_t i = 0; i < size; ++i)
+        {
+            parents[i].store(i);
+        }
+    }
+    
+    int64_t finishLabels(ParentArray& parents, const char* marked, vector<int64_t>& labelsOut)
+    {
+        const int64_t size = (int64_t)parents.size();
+        labelsOut.resize(size);
+#pragma omp CARET_PARFOR schedule(static)
+        for (int64_t i = 0; i < size; ++i)
+        {
+            labelsOut[i] = (marked[i] ? findRoot(parents, i) : -1);
+        }
+        int64_t ret = 0;
+        for (int64_t i = 0; i < size; ++i)
+        {
+            if (labelsOut[i] == i)
+            {
+                parents[i].store(ret);//unions are done, reuse the root entries to hold component numbers
+                ++ret;
+            }
+        }
+#pragma omp CARET_PARFOR schedule(static)
+        for (int64_t i = 0; i < size; ++i)
+        {
+            if (labelsOut[i] != -1)
+            {
+                labelsOut[i] = parents[labelsOut[i]].load();
+            }
+        }
+        return ret;
+    }
+}
+
+int64_t ConnectedComponentHelper::labelSurface(const TopologyHelper* topoHelp, const char* marked, vector<int64_t>& labelsOut)
+{
+    const int64_t numNodes = topoHelp->getNumberOfNodes();
+    ParentArray parents(numNodes);
+    initParents(parents);
+#pragma omp CARET_PARFOR schedule(dynamic, 1024)
+    for (int64_t i = 0; i < numNodes; ++i)
+    {
+        if (!marked[i]) continue;
+        int32_t numNeigh = 0;
+        const int32_t* neighbors = topoHelp->getNodeNeighbors(i, numNeigh);
+        for (int32_t n = 0; n < numNeigh; ++n)
+        {
+            if (neighbors[n] > i && marked[neighbors[n]])//each edge only needs one union
+            {
+                unite(parents, i, neighbors[n]);
+            }
+        }
+    }
+    return finishLabels(parents, marked, labelsOut);
+}
+
+int64_t ConnectedComponentHelper::labelVolume(const int64_t dims[3], const int& connectivity, const char* marked, vector<int64_t>& labelsOut)
+{
+    int maxNonzero = 0;
+    switch (connectivity)
+    {
+        case 6:
+            maxNonzero = 1;
+            break;
+        case 18:
+            maxNonzero = 2;
+            break;
+        case 26:
+            maxNonzero = 3;
+            break;
+        default:
+            throw CaretException("invalid voxel connectivity: " + AString::number(connectivity));
+    }
+    vector<int64_t> stencil;//only the half of the neighborhood with higher index, so each adjacency is only united once
+    for (int k = -1; k <= 1; ++k)
+    {
+        for (int j = -1; j <= 1; ++j)
+        {
+            for (int i = -1; i <= 1; ++i)
+            {
+                if (abs(i) + abs(j) + abs(k) > maxNonzero) continue;
+                if (k > 0 || (k == 0 && (j > 0 || (j == 0 && i > 0))))
+                {
+                    stencil.push_back(i);
+                    stencil.push_back(j);
+                    stencil.push_back(k);
+                }
+            }
+        }
+    }
+    const int stencilSize = (int)stencil.size() / 3;
+    const int64_t frameSize = dims[0] * dims[1] * dims[2], numRows = dims[1] * dims[2];
+    ParentArray parents(frameSize);
+    initParents(parents);
+#pragma omp CARET_PARFOR schedule(dynamic, 16)
+    for (int64_t row = 0; row < numRows; ++row)
+    {
+        const int64_t j = row % dims[1], k = row / dims[1];
+        for (int64_t i = 0; i < dims[0]; ++i)
+        {
+            const int64_t index = i + dims[0] * row;
+            if (!marked[index]) continue;
+            for (int s = 0; s < stencilSize; ++s)
+            {
+                const int64_t ni = i + stencil[s * 3], nj = j + stencil[s * 3 + 1], nk = k + stencil[s * 3 + 2];
+                if (ni < 0 || ni >= dims[0] || nj < 0 || nj >= dims[1] || nk >= dims[2]) continue;//nk can't be negative
+                const int64_t neighIndex = ni + dims[0] * (nj + dims[1] * nk);
+                if (marked[neighIndex])
+                {
+                    unite(parents, index, neighIndex);
+                }
+            }
+        }
+    }
+    return finishLabels(parents, marked, labelsOut);
+}
+
+void ConnectedComponentHelper::getMembers(const vector<int64_t>& labels, const int64_t& numComponents, vector<vector<int64_t> >& membersOut)
+{
+    membersOut.clear();
+    membersOut.resize(numComponents);
+    vector<int64_t> counts(numComponents, 0);
+    const int64_t size = (int64_t)labels.size();
+    for (int64_t i = 0; i < size; ++i)
+    {
+        if (labels[i] != -1) ++counts[labels[i]];
+    }
+    for (int64_t c = 0; c < numComponents; ++c)
+    {
+        membersOut[c].reserve(counts[c]);
+    }
+    for (int64_t i = 0; i < size; ++i)
+    {
+        if (labels[i] != -1)
+        {
+            CaretAssert(labels[i] < numComponents);
+            membersOut[labels[i]].push_back(i);
+        }
+    }
+}
+
+void ConnectedComponentHelper::orderSurfaceMembersByFill(const TopologyHelper* topoHelp, const vector<int64_t>& labels, vector<vector<int64_t> >& members)
+{
+    const int64_t numComponents = (int64_t)members.size();
+    vector<char> visited(labels.size(), 0);//components don't share vertices, so threads never write the same element
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int64_t c = 0; c < numComponents; ++c)
+    {
+        vector<int64_t>& myMembers = members[c];
+        if (myMembers.size() < 2) continue;
+        vector<int64_t> fillOrder;
+        fillOrder.reserve(myMembers.size());
+        fillOrder.push_back(myMembers[0]);//lowest member, where a serial search would have started
+        visited[myMembers[0]] = 1;
+        for (size_t index = 0; index < fillOrder.size(); ++index)//NOTE: vector grows inside loop
+        {
+            const vector<int32_t>& neighbors = topoHelp->getNodeNeighbors(fillOrder[index]);
+            for (size_t n = 0; n < neighbors.size(); ++n)
+            {
+                const int32_t neighbor = neighbors[n];
+                if (labels[neighbor] == c && !visited[neighbor])
+                {
+                    visited[neighbor] = 1;
+                    fillOrder.push_back(neighbor);
+                }
+            }
+        }
+        CaretAssert(fillOrder.size() == myMembers.size());
+        myMembers.swap(fillOrder);
+    }
+}
+
+void ConnectedComponentHelper::sumPerComponent(const vector<vector<int64_t> >& members, const float* weights, vector<double>& sumsOut)
+{
+    const int64_t numComponents = (int64_t)members.size();
+    sumsOut.resize(numComponents);
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int64_t c = 0; c < numComponents; ++c)
+    {
+        if (weights == NULL)
+        {
+            sumsOut[c] = members[c].size();
+        } else {
+            double accum = 0.0;//summed in member order, so thresholds on the sums don't depend on thread count
+            const vector<int64_t>& myMembers = members[c];
+            for (size_t m = 0; m < myMembers.size(); ++m)
+            {
+                accum += weights[myMembers[m]];
+            }
+            sumsOut[c] = accum;
+        }
+    }
+}
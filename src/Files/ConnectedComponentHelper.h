@@ -0,0 +1,54 @@
+#ifndef __CONNECTED_COMPONENT_HELPER_H__
+#define __CONNECTED_COMPONENT_HELPER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret {
+    
+    class TopologyHelper;
+    
+    ///connected components of a marked subset of surface vertices or voxels, using a lock-free union-find that runs in parallel over elements
+    ///roots always link toward the lower index, so components are numbered in order of their lowest element regardless of thread count
+    class ConnectedComponentHelper
+    {
+    public:
+        ///labelsOut gets -1 for unmarked vertices, and the component number for marked ones, returns the number of components
+        static int64_t labelSurface(const TopologyHelper* topoHelp, const char* marked, std::vector<int64_t>& labelsOut);
+        
+        ///connectivity is 6 (faces), 18 (faces and edges), or 26 (faces, edges and corners), marked is a frame in the usual i-fastest order
+        static int64_t labelVolume(const int64_t dims[3], const int& connectivity, const char* marked, std::vector<int64_t>& labelsOut);
+        
+        ///members of each component in increasing index order
+        static void getMembers(const std::vector<int64_t>& labels, const int64_t& numComponents, std::vector<std::vector<int64_t> >& membersOut);
+        
+        ///reorder the members of each surface component into the order a breadth-first flood fill from its lowest vertex visits them
+        static void orderSurfaceMembersByFill(const TopologyHelper* topoHelp, const std::vector<int64_t>& labels, std::vector<std::vector<int64_t> >& members);
+        
+        ///sum of weights over the members of each component, in member order (parallel over components), weights NULL counts members
+        static void sumPerComponent(const std::vector<std::vector<int64_t> >& members, const float* weights, std::vector<double>& sumsOut);
+    };
+    
+}
+
+#endif //__CONNECTED_COMPONENT_HELPER_H__
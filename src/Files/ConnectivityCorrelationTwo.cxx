@@ -38,6 +38,14 @@ using namespace caret;
  * \class caret::ConnectivityCorrelationTwo 
  * \brief Correlation and covariance
  * \ingroup Files
+ *
+ * The mean and sum squared of each data set are computed once when an
+ * instance is created.  Correlation and covariance are then computed
+ * from the dot product of two data sets.  When an instance owns the data
+ * (the data is contiguous), the mean is subtracted from each data set
+ * so that the dot product is the sum of the mean-removed products, which
+ * avoids loss of precision from subtracting large, nearly equal values.
+ * Changing the settings does not require recreating an instance.
  */
 
 /**
@@ -86,6 +94,59 @@ ConnectivityCorrelationTwo::newInstance(const AString& ownerName,
                                           dataStride);
 }
 
+/**
+ * Create a new instance for correlation and covariance that owns its data.
+ * Since the data is owned, the mean is removed from each data set in place
+ * which allows faster and more accurate computations.
+ * @param ownerName
+ *    Name of file that owns this instance
+ * @param settings
+ *    The settings for the various operations
+ * @param dataSetsData
+ *    Contains the data sets, one after the other with the elements of each
+ *    data set contiguous.  Typically each data set is the 'timepoints' for
+ *    one 'brainordinate'.  To avoid a copy of possibly very large data, the
+ *    content is MOVED into the new instance and 'dataSetsData' is empty upon
+ *    exit (unless there is an error).
+ * @param numberOfDataSets
+ *    Number of data sets
+ * @param numberOfDataElements
+ *    The number of elements in each data set
+ * @param errorMessageOut
+ *    Contains information describing the error
+ * @return Pointer to new instance or NULL if there is an error.
+ */
+ConnectivityCorrelationTwo*
+ConnectivityCorrelationTwo::newInstance(const AString& ownerName,
+                                        const ConnectivityCorrelationSettings& settings,
+                                        std::vector<float>& dataSetsData,
+                                        const int64_t numberOfDataSets,
+                                        const int64_t numberOfDataElements,
+                                        AString& errorMessageOut)
+{
+    errorMessageOut.clear();
+    
+    if (numberOfDataSets < 2) {
+        errorMessageOut.appendWithNewLine("There must be at least two sets of data");
+    }
+    if (numberOfDataElements < 2) {
+        errorMessageOut.appendWithNewLine("There must be at least two data elements");
+    }
+    if (static_cast<int64_t>(dataSetsData.size()) != (numberOfDataSets * numberOfDataElements)) {
+        errorMessageOut.appendWithNewLine("Size of data does not match number of data sets and elements");
+    }
+    
+    if ( ! errorMessageOut.isEmpty()) {
+        return NULL;
+    }
+    
+    return new ConnectivityCorrelationTwo(ownerName,
+                                          settings,
+                                          dataSetsData,
+                                          numberOfDataSets,
+                                          numberOfDataElements);
+}
+
 
 /**
  * Constructor.
@@ -111,7 +172,8 @@ m_ownerName(ownerName),
 m_settings(settings),
 m_numberOfDataSets(dataSetPointers.size()),
 m_numberOfDataElements(numberOfDataElements),
-m_dataStride(dataStride)
+m_dataStride(dataStride),
+m_dataDemeanedFlag(false)
 {
     m_dataSets.resize(m_numberOfDataSets,
                       NULL);
@@ -123,19 +185,22 @@ m_dataStride(dataStride)
         
         float mean(0.0);
         float sqrtSumSquared(0.0);
+        float sqrtSumSquaredNoDemean(0.0);
         
         computeMeanAndSumSquared(dataPtr,
                                  numberOfDataElements,
                                  dataStride,
                                  mean,
-                                 sqrtSumSquared);
+                                 sqrtSumSquared,
+                                 sqrtSumSquaredNoDemean);
         
         m_dataSets[dataSetIndex] = new DataSet(dataSetIndex,
                                                dataPtr,
                                                m_numberOfDataElements,
                                                m_dataStride,
                                                mean,
-                                               sqrtSumSquared);
+                                               sqrtSumSquared,
+                                               sqrtSumSquaredNoDemean);
     }
 
     if (m_debugFlag) {
@@ -143,6 +208,67 @@ m_dataStride(dataStride)
     }
 }
 
+/**
+ * Constructor for an instance that owns its data.
+ * @param ownerName
+ *    Name of file that owns this instance
+ * @param settings
+ *    The settings for the various operations
+ * @param dataSetsData
+ *    Contains the data sets, one after the other.  Content is MOVED
+ *    into this instance.
+ * @param numberOfDataSets
+ *    Number of data sets
+ * @param numberOfDataElements
+ *    The number of elements in each data set
+ */
+ConnectivityCorrelationTwo::ConnectivityCorrelationTwo(const AString& ownerName,
+                                                       const ConnectivityCorrelationSettings& settings,
+                                                       std::vector<float>& dataSetsData,
+                                                       const int64_t numberOfDataSets,
+                                                       const int64_t numberOfDataElements)
+: CaretObject(),
+m_ownerName(ownerName),
+m_settings(settings),
+m_numberOfDataSets(numberOfDataSets),
+m_numberOfDataElements(numberOfDataElements),
+m_dataStride(1),
+m_dataDemeanedFlag(true)
+{
+    m_dataSetsData.swap(dataSetsData);
+    m_dataSets.resize(m_numberOfDataSets,
+                      NULL);
+    
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t dataSetIndex = 0; dataSetIndex < m_numberOfDataSets; dataSetIndex++) {
+        const int64_t offset(dataSetIndex * m_numberOfDataElements);
+        CaretAssertVectorIndex(m_dataSetsData, offset + m_numberOfDataElements - 1);
+        float* dataPtr(&m_dataSetsData[offset]);
+        
+        float mean(0.0);
+        float sqrtSumSquared(0.0);
+        float sqrtSumSquaredNoDemean(0.0);
+        
+        demeanAndComputeSumSquared(dataPtr,
+                                   m_numberOfDataElements,
+                                   mean,
+                                   sqrtSumSquared,
+                                   sqrtSumSquaredNoDemean);
+        
+        m_dataSets[dataSetIndex] = new DataSet(dataSetIndex,
+                                               dataPtr,
+                                               m_numberOfDataElements,
+                                               m_dataStride,
+                                               mean,
+                                               sqrtSumSquared,
+                                               sqrtSumSquaredNoDemean);
+    }
+    
+    if (m_debugFlag) {
+        printDebugData();
+    }
+}
+
 /**
  * Compute the mean and the square root of sum squared for the given data
  * @param dataPtr
@@ -155,14 +281,17 @@ m_dataStride(dataStride)
  * @param meanOut
  *    Output with mean
  * @param sqrtSumSquaredOut
- *    Output with square root of sum squared
+ *    Output with square root of sum squared with mean removed
+ * @param sqrtSumSquaredNoDemeanOut
+ *    Output with square root of sum squared without removing mean
  */
 void
 ConnectivityCorrelationTwo::computeMeanAndSumSquared(const float* dataPtr,
                                                      const int64_t numberOfDataElements,
                                                      const int64_t dataStride,
                                                      float& meanOut,
-                                                     float& sqrtSumSquaredOut) const
+                                                     float& sqrtSumSquaredOut,
+                                                     float& sqrtSumSquaredNoDemeanOut) const
 {
     /*
      * NOTE: Do not use OpenMP here.  OpenMP is used
@@ -177,11 +306,52 @@ ConnectivityCorrelationTwo::computeMeanAndSumSquared(const float* dataPtr,
         sumSQ += (d * d);
     }
     
-    meanOut = (sum / static_cast<float>(numberOfDataElements));
-    const float sumSquared(m_settings.isCorrelationNoDemeanEnabled()
-                           ? sumSQ
-                           : (sumSQ - (m_numberOfDataElements * meanOut * meanOut)));
-    sqrtSumSquaredOut = (std::sqrt(sumSquared));
+    const double mean(sum / static_cast<double>(numberOfDataElements));
+    meanOut = mean;
+    sqrtSumSquaredOut = std::sqrt(std::max(sumSQ - (numberOfDataElements * mean * mean),
+                                           0.0));
+    sqrtSumSquaredNoDemeanOut = std::sqrt(sumSQ);
+}
+
+/**
+ * Remove the mean from the given data and compute the square root of sum squared
+ * @param dataPtr
+ *    Pointer to contiguous data that has its mean removed
+ * @param numberOfDataElements
+ *    Number of elements in data
+ * @param meanOut
+ *    Output with mean
+ * @param sqrtSumSquaredOut
+ *    Output with square root of sum squared with mean removed
+ * @param sqrtSumSquaredNoDemeanOut
+ *    Output with square root of sum squared without removing mean
+ */
+void
+ConnectivityCorrelationTwo::demeanAndComputeSumSquared(float* dataPtr,
+                                                       const int64_t numberOfDataElements,
+                                                       float& meanOut,
+                                                       float& sqrtSumSquaredOut,
+                                                       float& sqrtSumSquaredNoDemeanOut) const
+{
+    /*
+     * NOTE: Do not use OpenMP here.  OpenMP is used
+     * in the method that calls this method.
+     */
+    double sum(0.0);
+    for (int64_t j = 0; j < numberOfDataElements; j++) {
+        sum += dataPtr[j];
+    }
+    const double mean(sum / static_cast<double>(numberOfDataElements));
+    
+    double sumSQ(0.0);
+    for (int64_t j = 0; j < numberOfDataElements; j++) {
+        dataPtr[j] = static_cast<float>(dataPtr[j] - mean);
+        sumSQ += (static_cast<double>(dataPtr[j]) * dataPtr[j]);
+    }
+    
+    meanOut = mean;
+    sqrtSumSquaredOut = std::sqrt(sumSQ);
+    sqrtSumSquaredNoDemeanOut = std::sqrt(sumSQ + (numberOfDataElements * mean * mean));
 }
 
 
@@ -205,6 +375,18 @@ ConnectivityCorrelationTwo::getSettings() const
     return &m_settings;
 }
 
+/**
+ * Set the correlation settings.  The data is independent of the
+ * settings so changing them does not require a new instance.
+ * @param settings
+ *    New settings
+ */
+void
+ConnectivityCorrelationTwo::setSettings(const ConnectivityCorrelationSettings& settings)
+{
+    m_settings = settings;
+}
+
 /**
  * Compute correlation/covariance for the given data set indices and output the
  * average of the computations.
@@ -356,35 +538,51 @@ ConnectivityCorrelationTwo::computeForDataSets(const DataSet& a,
     CaretAssert(a.m_numDataElements == b.m_numDataElements);
     CaretAssert(a.m_numDataElements >= 1);
 
+    /*
+     * Sum of products of the data as stored
+     */
+    double xySum(0.0);
+    if ((a.m_dataStride == 1)
+        && (b.m_dataStride == 1)) {
+        /*
+         * "dsdot" requires contiguous data
+         */
+        xySum = dsdot(a.m_dataElements,
+                      b.m_dataElements,
+                      m_numberOfDataElements);
+    }
+    else {
+        for (int64_t i = 0; i < a.m_numDataElements; i++) {
+            xySum += (a.get(i) * b.get(i));
+        }
+    }
+    
+    /*
+     * Sum of products with and without the mean removed
+     */
+    const double meansProduct(m_numberOfDataElements
+                              * static_cast<double>(a.m_mean)
+                              * static_cast<double>(b.m_mean));
+    const double demeanedXYSum(m_dataDemeanedFlag
+                               ? xySum
+                               : (xySum - meansProduct));
+    const double noDemeanXYSum(m_dataDemeanedFlag
+                               ? (xySum + meansProduct)
+                               : xySum);
+    
     float value(0.0);
     
     switch (m_settings.getMode()) {
         case ConnectivityCorrelationModeEnum::CORRELATION:
         {
-            double xySum(0.0);
+            const bool noDemeanFlag(m_settings.isCorrelationNoDemeanEnabled());
+            const double ssxy(noDemeanFlag
+                              ? noDemeanXYSum
+                              : demeanedXYSum);
             
-            if ((a.m_dataStride == 1)
-                && (b.m_dataStride == 1)) {
-                /*
-                 * "dsdot" requires contiguous data
-                 */
-                xySum = dsdot(a.m_dataElements,
-                              b.m_dataElements,
-                              m_numberOfDataElements);
-            }
-            else {
-                for (int64_t i = 0; i < a.m_numDataElements; i++) {
-                    xySum += (a.get(i) * b.get(i));
-                }
-            }
-            
-            const double ssxy(m_settings.isCorrelationNoDemeanEnabled()
-                              ? xySum
-                              : (xySum - (m_numberOfDataElements
-                                          * a.m_mean
-                                          * b.m_mean)));
-            
-            const double denom(a.m_sqrtSumSquared * b.m_sqrtSumSquared);
+            const double denom(noDemeanFlag
+                               ? (static_cast<double>(a.m_sqrtSumSquaredNoDemean) * b.m_sqrtSumSquaredNoDemean)
+                               : (static_cast<double>(a.m_sqrtSumSquared) * b.m_sqrtSumSquared));
             if (denom != 0.0) {
                 value = (ssxy / denom);
 
@@ -402,13 +600,7 @@ ConnectivityCorrelationTwo::computeForDataSets(const DataSet& a,
             break;
         case ConnectivityCorrelationModeEnum::COVARIANCE:
         {
-            double sum(0.0);
-            for (int64_t i = 0; i < a.m_numDataElements; i++) {
-                sum += ((a.get(i) - a.m_mean)
-                        * (b.get(i) - b.m_mean));
-            }
-
-            value = (sum / static_cast<double>(a.m_numDataElements));
+            value = (demeanedXYSum / static_cast<double>(a.m_numDataElements));
         }
             break;
     }
@@ -427,7 +619,8 @@ ConnectivityCorrelationTwo::printDebugData()
         const DataSet* ds(m_dataSets[i]);
         CaretAssert(ds);
         std::cout << "   " << i << "u=" << ds->m_mean
-        << ", SS=" << ds->m_sqrtSumSquared << std::endl;
+        << ", SS=" << ds->m_sqrtSumSquared
+        << ", SS No Demean=" << ds->m_sqrtSumSquaredNoDemean << std::endl;
     }
 }
 
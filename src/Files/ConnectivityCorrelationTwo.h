@@ -40,6 +40,13 @@ namespace caret {
                                                        const int64_t dataStride,
                                                        AString& errorMessageOut);
 
+        static ConnectivityCorrelationTwo* newInstance(const AString& ownerName,
+                                                       const ConnectivityCorrelationSettings& settings,
+                                                       std::vector<float>& dataSetsData,
+                                                       const int64_t numberOfDataSets,
+                                                       const int64_t numberOfDataElements,
+                                                       AString& errorMessageOut);
+
         virtual ~ConnectivityCorrelationTwo();
         
         ConnectivityCorrelationTwo(const ConnectivityCorrelationTwo&) = delete;
@@ -48,6 +55,8 @@ namespace caret {
         
         const ConnectivityCorrelationSettings* getSettings() const;
         
+        void setSettings(const ConnectivityCorrelationSettings& settings);
+        
         void computeAverageForDataSetIndices(const std::vector<int64_t> dataSetIndices,
                                              std::vector<float>& dataOut) const;
         
@@ -64,13 +73,15 @@ namespace caret {
                     const int64_t numDataElements,
                     const int64_t dataStride,
                     const float mean,
-                    const float sqrtSumSquared)
+                    const float sqrtSumSquared,
+                    const float sqrtSumSquaredNoDemean)
             : m_dataSetIndex(dataSetIndex),
             m_dataElements(dataElements),
             m_numDataElements(numDataElements),
             m_dataStride(dataStride),
             m_mean(mean),
-            m_sqrtSumSquared(sqrtSumSquared)            
+            m_sqrtSumSquared(sqrtSumSquared),
+            m_sqrtSumSquaredNoDemean(sqrtSumSquaredNoDemean)
             { }
             
             /** @return data element at given index */
@@ -84,7 +95,10 @@ namespace caret {
             const int64_t m_numDataElements;
             const int64_t m_dataStride;
             const float   m_mean;
+            /** Square root of sum squared of the data with the mean removed */
             const float   m_sqrtSumSquared;
+            /** Square root of sum squared of the data without removing the mean */
+            const float   m_sqrtSumSquaredNoDemean;
         };
         
         ConnectivityCorrelationTwo(const AString& ownerName,
@@ -93,6 +107,12 @@ namespace caret {
                                    const int64_t numberOfDataElements,
                                    const int64_t dataStride);
         
+        ConnectivityCorrelationTwo(const AString& ownerName,
+                                   const ConnectivityCorrelationSettings& settings,
+                                   std::vector<float>& dataSetsData,
+                                   const int64_t numberOfDataSets,
+                                   const int64_t numberOfDataElements);
+        
         void computeForDataSet(const DataSet& dataSet,
                                std::vector<float>& dataOut) const;
         
@@ -103,13 +123,20 @@ namespace caret {
                                       const int64_t numberOfDataElements,
                                       const int64_t dataStride,
                                       float& meanOut,
-                                      float& sqrtSumSquaredOut) const;
+                                      float& sqrtSumSquaredOut,
+                                      float& sqrtSumSquaredNoDemeanOut) const;
+        
+        void demeanAndComputeSumSquared(float* dataPtr,
+                                        const int64_t numberOfDataElements,
+                                        float& meanOut,
+                                        float& sqrtSumSquaredOut,
+                                        float& sqrtSumSquaredNoDemeanOut) const;
         
         void printDebugData();
         
         const AString m_ownerName;
         
-        const ConnectivityCorrelationSettings m_settings;
+        ConnectivityCorrelationSettings m_settings;
         
         const int64_t m_numberOfDataSets;
         
@@ -117,6 +144,12 @@ namespace caret {
         
         const int64_t m_dataStride;
         
+        /** True if each data set's mean has been subtracted from its data elements */
+        const bool m_dataDemeanedFlag;
+        
+        /** Contains the data sets when they are owned by this instance */
+        std::vector<float> m_dataSetsData;
+        
         std::vector<DataSet*> m_dataSets;
         
         bool m_debugFlag = false;
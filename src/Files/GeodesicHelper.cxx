@@ -27,12 +27,62 @@
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 
+#include <algorithm>
 #include <cmath>
 #include <stdint.h>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    //breadth first search from start over nodes not yet in the order, visiting neighbors in order of increasing degree, appends to orderOut
+    void cuthillMcKeeComponent(const vector<vector<int32_t> >& neighbors, const int32_t& start, vector<char>& placed, vector<int32_t>& orderOut)
+    {
+        vector<pair<size_t, int32_t> > scratch;
+        size_t head = orderOut.size();
+        orderOut.push_back(start);
+        placed[start] = 1;
+        while (head < orderOut.size())
+        {
+            const vector<int32_t>& myNeigh = neighbors[orderOut[head]];
+            ++head;
+            scratch.clear();
+            for (size_t j = 0; j < myNeigh.size(); ++j)
+            {
+                if (!placed[myNeigh[j]])
+                {
+                    placed[myNeigh[j]] = 1;
+                    scratch.push_back(make_pair(neighbors[myNeigh[j]].size(), myNeigh[j]));
+                }
+            }
+            sort(scratch.begin(), scratch.end());
+            for (size_t j = 0; j < scratch.size(); ++j)
+            {
+                orderOut.push_back(scratch[j].second);
+            }
+        }
+    }
+    
+    //reverse cuthill-mckee, so that nodes close on the surface are close in memory, returns new index to old index
+    vector<int32_t> reverseCuthillMcKee(const vector<vector<int32_t> >& neighbors)
+    {
+        const int32_t numNodes = (int32_t)neighbors.size();
+        vector<int32_t> ret, probe;
+        ret.reserve(numNodes);
+        vector<char> placed(numNodes, 0), probed(numNodes, 0);
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            if (placed[i]) continue;
+            probe.clear();//start from the last node reached from i, an approximate peripheral node, which makes the breadth first levels narrow
+            cuthillMcKeeComponent(neighbors, i, probed, probe);
+            cuthillMcKeeComponent(neighbors, probe.back(), placed, ret);
+        }
+        reverse(ret.begin(), ret.end());
+        return ret;
+    }
+}
+
 GeodesicHelperBase::GeodesicHelperBase(const SurfaceFile* surfaceIn, const float* correctedAreas)
 {
     CaretPointer<TopologyHelperBase> topoBase(new TopologyHelperBase(surfaceIn));
@@ -162,6 +212,48 @@ GeodesicHelperBase::GeodesicHelperBase(const SurfaceFile* surfaceIn, const float
         distances2[baseNode].push_back(tempf);
         neighbors2PathInfo[baseNode].push_back(tempInfo);
     }
+    reorderForLocality();
+}
+
+void GeodesicHelperBase::reorderForLocality()
+{//searches touch neighbors of the nodes they pop from the heap, file order often scatters neighbors across the arrays on large meshes
+    m_toFileOrder = reverseCuthillMcKee(nodeNeighbors);
+    CaretAssert((int32_t)m_toFileOrder.size() == numNodes);
+    m_toInternal.resize(numNodes);
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        m_toInternal[m_toFileOrder[i]] = i;
+    }
+    vector<vector<float> > newDistances(numNodes), newDistances2(numNodes);
+    vector<vector<int32_t> > newNeighbors(numNodes), newNeighbors2(numNodes);
+    vector<vector<CrawlInfo> > newPathInfo(numNodes);
+    vector<Vector3D> newCoords(numNodes);
+    for (int32_t i = 0; i < numNodes; ++i)
+    {//allocating the new per-node vectors in the new order also tends to put them near each other on the heap
+        const int32_t oldNode = m_toFileOrder[i];
+        newNeighbors[i] = nodeNeighbors[oldNode];
+        for (size_t j = 0; j < newNeighbors[i].size(); ++j)
+        {
+            newNeighbors[i][j] = m_toInternal[newNeighbors[i][j]];
+        }
+        newDistances[i] = distances[oldNode];
+        newNeighbors2[i] = nodeNeighbors2[oldNode];
+        newPathInfo[i] = neighbors2PathInfo[oldNode];
+        for (size_t j = 0; j < newNeighbors2[i].size(); ++j)
+        {
+            newNeighbors2[i][j] = m_toInternal[newNeighbors2[i][j]];
+            newPathInfo[i][j].edgeNodes[0] = m_toInternal[newPathInfo[i][j].edgeNodes[0]];
+            newPathInfo[i][j].edgeNodes[1] = m_toInternal[newPathInfo[i][j].edgeNodes[1]];
+        }
+        newDistances2[i] = distances2[oldNode];
+        newCoords[i] = nodeCoords[oldNode];
+    }
+    nodeNeighbors.swap(newNeighbors);
+    distances.swap(newDistances);
+    nodeNeighbors2.swap(newNeighbors2);
+    distances2.swap(newDistances2);
+    neighbors2PathInfo.swap(newPathInfo);
+    nodeCoords.swap(newCoords);
 }
 
 GeodesicHelper::GeodesicHelper(const CaretPointer<const GeodesicHelperBase>& baseIn)
@@ -177,14 +269,16 @@ GeodesicHelper::GeodesicHelper(const CaretPointer<const GeodesicHelperBase>& bas
     nodeNeighbors2 = m_myBase->nodeNeighbors2.data();
     nodeCoords = m_myBase->nodeCoords.data();
     neighbors2PathInfo = m_myBase->neighbors2PathInfo.data();
+    m_toInternal = m_myBase->m_toInternal.data();
+    m_toFileOrder = m_myBase->m_toFileOrder.data();
     //allocate private scratch space
     marked.resize(numNodes, 0);//initialize once, each internal function (dijkstra methods) tracks elements changed, and resets only those (except in the case of whole surface)
     m_heapIdent.resize(numNodes);//the idea is to make it faster for the more likely case of small areas of the surface for functions that have limits, by removing the runtime term based solely on surface size
     outputStore.resize(numNodes);
-    output = outputStore.data();//because we have a function that does a pointer swap to compute distances directly in the output array
+    output = outputStore.data();
     changed.resize(numNodes);
     parentStore.resize(numNodes);
-    parent = parentStore.data();//ditto for parents
+    parent = parentStore.data();
     heurVal.resize(numNodes);
 }
 
@@ -195,7 +289,11 @@ void GeodesicHelper::getNodesToGeoDist(const int32_t node, const float maxdist,
     CaretAssert(node < numNodes && node >= 0);
     if (node >= numNodes || maxdist < 0.0f || node < 0) return;//check what we asserted so release doesn't do strange things
     CaretMutexLocker locked(&inUse);//let sanity checks go multithreaded, as if it mattered
-    dijkstra(node, maxdist, nodesOut, distsOut, smoothflag);
+    dijkstra(m_toInternal[node], maxdist, nodesOut, distsOut, smoothflag);
+    for (size_t i = 0; i < nodesOut.size(); ++i)
+    {
+        nodesOut[i] = m_toFileOrder[nodesOut[i]];
+    }
 }
 
 void GeodesicHelper::getNodesToGeoDist(const int32_t node, const float maxdist, std::vector<int32_t>& nodesOut, std::vector<float>& distsOut, std::vector<int32_t>& parentsOut, const bool smoothflag)
@@ -205,12 +303,14 @@ void GeodesicHelper::getNodesToGeoDist(const int32_t node, const float maxdist,
     CaretAssert(node < numNodes && node >= 0);
     if (node >= numNodes || maxdist < 0.0f || node < 0) return;
     CaretMutexLocker locked(&inUse);//we need the parents array to stay put, so don't scope this
-    dijkstra(node, maxdist, nodesOut, distsOut, smoothflag);
+    dijkstra(m_toInternal[node], maxdist, nodesOut, distsOut, smoothflag);
     int32_t mysize = (int32_t)nodesOut.size();
     parentsOut.resize(mysize);
     for (int32_t i = 0; i < mysize; ++i)
     {
-        parentsOut[i] = parent[nodesOut[i]];
+        const int32_t myParent = parent[nodesOut[i]];
+        parentsOut[i] = (myParent < 0 ? myParent : m_toFileOrder[myParent]);
+        nodesOut[i] = m_toFileOrder[nodesOut[i]];
     }
 }
 
@@ -365,10 +465,7 @@ void GeodesicHelper::getGeoFromNode(const int32_t node, float* valuesOut, const
         return;
     }
     CaretMutexLocker locked(&inUse);//don't screw with member variables while in use
-    float* temp = output;//swap out the output pointer to avoid allocation
-    output = valuesOut;
-    dijkstra(node, smoothflag);
-    output = temp;//restore the pointer to the original memory
+    dijkstraToFileOrder(m_toInternal[node], smoothflag, valuesOut, NULL);
 }
 
 void GeodesicHelper::getGeoFromNode(const int32_t node, float* valuesOut, int32_t* parentsOut, const bool smoothflag)
@@ -379,13 +476,7 @@ void GeodesicHelper::getGeoFromNode(const int32_t node, float* valuesOut, int32_
         return;
     }
     CaretMutexLocker locked(&inUse);//don't screw with member variables while in use
-    float* temp = output;//swap out the output pointer to avoid allocation
-    int32_t* tempi = parent;
-    output = valuesOut;
-    parent = parentsOut;
-    dijkstra(node, smoothflag);
-    output = temp;//restore the pointers to the original memory
-    parent = tempi;
+    dijkstraToFileOrder(m_toInternal[node], smoothflag, valuesOut, parentsOut);
 }
 
 void GeodesicHelper::getGeoFromNode(const int32_t node, std::vector<float>& valuesOut, const bool smoothflag)
@@ -397,11 +488,8 @@ void GeodesicHelper::getGeoFromNode(const int32_t node, std::vector<float>& valu
         return;
     }
     CaretMutexLocker locked(&inUse);
-    float* temp = output;//swap the output pointer to avoid copy
     valuesOut.resize(numNodes);
-    output = valuesOut.data();
-    dijkstra(node, smoothflag);
-    output = temp;//restore
+    dijkstraToFileOrder(m_toInternal[node], smoothflag, valuesOut.data(), NULL);
 }
 
 void GeodesicHelper::getGeoFromNode(const int32_t node, std::vector<float>& valuesOut, std::vector<int32_t>& parentsOut, const bool smoothflag)
@@ -412,15 +500,44 @@ void GeodesicHelper::getGeoFromNode(const int32_t node, std::vector<float>& valu
         return;
     }
     CaretMutexLocker locked(&inUse);
-    float* temp = output;//swap out the output pointer to avoid copying into the vector afterwards
-    int32_t* tempi = parent;
     valuesOut.resize(numNodes);
     parentsOut.resize(numNodes);
-    output = valuesOut.data();
-    parent = parentsOut.data();
-    dijkstra(node, smoothflag);
-    output = temp;//restore the pointers to the original memory
-    parent = tempi;
+    dijkstraToFileOrder(m_toInternal[node], smoothflag, valuesOut.data(), parentsOut.data());
+}
+
+void GeodesicHelper::dijkstraToFileOrder(const int32_t root, bool smooth, float* valuesOut, int32_t* parentsOut)
+{
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        output[i] = -1.0f;//whole surface dijkstra clears the flags when done, so mark unreached nodes with a distance it never produces
+    }
+    dijkstra(root, smooth);
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        if (output[i] < 0.0f) continue;//unreached nodes keep whatever the caller had, as when the search wrote directly into the caller's arrays
+        const int32_t fileNode = m_toFileOrder[i];
+        valuesOut[fileNode] = output[i];
+        if (parentsOut != NULL)
+        {
+            parentsOut[fileNode] = (parent[i] < 0 ? parent[i] : m_toFileOrder[parent[i]]);
+        }
+    }
+}
+
+void GeodesicHelper::exportPath(const int32_t& internalEnd, vector<int32_t>& pathNodesOut, vector<float>& pathDistsOut)
+{
+    vector<int32_t> tempReverse;
+    for (int32_t next = internalEnd; next != -1; next = parent[next])//-1 is "parent" of start node
+    {
+        tempReverse.push_back(next);
+    }
+    int32_t tempSize = (int32_t)tempReverse.size();
+    for (int32_t i = tempSize - 1; i >= 0; --i)
+    {
+        int32_t tempNode = tempReverse[i];
+        pathNodesOut.push_back(m_toFileOrder[tempNode]);
+        pathDistsOut.push_back(output[tempNode]);
+    }
 }
 
 void GeodesicHelper::dijkstra(const int32_t root, const std::vector<int32_t>& interested, bool smooth)
@@ -633,7 +750,7 @@ int32_t GeodesicHelper::closest(const int32_t& root, const char* roi, const floa
     while (!m_active.isEmpty())
     {
         whichnode = m_active.pop();
-        if (roi[whichnode] != 0)//we have found the closest node in the roi to the root, we are done
+        if (roi[m_toFileOrder[whichnode]] != 0)//we have found the closest node in the roi to the root, we are done
         {
             distOut = output[whichnode];
             ret = whichnode;
@@ -721,7 +838,7 @@ int32_t GeodesicHelper::closest(const int32_t& root, const char* roi, bool smoot
     while (!m_active.isEmpty())
     {
         whichnode = m_active.pop();
-        if (roi[whichnode] != 0)//we have found the closest node in the roi to the root, we are done
+        if (roi[m_toFileOrder[whichnode]] != 0)//we have found the closest node in the roi to the root, we are done
         {
             ret = whichnode;
             break;
@@ -1023,6 +1140,7 @@ void GeodesicHelper::getGeoToTheseNodes(const int32_t root, const std::vector<in
         return;
     }
     int32_t i, mysize = ofInterest.size(), node;
+    vector<int32_t> internalInterest(mysize);
     for (i = 0; i < mysize; ++i)
     {//needs to do a linear scan of this array later anyway, so lets sanity check it
         node = ofInterest[i];
@@ -1031,13 +1149,14 @@ void GeodesicHelper::getGeoToTheseNodes(const int32_t root, const std::vector<in
             distsOut.clear();//empty array is error condition
             return;
         }
+        internalInterest[i] = m_toInternal[node];
     }
     CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    dijkstra(root, ofInterest, smoothflag);
+    dijkstra(m_toInternal[root], internalInterest, smoothflag);
     distsOut.resize(mysize);
     for (i = 0; i < mysize; ++i)
     {
-        distsOut[i] = output[ofInterest[i]];
+        distsOut[i] = output[internalInterest[i]];
     }
 }
 
@@ -1050,28 +1169,15 @@ void GeodesicHelper::getPathToNode(const int32_t root, const int32_t endpoint, v
     {
         return;
     }
+    const int32_t internalEnd = m_toInternal[endpoint];
     CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    parent[endpoint] = -2;//sentinel value that DOESN'T mean end of path
-    aStar(root, endpoint, smoothflag);
-    if (parent[endpoint] == -2)//check for invalid value
+    parent[internalEnd] = -2;//sentinel value that DOESN'T mean end of path
+    aStar(m_toInternal[root], internalEnd, smoothflag);
+    if (parent[internalEnd] == -2)//check for invalid value
     {
         return;
     }
-    vector<int32_t> tempReverse;
-    int32_t next = endpoint;
-    while (next != root)
-    {
-        tempReverse.push_back(next);
-        next = parent[next];
-    }
-    tempReverse.push_back(next);
-    int32_t tempSize = (int32_t)tempReverse.size();
-    for (int32_t i = tempSize - 1; i >= 0; --i)
-    {
-        int32_t tempNode = tempReverse[i];
-        pathNodesOut.push_back(tempNode);
-        pathDistsOut.push_back(output[tempNode]);
-    }
+    exportPath(internalEnd, pathNodesOut, pathDistsOut);
 }
 
 void GeodesicHelper::getPathBetweenNodeLists(const vector<int32_t>& startList, const vector<int32_t>& endList, const float& maxDist, vector<int32_t>& pathNodesOut, vector<float>& pathDistsOut, bool smoothflag)
@@ -1086,24 +1192,19 @@ void GeodesicHelper::getPathBetweenNodeLists(const vector<int32_t>& startList, c
     {
         if (endList[i] < 0 || endList[i] >= numNodes) return;
     }
-    CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    int32_t pathEnd = dijkstra(startList, endList, maxDist, smoothflag);//not sure if A* with a PointLocator would be any faster, so don't add a dependency
-    if (pathEnd == -1) return;//no path found
-    vector<int32_t> tempReverse;
-    int32_t next = pathEnd;
-    while (next != -1)//-1 is "parent" of start node
+    vector<int32_t> internalStart(startList.size()), internalEnd(endList.size());
+    for (size_t i = 0; i < startList.size(); ++i)
     {
-        tempReverse.push_back(next);
-        next = parent[next];
+        internalStart[i] = m_toInternal[startList[i]];
     }
-    tempReverse.push_back(next);
-    int32_t tempSize = (int32_t)tempReverse.size();
-    for (int32_t i = tempSize - 1; i >= 0; --i)
+    for (size_t i = 0; i < endList.size(); ++i)
     {
-        int32_t tempNode = tempReverse[i];
-        pathNodesOut.push_back(tempNode);
-        pathDistsOut.push_back(output[tempNode]);
+        internalEnd[i] = m_toInternal[endList[i]];
     }
+    CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
+    int32_t pathEnd = dijkstra(internalStart, internalEnd, maxDist, smoothflag);//not sure if A* with a PointLocator would be any faster, so don't add a dependency
+    if (pathEnd == -1) return;//no path found
+    exportPath(pathEnd, pathNodesOut, pathDistsOut);
 }
 
 void GeodesicHelper::getPathAlongLine(const int32_t root, const int32_t endpoint, const Vector3D& linep1, const Vector3D& linep2, vector<int32_t>& pathNodesOut, vector<float>& pathDistsOut)
@@ -1115,28 +1216,15 @@ void GeodesicHelper::getPathAlongLine(const int32_t root, const int32_t endpoint
     {
         return;
     }
+    const int32_t internalEnd = m_toInternal[endpoint];
     CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    parent[endpoint] = -2;//sentinel value that DOESN'T mean end of path
-    aStarLine(root, endpoint, linep1, linep2, false);
-    if (parent[endpoint] == -2)//check for invalid value
+    parent[internalEnd] = -2;//sentinel value that DOESN'T mean end of path
+    aStarLine(m_toInternal[root], internalEnd, linep1, linep2, false);
+    if (parent[internalEnd] == -2)//check for invalid value
     {
         return;
     }
-    vector<int32_t> tempReverse;
-    int32_t next = endpoint;
-    while (next != root)
-    {
-        tempReverse.push_back(next);
-        next = parent[next];
-    }
-    tempReverse.push_back(next);
-    int32_t tempSize = (int32_t)tempReverse.size();
-    for (int32_t i = tempSize - 1; i >= 0; --i)
-    {
-        int32_t tempNode = tempReverse[i];
-        pathNodesOut.push_back(tempNode);
-        pathDistsOut.push_back(output[tempNode]);
-    }
+    exportPath(internalEnd, pathNodesOut, pathDistsOut);
 }
 
 void GeodesicHelper::getPathAlongLineSegment(const int32_t root, const int32_t endpoint, const Vector3D& linep1, const Vector3D& linep2, vector<int32_t>& pathNodesOut, vector<float>& pathDistsOut)
@@ -1149,28 +1237,15 @@ void GeodesicHelper::getPathAlongLineSegment(const int32_t root, const int32_t e
         return;
     }
     vector<int32_t> ofInterest(1, endpoint);
+    const int32_t internalEnd = m_toInternal[endpoint];
     CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    parent[endpoint] = -2;//sentinel value that DOESN'T mean end of path
-    aStarLine(root, endpoint, linep1, linep2, true);
-    if (parent[endpoint] == -2)//check for invalid value
+    parent[internalEnd] = -2;//sentinel value that DOESN'T mean end of path
+    aStarLine(m_toInternal[root], internalEnd, linep1, linep2, true);
+    if (parent[internalEnd] == -2)//check for invalid value
     {
         return;
     }
-    vector<int32_t> tempReverse;
-    int32_t next = endpoint;
-    while (next != root)
-    {
-        tempReverse.push_back(next);
-        next = parent[next];
-    }
-    tempReverse.push_back(next);
-    int32_t tempSize = (int32_t)tempReverse.size();
-    for (int32_t i = tempSize - 1; i >= 0; --i)
-    {
-        int32_t tempNode = tempReverse[i];
-        pathNodesOut.push_back(tempNode);
-        pathDistsOut.push_back(output[tempNode]);
-    }
+    exportPath(internalEnd, pathNodesOut, pathDistsOut);
 }
 
 void GeodesicHelper::getPathFollowingData(const int32_t root, const int32_t endpoint, const float* data, vector<int32_t>& pathNodesOut, vector<float>& pathDistsOut,
@@ -1222,28 +1297,28 @@ void GeodesicHelper::getPathFollowingData(const int32_t root, const int32_t endp
             }
         }
     }
-    CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    parent[endpoint] = -2;//sentinel value that DOESN'T mean end of path
-    aStarData(root, endpoint, rescaledData.data(), followStrength, roiData, smoothFlag);
-    if (parent[endpoint] == -2)//check for invalid value
+    vector<float> internalData(numNodes), internalRoi;//the search uses the internal node order
+    for (int i = 0; i < numNodes; ++i)
     {
-        return;
+        internalData[i] = rescaledData[m_toFileOrder[i]];
     }
-    vector<int32_t> tempReverse;
-    int32_t next = endpoint;
-    while (next != root)
+    if (roiData != NULL)
     {
-        tempReverse.push_back(next);
-        next = parent[next];
+        internalRoi.resize(numNodes);
+        for (int i = 0; i < numNodes; ++i)
+        {
+            internalRoi[i] = roiData[m_toFileOrder[i]];
+        }
     }
-    tempReverse.push_back(next);
-    int32_t tempSize = (int32_t)tempReverse.size();
-    for (int32_t i = tempSize - 1; i >= 0; --i)
+    const int32_t internalEnd = m_toInternal[endpoint];
+    CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
+    parent[internalEnd] = -2;//sentinel value that DOESN'T mean end of path
+    aStarData(m_toInternal[root], internalEnd, internalData.data(), followStrength, (roiData == NULL ? NULL : internalRoi.data()), smoothFlag);
+    if (parent[internalEnd] == -2)//check for invalid value
     {
-        int32_t tempNode = tempReverse[i];
-        pathNodesOut.push_back(tempNode);
-        pathDistsOut.push_back(output[tempNode]);
+        return;
     }
+    exportPath(internalEnd, pathNodesOut, pathDistsOut);
 }
 
 int32_t GeodesicHelper::getClosestNodeInRoi(const int32_t& root, const char* roi, const float& maxdist, float& distOut, bool smoothflag)
@@ -1254,7 +1329,9 @@ int32_t GeodesicHelper::getClosestNodeInRoi(const int32_t& root, const char* roi
         return -1;
     }
     CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    return closest(root, roi, maxdist, distOut, smoothflag);
+    int32_t ret = closest(m_toInternal[root], roi, maxdist, distOut, smoothflag);
+    if (ret == -1) return ret;
+    return m_toFileOrder[ret];
 }
 
 int32_t GeodesicHelper::getClosestNodeInRoi(const int32_t& root, const char* roi, vector<int32_t>& pathNodesOut, vector<float>& pathDistsOut, bool smoothflag)
@@ -1267,22 +1344,8 @@ int32_t GeodesicHelper::getClosestNodeInRoi(const int32_t& root, const char* roi
         return -1;
     }
     CaretMutexLocker locked(&inUse);//let sanity checks fail without locking
-    int32_t ret = closest(root, roi, smoothflag);
+    int32_t ret = closest(m_toInternal[root], roi, smoothflag);
     if (ret == -1) return ret;
-    vector<int32_t> tempReverse;
-    int32_t next = ret;
-    while (next != root)
-    {
-        tempReverse.push_back(next);
-        next = parent[next];
-    }
-    tempReverse.push_back(next);
-    int32_t tempSize = (int32_t)tempReverse.size();
-    for (int32_t i = tempSize - 1; i >= 0; --i)
-    {
-        int32_t tempNode = tempReverse[i];
-        pathNodesOut.push_back(tempNode);
-        pathDistsOut.push_back(output[tempNode]);
-    }
-    return ret;
+    exportPath(ret, pathNodesOut, pathDistsOut);
+    return m_toFileOrder[ret];
 }
@@ -53,6 +53,8 @@ namespace caret {
         std::vector<std::vector<int32_t> > nodeNeighbors, nodeNeighbors2;
         std::vector<std::vector<CrawlInfo> > neighbors2PathInfo;
         std::vector<Vector3D> nodeCoords;//for line-following and A*
+        std::vector<int32_t> m_toInternal, m_toFileOrder;//all arrays above are in a locality-preserving order, GeodesicHelper translates node indices at its public functions
+        void reorderForLocality();
         int32_t numNodes;
         float m_avgNodeSpacing;//to use for balancing line following penalty
         float m_corrAreaSmallestFactor;//so that heuristics can be consistent despite corrected areas
@@ -70,6 +72,7 @@ namespace caret {
         const std::vector<int32_t>* nodeNeighbors, *nodeNeighbors2;
         const std::vector<GeodesicHelperBase::CrawlInfo>* neighbors2PathInfo;
         const Vector3D* nodeCoords;
+        const int32_t* m_toInternal, *m_toFileOrder;
         float* output;
         int32_t* parent;
         std::vector<float> outputStore;
@@ -93,6 +96,8 @@ namespace caret {
         float lineHeuristic(const Vector3D& pos, const Vector3D& linep1, const Vector3D& linep2, const float& remainEucl, const bool& segment);
         void aStarLine(const int32_t& root, const int32_t& endpoint, const Vector3D& linep1, const Vector3D& linep2, const bool& segment);//to single endpoint, following line
         void aStarData(const int32_t& root, const int32_t& endpoint, const float* data, const float& followStrength, const float* roiData, const bool& smooth);//to single endpoint, following data
+        void dijkstraToFileOrder(const int32_t root, bool smooth, float* valuesOut, int32_t* parentsOut);//whole surface, writes only reached nodes, parentsOut may be NULL
+        void exportPath(const int32_t& internalEnd, std::vector<int32_t>& pathNodesOut, std::vector<float>& pathDistsOut);//follows parents to a root (parent -1), outputs in file order
     public:
         explicit GeodesicHelper(const CaretPointer<const GeodesicHelperBase>& baseIn);
         /// Get distances from root node, up to a geodesic distance cutoff (stops computing when no more nodes are within that distance)
@@ -457,13 +457,11 @@ MetricDynamicConnectivityFile::getConnectivityCorrelationTwo() const
 {
     if ( ! m_connectivityCorrelationFailedFlag) {
         /**
-         * Need to recreate correlation algorithm if settins have changed
+         * Update correlation algorithm if settings have changed
          */
         if (m_connectivityCorrelationTwo != NULL) {
             if (*m_correlationSettings != *m_connectivityCorrelationTwo->getSettings()) {
-                m_connectivityCorrelationTwo.reset();
-                CaretLogFine("Recreating correlation algorithm for "
-                             + getFileName());
+                m_connectivityCorrelationTwo->setSettings(*m_correlationSettings);
             }
         }
         if (m_connectivityCorrelationTwo == NULL) {
@@ -478,27 +476,23 @@ MetricDynamicConnectivityFile::getConnectivityCorrelationTwo() const
                  */
                 CaretAssert(m_parentMetricFile);
                 const int64_t dataSize(numberOfVertices * numberOfTimePoints);
-                m_metricDataCopy.reserve(dataSize);
-                std::vector<const float*> brainordinateDataPointers;
+                std::vector<float> metricDataCopy;
+                metricDataCopy.reserve(dataSize);
                 for (int64_t i = 0; i < numberOfVertices; i++) {
                     for (int64_t j = 0; j < numberOfTimePoints; j++) {
-                        m_metricDataCopy.push_back(m_parentMetricFile->getValue(i, j));
+                        metricDataCopy.push_back(m_parentMetricFile->getValue(i, j));
                     }
-                    
-                    const int64_t offset(i * numberOfTimePoints);
-                    CaretAssertVectorIndex(m_metricDataCopy, offset);
-                    const float* dataPtr(&m_metricDataCopy[offset]);
-                    CaretAssert(dataPtr);
-                    brainordinateDataPointers.push_back(dataPtr);
                 }
                 
-                const int64_t nextBrainordinateStride(1);
+                /*
+                 * Data is moved into the correlation algorithm
+                 */
                 AString errorMessage;
                 ConnectivityCorrelationTwo* cc = ConnectivityCorrelationTwo::newInstance(getFileName(),
                                                                                          *m_correlationSettings,
-                                                                                         brainordinateDataPointers,
+                                                                                         metricDataCopy,
+                                                                                         numberOfVertices,
                                                                                          numberOfTimePoints,
-                                                                                         nextBrainordinateStride,
                                                                                          errorMessage);
                 if (cc != NULL) {
                     m_connectivityCorrelationTwo.reset(cc);
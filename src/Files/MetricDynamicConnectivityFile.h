@@ -135,8 +135,6 @@ namespace caret {
         
         mutable std::unique_ptr<ConnectivityCorrelationSettings> m_correlationSettings;
         
-        mutable std::vector<float> m_metricDataCopy;
-        
         // ADD_NEW_MEMBERS_HERE
 
     };
@@ -19,8 +19,10 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <memory>
 
 //#include <QRunnable>
 //#include <QSemaphore>
@@ -38,6 +40,7 @@
 #include "GroupAndNameHierarchyItem.h"
 #include "Palette.h"
 #include "PaletteColorMapping.h"
+#include "PaletteLookupTable.h"
 #include "MathFunctions.h"
 
 using namespace caret;
@@ -197,6 +200,13 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
                              rgbaNegativeOne);
     const bool rgbaNegativeOneValid = (rgbaNegativeOne[3] > 0.0);
     
+    /*
+     * Colors for other values come from a lookup table so that
+     * the palette is not searched for every scalar.
+     */
+    std::shared_ptr<const PaletteLookupTable> paletteLookupTable = palette->getLookupTable(interpolateFlag);
+    CaretAssert(paletteLookupTable);
+    
     /*
      * Color all scalars.
      */
@@ -294,9 +304,8 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
              * Color scalar using palette
              */
             float rgba[4];
-            palette->getPaletteColor(normalValue,
-                                     interpolateFlag,
-                                     rgba);
+            paletteLookupTable->getPaletteColor(normalValue,
+                                                rgba);
             if (rgba[3] > 0.0f) {
                 rgbaOut[0] = rgba[0];
                 rgbaOut[1] = rgba[1];
@@ -737,54 +746,192 @@ NodeAndVoxelColoring::colorIndicesWithLabelTableForDisplayGroupTabPrivate(const
             break;
     }
     
+    /*
+     * Resolve the color of each label key once, so that elements only need an
+     * array lookup rather than a search of the label table.  Keys that are not
+     * in the label table or are not selected have an alpha of zero.
+     */
+    std::vector<int32_t> labelKeys;
+    labelTable->getKeys(labelKeys);
+    if (labelKeys.empty()) {
+        return;
+    }
+    const int64_t minimumKey = *std::min_element(labelKeys.begin(), labelKeys.end());
+    const int64_t maximumKey = *std::max_element(labelKeys.begin(), labelKeys.end());
+    const int64_t numberOfKeys = maximumKey - minimumKey + 1;
+    if (numberOfKeys > std::max(static_cast<int64_t>(labelKeys.size()) * 16, static_cast<int64_t>(65536))) {
+        /*
+         * Keys too sparse for an array, rarely (if ever) happens
+         */
+        colorIndicesWithLabelTableSparse(labelTable,
+                                         labelIndices,
+                                         numberOfIndices,
+                                         displayGroup,
+                                         tabIndex,
+                                         colorDataType,
+                                         rgbaOutPointer);
+        return;
+    }
+    std::vector<float> keyRGBA(numberOfKeys * 4, 0.0f);
+    for (const int32_t key : labelKeys) {
+        const GiftiLabel* gl = labelTable->getLabel(key);
+        if (gl != NULL) {
+            if (isLabelColored(gl, displayGroup, tabIndex)) {
+                gl->getColor(&keyRGBA[(key - minimumKey) * 4]);
+            }
+        }
+    }
+    
     /*
      * Assign colors from labels to nodes
      */
-    float labelRGBA[4];
-	for (int64_t i = 0; i < numberOfIndices; i++) {
+#pragma omp CARET_PARFOR schedule(dynamic, 4096)
+    for (int64_t i = 0; i < numberOfIndices; i++) {
         const int64_t labelKey = static_cast<int64_t>(labelIndices[i]);
-        const GiftiLabel* gl = labelTable->getLabel(labelKey);
-        if (gl != NULL) {
-            const GroupAndNameHierarchyItem* item = gl->getGroupNameSelectionItem();
-            bool colorDataFlag = false;
-            if (item != NULL) {
-                if (tabIndex == NodeAndVoxelColoring::INVALID_TAB_INDEX) {
-                    colorDataFlag = true;
-                }
-                else if (item->isSelected(displayGroup, tabIndex)) {
-                    colorDataFlag = true;
-                }
+        if ((labelKey < minimumKey)
+            || (labelKey > maximumKey)) {
+            continue;
+        }
+        const float* labelRGBA = &keyRGBA[(labelKey - minimumKey) * 4];
+        if (labelRGBA[3] > 0.0) {
+            setLabelColor(labelRGBA,
+                          i,
+                          colorDataType,
+                          rgbaFloat,
+                          rgbaUnsignedByte);
+        }
+    }
+}
+
+/**
+ * Is a label colored in the given display group and tab?
+ *
+ * @param gl
+ *    The label.
+ * @param displayGroup
+ *    The selected display group.
+ * @param tabIndex
+ *    Index of selected tab.
+ * @return
+ *    True if the label is colored.
+ */
+bool
+NodeAndVoxelColoring::isLabelColored(const GiftiLabel* gl,
+                                     const DisplayGroupEnum::Enum displayGroup,
+                                     const int32_t tabIndex)
+{
+    const GroupAndNameHierarchyItem* item = gl->getGroupNameSelectionItem();
+    bool colorDataFlag = false;
+    if (item != NULL) {
+        if (tabIndex == NodeAndVoxelColoring::INVALID_TAB_INDEX) {
+            colorDataFlag = true;
+        }
+        else if (item->isSelected(displayGroup, tabIndex)) {
+            colorDataFlag = true;
+        }
+    }
+    else {
+        colorDataFlag = true;
+    }
+    return colorDataFlag;
+}
+
+/**
+ * Set the color of one element from a label's color.
+ *
+ * @param labelRGBA
+ *    Color of the label.
+ * @param i
+ *    Index of the element.
+ * @param colorDataType
+ *    Data type of the output.
+ * @param rgbaFloat
+ *    Float output, used if colorDataType is float.
+ * @param rgbaUnsignedByte
+ *    Byte output, used if colorDataType is unsigned byte.
+ */
+void
+NodeAndVoxelColoring::setLabelColor(const float labelRGBA[4],
+                                    const int64_t i,
+                                    const ColorDataType colorDataType,
+                                    float* rgbaFloat,
+                                    uint8_t* rgbaUnsignedByte)
+{
+    const int64_t i4 = i * 4;
+    
+    switch (colorDataType) {
+        case COLOR_TYPE_FLOAT:
+            rgbaFloat[i4] = labelRGBA[0];
+            rgbaFloat[i4+1] = labelRGBA[1];
+            rgbaFloat[i4+2] = labelRGBA[2];
+            rgbaFloat[i4+3] = labelRGBA[3];
+            break;
+        case COLOR_TYPE_UNSIGNED_BTYE:
+            rgbaUnsignedByte[i4]   = labelRGBA[0] * 255.0;
+            rgbaUnsignedByte[i4+1] = labelRGBA[1] * 255.0;
+            rgbaUnsignedByte[i4+2] = labelRGBA[2] * 255.0;
+            if (labelRGBA[3] > 0.0) {
+                rgbaUnsignedByte[i4+3] = labelRGBA[3] * 255.0;
             }
             else {
-                colorDataFlag = true;
+                rgbaUnsignedByte[i4+3] = 0;
             }
-            
-            if (colorDataFlag) {
+            break;
+    }
+}
+
+/**
+ * Assign colors to label indices by looking up each index in the label table,
+ * used when the label keys are too sparse for an array of colors.
+ *
+ * @param labelTabl
+ *     Label table used for coloring and indexing with label indices.
+ * @param labelIndices
+ *     The indices are are used to access colors in the label table.
+ * @param numberOfIndices
+ *     Number of indices.
+ * @param displayGroup
+ *    The selected display group.
+ * @param tabIndex
+ *    Index of selected tab.
+ * @param colorDataType
+ *    Data type of the rgbaOut parameter
+ * @param rgbaOutPointer
+ *    RGBA Colors that are output.  Alpha must already be set to zero.
+ */
+void
+NodeAndVoxelColoring::colorIndicesWithLabelTableSparse(const GiftiLabelTable* labelTable,
+                                                       const float* labelIndices,
+                                                       const int64_t numberOfIndices,
+                                                       const DisplayGroupEnum::Enum displayGroup,
+                                                       const int32_t tabIndex,
+                                                       const ColorDataType colorDataType,
+                                                       void* rgbaOutPointer)
+{
+    float* rgbaFloat = NULL;
+    uint8_t* rgbaUnsignedByte = NULL;
+    switch (colorDataType) {
+        case COLOR_TYPE_FLOAT:
+            rgbaFloat = (float*)rgbaOutPointer;
+            break;
+        case COLOR_TYPE_UNSIGNED_BTYE:
+            rgbaUnsignedByte = (uint8_t*)rgbaOutPointer;
+            break;
+    }
+    
+    float labelRGBA[4];
+    for (int64_t i = 0; i < numberOfIndices; i++) {
+        const int64_t labelKey = static_cast<int64_t>(labelIndices[i]);
+        const GiftiLabel* gl = labelTable->getLabel(labelKey);
+        if (gl != NULL) {
+            if (isLabelColored(gl, displayGroup, tabIndex)) {
                 gl->getColor(labelRGBA);
                 if (labelRGBA[3] > 0.0) {
-                    const int64_t i4 = i * 4;
-                    
-                    switch (colorDataType) {
-                        case COLOR_TYPE_FLOAT:
-                            CaretAssertArrayIndex(rgbaFloat, numberOfIndices * 4, i*4+3);
-                            rgbaFloat[i*4] = labelRGBA[0];
-                            rgbaFloat[i*4+1] = labelRGBA[1];
-                            rgbaFloat[i*4+2] = labelRGBA[2];
-                            rgbaFloat[i*4+3] = labelRGBA[3];
-                            break;
-                        case COLOR_TYPE_UNSIGNED_BTYE:
-                            CaretAssertArrayIndex(rgbaUnsignedByte, numberOfIndices * 4, i*4+3);
-                            rgbaUnsignedByte[i4]   = labelRGBA[0] * 255.0;
-                            rgbaUnsignedByte[i4+1] = labelRGBA[1] * 255.0;
-                            rgbaUnsignedByte[i4+2] = labelRGBA[2] * 255.0;
-                            if (labelRGBA[3] > 0.0) {
-                                rgbaUnsignedByte[i4+3] = labelRGBA[3] * 255.0;
-                            }
-                            else {
-                                rgbaUnsignedByte[i4+3] = 0;
-                            }
-                            break;
-                    }
+                    setLabelColor(labelRGBA,
+                                  i,
+                                  colorDataType,
+                                  rgbaFloat,
+                                  rgbaUnsignedByte);
                 }
             }
         }
@@ -30,6 +30,7 @@
 
 namespace caret {
     class FastStatistics;
+    class GiftiLabel;
     class GiftiLabelTable;
     class PaletteColorMapping;
     
@@ -125,6 +126,24 @@ namespace caret {
                                                       const ColorDataType colorDataType,
                                                       void* rgbaOutPointer);
         
+        static void colorIndicesWithLabelTableSparse(const GiftiLabelTable* labelTable,
+                                                     const float* labelIndices,
+                                                     const int64_t numberOfIndices,
+                                                     const DisplayGroupEnum::Enum displayGroup,
+                                                     const int32_t tabIndex,
+                                                     const ColorDataType colorDataType,
+                                                     void* rgbaOutPointer);
+        
+        static bool isLabelColored(const GiftiLabel* gl,
+                                   const DisplayGroupEnum::Enum displayGroup,
+                                   const int32_t tabIndex);
+        
+        static void setLabelColor(const float labelRGBA[4],
+                                  const int64_t i,
+                                  const ColorDataType colorDataType,
+                                  float* rgbaFloat,
+                                  uint8_t* rgbaUnsignedByte);
+        
         static void colorScalarsWithRGBAPrivate(const float* redComponents,
                                                 const float* greenComponents,
                                                 const float* blueComponents,
@@ -43,10 +43,13 @@
 using namespace std;
 using namespace caret;
 
+const int SurfaceResamplingHelper::BATCH_SIZE;//min() takes a reference, so this needs a definition
+
 SurfaceResamplingHelper::SurfaceResamplingHelper(const SurfaceResamplingMethodEnum::Enum& myMethod, const SurfaceFile* currentSphere, const SurfaceFile* newSphere,
                                                  const float* currentAreas, const float* newAreas, const float* currentRoi, const bool allowNonSphere)
 {
     m_nonsphereAllowed = allowNonSphere;
+    m_numInputNodes = currentSphere->getNumberOfNodes();
     SurfaceFile currentSphereMod, newSphereMod;
     const SurfaceFile* useCurrent = currentSphere, *useNew = newSphere;
     if (!allowNonSphere)
@@ -202,6 +205,171 @@ void SurfaceResamplingHelper::resampleLargest(const int32_t* input, int32_t* out
     }
 }
 
+void SurfaceResamplingHelper::resampleNormal(const vector<const float*>& inputs, const vector<float*>& outputs, const float& invalidVal) const
+{
+    CaretAssert(inputs.size() == outputs.size());
+    int numNodes = (int)m_weights.size() - 1, numColumns = (int)inputs.size();
+    vector<float> interleaved;
+    for (int batchStart = 0; batchStart < numColumns; batchStart += BATCH_SIZE)
+    {
+        const int batchCols = min(BATCH_SIZE, numColumns - batchStart);
+        interleaved.resize((size_t)m_numInputNodes * batchCols);
+#pragma omp CARET_PARFOR schedule(static)
+        for (int n = 0; n < m_numInputNodes; ++n)
+        {
+            float* dest = interleaved.data() + (size_t)n * batchCols;
+            for (int c = 0; c < batchCols; ++c)
+            {
+                dest[c] = inputs[batchStart + c][n];
+            }
+        }
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+        for (int i = 0; i < numNodes; ++i)
+        {
+            WeightElem* end = m_weights[i + 1], *elem = m_weights[i];
+            if (elem != end)
+            {
+                double accum[BATCH_SIZE];
+                for (int c = 0; c < batchCols; ++c)
+                {
+                    accum[c] = 0.0;
+                }
+                for (; elem != end; ++elem)
+                {
+                    const float* inVals = interleaved.data() + (size_t)elem->node * batchCols;
+                    for (int c = 0; c < batchCols; ++c)
+                    {
+                        accum[c] += inVals[c] * elem->weight;//same arithmetic as the single column version, so results are identical
+                    }
+                }
+                for (int c = 0; c < batchCols; ++c)
+                {
+                    outputs[batchStart + c][i] = accum[c];
+                }
+            } else {
+                for (int c = 0; c < batchCols; ++c)
+                {
+                    outputs[batchStart + c][i] = invalidVal;
+                }
+            }
+        }
+    }
+}
+
+void SurfaceResamplingHelper::resamplePopular(const vector<const int32_t*>& inputs, const vector<int32_t*>& outputs, const int32_t& invalidVal) const
+{
+    CaretAssert(inputs.size() == outputs.size());
+    int numNodes = (int)m_weights.size() - 1, numColumns = (int)inputs.size();
+    vector<int32_t> interleaved;
+    for (int batchStart = 0; batchStart < numColumns; batchStart += BATCH_SIZE)
+    {
+        const int batchCols = min(BATCH_SIZE, numColumns - batchStart);
+        interleaved.resize((size_t)m_numInputNodes * batchCols);
+#pragma omp CARET_PARFOR schedule(static)
+        for (int n = 0; n < m_numInputNodes; ++n)
+        {
+            int32_t* dest = interleaved.data() + (size_t)n * batchCols;
+            for (int c = 0; c < batchCols; ++c)
+            {
+                dest[c] = inputs[batchStart + c][n];
+            }
+        }
+#pragma omp CARET_PAR
+        {
+            vector<pair<int32_t, float> > accum;//only a handful of weights per vertex, so a linear search beats a map
+#pragma omp CARET_FOR schedule(dynamic, 64)
+            for (int i = 0; i < numNodes; ++i)
+            {
+                WeightElem* start = m_weights[i], *end = m_weights[i + 1];
+                for (int c = 0; c < batchCols; ++c)
+                {
+                    accum.clear();
+                    float maxweight = -1.0f;
+                    int32_t bestlabel = invalidVal;
+                    for (WeightElem* elem = start; elem != end; ++elem)
+                    {
+                        int32_t label = interleaved[(size_t)elem->node * batchCols + c];
+                        size_t which = 0;
+                        while (which < accum.size() && accum[which].first != label) ++which;
+                        if (which == accum.size())
+                        {
+                            accum.push_back(make_pair(label, elem->weight));
+                        } else {
+                            accum[which].second += elem->weight;
+                        }
+                        if (accum[which].second > maxweight)
+                        {
+                            maxweight = accum[which].second;
+                            bestlabel = label;
+                        }
+                    }
+                    outputs[batchStart + c][i] = bestlabel;
+                }
+            }
+        }
+    }
+}
+
+void SurfaceResamplingHelper::resampleLargest(const vector<const float*>& inputs, const vector<float*>& outputs, const float& invalidVal) const
+{
+    CaretAssert(inputs.size() == outputs.size());
+    int numNodes = (int)m_weights.size() - 1, numColumns = (int)inputs.size();
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int i = 0; i < numNodes; ++i)
+    {
+        WeightElem* end = m_weights[i + 1];
+        float largest = -1.0f;
+        int largestNode = -1;
+        for (WeightElem* elem = m_weights[i]; elem != end; ++elem)
+        {
+            if (elem->weight > largest)
+            {
+                largest = elem->weight;
+                largestNode = elem->node;
+            }
+        }
+        for (int c = 0; c < numColumns; ++c)
+        {
+            if (largestNode != -1)
+            {
+                outputs[c][i] = inputs[c][largestNode];
+            } else {
+                outputs[c][i] = invalidVal;
+            }
+        }
+    }
+}
+
+void SurfaceResamplingHelper::resampleLargest(const vector<const int32_t*>& inputs, const vector<int32_t*>& outputs, const int32_t& invalidVal) const
+{
+    CaretAssert(inputs.size() == outputs.size());
+    int numNodes = (int)m_weights.size() - 1, numColumns = (int)inputs.size();
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int i = 0; i < numNodes; ++i)
+    {
+        WeightElem* end = m_weights[i + 1];
+        float largest = -1.0f;
+        int largestNode = -1;
+        for (WeightElem* elem = m_weights[i]; elem != end; ++elem)
+        {
+            if (elem->weight > largest)
+            {
+                largest = elem->weight;
+                largestNode = elem->node;
+            }
+        }
+        for (int c = 0; c < numColumns; ++c)
+        {
+            if (largestNode != -1)
+            {
+                outputs[c][i] = inputs[c][largestNode];
+            } else {
+                outputs[c][i] = invalidVal;
+            }
+        }
+    }
+}
+
 void SurfaceResamplingHelper::getResampleValidROI(float* output) const
 {
     int numNodes = (int)m_weights.size() - 1;
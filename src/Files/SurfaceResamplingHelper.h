@@ -43,6 +43,8 @@ namespace caret {
         CaretArray<WeightElem> m_storagechunk;
         CaretArray<WeightElem*> m_weights;
         bool m_nonsphereAllowed;
+        int m_numInputNodes;
+        static const int BATCH_SIZE = 16;//columns per batch in the batched functions, also sizes their per-vertex stack arrays
         static bool checkSphere(const SurfaceFile* surface);
         static void changeRadius(const float& radius, const SurfaceFile* input, SurfaceFile* output);
         void computeWeightsAdapBaryArea(const SurfaceFile* currentSphere, const SurfaceFile* newSphere, const float* currentAreas, const float* newAreas, const float* currentRoi);
@@ -50,7 +52,7 @@ namespace caret {
         void makeBarycentricWeights(const SurfaceFile* from, const SurfaceFile* to, std::vector<std::map<int, float> >& weights, const float* currentRoi);
         void compactWeights(const std::vector<std::map<int, float> >& weights);
     public:
-        SurfaceResamplingHelper() { }
+        SurfaceResamplingHelper() { m_numInputNodes = 0; }
         SurfaceResamplingHelper(const SurfaceResamplingMethodEnum::Enum& myMethod, const SurfaceFile* currentSphere, const SurfaceFile* newSphere,
                                 const float* currentAreas = NULL, const float* newAreas = NULL, const float* currentRoi = NULL, const bool allowNonSphere = false);
         ///resample real-valued data by means of weights
@@ -63,6 +65,17 @@ namespace caret {
         void resampleLargest(const float* input, float* output, const float& invalidVal = 0.0f) const;
         ///resample int data according to what weight is largest
         void resampleLargest(const int32_t* input, int32_t* output, const int32_t& invalidVal = 0) const;
+        
+        ///number of columns the batch functions interleave at a time, callers that buffer outputs should use multiples of this
+        static int getBatchSize() { return BATCH_SIZE; }
+        ///resample several columns at once, reading the weights once per batch and interleaving the input columns so the gathers are contiguous
+        void resampleNormal(const std::vector<const float*>& inputs, const std::vector<float*>& outputs, const float& invalidVal = 0.0f) const;
+        ///batched version of resamplePopular
+        void resamplePopular(const std::vector<const int32_t*>& inputs, const std::vector<int32_t*>& outputs, const int32_t& invalidVal = 0) const;
+        ///batched version of resampleLargest, the largest weight is found once per vertex for all columns
+        void resampleLargest(const std::vector<const float*>& inputs, const std::vector<float*>& outputs, const float& invalidVal = 0.0f) const;
+        void resampleLargest(const std::vector<const int32_t*>& inputs, const std::vector<int32_t*>& outputs, const int32_t& invalidVal = 0) const;
+        
         ///get the ROI of nodes that have data within the input ROI
         void getResampleValidROI(float* output) const;
         
@@ -0,0 +1,164 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "SurfaceSmoothingHelper.h"
+
+#include "CaretOMP.h"
+#include "SurfaceFile.h"
+#include "TopologyHelper.h"
+
+#include <cmath>
+
+using namespace caret;
+using namespace std;
+
+SurfaceSmoothingHelper::SurfaceSmoothingHelper(const SurfaceFile* mySurf)
+{
+    m_numNodes = mySurf->getNumberOfNodes();
+    CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper(true);//must be sorted, smoothing uses consecutive neighbors as triangles
+    m_neighborStart.resize(m_numNodes + 1);
+    m_neighborStart[0] = 0;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        int32_t numNeighbors = 0;
+        myTopoHelp->getNodeNeighbors(i, numNeighbors);
+        m_neighborStart[i + 1] = m_neighborStart[i] + numNeighbors;
+    }
+    m_neighbors.resize(m_neighborStart[m_numNodes]);
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        int32_t numNeighbors = 0;
+        const int32_t* neighbors = myTopoHelp->getNodeNeighbors(i, numNeighbors);
+        for (int32_t j = 0; j < numNeighbors; ++j)
+        {
+            m_neighbors[m_neighborStart[i] + j] = neighbors[j];
+        }
+    }
+    for (int buf = 0; buf < 2; ++buf)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            m_coords[buf][axis].resize(m_numNodes);
+        }
+    }
+    m_current = 0;
+    setCoordinates(mySurf->getCoordinateData());
+}
+
+void SurfaceSmoothingHelper::smooth(const float& strength, const int32_t& iterations)
+{
+    const float inverseStrength = 1.0f - strength;
+    for (int32_t iter = 0; iter < iterations; ++iter)
+    {
+        const float* inX = m_coords[m_current][0].data(), *inY = m_coords[m_current][1].data(), *inZ = m_coords[m_current][2].data();
+        float* outX = m_coords[1 - m_current][0].data(), *outY = m_coords[1 - m_current][1].data(), *outZ = m_coords[1 - m_current][2].data();
+        const int32_t* neighborStart = m_neighborStart.data();
+        const int32_t* allNeighbors = m_neighbors.data();
+#pragma omp CARET_PARFOR schedule(dynamic, 1024)
+        for (int32_t node = 0; node < m_numNodes; ++node)
+        {
+            const int32_t* neighbors = allNeighbors + neighborStart[node];
+            const int32_t numNeighbors = neighborStart[node + 1] - neighborStart[node];
+            if (numNeighbors < 2)
+            {
+                outX[node] = inX[node];
+                outY[node] = inY[node];
+                outZ[node] = inZ[node];
+                continue;
+            }
+            const float x1 = inX[node], y1 = inY[node], z1 = inZ[node];
+            double totalArea = 0.0;
+            float sumX = 0.0f, sumY = 0.0f, sumZ = 0.0f;//area weighted sums of triangle centers, divided by total area afterwards
+            for (int32_t j = 0; j < numNeighbors; ++j)
+            {
+                const int32_t n1 = neighbors[j];
+                const int32_t n2 = neighbors[(j + 1 < numNeighbors) ? j + 1 : 0];
+                const float x2 = inX[n1], y2 = inY[n1], z2 = inZ[n1];
+                const float x3 = inX[n2], y3 = inY[n2], z3 = inZ[n2];
+                //same formula as MathFunctions::triangleArea()
+                float dx = x1 - x2, dy = y1 - y2, dz = z1 - z2;
+                const double a = dx * dx + dy * dy + dz * dz;
+                dx = x2 - x3; dy = y2 - y3; dz = z2 - z3;
+                const double b = dx * dx + dy * dy + dz * dz;
+                dx = x3 - x1; dy = y3 - y1; dz = z3 - z1;
+                const double c = dx * dx + dy * dy + dz * dz;
+                const float area = (float)(0.25f * sqrt(abs(4.0 * a * c - (a - b + c) * (a - b + c))));
+                if (area > 0.0f)
+                {
+                    totalArea += area;
+                    sumX += area * ((x1 + x2 + x3) / 3.0f);
+                    sumY += area * ((y1 + y2 + y3) / 3.0f);
+                    sumZ += area * ((z1 + z2 + z3) / 3.0f);
+                }
+            }
+            float avgX = 0.0f, avgY = 0.0f, avgZ = 0.0f;
+            if (totalArea > 0.0)
+            {
+                avgX = sumX / totalArea;
+                avgY = sumY / totalArea;
+                avgZ = sumZ / totalArea;
+            }
+            outX[node] = x1 * inverseStrength + avgX * strength;
+            outY[node] = y1 * inverseStrength + avgY * strength;
+            outZ[node] = z1 * inverseStrength + avgZ * strength;
+        }
+        m_current = 1 - m_current;
+    }
+}
+
+void SurfaceSmoothingHelper::inflate(const float& rangeX, const float& rangeY, const float& rangeZ, const float& inflationFactor)
+{
+    float* coordX = m_coords[m_current][0].data(), *coordY = m_coords[m_current][1].data(), *coordZ = m_coords[m_current][2].data();
+#pragma omp CARET_PARFOR schedule(static)
+    for (int32_t node = 0; node < m_numNodes; ++node)
+    {
+        const float x = coordX[node] / rangeX;
+        const float y = coordY[node] / rangeY;
+        const float z = coordZ[node] / rangeZ;
+        const float radius = sqrt(x * x + y * y + z * z);
+        const float scale = 1.0 + inflationFactor * (1.0 - radius);
+        coordX[node] *= scale;
+        coordY[node] *= scale;
+        coordZ[node] *= scale;
+    }
+}
+
+void SurfaceSmoothingHelper::getCoordinates(vector<float>& coordsOut) const
+{
+    coordsOut.resize(m_numNodes * 3);
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            coordsOut[i * 3 + axis] = m_coords[m_current][axis][i];
+        }
+    }
+}
+
+void SurfaceSmoothingHelper::setCoordinates(const float* coordsIn)
+{
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            m_coords[m_current][axis][i] = coordsIn[i * 3 + axis];
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef __SURFACE_SMOOTHING_HELPER_H__
+#define __SURFACE_SMOOTHING_HELPER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <cstdint>
+#include <vector>
+
+namespace caret
+{
+
+    class SurfaceFile;
+    
+    ///iterative area weighted smoothing of surface coordinates, neighbors are packed into one array, and coordinates are stored per axis and double buffered so each iteration can be done in parallel
+    class SurfaceSmoothingHelper
+    {
+        std::vector<int32_t> m_neighborStart;//index into m_neighbors of each node's first neighbor, has numNodes + 1 elements
+        std::vector<int32_t> m_neighbors;//neighbors of all nodes, in the order given by the topology helper
+        std::vector<float> m_coords[2][3];//[buffer][axis]
+        int m_current;//buffer containing the current coordinates
+        int32_t m_numNodes;
+    public:
+        SurfaceSmoothingHelper(const SurfaceFile* mySurf);
+        
+        ///perform smoothing iterations, each node moves toward the area weighted average of the centers of its triangles
+        void smooth(const float& strength, const int32_t& iterations = 1);
+        
+        ///move the nodes away from the center, scaled per axis by the given ranges, as done by surface inflation
+        void inflate(const float& rangeX, const float& rangeY, const float& rangeZ, const float& inflationFactor);
+        
+        void getCoordinates(std::vector<float>& coordsOut) const;
+        
+        void setCoordinates(const float* coordsIn);
+        
+        int32_t getNumberOfNodes() const { return m_numNodes; }
+    };
+    
+}
+
+#endif //__SURFACE_SMOOTHING_HELPER_H__
@@ -528,13 +528,11 @@ VolumeDynamicConnectivityFile::getConnectivityCorrelationTwo() const
 {
     if ( ! m_connectivityCorrelationFailedFlag) {
         /**
-         * Need to recreate correlation algorithm if settins have changed
+         * Update correlation algorithm if settings have changed
          */
         if (m_connectivityCorrelationTwo != NULL) {
             if (*m_correlationSettings != *m_connectivityCorrelationTwo->getSettings()) {
-                m_connectivityCorrelationTwo.reset();
-                CaretLogFine("Recreating correlation algorithm for "
-                             + getFileName());
+                m_connectivityCorrelationTwo->setSettings(*m_correlationSettings);
             }
         }
         if (m_connectivityCorrelationTwo == NULL) {
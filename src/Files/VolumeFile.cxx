@@ -25,6 +25,7 @@
 #include <sstream>
 #include <string>
 
+#include <QFileInfo>
 #include <QTemporaryFile>
 
 #include "ApplicationInformation.h"
@@ -61,6 +62,7 @@ using namespace std;
 
 const float VolumeFile::INVALID_INTERP_VALUE = 0.0f;//we may want NaN or something more obvious
 bool VolumeFile::s_voxelColoringEnabled = true;
+int64_t VolumeFile::s_onDemandCacheBytes = 0;
 const AString VolumeFile::s_paletteColorMappingNameInMetaData = "__DYNAMIC_FILE_PALETTE_COLOR_MAPPING__";
 
 /**
@@ -83,6 +85,100 @@ VolumeFile::setVoxelColoringEnabled(const bool enabled)
                            : "Volume coloring is disabled."));
 }
 
+/**
+ * Static method that sets the memory limit for reading volume files on demand.
+ * When nonzero, a local, uncompressed volume file with more voxel data than this
+ * is not read into memory when opened.  Instead, each frame is read from the
+ * file when it is first used, and least recently used frames are discarded to
+ * stay within this many bytes.  Modifying the voxels reads the entire file.
+ *
+ * Only affects files read after this call.
+ *
+ * @param bytes
+ *    Memory limit in bytes, 0 (the default) reads all files into memory.
+ */
+void
+VolumeFile::setOnDemandFrameCacheBytes(const int64_t bytes)
+{
+    s_onDemandCacheBytes = max(int64_t(0), bytes);
+    
+    CaretLogConfig(s_onDemandCacheBytes > 0
+                   ? "Large volume files are read on demand, frame cache limit is " + AString::number(s_onDemandCacheBytes / (1024 * 1024)) + " MB."
+                   : AString("Volume files are read entirely into memory."));
+}
+
+/**
+ * @return The memory limit for reading volume files on demand, 0 if disabled.
+ */
+int64_t
+VolumeFile::getOnDemandFrameCacheBytes()
+{
+    return s_onDemandCacheBytes;
+}
+
+namespace
+{
+    ///keeps a nifti file open to read bricks from for on-demand volume storage
+    class NiftiFrameReader : public AbstractVolumeFrameReader
+    {
+        NiftiIO m_io;//readData has its own mutex
+        int m_fullDims, m_numComponents;
+        int64_t m_frameSize;
+        
+        vector<int64_t> getExtraIndexes(int64_t brickIndex) const
+        {//first non-spatial dimension changes fastest, same as VolumeBase::getBrickIndexFromNonSpatialIndexes
+            const vector<int64_t>& dims = m_io.getDimensions();
+            vector<int64_t> ret;
+            for (int i = 3; i < (int)dims.size(); ++i)
+            {
+                ret.push_back(brickIndex % dims[i]);
+                brickIndex /= dims[i];
+            }
+            return ret;
+        }
+    public:
+        NiftiFrameReader(const AString& filename)
+        {
+            m_io.openRead(filename);
+            const vector<int64_t>& dims = m_io.getDimensions();
+            m_fullDims = min(3, (int)dims.size());
+            m_numComponents = m_io.getNumComponents();
+            m_frameSize = 1;
+            for (int i = 0; i < m_fullDims; ++i)
+            {
+                m_frameSize *= dims[i];
+            }
+        }
+        
+        void readBrick(const int64_t& brickIndex, float* const* componentFramesOut) override
+        {
+            if (m_numComponents == 1)
+            {
+                m_io.readData(componentFramesOut[0], m_fullDims, getExtraIndexes(brickIndex));
+                return;
+            }
+            vector<float> readBuffer(m_frameSize * m_numComponents);
+            m_io.readData(readBuffer.data(), m_fullDims, getExtraIndexes(brickIndex));
+            for (int c = 0; c < m_numComponents; ++c)
+            {
+                float* frameOut = componentFramesOut[c];
+                for (int64_t i = 0; i < m_frameSize; ++i)
+                {
+                    frameOut[i] = readBuffer[i * m_numComponents + c];
+                }
+            }
+        }
+        
+        void readVoxel(const int64_t indexIn[3], const int64_t& brickIndex, float* componentValuesOut) override
+        {
+            vector<int64_t> indexSelect(indexIn, indexIn + m_fullDims);
+            vector<int64_t> extraIndexes = getExtraIndexes(brickIndex);
+            indexSelect.insert(indexSelect.end(), extraIndexes.begin(), extraIndexes.end());
+            m_io.readData(componentValuesOut, 0, indexSelect);
+        }
+    };
+}
+
 /** protected, used by dynamic volume file */
 VolumeFile::VolumeFile(const DataFileTypeEnum::Enum dataFileType)
 : VolumeBase(),
@@ -322,7 +418,13 @@ void VolumeFile::readFile(const AString& filename)
         reinitialize(myDims, inHeader.getSForm(), numComponents);
         setFileName(filename);  // must be done after reinitialize() since it calls clear() which clears the name of the file
         int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
-        if (numComponents != 1)
+        const int64_t dataBytes = frameSize * getDimensionsPtr()[3] * numComponents * sizeof(float);
+        if (s_onDemandCacheBytes > 0 && dataBytes > s_onDemandCacheBytes && fileToRead == filename && !filename.endsWith(".gz"))
+        {//seeking in a gzipped file means decompressing everything before that point, and a network file is in a temporary file that will be deleted
+            CaretPointer<AbstractVolumeFrameReader> myReader(new NiftiFrameReader(fileToRead));
+            setReadingOnDemand(myReader, s_onDemandCacheBytes);
+            CaretLogInfo("Reading frames of volume file " + filename + " on demand.");
+        } else if (numComponents != 1)
         {
             vector<float> tempFrame(frameSize), readBuffer(frameSize * numComponents);
             for (MultiDimIterator<int64_t> myiter(extraDims); !myiter.atEnd(); ++myiter)
@@ -397,6 +499,11 @@ VolumeFile::writeFile(const AString& filename)
                                 "writing multi-component volumes is not currently supported");//its a hassle, and uncommon, and there is only one 3-component type, restricted to 0-255
     }
     
+    if (isReadingOnDemand() && QFileInfo(filename).canonicalFilePath() == QFileInfo(getFileName()).canonicalFilePath())
+    {//overwriting the file that frames are being read from, so read them all first
+        loadAllOnDemandData();
+    }
+    
     /*
      * Put the child dynamic data-series file's palette in the file's metadata.
      */
@@ -1208,12 +1315,18 @@ const FastStatistics*
 VolumeFile::getFileFastStatistics()
 {
     if (m_fileFastStatistics == NULL) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        if ( ! fileData.empty()) {
+        int64_t dimI, dimJ, dimK, dimTime, dimComp;
+        getDimensions(dimI, dimJ, dimK, dimTime, dimComp);
+        if ((dimI * dimJ * dimK * dimTime * dimComp) > 0) {
+            /*
+             * Frames are processed in parallel so that the
+             * entire file is never copied
+             */
             m_fileFastStatistics.grabNew(new FastStatistics());
-            m_fileFastStatistics->update(&fileData[0],
-                                         fileData.size());
+            m_fileFastStatistics->update(dimTime,
+                                         [this](const int64_t& frameIndex, std::vector<float>& frameDataOut) {
+                                             getFileDataFrame(frameIndex, frameDataOut);
+                                         });
         }
     }
     
@@ -1245,15 +1358,17 @@ VolumeFile::getFileHistogram()
     }
     
     if (updateHistogramFlag) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        if ( ! fileData.empty()) {
+        int64_t dimI, dimJ, dimK, dimTime, dimComp;
+        getDimensions(dimI, dimJ, dimK, dimTime, dimComp);
+        if ((dimI * dimJ * dimK * dimTime * dimComp) > 0) {
             if (m_fileHistogram == NULL) {
                 m_fileHistogram.grabNew(new Histogram(numBuckets));
             }
             m_fileHistogram->update(numBuckets,
-                                    &fileData[0],
-                                    fileData.size());
+                                    dimTime,
+                                    [this](const int64_t& frameIndex, std::vector<float>& frameDataOut) {
+                                        getFileDataFrame(frameIndex, frameDataOut);
+                                    });
             m_fileHistogramNumberOfBuckets = numBuckets;
         }
     }
@@ -1304,15 +1419,17 @@ VolumeFile::getFileHistogram(const float mostPositiveValueInclusive,
     }
     
     if (updateHistogramFlag) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        if ( ! fileData.empty()) {
+        int64_t dimI, dimJ, dimK, dimTime, dimComp;
+        getDimensions(dimI, dimJ, dimK, dimTime, dimComp);
+        if ((dimI * dimJ * dimK * dimTime * dimComp) > 0) {
             if (m_fileHistorgramLimitedValues == NULL) {
                 m_fileHistorgramLimitedValues.grabNew(new Histogram());
             }
             m_fileHistorgramLimitedValues->update(numberOfBuckets,
-                                                  &fileData[0],
-                                                  fileData.size(),
+                                                  dimTime,
+                                                  [this](const int64_t& frameIndex, std::vector<float>& frameDataOut) {
+                                                      getFileDataFrame(frameIndex, frameDataOut);
+                                                  },
                                                   mostPositiveValueInclusive,
                                                   leastPositiveValueInclusive,
                                                   leastNegativeValueInclusive,
@@ -1388,6 +1505,37 @@ VolumeFile::getFileData(std::vector<float>& dataOut) const
     CaretAssert(dataOffset == static_cast<int64_t>(dataOut.size()));
 }
 
+/**
+ * Get the data for one frame (map) of the volume file.  Used
+ * when computing statistics and histograms for the file one
+ * frame at a time and may be called from multiple threads.
+ *
+ * @param frameIndex
+ *    Index of the frame.
+ * @param frameDataOut
+ *    Output with data for the frame (all components).
+ */
+void
+VolumeFile::getFileDataFrame(const int64_t frameIndex,
+                             std::vector<float>& frameDataOut) const
+{
+    int64_t dimI, dimJ, dimK, dimTime, dimComp;
+    getDimensions(dimI, dimJ, dimK, dimTime, dimComp);
+    const int64_t frameSize = dimI * dimJ * dimK;
+    frameDataOut.resize(frameSize * dimComp);
+    for (int64_t iComp = 0; iComp < dimComp; iComp++) {
+        /*
+         * Pin the frame, other threads may be reading frames
+         * that would otherwise evict it when reading on demand.
+         */
+        VolumeFramePin framePin;
+        const float* frameData = getFrame(frameIndex, iComp, framePin);
+        std::copy(frameData,
+                  frameData + frameSize,
+                  frameDataOut.begin() + iComp * frameSize);
+    }
+}
+
 /**
  * @return Is the data in the file mapped to colors using
  * a palette.
@@ -1730,7 +1878,12 @@ VolumeFile::updateScalarColoringForMap(const int32_t mapIndex)
     CaretAssertVectorIndex(m_caretVolExt.m_attributes, mapIndex);
     CaretAssert(m_voxelColorizer);
 
-    m_voxelColorizer->assignVoxelColorsForMap(mapIndex);
+    /*
+     * A map that has not been colored recently is colored when it is next displayed
+     */
+    if (m_voxelColorizer->isMapColoringAllocated(mapIndex)) {
+        m_voxelColorizer->assignVoxelColorsForMap(mapIndex);
+    }
 
     m_graphicsPrimitiveManager->invalidateColoringForMap(mapIndex);
     
@@ -2143,14 +2296,18 @@ VolumeFile::getDataRangeFromAllMaps(float& dataRangeMinimumOut,
     m_dataRangeMinimum = std::numeric_limits<float>::max();
     
     const int64_t* dimensions = getDimensionsPtr();
-    int64_t m_dataSize = dimensions[0] * dimensions[1] * dimensions[2] * dimensions[3] * dimensions[4];
-    const float* data = getFrame();//HACK: use first frame knowing all data is contiguous after it
-    for (int64_t i = 0; i < m_dataSize; i++) {
-        if (data[i] > m_dataRangeMaximum) {
-            m_dataRangeMaximum = data[i];
-        }
-        if (data[i] < m_dataRangeMinimum) {
-            m_dataRangeMinimum = data[i];
+    const int64_t frameSize = dimensions[0] * dimensions[1] * dimensions[2];
+    for (int64_t c = 0; c < dimensions[4]; c++) {
+        for (int64_t b = 0; b < dimensions[3]; b++) {
+            const float* data = getFrame(b, c);//frames are not contiguous when reading on demand
+            for (int64_t i = 0; i < frameSize; i++) {
+                if (data[i] > m_dataRangeMaximum) {
+                    m_dataRangeMaximum = data[i];
+                }
+                if (data[i] < m_dataRangeMinimum) {
+                    m_dataRangeMinimum = data[i];
+                }
+            }
         }
     }
     
@@ -2600,11 +2757,9 @@ VolumeFile::loadLineSeriesChartDataForVoxelAtCoordinate(const float xyz[3])
                        ijk);
         
         if (indexValid(ijk)) {
-            std::vector<float> data;
-            
-            const int32_t numMaps = getNumberOfMaps();
-            for (int32_t iMap = 0; iMap < numMaps; iMap++) {
-                data.push_back(getValue(ijk, iMap));
+            std::vector<float> data(getNumberOfMaps());
+            if ( ! data.empty()) {
+                getValueAllBricks(ijk, data.data());
             }
             
             try {
@@ -2662,9 +2817,9 @@ VolumeFile::getDataForSelector(const MapFileDataSelector& mapFileDataSelector,
                                ijk);
                 
                 if (indexValid(ijk)) {
-                    const int32_t numMaps = getNumberOfMaps();
-                    for (int32_t iMap = 0; iMap < numMaps; iMap++) {
-                        dataOut.push_back(getValue(ijk, iMap));
+                    dataOut.resize(getNumberOfMaps());
+                    if ( ! dataOut.empty()) {
+                        getValueAllBricks(ijk, dataOut.data());
                     }
                 }
             }
@@ -137,6 +137,9 @@ namespace caret {
         CaretPointer<VolumeFileEditorDelegate> m_volumeFileEditorDelegate;
         
         static const AString s_paletteColorMappingNameInMetaData;
+        
+        /** Memory limit for frames of volume files read on demand, 0 reads all data into memory */
+        static int64_t s_onDemandCacheBytes;
 
         int16_t m_writingDType;
 
@@ -169,6 +172,10 @@ namespace caret {
         
         static void setVoxelColoringEnabled(const bool enabled);
         
+        static void setOnDemandFrameCacheBytes(const int64_t bytes);
+        
+        static int64_t getOnDemandFrameCacheBytes();
+        
         VolumeFile();
         VolumeFile(const std::vector<int64_t>& dimensionsIn, const std::vector<std::vector<float> >& indexToSpace, const int64_t numComponents = 1,
                    SubvolumeAttributes::VolumeType whatType = SubvolumeAttributes::ANATOMY, const AbstractHeader* templateHeader = NULL);
@@ -306,6 +313,9 @@ namespace caret {
         
         void getFileData(std::vector<float>& dataOut) const;
         
+        void getFileDataFrame(const int64_t frameIndex,
+                              std::vector<float>& frameDataOut) const;
+        
         bool isMappedWithPalette() const;
         
         virtual void getPaletteNormalizationModesSupported(std::vector<PaletteNormalizationModeEnum::Enum>& modesSupportedOut) const;
@@ -33,15 +33,37 @@
 #include "VolumeFile.h"
 #include "VoxelColorUpdate.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
 
-
+namespace {
+    /**
+     * Memory for map coloring, beyond this the least recently used
+     * map's coloring is released and recreated if the map is displayed again.
+     */
+    const int64_t MAXIMUM_COLORING_BYTES = 512 * 1024 * 1024;
+    
+    /** Maps that may be colored at one time regardless of memory */
+    const int64_t MINIMUM_ALLOCATED_MAP_COUNT = 16;
+    
+    /**
+     * A map used this recently is assumed to be displayed (montage, several tabs)
+     * and is not released, so drawing more maps than the limit does not recolor every frame
+     */
+    const double RECENTLY_USED_SECONDS = 2.0;
+}
     
 /**
  * \class caret::VolumeFileVoxelColorizer 
  * \brief Delegate for coloring a volumes voxels.
+ *
+ * A map's RGBA is not allocated until the map is colored, and only a
+ * limited number of maps keep their coloring, so a series with many maps
+ * does not need an RGBA copy of every map.  Maps that have been used
+ * recently are kept even beyond the limit so that displaying many maps
+ * at once does not release and recolor them on every redraw.
  */
 
 /**
@@ -67,9 +89,18 @@ VolumeFileVoxelColorizer::VolumeFileVoxelColorizer(VolumeFile* volumeFile)
     m_voxelCountPerMap = m_dimI * m_dimJ * m_dimK;
     m_mapRGBACount = m_voxelCountPerMap * 4;
     
-    for (int64_t i = 0; i < m_mapCount; i++) {
-        m_mapRGBA.push_back(new uint8_t[m_mapRGBACount]);
-        m_mapColoringValid.push_back(false);
+    m_mapRGBA.resize(m_mapCount, NULL);
+    m_mapColoringValid.resize(m_mapCount, false);
+    m_mapLastUsed.resize(m_mapCount, 0);
+    m_mapLastUsedSeconds.resize(m_mapCount, 0.0);
+    m_mapUseCounter = 0;
+    m_usageTimer.start();
+    m_allocatedMapCount = 0;
+    
+    m_maximumAllocatedMapCount = MINIMUM_ALLOCATED_MAP_COUNT;
+    if (m_mapRGBACount > 0) {
+        m_maximumAllocatedMapCount = std::max(m_maximumAllocatedMapCount,
+                                              MAXIMUM_COLORING_BYTES / m_mapRGBACount);
     }
 }
 
@@ -84,6 +115,94 @@ VolumeFileVoxelColorizer::~VolumeFileVoxelColorizer()
     m_mapRGBA.clear();
 }
 
+/**
+ * @return True if the map's RGBA is allocated, which happens when the map
+ * is colored.  A map that is not allocated is colored when its coloring is requested.
+ *
+ * @param mapIndex
+ *     Index of map.
+ */
+bool
+VolumeFileVoxelColorizer::isMapColoringAllocated(const int32_t mapIndex) const
+{
+    CaretAssertVectorIndex(m_mapRGBA, mapIndex);
+    return (m_mapRGBA[mapIndex] != NULL);
+}
+
+/**
+ * Mark a map as used for releasing the least recently used map.
+ *
+ * @param mapIndex
+ *     Index of map.
+ */
+void
+VolumeFileVoxelColorizer::setMapUsed(const int32_t mapIndex) const
+{
+    CaretAssertVectorIndex(m_mapLastUsed, mapIndex);
+    m_mapLastUsed[mapIndex] = ++m_mapUseCounter;
+    m_mapLastUsedSeconds[mapIndex] = m_usageTimer.getElapsedTimeSeconds();
+}
+
+/**
+ * Allocate the RGBA for a map if it is not allocated.  When the maximum
+ * number of maps are allocated, the least recently used map's RGBA
+ * is released and its coloring invalidated.  If that map was used
+ * within the last few seconds it is probably displayed, so no map is
+ * released and more than the maximum number of maps are allocated.
+ *
+ * @param mapIndex
+ *     Index of map.
+ */
+void
+VolumeFileVoxelColorizer::allocateMapRGBA(const int32_t mapIndex) const
+{
+    CaretAssertVectorIndex(m_mapRGBA, mapIndex);
+    setMapUsed(mapIndex);
+    if (m_mapRGBA[mapIndex] != NULL) {
+        return;
+    }
+    
+    const double nowSeconds = m_usageTimer.getElapsedTimeSeconds();
+    while (m_allocatedMapCount >= m_maximumAllocatedMapCount) {
+        int64_t oldestIndex = -1;
+        for (int64_t i = 0; i < m_mapCount; i++) {
+            if (m_mapRGBA[i] != NULL) {
+                if ((oldestIndex < 0)
+                    || (m_mapLastUsed[i] < m_mapLastUsed[oldestIndex])) {
+                    oldestIndex = i;
+                }
+            }
+        }
+        CaretAssert(oldestIndex >= 0);
+        if ((nowSeconds - m_mapLastUsedSeconds[oldestIndex]) < RECENTLY_USED_SECONDS) {
+            break;
+        }
+        delete[] m_mapRGBA[oldestIndex];
+        m_mapRGBA[oldestIndex] = NULL;
+        m_mapColoringValid[oldestIndex] = false;
+        --m_allocatedMapCount;
+    }
+    
+    m_mapRGBA[mapIndex] = new uint8_t[m_mapRGBACount];
+    ++m_allocatedMapCount;
+    clearVoxelColoringForMap(mapIndex);
+}
+
+/**
+ * Get the RGBA for a map after it has been assigned and mark it as used.
+ *
+ * @param mapIndex
+ *     Index of map.
+ */
+const uint8_t*
+VolumeFileVoxelColorizer::getMapRGBA(const int32_t mapIndex) const
+{
+    CaretAssertVectorIndex(m_mapRGBA, mapIndex);
+    CaretAssert(m_mapRGBA[mapIndex]);
+    setMapUsed(mapIndex);
+    return m_mapRGBA[mapIndex];
+}
+
 /**
  * Assign voxel coloring for a map.
  *
@@ -94,6 +213,7 @@ void
 VolumeFileVoxelColorizer::assignVoxelColorsForMap(const int32_t mapIndex) const
 {
     CaretAssertVectorIndex(m_mapRGBA, mapIndex);
+    allocateMapRGBA(mapIndex);
     
     CaretAssertVectorIndex(m_mapColoringValid, mapIndex);
     if ( ! m_mapColoringValid[mapIndex]) {
@@ -353,7 +473,7 @@ VolumeFileVoxelColorizer::getVoxelColorsForSliceInMap(const int32_t mapIndex,
     /*
      * Pointer to maps RGBA values
      */
-    const uint8_t* mapRGBA = m_mapRGBA[mapIndex];
+    const uint8_t* mapRGBA = getMapRGBA(mapIndex);
     
     const GiftiLabelTable* labelTable = (m_volumeFile->isMappedWithLabelTable()
                                          ? m_volumeFile->getMapLabelTable(mapIndex)
@@ -456,7 +576,7 @@ VolumeFileVoxelColorizer::getVoxelColorsForSliceInMap(const int32_t mapIndex,
     /*
      * Pointer to maps RGBA values
      */
-    const uint8_t* mapRGBA = m_mapRGBA[mapIndex];
+    const uint8_t* mapRGBA = getMapRGBA(mapIndex);
     
     const GiftiLabelTable* labelTable = (m_volumeFile->isMappedWithLabelTable()
                                          ? m_volumeFile->getMapLabelTable(mapIndex)
@@ -622,7 +742,7 @@ VolumeFileVoxelColorizer::getVoxelColorsForSubSliceInMap(const int32_t mapIndex,
     /*
      * Pointer to maps RGBA values
      */
-    const uint8_t* mapRGBA = m_mapRGBA[mapIndex];
+    const uint8_t* mapRGBA = getMapRGBA(mapIndex);
     
     const GiftiLabelTable* labelTable = (m_volumeFile->isMappedWithLabelTable()
                                          ? m_volumeFile->getMapLabelTable(mapIndex)
@@ -728,7 +848,7 @@ VolumeFileVoxelColorizer::getVoxelColorInMap(const int64_t i,
      * Pointer to maps RGBA values
      */
     CaretAssertVectorIndex(m_mapRGBA, mapIndex);
-    const uint8_t* mapRGBA = m_mapRGBA[mapIndex];
+    const uint8_t* mapRGBA = getMapRGBA(mapIndex);
     const int64_t rgbaOffset = getRgbaOffsetForVoxelIndex(i, j, k);
     CaretAssertArrayIndex(mapRGBA, m_mapRGBACount, rgbaOffset);
     rgbaOut[0] = mapRGBA[rgbaOffset];
@@ -775,8 +895,10 @@ VolumeFileVoxelColorizer::clearVoxelColoringForMap(const int64_t mapIndex) const
     CaretAssertVectorIndex(m_mapRGBA, mapIndex);
     uint8_t* mapRGBA = m_mapRGBA[mapIndex];
     
-    for (int64_t i = 0; i < m_mapRGBACount; i++) {
-        mapRGBA[i] = 0.0;
+    if (mapRGBA != NULL) {
+        for (int64_t i = 0; i < m_mapRGBACount; i++) {
+            mapRGBA[i] = 0.0;
+        }
     }
     
     CaretAssertVectorIndex(m_mapColoringValid, mapIndex);
@@ -24,6 +24,7 @@
 
 #include "CaretObject.h"
 #include "DisplayGroupEnum.h"
+#include "ElapsedTimer.h"
 #include "VolumeSliceViewPlaneEnum.h"
 #include "VoxelIJK.h"
 
@@ -41,6 +42,8 @@ namespace caret {
         
         void assignVoxelColorsForMap(const int32_t mapIndex) const;
         
+        bool isMapColoringAllocated(const int32_t mapIndex) const;
+        
         int64_t getVoxelColorsForSliceInMap(const int32_t mapIndex,
                                             const int64_t firstVoxelIJK[3],
                                             const int64_t rowStepIJK[3],
@@ -87,6 +90,12 @@ namespace caret {
 
         VolumeFileVoxelColorizer& operator=(const VolumeFileVoxelColorizer&);
         
+        void setMapUsed(const int32_t mapIndex) const;
+        
+        void allocateMapRGBA(const int32_t mapIndex) const;
+        
+        const uint8_t* getMapRGBA(const int32_t mapIndex) const;
+        
         /**
          * Get theRGBA offset for a voxel index
          */
@@ -120,6 +129,22 @@ namespace caret {
         
         mutable std::vector<bool> m_mapColoringValid;
         mutable std::vector<uint8_t*> m_mapRGBA;
+        
+        /** Maximum number of maps with RGBA allocated at one time */
+        int64_t m_maximumAllocatedMapCount;
+        
+        mutable int64_t m_allocatedMapCount;
+        
+        /** Value of m_mapUseCounter when the map's RGBA was last used, for releasing least recently used */
+        mutable std::vector<int64_t> m_mapLastUsed;
+        
+        mutable int64_t m_mapUseCounter;
+        
+        /** Time, from m_usageTimer, when the map's RGBA was last used */
+        mutable std::vector<double> m_mapLastUsedSeconds;
+        
+        /** Times map usage for keeping maps that are displayed */
+        ElapsedTimer m_usageTimer;
     };
     
 #ifdef __VOLUME_FILE_VOXEL_COLORIZER_DECLARE__
@@ -19,6 +19,7 @@
 /*LICENSE_END*/
 
 #include "VolumeBase.h"
+#include "CaretOMP.h"
 #include "DataFileException.h"
 #include "FloatMatrix.h"
 #include "GiftiLabelTable.h"
@@ -28,6 +29,7 @@
 #include "PaletteColorMapping.h"
 #include "Vector3D.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
@@ -37,6 +39,10 @@ AbstractHeader::~AbstractHeader()
 {
 }
 
+AbstractVolumeFrameReader::~AbstractVolumeFrameReader()
+{
+}
+
 void VolumeBase::reinitialize(const vector<int64_t>& dimensionsIn, const vector<vector<float> >& indexToSpace, const int64_t numComponents)
 {
     CaretAssert(numComponents > 0);
@@ -354,10 +360,12 @@ VolumeBase::VolumeStorage::VolumeStorage()
         m_dimensions[i] = 0;
         m_mult[i] = 0;
     }
+    m_brickCacheMax = 0;
 }
 
 void VolumeBase::VolumeStorage::reinitialize(int64_t dims[5])
 {
+    clearOnDemand();
     for (int i = 0; i < 5; ++i)
     {
         CaretAssert(dims[i] > 0);//stop the debugger in the right place
@@ -374,18 +382,174 @@ void VolumeBase::VolumeStorage::reinitialize(int64_t dims[5])
 
 VolumeBase::VolumeStorage::VolumeStorage(int64_t dims[5])
 {
+    m_brickCacheMax = 0;
     reinitialize(dims);
 }
 
+void VolumeBase::VolumeStorage::setOnDemand(const CaretPointer<AbstractVolumeFrameReader>& reader, const int64_t& cacheBytes)
+{
+    CaretAssert(reader != NULL);
+    CaretAssert(m_mult[4] > 0);
+    clearOnDemand();
+    vector<float>().swap(m_data);//actually release the memory
+    m_frameReader = reader;
+    const int64_t brickBytes = m_mult[2] * m_dimensions[4] * sizeof(float);
+    int minBricks = 4;//a caller can use getFrame on a few bricks at once (interpolating between frames, RGB, etc), and each thread may hold one
+#ifdef CARET_OMP
+    minBricks += omp_get_max_threads();
+#endif
+    m_brickCacheMax = max(int64_t(minBricks), cacheBytes / brickBytes);
+    m_brickCache.resize(m_dimensions[3]);
+    m_brickCachePos.resize(m_dimensions[3]);
+}
+
+void VolumeBase::VolumeStorage::clearOnDemand()
+{
+    m_frameReader.grabNew(NULL);
+    vector<shared_ptr<vector<float> > >().swap(m_brickCache);
+    m_brickCacheOrder.clear();
+    m_brickCachePos.clear();
+    m_brickCacheMax = 0;
+}
+
+shared_ptr<vector<float> > VolumeBase::VolumeStorage::getCachedBrick(const int64_t& brickIndex) const
+{
+    CaretAssert(m_frameReader != NULL);
+    CaretAssert(brickIndex >= 0 && brickIndex < m_dimensions[3]);
+    {
+        CaretMutexLocker locked(&m_brickCacheMutex);
+        if (m_brickCache[brickIndex])
+        {
+            if (m_brickCacheOrder.front() != brickIndex)
+            {
+                m_brickCacheOrder.splice(m_brickCacheOrder.begin(), m_brickCacheOrder, m_brickCachePos[brickIndex]);
+            }
+            return m_brickCache[brickIndex];
+        }
+    }
+    //read without holding the lock, so other threads can use cached bricks meanwhile (the reader must be thread-safe anyway)
+    shared_ptr<vector<float> > newBrick(new vector<float>(m_mult[2] * m_dimensions[4]));
+    vector<float*> componentFrames(m_dimensions[4]);
+    for (int64_t c = 0; c < m_dimensions[4]; ++c)
+    {
+        componentFrames[c] = newBrick->data() + c * m_mult[2];
+    }
+    m_frameReader->readBrick(brickIndex, componentFrames.data());//if this throws, nothing was added to the cache
+    CaretMutexLocker locked(&m_brickCacheMutex);
+    if (m_brickCache[brickIndex])
+    {//another thread read it first, use theirs so there is only one copy
+        if (m_brickCacheOrder.front() != brickIndex)
+        {
+            m_brickCacheOrder.splice(m_brickCacheOrder.begin(), m_brickCacheOrder, m_brickCachePos[brickIndex]);
+        }
+        return m_brickCache[brickIndex];
+    }
+    evictForInsert();
+    m_brickCache[brickIndex] = newBrick;
+    m_brickCacheOrder.push_front(brickIndex);
+    m_brickCachePos[brickIndex] = m_brickCacheOrder.begin();
+    return newBrick;
+}
+
+void VolumeBase::VolumeStorage::evictForInsert() const
+{//must be called with m_brickCacheMutex locked
+    list<int64_t>::iterator iter = m_brickCacheOrder.end();
+    while ((int64_t)m_brickCacheOrder.size() >= m_brickCacheMax && iter != m_brickCacheOrder.begin())
+    {
+        --iter;
+        shared_ptr<vector<float> >& candidate = m_brickCache[*iter];
+        if (candidate.use_count() == 1)
+        {//only the cache holds it, and new holders can only be made under the lock
+            candidate.reset();
+            iter = m_brickCacheOrder.erase(iter);
+        }
+    }//if everything is pinned, go over the limit rather than wait, it shrinks again on later inserts
+}
+
+void VolumeBase::VolumeStorage::loadAll()
+{
+    if (m_frameReader == NULL) return;
+    vector<float> newData(m_mult[4]);
+    vector<float*> componentFrames(m_dimensions[4]);
+    for (int64_t b = 0; b < m_dimensions[3]; ++b)
+    {
+        for (int64_t c = 0; c < m_dimensions[4]; ++c)
+        {
+            componentFrames[c] = newData.data() + b * m_mult[2] + c * m_mult[3];
+        }
+        if (!m_brickCache[b])
+        {
+            m_frameReader->readBrick(b, componentFrames.data());
+        } else {
+            const vector<float>& cached = *(m_brickCache[b]);
+            for (int64_t c = 0; c < m_dimensions[4]; ++c)
+            {
+                std::copy(cached.begin() + c * m_mult[2], cached.begin() + (c + 1) * m_mult[2], componentFrames[c]);
+            }
+        }
+    }
+    clearOnDemand();
+    m_data.swap(newData);
+}
+
 const float* VolumeBase::VolumeStorage::getFrame(const int64_t brickIndex, const int64_t component) const
 {
+    if (m_frameReader != NULL)
+    {
+        CaretAssert(component >= 0 && component < m_dimensions[4]);
+        return getCachedBrick(brickIndex)->data() + component * m_mult[2];//the cache still holds it after the returned pointer is released
+    }
+    return m_data.data() + brickIndex * m_mult[2] + component * m_mult[3];//NOTE: do not use [4]
+}
+
+const float* VolumeBase::VolumeStorage::getFrame(const int64_t brickIndex, const int64_t component, VolumeFramePin& pinOut) const
+{
+    if (m_frameReader != NULL)
+    {
+        CaretAssert(component >= 0 && component < m_dimensions[4]);
+        shared_ptr<vector<float> > brick = getCachedBrick(brickIndex);
+        pinOut = brick;
+        return brick->data() + component * m_mult[2];
+    }
+    pinOut.reset();
     return m_data.data() + brickIndex * m_mult[2] + component * m_mult[3];//NOTE: do not use [4]
 }
 
+void VolumeBase::VolumeStorage::getValueAllBricks(const int64_t indexIn[3], const int64_t component, float* valuesOut) const
+{
+    CaretAssert(indexValid(indexIn, 0, component));
+    const int64_t voxelOffset = indexIn[0] + m_mult[0] * indexIn[1] + m_mult[1] * indexIn[2];
+    if (m_frameReader == NULL)
+    {
+        for (int64_t b = 0; b < m_dimensions[3]; ++b)
+        {
+            valuesOut[b] = m_data[voxelOffset + b * m_mult[2] + component * m_mult[3]];
+        }
+        return;
+    }
+    vector<shared_ptr<vector<float> > > cached;
+    {//copy the pointers so the cached bricks stay alive, and the reads can be done without holding the lock
+        CaretMutexLocker locked(&m_brickCacheMutex);
+        cached = m_brickCache;
+    }
+    vector<float> voxelComponents(m_dimensions[4]);
+    for (int64_t b = 0; b < m_dimensions[3]; ++b)
+    {//don't load whole bricks for this, it would push everything else out of the cache
+        if (!cached[b])
+        {
+            m_frameReader->readVoxel(indexIn, b, voxelComponents.data());
+            valuesOut[b] = voxelComponents[component];
+        } else {
+            valuesOut[b] = (*(cached[b]))[voxelOffset + component * m_mult[2]];
+        }
+    }
+}
+
 void VolumeBase::VolumeStorage::setFrame(const float* frameIn, const int64_t brickIndex, const int64_t component)
 {
     CaretAssert(brickIndex >= 0 && brickIndex < m_dimensions[3]);
     CaretAssert(component >= 0 && component < m_dimensions[4]);
+    if (m_frameReader != NULL) loadAll();
     int64_t start = brickIndex * m_mult[2] + component * m_mult[3];
     for (int64_t i = 0; i < m_mult[2]; ++i)
     {
@@ -395,6 +559,11 @@ void VolumeBase::VolumeStorage::setFrame(const float* frameIn, const int64_t bri
 
 void VolumeBase::VolumeStorage::setValueAllVoxels(const float value)
 {
+    if (m_frameReader != NULL)
+    {//nothing to keep, so don't read it
+        clearOnDemand();
+        m_data.resize(m_mult[4]);
+    }
     for (int64_t i = 0; i < m_mult[4]; ++i)
     {
         m_data[i] = value;
@@ -409,6 +578,13 @@ void VolumeBase::VolumeStorage::swap(VolumeStorage& rhs)
         std::swap(m_dimensions[i], rhs.m_dimensions[i]);
         std::swap(m_mult[i], rhs.m_mult[i]);
     }
+    CaretPointer<AbstractVolumeFrameReader> tempReader = m_frameReader;//CaretPointer has no swap
+    m_frameReader = rhs.m_frameReader;
+    rhs.m_frameReader = tempReader;
+    m_brickCache.swap(rhs.m_brickCache);
+    m_brickCacheOrder.swap(rhs.m_brickCacheOrder);//list iterators stay valid through swap
+    m_brickCachePos.swap(rhs.m_brickCachePos);
+    std::swap(m_brickCacheMax, rhs.m_brickCacheMax);
 }
 
 void VolumeBase::VolumeStorage::getDimensions(vector<int64_t>& dimOut) const
@@ -438,6 +614,7 @@ vector<int64_t> VolumeBase::VolumeStorage::getDimensions() const
 
 void VolumeBase::VolumeStorage::clear()
 {
+    clearOnDemand();
     m_data.clear();
     for (int i = 0; i < 5; ++i)
     {
@@ -23,8 +23,11 @@
 /*LICENSE_END*/
 
 #include "stdint.h"
+#include <list>
+#include <memory>
 #include <vector>
 #include "CaretAssert.h"
+#include "CaretMutex.h"
 #include "CaretPointer.h"
 #include "VolumeMappableInterface.h"
 #include "VolumeSpace.h"
@@ -44,6 +47,19 @@ namespace caret {
         virtual ~AbstractHeader();
     };
     
+    ///source of voxel data for on-demand storage, must be safe to call from multiple threads
+    struct AbstractVolumeFrameReader
+    {
+        ///read all components of one brick, componentFramesOut has one frame-sized buffer per component
+        virtual void readBrick(const int64_t& brickIndex, float* const* componentFramesOut) = 0;
+        ///read all components of one voxel from one brick, without reading the whole brick
+        virtual void readVoxel(const int64_t indexIn[3], const int64_t& brickIndex, float* componentValuesOut) = 0;
+        virtual ~AbstractVolumeFrameReader();
+    };
+    
+    ///keeps an on-demand brick from being evicted while a frame pointer into it is in use, empty when the volume is in memory
+    typedef std::shared_ptr<const std::vector<float> > VolumeFramePin;
+    
     class VolumeBase : public VolumeMappableInterface
     {
         class VolumeStorage
@@ -51,6 +67,18 @@ namespace caret {
             std::vector<float> m_data;
             int64_t m_dimensions[5];//store internally as 4d+component
             int64_t m_mult[5];//precalculated multipliers for getIndex/getValue/setValue - NOTE: [0] is for index[1], [4] is the entire size of the data
+            
+            //on-demand mode: m_data is empty, bricks are read when used and kept in a least recently used cache
+            CaretPointer<AbstractVolumeFrameReader> m_frameReader;//NULL when all data is in m_data
+            mutable std::vector<std::shared_ptr<std::vector<float> > > m_brickCache;//all components of a brick, NULL if not loaded, bricks that are also held elsewhere are not evicted
+            mutable std::list<int64_t> m_brickCacheOrder;//loaded bricks, most recently used first
+            mutable std::vector<std::list<int64_t>::iterator> m_brickCachePos;
+            int64_t m_brickCacheMax;
+            mutable CaretMutex m_brickCacheMutex;
+            std::shared_ptr<std::vector<float> > getCachedBrick(const int64_t& brickIndex) const;
+            void evictForInsert() const;
+            void clearOnDemand();
+            
             VolumeStorage(const VolumeStorage& rhs);//deny copy, assignment for now
             VolumeStorage& operator=(const VolumeStorage& rhs);
         public:
@@ -69,13 +97,24 @@ namespace caret {
 
             void swap(VolumeStorage& rhs);
             
-            ///get a value at three indexes and optionally timepoint
-            inline const float& getValue(const int64_t& indexIn1, const int64_t& indexIn2, const int64_t& indexIn3, const int64_t brickIndex, const int64_t component) const
+            ///stop holding the data in memory, instead read bricks through the reader when they are used, keeping at most cacheBytes of them (but always a few bricks)
+            ///dimensions must already be set, any values already in memory are discarded
+            void setOnDemand(const CaretPointer<AbstractVolumeFrameReader>& reader, const int64_t& cacheBytes);
+            bool isOnDemand() const { return m_frameReader != NULL; }
+            ///read everything into memory and leave on-demand mode, done automatically before modifying any values
+            void loadAll();
+            
+            ///get a value at three indexes and optionally timepoint, in on-demand mode this locks the brick cache for every call, so loops over many voxels should use a pinned frame
+            inline float getValue(const int64_t& indexIn1, const int64_t& indexIn2, const int64_t& indexIn3, const int64_t brickIndex, const int64_t component) const
             {
                 CaretAssert(indexValid(indexIn1, indexIn2, indexIn3, brickIndex, component));//assert so release version isn't slowed by checking
+                if (m_frameReader != NULL)
+                {
+                    return (*getCachedBrick(brickIndex))[indexIn1 + m_mult[0] * indexIn2 + m_mult[1] * indexIn3 + m_mult[2] * component];
+                }
                 return m_data[getIndex(indexIn1, indexIn2, indexIn3, brickIndex, component)];
             }
-            inline const float& getValue(const int64_t indexIn[3], const int64_t brickIndex, const int64_t component) const
+            inline float getValue(const int64_t indexIn[3], const int64_t brickIndex, const int64_t component) const
             {
                 return getValue(indexIn[0], indexIn[1], indexIn[2], brickIndex, component);
             }
@@ -110,6 +149,7 @@ namespace caret {
             inline void setValue(const float& valueIn, const int64_t& indexIn1, const int64_t& indexIn2, const int64_t& indexIn3, const int64_t brickIndex, const int64_t component)
             {
                 CaretAssert(indexValid(indexIn1, indexIn2, indexIn3, brickIndex, component));//assert so release version isn't slowed by checking
+                if (m_frameReader != NULL) loadAll();
                 m_data[getIndex(indexIn1, indexIn2, indexIn3, brickIndex, component)] = valueIn;
             }
             inline void setValue(const float& valueIn, const int64_t indexIn[3], const int64_t brickIndex, const int64_t component)
@@ -120,9 +160,15 @@ namespace caret {
             /// set every voxel to the given value
             void setValueAllVoxels(const float value);
             
-            ///get a frame (const)
+            ///get a frame (const), in on-demand mode the pointer is only valid until a few other bricks are used, so only use this from one thread
             const float* getFrame(const int64_t brickIndex = 0, const int64_t component = 0) const;
             
+            ///get a frame (const), the pointer stays valid as long as pinOut is held, safe to use from multiple threads
+            const float* getFrame(const int64_t brickIndex, const int64_t component, VolumeFramePin& pinOut) const;
+            
+            ///get the value of one voxel in every brick, uncached bricks are read one voxel at a time rather than loaded
+            void getValueAllBricks(const int64_t indexIn[3], const int64_t component, float* valuesOut) const;
+            
             ///set a frame
             void setFrame(const float* frameIn, const int64_t brickIndex = 0, const int64_t component = 0);
         };
@@ -140,6 +186,11 @@ namespace caret {
         
         void addSubvolumes(const int64_t& numToAdd);
         
+        ///switch to reading voxel data through the reader as it is used, call after reinitialize
+        void setReadingOnDemand(const CaretPointer<AbstractVolumeFrameReader>& reader, const int64_t& cacheBytes) { m_storage.setOnDemand(reader, cacheBytes); }
+        ///read all data into memory, if it was being read on demand
+        void loadAllOnDemandData() { m_storage.loadAll(); }
+        
     public:
         void clear();
         virtual ~VolumeBase();
@@ -218,13 +269,14 @@ namespace caret {
         inline const VolumeSpace& getVolumeSpace() const { return m_volSpace; }
 
         ///get a value at an index triplet and optionally timepoint
-        inline const float& getValue(const int64_t* indexIn, const int64_t brickIndex = 0, const int64_t component = 0) const
+        ///when reading on demand, each call locks the brick cache, so loops over many voxels should use getFrame with a pin, or getValueAllBricks for time courses
+        inline float getValue(const int64_t* indexIn, const int64_t brickIndex = 0, const int64_t component = 0) const
         {
             return m_storage.getValue(indexIn[0], indexIn[1], indexIn[2], brickIndex, component);
         }
         
-        ///get a value at three indexes and optionally timepoint
-        inline const float& getValue(const int64_t& indexIn1, const int64_t& indexIn2, const int64_t& indexIn3, const int64_t brickIndex = 0, const int64_t component = 0) const
+        ///get a value at three indexes and optionally timepoint, locks the brick cache for each call when reading on demand (see above)
+        inline float getValue(const int64_t& indexIn1, const int64_t& indexIn2, const int64_t& indexIn3, const int64_t brickIndex = 0, const int64_t component = 0) const
         {
             return m_storage.getValue(indexIn1, indexIn2, indexIn3, brickIndex, component);
         }
@@ -308,9 +360,18 @@ namespace caret {
             return 0.0;
         }
         
-        ///get a frame (const)
+        ///get a frame (const), when reading on demand, the pointer is only valid until a few other frames have been used, so only use this from one thread
         const float* getFrame(const int64_t brickIndex = 0, const int64_t component = 0) const { return m_storage.getFrame(brickIndex, component); }
         
+        ///get a frame (const), the pointer stays valid as long as pinOut is held, use this when reading frames from multiple threads
+        const float* getFrame(const int64_t brickIndex, const int64_t component, VolumeFramePin& pinOut) const { return m_storage.getFrame(brickIndex, component, pinOut); }
+        
+        ///get the value of one voxel in every brick (a time course), for one component
+        void getValueAllBricks(const int64_t* indexIn, float* valuesOut, const int64_t component = 0) const { m_storage.getValueAllBricks(indexIn, component, valuesOut); }
+        
+        ///whether voxel data is being read from the file as it is used, rather than all held in memory
+        bool isReadingOnDemand() const { return m_storage.isOnDemand(); }
+        
         ///set a value at an index triplet and optionally timepoint
         inline void setValue(const float& valueIn, const int64_t* indexIn, const int64_t brickIndex = 0, const int64_t component = 0)
         {
@@ -543,7 +543,41 @@ GraphicsEngineDataOpenGL::loadTextureImageDataBuffer2D(GraphicsPrimitive* primit
                 break;
         }
 
-        if (useMipMapFlag) {
+        if (useMipMapFlag
+            && (textureSettings.getNumberOfMipMapLevels() > 0)) {
+            /*
+             * Mip map levels were precomputed (typically in parallel
+             * by GraphicsTexturePyramid) so load each level directly.
+             * This avoids gluBuild2DMipmaps() which runs in software and
+             * rescales images that are not a power of two.
+             */
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat,
+                         imageWidth, imageHeight, 0,
+                         pixelDataFormat, GL_UNSIGNED_BYTE, imageBytesPtr);
+            const int32_t numMipMapLevels(textureSettings.getNumberOfMipMapLevels());
+            for (int32_t iLevel = 0; iLevel < numMipMapLevels; iLevel++) {
+                glTexImage2D(GL_TEXTURE_2D, iLevel + 1, internalFormat,
+                             textureSettings.getMipMapLevelWidth(iLevel),
+                             textureSettings.getMipMapLevelHeight(iLevel), 0,
+                             pixelDataFormat, GL_UNSIGNED_BYTE,
+                             textureSettings.getMipMapLevelBytesPointer(iLevel));
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numMipMapLevels);
+
+            const auto errorGL = GraphicsUtilitiesOpenGL::getOpenGLError();
+            if (errorGL) {
+                useMipMapFlag = false;
+                CaretLogSevere("OpenGL error loading precomputed mip maps, width="
+                               + AString::number(imageWidth)
+                               + ", height="
+                               + AString::number(imageHeight)
+                               + ": "
+                               + errorGL->getVerboseDescription());
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+            }
+        }
+        else if (useMipMapFlag) {
             /*
              * This code seems to work if OpenGL 3.0 or later and
              * replaces gluBuild2DMipmaps()
@@ -1112,6 +1112,7 @@ GraphicsPrimitive::replaceVertexFloatXYZ(const int32_t vertexIndex,
     m_xyz[offset]     = xyz[0];
     m_xyz[offset + 1] = xyz[1];
     m_xyz[offset + 2] = xyz[2];
+    invalidateVertexMeasurements();
 
     if (m_graphicsEngineDataForOpenGL != NULL) {
         m_graphicsEngineDataForOpenGL->invalidateCoordinates();
@@ -1198,6 +1199,7 @@ GraphicsPrimitive::transformVerticesFloatXYZ(const Matrix4x4Interface& matrix)
         const int32_t i3(i * 3);
         matrix.multiplyPoint3(&m_xyz[i3]);
     }
+    invalidateVertexMeasurements();
 }
 
 /**
@@ -2057,6 +2059,7 @@ GraphicsPrimitive::simplfyLines(const int32_t skipVertexCount)
     m_floatRGBA = rgbaFloat;
     m_unsignedByteRGBA = rgbaByte;
     m_floatTextureSTR = textureSTR;
+    invalidateVertexMeasurements();
 }
 
 /**
@@ -2591,6 +2594,7 @@ GraphicsPrimitive::invalidateVertexMeasurements()
     m_boundingBoxValid  = false;
     m_yMean              = 0.0;
     m_yStandardDeviation = -1.0;
+    ++m_coordinatesModifiedCount;
 }
 
 /**
@@ -419,6 +419,12 @@ namespace caret {
          */
         const std::vector<float>& getFloatXYZ() const { return m_xyz; }
         
+        /**
+         * @return Count that changes each time the coordinates are modified, for
+         * detecting that data derived from the coordinates is out of date.
+         */
+        int64_t getCoordinatesModifiedCount() const { return m_coordinatesModifiedCount; }
+        
         void getVertexFloatXYZ(const int32_t vertexIndex,
                                float xyzOut[3]) const;
         
@@ -616,6 +622,8 @@ namespace caret {
         
         mutable float m_yStandardDeviation = -1.0;
         
+        int64_t m_coordinatesModifiedCount = 0;
+        
         friend class GraphicsEngineDataOpenGL;
         friend class GraphicsOpenGLPolylineTriangles;
         friend class GraphicsPrimitiveSelectionHelper;
@@ -0,0 +1,255 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __GRAPHICS_TEXTURE_PYRAMID_DECLARE__
+#include "GraphicsTexturePyramid.h"
+#undef __GRAPHICS_TEXTURE_PYRAMID_DECLARE__
+
+#include <algorithm>
+
+#include "CaretAssert.h"
+#include "CaretOMP.h"
+#include "GraphicsTextureSettings.h"
+
+using namespace caret;
+
+
+
+/**
+ * \class caret::GraphicsTexturePyramid
+ * \brief Level of detail pyramid for a large RGBA texture image
+ * \ingroup Graphics
+ *
+ * Level zero is the full resolution image.  Each following level
+ * halves the width and height (rounded down, minimum of one) which
+ * matches the dimensions that OpenGL expects for mip map levels of
+ * non-power of two textures.  Levels are created on demand and each
+ * level is reduced in parallel.  Texels are averaged weighted by alpha
+ * so that transparent texels (such as matrix cells that are not drawn)
+ * do not darken the colors of neighboring texels.
+ */
+
+/**
+ * Constructor.
+ * @param rgba
+ *    RGBA with 'width' * 'height' * 4 texels for the full resolution
+ *    image.  To avoid a copy of a possibly very large image, the content
+ *    is MOVED into this instance and 'rgba' is empty upon exit.
+ * @param width
+ *    Width of the image
+ * @param height
+ *    Height of the image
+ */
+GraphicsTexturePyramid::GraphicsTexturePyramid(std::vector<uint8_t>& rgba,
+                                               const int64_t width,
+                                               const int64_t height)
+: CaretObject()
+{
+    CaretAssert(width > 0);
+    CaretAssert(height > 0);
+    CaretAssert(static_cast<int64_t>(rgba.size()) == (width * height * 4));
+
+    int64_t w(width);
+    int64_t h(height);
+    m_levelWidths.push_back(w);
+    m_levelHeights.push_back(h);
+    while ((w > 1)
+           || (h > 1)) {
+        w = std::max(w / 2, static_cast<int64_t>(1));
+        h = std::max(h / 2, static_cast<int64_t>(1));
+        m_levelWidths.push_back(w);
+        m_levelHeights.push_back(h);
+    }
+
+    m_levelRGBA.resize(m_levelWidths.size());
+    m_levelRGBA[0].reset(new std::vector<uint8_t>());
+    m_levelRGBA[0]->swap(rgba);
+}
+
+/**
+ * Destructor.
+ */
+GraphicsTexturePyramid::~GraphicsTexturePyramid()
+{
+}
+
+/**
+ * @return Number of levels in the pyramid (including the full resolution level)
+ */
+int32_t
+GraphicsTexturePyramid::getNumberOfLevels() const
+{
+    return m_levelWidths.size();
+}
+
+/**
+ * @return Width of the given level
+ * @param level
+ *    Index of the level
+ */
+int64_t
+GraphicsTexturePyramid::getLevelWidth(const int32_t level) const
+{
+    CaretAssertVectorIndex(m_levelWidths, level);
+    return m_levelWidths[level];
+}
+
+/**
+ * @return Height of the given level
+ * @param level
+ *    Index of the level
+ */
+int64_t
+GraphicsTexturePyramid::getLevelHeight(const int32_t level) const
+{
+    CaretAssertVectorIndex(m_levelHeights, level);
+    return m_levelHeights[level];
+}
+
+/**
+ * @return RGBA for the given level, level is created if needed.
+ * The returned pointer shares ownership of the level's memory so it
+ * may be passed to GraphicsTextureSettings.
+ * @param level
+ *    Index of the level
+ */
+std::shared_ptr<uint8_t>
+GraphicsTexturePyramid::getLevelRGBA(const int32_t level)
+{
+    CaretAssertVectorIndex(m_levelRGBA, level);
+    createLevel(level);
+    std::shared_ptr<std::vector<uint8_t>>& levelData(m_levelRGBA[level]);
+    return std::shared_ptr<uint8_t>(levelData,
+                                    levelData->data());
+}
+
+/**
+ * Add the levels after the base level to the texture settings as
+ * precomputed mip map levels.
+ * @param baseLevel
+ *    Level that is used for the texture image
+ * @param textureSettings
+ *    Texture settings that receive the mip map levels
+ */
+void
+GraphicsTexturePyramid::addMipMapLevelsToTextureSettings(const int32_t baseLevel,
+                                                         GraphicsTextureSettings& textureSettings)
+{
+    const int32_t numLevels(getNumberOfLevels());
+    for (int32_t iLevel = baseLevel + 1; iLevel < numLevels; iLevel++) {
+        std::shared_ptr<uint8_t> levelRGBA(getLevelRGBA(iLevel));
+        textureSettings.addMipMapLevel(levelRGBA,
+                                       getLevelWidth(iLevel),
+                                       getLevelHeight(iLevel));
+    }
+}
+
+/**
+ * Create the given level (and any levels before it) if it does not exist.
+ * @param level
+ *    Index of the level
+ */
+void
+GraphicsTexturePyramid::createLevel(const int32_t level)
+{
+    CaretAssertVectorIndex(m_levelRGBA, level);
+    if (m_levelRGBA[level]) {
+        return;
+    }
+    CaretAssert(level > 0);
+    createLevel(level - 1);
+
+    const std::vector<uint8_t>& inputRGBA(*m_levelRGBA[level - 1]);
+    const int64_t inputWidth(m_levelWidths[level - 1]);
+    const int64_t inputHeight(m_levelHeights[level - 1]);
+    const int64_t outputWidth(m_levelWidths[level]);
+    const int64_t outputHeight(m_levelHeights[level]);
+
+    m_levelRGBA[level].reset(new std::vector<uint8_t>(outputWidth * outputHeight * 4));
+    std::vector<uint8_t>& outputRGBA(*m_levelRGBA[level]);
+
+    /*
+     * Each output texel averages a 2x2 block of input texels.  When an input
+     * dimension is odd, the last output texel also includes the last input
+     * texel so that no input texels are dropped.
+     */
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t outY = 0; outY < outputHeight; outY++) {
+        const int64_t firstY(std::min(outY * 2, inputHeight - 1));
+        int64_t lastY(std::min(firstY + 1, inputHeight - 1));
+        if (outY == (outputHeight - 1)) {
+            lastY = inputHeight - 1;
+        }
+        for (int64_t outX = 0; outX < outputWidth; outX++) {
+            const int64_t firstX(std::min(outX * 2, inputWidth - 1));
+            int64_t lastX(std::min(firstX + 1, inputWidth - 1));
+            if (outX == (outputWidth - 1)) {
+                lastX = inputWidth - 1;
+            }
+
+            double sumRGB[3] = { 0.0, 0.0, 0.0 };
+            double sumAlpha(0.0);
+            int32_t count(0);
+            for (int64_t y = firstY; y <= lastY; y++) {
+                for (int64_t x = firstX; x <= lastX; x++) {
+                    const int64_t inputOffset((x + (y * inputWidth)) * 4);
+                    CaretAssertVectorIndex(inputRGBA, inputOffset + 3);
+                    const double alpha(inputRGBA[inputOffset + 3]);
+                    sumRGB[0] += inputRGBA[inputOffset]     * alpha;
+                    sumRGB[1] += inputRGBA[inputOffset + 1] * alpha;
+                    sumRGB[2] += inputRGBA[inputOffset + 2] * alpha;
+                    sumAlpha  += alpha;
+                    ++count;
+                }
+            }
+
+            const int64_t outputOffset((outX + (outY * outputWidth)) * 4);
+            CaretAssertVectorIndex(outputRGBA, outputOffset + 3);
+            if (sumAlpha > 0.0) {
+                for (int32_t k = 0; k < 3; k++) {
+                    outputRGBA[outputOffset + k] = static_cast<uint8_t>(sumRGB[k] / sumAlpha + 0.5);
+                }
+                outputRGBA[outputOffset + 3] = static_cast<uint8_t>(sumAlpha / count + 0.5);
+            }
+            else {
+                for (int32_t k = 0; k < 4; k++) {
+                    outputRGBA[outputOffset + k] = 0;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+GraphicsTexturePyramid::toString() const
+{
+    return ("GraphicsTexturePyramid levels="
+            + AString::number(getNumberOfLevels())
+            + " width="
+            + AString::number(m_levelWidths[0])
+            + " height="
+            + AString::number(m_levelHeights[0]));
+}
+
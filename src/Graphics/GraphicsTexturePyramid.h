@@ -0,0 +1,81 @@
+#ifndef __GRAPHICS_TEXTURE_PYRAMID_H__
+#define __GRAPHICS_TEXTURE_PYRAMID_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CaretObject.h"
+
+namespace caret {
+
+    class GraphicsTextureSettings;
+
+    class GraphicsTexturePyramid : public CaretObject {
+
+    public:
+        GraphicsTexturePyramid(std::vector<uint8_t>& rgba,
+                               const int64_t width,
+                               const int64_t height);
+
+        virtual ~GraphicsTexturePyramid();
+
+        GraphicsTexturePyramid(const GraphicsTexturePyramid&) = delete;
+
+        GraphicsTexturePyramid& operator=(const GraphicsTexturePyramid&) = delete;
+
+        int32_t getNumberOfLevels() const;
+
+        int64_t getLevelWidth(const int32_t level) const;
+
+        int64_t getLevelHeight(const int32_t level) const;
+
+        std::shared_ptr<uint8_t> getLevelRGBA(const int32_t level);
+
+        void addMipMapLevelsToTextureSettings(const int32_t baseLevel,
+                                              GraphicsTextureSettings& textureSettings);
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        void createLevel(const int32_t level);
+
+        std::vector<std::shared_ptr<std::vector<uint8_t>>> m_levelRGBA;
+
+        std::vector<int64_t> m_levelWidths;
+
+        std::vector<int64_t> m_levelHeights;
+
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+
+#ifdef __GRAPHICS_TEXTURE_PYRAMID_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __GRAPHICS_TEXTURE_PYRAMID_DECLARE__
+
+} // namespace
+#endif  //__GRAPHICS_TEXTURE_PYRAMID_H__
@@ -342,6 +342,7 @@ GraphicsTextureSettings::copyHelperGraphicsTextureSettings(const GraphicsTexture
     m_magnificationFilter = obj.m_magnificationFilter;
     m_minificationFilter  = obj.m_minificationFilter;
     m_borderColor         = obj.m_borderColor;
+    m_mipMapLevels        = obj.m_mipMapLevels;
 }
 
 /**
@@ -515,6 +516,77 @@ GraphicsTextureSettings::getBorderColor() const
 {
     return m_borderColor;
 }
+
+/**
+ * Add a precomputed mip map level.  Levels must be added in order, starting
+ * with level 1 (first reduction of the image).  Each level's dimensions
+ * must be half (rounded down, minimum of one) of the previous level.
+ * When precomputed levels are present, they are loaded into OpenGL instead
+ * of generating the mip maps with GLU.
+ * @param levelRgbaData
+ *    RGBA data for the level (width * height * 4 bytes)
+ * @param levelWidth
+ *    Width of the level
+ * @param levelHeight
+ *    Height of the level
+ */
+void
+GraphicsTextureSettings::addMipMapLevel(std::shared_ptr<uint8_t>& levelRgbaData,
+                                        const int64_t levelWidth,
+                                        const int64_t levelHeight)
+{
+    CaretAssert(levelRgbaData);
+    CaretAssert((levelWidth > 0)
+                && (levelHeight > 0));
+    m_mipMapLevels.push_back(MipMapLevel(levelRgbaData,
+                                         levelWidth,
+                                         levelHeight));
+}
+
+/**
+ * @return Number of precomputed mip map levels (does not include the image, level 0)
+ */
+int32_t
+GraphicsTextureSettings::getNumberOfMipMapLevels() const
+{
+    return m_mipMapLevels.size();
+}
+
+/**
+ * @return Pointer to RGBA data for a precomputed mip map level
+ * @param levelIndex
+ *    Index of the level (zero is the first reduction of the image)
+ */
+const uint8_t*
+GraphicsTextureSettings::getMipMapLevelBytesPointer(const int32_t levelIndex) const
+{
+    CaretAssertVectorIndex(m_mipMapLevels, levelIndex);
+    return m_mipMapLevels[levelIndex].m_rgbaData.get();
+}
+
+/**
+ * @return Width of a precomputed mip map level
+ * @param levelIndex
+ *    Index of the level (zero is the first reduction of the image)
+ */
+int64_t
+GraphicsTextureSettings::getMipMapLevelWidth(const int32_t levelIndex) const
+{
+    CaretAssertVectorIndex(m_mipMapLevels, levelIndex);
+    return m_mipMapLevels[levelIndex].m_width;
+}
+
+/**
+ * @return Height of a precomputed mip map level
+ * @param levelIndex
+ *    Index of the level (zero is the first reduction of the image)
+ */
+int64_t
+GraphicsTextureSettings::getMipMapLevelHeight(const int32_t levelIndex) const
+{
+    CaretAssertVectorIndex(m_mipMapLevels, levelIndex);
+    return m_mipMapLevels[levelIndex].m_height;
+}
 /**
  * Get a description of this object's content.
  * @return String describing this object's content.
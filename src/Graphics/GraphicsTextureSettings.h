@@ -23,6 +23,7 @@
 
 #include <array>
 #include <memory>
+#include <vector>
 
 #include "CaretObject.h"
 #include "GraphicsTextureMagnificationFilterEnum.h"
@@ -187,11 +188,42 @@ namespace caret {
         
         std::array<float, 4> getBorderColor() const;
 
+        void addMipMapLevel(std::shared_ptr<uint8_t>& levelRgbaData,
+                            const int64_t levelWidth,
+                            const int64_t levelHeight);
+        
+        int32_t getNumberOfMipMapLevels() const;
+        
+        const uint8_t* getMipMapLevelBytesPointer(const int32_t levelIndex) const;
+        
+        int64_t getMipMapLevelWidth(const int32_t levelIndex) const;
+        
+        int64_t getMipMapLevelHeight(const int32_t levelIndex) const;
+        
         // ADD_NEW_METHODS_HERE
 
         virtual AString toString() const;
         
     private:
+        /**
+         * A precomputed mip map level (level 1 is first reduction of the image)
+         */
+        class MipMapLevel {
+        public:
+            MipMapLevel(std::shared_ptr<uint8_t>& rgbaData,
+                        const int64_t width,
+                        const int64_t height)
+            : m_rgbaData(rgbaData),
+            m_width(width),
+            m_height(height) { }
+            
+            std::shared_ptr<uint8_t> m_rgbaData;
+            
+            int64_t m_width;
+            
+            int64_t m_height;
+        };
+        
         enum class ImageDataType {
             INVALID,
             POINTER,
@@ -232,6 +264,8 @@ namespace caret {
         
         int32_t m_unpackAlignment = 4;
         
+        std::vector<MipMapLevel> m_mipMapLevels;
+        
         // ADD_NEW_MEMBERS_HERE
 
     };
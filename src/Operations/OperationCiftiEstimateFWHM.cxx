@@ -184,17 +184,26 @@ void OperationCiftiEstimateFWHM::useParameters(OperationParameters* myParams, Pr
         if (column == -1)
         {
             int rowLength = (int)myCifti->getNumberOfColumns();
+            vector<vector<float> > surfResults(surfProcess.size());//compute each structure for all columns at once, so the neighbor setup isn't repeated per column
+            for (int j = 0; j < (int)surfProcess.size(); ++j)
+            {
+                surfResults[j] = AlgorithmMetricEstimateFWHM::estimateFWHMEachColumn(surfProcess[j].surf, surfProcess[j].data, surfProcess[j].roi);
+            }
+            vector<vector<Vector3D> > volResults(volProcess.size());
+            for (int j = 0; j < (int)volProcess.size(); ++j)
+            {
+                volResults[j] = AlgorithmVolumeEstimateFWHM::estimateFWHMEachFrame(volProcess[j].data, volProcess[j].roi);
+            }
             for (int i = 0; i < rowLength; ++i)
             {
                 if (rowLength > 1) cout << "Column " << i + 1 << ":" << endl;
                 for (int j = 0; j < (int)surfProcess.size(); ++j)
                 {
-                    float fwhm = AlgorithmMetricEstimateFWHM::estimateFWHM(surfProcess[j].surf, surfProcess[j].data, surfProcess[j].roi, i);
-                    cout << surfProcess[j].name << " FWHM: " << fwhm << endl;
+                    cout << surfProcess[j].name << " FWHM: " << surfResults[j][i] << endl;
                 }
                 for (int j = 0; j < (int)volProcess.size(); ++j)
                 {
-                    Vector3D fwhm = AlgorithmVolumeEstimateFWHM::estimateFWHM(volProcess[j].data, volProcess[j].roi, i);
+                    const Vector3D& fwhm = volResults[j][i];
                     cout << volProcess[j].name << " FWHM: " << fwhm[0] << ", " << fwhm[1] << ", " << fwhm[2] << endl;
                 }
             }
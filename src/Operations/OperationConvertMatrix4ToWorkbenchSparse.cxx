@@ -26,13 +26,12 @@
 #include "CiftiFile.h"
 #include "OxfordSparseThreeFile.h"
 #include "MetricFile.h"
+#include "NumericTextReader.h"
 #include "VolumeFile.h"
 
 #include <cmath>
 #include <map>
 #include <vector>
-#include <fstream>
-#include <string>
 
 using namespace caret;
 using namespace std;
@@ -140,34 +139,27 @@ void OperationConvertMatrix4ToWorkbenchSparse::useParameters(OperationParameters
         myXML.setMap(CiftiXML::ALONG_COLUMN, tempMap);
     }
     CaretAssert(myXML.getDimensionLength(CiftiXML::ALONG_COLUMN) == sparseDims[1]);
-    fstream voxelFile(voxelFileName.toLocal8Bit().constData(), fstream::in);
-    if (!voxelFile.good())
+    vector<int64_t> voxelIndices;
+    bool readWholeFile = false;
+    AString badLine;
+    try
     {
+        NumericTextReader voxelReader(voxelFileName);
+        readWholeFile = voxelReader.readAllIntegers(voxelIndices, badLine);
+    } catch (CaretException& e) {
         throw OperationException("failed to open voxel list file for reading");
     }
+    if (!readWholeFile)
+    {
+        throw OperationException("found non-digit, non-whitespace characters: " + badLine);
+    }
     const CiftiBrainModelsMap& rowMap = myXML.getBrainModelsMap(CiftiXML::ALONG_ROW);//tested above, as orientationXML
     const int64_t* volDims = rowMap.getVolumeSpace().getDims();
-    vector<int64_t> voxelIndices;
-    int64_t ind1, ind2, ind3;
-    while (voxelFile >> ind1 >> ind2 >> ind3)
+    for (int64_t i = 0; i + 2 < (int64_t)voxelIndices.size(); i += 3)
     {
+        const int64_t ind1 = voxelIndices[i], ind2 = voxelIndices[i + 1], ind3 = voxelIndices[i + 2];
         if (min(min(ind1, ind2), ind3) < 0) throw OperationException("negative voxel index found in voxel list");
         if (ind1 >= volDims[0] || ind2 >= volDims[1] || ind3 >= volDims[2]) throw OperationException("found voxel index that exceeds dimension in voxel list");
-        voxelIndices.push_back(ind1);
-        voxelIndices.push_back(ind2);
-        voxelIndices.push_back(ind3);
-    }
-    if (!voxelFile.eof())
-    {
-        voxelFile.clear();
-        string mystring;
-        while (getline(voxelFile, mystring))
-        {
-            if (AString(mystring.c_str()).trimmed() != "")
-            {
-                throw OperationException("found non-digit, non-whitespace characters: " + AString(mystring.c_str()));
-            }
-        }
     }
     if ((int64_t)voxelIndices.size() != sparseDims[0] * 3) throw OperationException("voxel list file contains the wrong number of voxels, expected " +
                                                                                     AString::number(sparseDims[0] * 3) + " integers, read " + AString::number(voxelIndices.size()));
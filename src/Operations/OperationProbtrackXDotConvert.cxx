@@ -21,8 +21,11 @@
 #include "OperationProbtrackXDotConvert.h"
 #include "OperationException.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CaretPointer.h"
 #include "CiftiFile.h"
 #include "MetricFile.h"
+#include "NumericTextReader.h"
 #include "StructureEnum.h"
 #include "VolumeFile.h"
 
@@ -45,6 +48,48 @@ struct SparseValue
     }
 };
 
+namespace
+{
+    //results of parsing one chunk of the .dot file
+    struct DotChunkInfo
+    {
+        vector<SparseValue> values;
+        int64_t numZeros;
+        bool afterZero, hasData, complete;
+        AString errorMessage;
+        DotChunkInfo() : numZeros(0), afterZero(false), hasData(false), complete(false) { }
+    };
+    
+    //in-place counting sort by row (index[1]), linear time instead of a comparison sort, rows are already known to be in range
+    void sortByRow(vector<SparseValue>& values, const int32_t& numRows)
+    {
+        vector<int64_t> next(numRows + 1, 0), rowEnd(numRows);
+        for (int64_t i = 0; i < (int64_t)values.size(); ++i)
+        {
+            ++next[values[i].index[1] + 1];
+        }
+        for (int32_t r = 0; r < numRows; ++r)
+        {
+            next[r + 1] += next[r];
+            rowEnd[r] = next[r + 1];
+        }
+        for (int32_t r = 0; r < numRows; ++r)
+        {//swap each element directly to the next open position of its row
+            while (next[r] < rowEnd[r])
+            {
+                int32_t target = values[next[r]].index[1];
+                if (target == r)
+                {
+                    ++next[r];
+                } else {
+                    swap(values[next[r]], values[next[target]]);
+                    ++next[target];
+                }
+            }
+        }
+    }
+}
+
 AString OperationProbtrackXDotConvert::getCommandSwitch()
 {
     return "-probtrackx-dot-convert";
@@ -181,13 +226,6 @@ void OperationProbtrackXDotConvert::useParameters(OperationParameters* myParams,
         }
         myXML.copyMapping(CiftiXMLOld::ALONG_COLUMN, colCiftiOpt->getCifti(1)->getCiftiXMLOld(), myDir);
     }
-    fstream dotFile(dotFileName.toLatin1().constData(), fstream::in);
-    if (!dotFile.good())
-    {
-        throw OperationException("error opening text file '" + dotFileName + "'");
-    }
-    SparseValue tempValue;
-    vector<SparseValue> dotFileContents;
     int32_t rowSize = myXML.getNumberOfColumns(), colSize = myXML.getNumberOfRows();
     if (halfMatrix && rowSize != colSize)
     {
@@ -197,70 +235,86 @@ void OperationProbtrackXDotConvert::useParameters(OperationParameters* myParams,
     {
         CaretLogInfo("-transpose is not needed with -make-symmetric");
     }
-    int64_t numZeros = 0;
-    bool afterZero = false;
-    if (transpose)
+    CaretPointer<NumericTextReader> dotReader;
+    try
     {
-        while (dotFile >> tempValue.index[1] >> tempValue.index[0] >> tempValue.value)//this is the only line that is different for transpose
+        dotReader.grabNew(new NumericTextReader(dotFileName));
+    } catch (CaretException& e) {
+        throw OperationException("error opening text file '" + dotFileName + "'");
+    }
+    const int64_t numChunks = dotReader->getNumberOfChunks();
+    vector<DotChunkInfo> chunkInfo(numChunks);
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t chunk = 0; chunk < numChunks; ++chunk)
+    {//chunks of lines are parsed in parallel, errors are recorded and thrown afterwards in file order
+        const char* pos, *end;
+        dotReader->getChunk(chunk, pos, end);
+        DotChunkInfo& myInfo = chunkInfo[chunk];
+        SparseValue tempValue;
+        int64_t tempIndex[2];
+        while (NumericTextReader::parseInt(pos, end, tempIndex[0]) && NumericTextReader::parseInt(pos, end, tempIndex[1]) &&
+               NumericTextReader::parseFloat(pos, end, tempValue.value))
         {
-            if (tempValue.value == 0.0f)
+            if (transpose)//this is the only thing that is different for transpose
             {
-                if (tempValue.index[0] != rowSize || tempValue.index[1] != colSize)
-                {
-                    throw OperationException("dimensions line in .dot file doesn't agree with provided row/column spaces");
-                }
-                ++numZeros;//ignore, we expect one line (last in file) to have this
+                tempValue.index[1] = (int32_t)tempIndex[0];
+                tempValue.index[0] = (int32_t)tempIndex[1];
             } else {
-                if (tempValue.index[0] < 1 || tempValue.index[0] > rowSize ||
-                    tempValue.index[1] < 1 || tempValue.index[1] > colSize)
-                {
-                    throw OperationException("found invalid index pair in dot file: " + AString::number(tempValue.index[0]) + ", " + AString::number(tempValue.index[1]) +
-                        ", perhaps you need to remove -transpose");
-                }
-                if (numZeros != 0) afterZero = true;
-                tempValue.index[0] -= 1;//fix for 1-indexing
-                tempValue.index[1] -= 1;
-                dotFileContents.push_back(tempValue);
-                if (halfMatrix && tempValue.index[0] != tempValue.index[1])
-                {
-                    int32_t tempIndex = tempValue.index[0];
-                    tempValue.index[0] = tempValue.index[1];
-                    tempValue.index[1] = tempIndex;
-                    dotFileContents.push_back(tempValue);
-                }
+                tempValue.index[0] = (int32_t)tempIndex[0];
+                tempValue.index[1] = (int32_t)tempIndex[1];
             }
-        }
-    } else {
-        while (dotFile >> tempValue.index[0] >> tempValue.index[1] >> tempValue.value)
-        {
             if (tempValue.value == 0.0f)
             {
                 if (tempValue.index[0] != rowSize || tempValue.index[1] != colSize)
                 {
-                    throw OperationException("dimensions line in .dot file doesn't agree with provided row/column spaces");
+                    myInfo.errorMessage = "dimensions line in .dot file doesn't agree with provided row/column spaces";
+                    break;
                 }
-                ++numZeros;
+                ++myInfo.numZeros;//ignore, we expect one line (last in file) to have this
             } else {
                 if (tempValue.index[0] < 1 || tempValue.index[0] > rowSize ||
                     tempValue.index[1] < 1 || tempValue.index[1] > colSize)
                 {
-                    throw OperationException("found invalid index pair in dot file: " + AString::number(tempValue.index[0]) + ", " + AString::number(tempValue.index[1]) +
-                        ", perhaps you need to use -transpose");
+                    myInfo.errorMessage = "found invalid index pair in dot file: " + AString::number(tempValue.index[0]) + ", " + AString::number(tempValue.index[1]) +
+                        (transpose ? ", perhaps you need to remove -transpose" : ", perhaps you need to use -transpose");
+                    break;
                 }
-                if (numZeros != 0) afterZero = true;
+                if (myInfo.numZeros != 0) myInfo.afterZero = true;
+                myInfo.hasData = true;
                 tempValue.index[0] -= 1;//fix for 1-indexing
                 tempValue.index[1] -= 1;
-                dotFileContents.push_back(tempValue);
+                myInfo.values.push_back(tempValue);
                 if (halfMatrix && tempValue.index[0] != tempValue.index[1])
                 {
-                    int32_t tempIndex = tempValue.index[0];
+                    int32_t swapIndex = tempValue.index[0];
                     tempValue.index[0] = tempValue.index[1];
-                    tempValue.index[1] = tempIndex;
-                    dotFileContents.push_back(tempValue);
+                    tempValue.index[1] = swapIndex;
+                    myInfo.values.push_back(tempValue);
                 }
             }
         }
+        myInfo.complete = myInfo.errorMessage.isEmpty() && NumericTextReader::atEnd(pos, end);
+    }
+    int64_t numZeros = 0, totalValues = 0;
+    bool afterZero = false;
+    int64_t lastChunk = 0;
+    for (; lastChunk < numChunks; ++lastChunk)
+    {//like stream extraction, stop at the first thing that can't be read
+        const DotChunkInfo& myInfo = chunkInfo[lastChunk];
+        if (!myInfo.errorMessage.isEmpty()) throw OperationException(myInfo.errorMessage);
+        if (myInfo.afterZero || (numZeros != 0 && myInfo.hasData)) afterZero = true;
+        numZeros += myInfo.numZeros;
+        totalValues += (int64_t)myInfo.values.size();
+        if (!myInfo.complete) break;
+    }
+    vector<SparseValue> dotFileContents;
+    dotFileContents.reserve(totalValues);
+    for (int64_t chunk = 0; chunk < numChunks && chunk <= lastChunk; ++chunk)
+    {
+        dotFileContents.insert(dotFileContents.end(), chunkInfo[chunk].values.begin(), chunkInfo[chunk].values.end());
+        vector<SparseValue>().swap(chunkInfo[chunk].values);//release memory as we go
     }
+    dotReader.grabNew(NULL);
     if (numZeros != 1)
     {
         CaretLogWarning("found (and ignored) " + AString::number(numZeros) + " lines with zero for value, expected 1");
@@ -283,7 +337,7 @@ void OperationProbtrackXDotConvert::useParameters(OperationParameters* myParams,
             break;
         }
     }
-    if (!sorted) sort(dotFileContents.begin(), dotFileContents.end());
+    if (!sorted) sortByRow(dotFileContents, colSize);
     if (!sorted && !halfMatrix)
     {
         CaretLogInfo("sorting finished");
@@ -0,0 +1,200 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "OperationInputFileCache.h"
+
+#include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CiftiFile.h"
+#include "FileInformation.h"
+
+#include <QDateTime>
+
+#include <list>
+#include <map>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    struct CacheEntry
+    {
+        shared_ptr<void> m_file;//gifti and volume files, copied for each use
+        CaretPointer<CiftiFile> m_cifti;//cifti files, shared
+        int64_t m_modified, m_size;
+        list<AString>::iterator m_lruIter;
+    };
+
+    CaretMutex g_cacheMutex;
+    bool g_cacheEnabled = false;
+    int64_t g_maximumBytes = 0, g_currentBytes = 0, g_hits = 0, g_misses = 0;
+    map<AString, CacheEntry> g_entries;
+    list<AString> g_leastRecentlyUsed;//most recently used at the front
+
+    void removeEntry(map<AString, CacheEntry>::iterator iter)
+    {//caller must hold the mutex
+        g_currentBytes -= iter->second.m_size;
+        g_leastRecentlyUsed.erase(iter->second.m_lruIter);
+        g_entries.erase(iter);
+    }
+
+    //returns the entry if it exists and the file on disk has not changed, removes a stale entry, caller must hold the mutex
+    CacheEntry* findEntry(const AString& key, const int64_t& modified, const int64_t& size)
+    {
+        map<AString, CacheEntry>::iterator iter = g_entries.find(key);
+        if (iter == g_entries.end())
+        {
+            ++g_misses;
+            return NULL;
+        }
+        if (iter->second.m_modified != modified || iter->second.m_size != size)
+        {
+            CaretLogFine("file changed on disk, dropping cached copy: " + key);
+            removeEntry(iter);
+            ++g_misses;
+            return NULL;
+        }
+        g_leastRecentlyUsed.splice(g_leastRecentlyUsed.begin(), g_leastRecentlyUsed, iter->second.m_lruIter);
+        ++g_hits;
+        return &(iter->second);
+    }
+
+    //file size on disk is used as the memory estimate, it is close for uncompressed files, and errs small for compressed ones
+    //caller must hold the mutex
+    CacheEntry* insertEntry(const AString& key, const int64_t& modified, const int64_t& size)
+    {
+        if (size > g_maximumBytes) return NULL;//don't throw out everything else for a file that can't fit
+        map<AString, CacheEntry>::iterator iter = g_entries.find(key);
+        if (iter != g_entries.end()) removeEntry(iter);
+        while (!g_leastRecentlyUsed.empty() && g_currentBytes + size > g_maximumBytes)
+        {
+            removeEntry(g_entries.find(g_leastRecentlyUsed.back()));
+        }
+        g_leastRecentlyUsed.push_front(key);
+        CacheEntry& newEntry = g_entries[key];
+        newEntry.m_modified = modified;
+        newEntry.m_size = size;
+        newEntry.m_lruIter = g_leastRecentlyUsed.begin();
+        g_currentBytes += size;
+        return &newEntry;
+    }
+}
+
+void OperationInputFileCache::enable(const int64_t& maximumBytes)
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    g_maximumBytes = maximumBytes;
+    while (!g_leastRecentlyUsed.empty() && g_currentBytes > g_maximumBytes)
+    {
+        removeEntry(g_entries.find(g_leastRecentlyUsed.back()));
+    }
+    g_cacheEnabled = true;
+}
+
+void OperationInputFileCache::disable()
+{
+    clear();
+    CaretMutexLocker locked(&g_cacheMutex);
+    g_cacheEnabled = false;
+}
+
+bool OperationInputFileCache::isEnabled()
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    return g_cacheEnabled;
+}
+
+void OperationInputFileCache::clear()
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    g_entries.clear();
+    g_leastRecentlyUsed.clear();
+    g_currentBytes = 0;
+}
+
+AString OperationInputFileCache::getStatistics()
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    return "input file cache: " + AString::number(g_entries.size()) + " files, " +
+           AString::number(g_currentBytes / 1048576.0, 'f', 1) + " of " + AString::number(g_maximumBytes / 1048576.0, 'f', 1) + " MB, " +
+           AString::number(g_hits) + " hits, " + AString::number(g_misses) + " misses";
+}
+
+bool OperationInputFileCache::getFileStamp(const AString& filename, const char* typeName, FileStamp& stampOut)
+{
+    FileInformation myInfo(filename);
+    if (!myInfo.exists()) return false;
+    stampOut.m_key = AString(typeName) + ":" + myInfo.getCanonicalFilePath();
+    stampOut.m_modified = myInfo.getLastModified().toMSecsSinceEpoch();
+    stampOut.m_size = myInfo.size();
+    return true;
+}
+
+shared_ptr<void> OperationInputFileCache::findFile(const FileStamp& stamp)
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    CacheEntry* myEntry = findEntry(stamp.m_key, stamp.m_modified, stamp.m_size);
+    if (myEntry == NULL) return shared_ptr<void>();
+    return myEntry->m_file;
+}
+
+void OperationInputFileCache::addFile(const FileStamp& stamp, const shared_ptr<void>& file)
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    CacheEntry* myEntry = insertEntry(stamp.m_key, stamp.m_modified, stamp.m_size);
+    if (myEntry != NULL) myEntry->m_file = file;
+}
+
+CaretPointer<CiftiFile> OperationInputFileCache::findCifti(const FileStamp& stamp)
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    CacheEntry* myEntry = findEntry(stamp.m_key, stamp.m_modified, stamp.m_size);
+    if (myEntry == NULL) return CaretPointer<CiftiFile>();
+    return myEntry->m_cifti;
+}
+
+void OperationInputFileCache::addCifti(const FileStamp& stamp, const CaretPointer<CiftiFile>& file)
+{
+    CaretMutexLocker locked(&g_cacheMutex);
+    CacheEntry* myEntry = insertEntry(stamp.m_key, stamp.m_modified, stamp.m_size);
+    if (myEntry != NULL) myEntry->m_cifti = file;
+}
+
+bool OperationInputFileCache::openCiftiFile(const AString& filename, CaretPointer<CiftiFile>& fileOut, const bool& readIntoMemory)
+{
+    if (!isEnabled()) return false;
+    FileStamp stamp;
+    if (!getFileStamp(filename, "CiftiFile", stamp)) return false;
+    //an on-disk cifti that is later requested in memory is still fine to reuse, it just reads rows from disk
+    CaretPointer<CiftiFile> cached = findCifti(stamp);
+    if (cached == NULL)
+    {
+        cached.grabNew(new CiftiFile());
+        cached->openFile(filename);
+        if (readIntoMemory)
+        {
+            cached->convertToInMemory();
+        }
+        addCifti(stamp, cached);
+    }
+    fileOut = cached;
+    return true;
+}
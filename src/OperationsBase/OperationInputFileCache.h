@@ -0,0 +1,86 @@
+#ifndef __OPERATION_INPUT_FILE_CACHE_H__
+#define __OPERATION_INPUT_FILE_CACHE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+#include "CaretPointer.h"
+
+#include <cstdint>
+#include <memory>
+#include <typeinfo>
+
+namespace caret {
+
+    class CiftiFile;
+
+    ///keeps input files in memory between commands when wb_command runs as a server, so that files used by many consecutive commands are only read once
+    ///disabled unless enable() is called, files are keyed by type, canonical path, modification time and size, and the least recently used files are dropped when over the size limit
+    class OperationInputFileCache
+    {
+        struct FileStamp
+        {
+            AString m_key;
+            int64_t m_modified, m_size;
+        };
+        static bool getFileStamp(const AString& filename, const char* typeName, FileStamp& stampOut);
+        static std::shared_ptr<void> findFile(const FileStamp& stamp);
+        static void addFile(const FileStamp& stamp, const std::shared_ptr<void>& file);
+        static CaretPointer<CiftiFile> findCifti(const FileStamp& stamp);
+        static void addCifti(const FileStamp& stamp, const CaretPointer<CiftiFile>& file);
+    public:
+        static void enable(const int64_t& maximumBytes);
+        static void disable();
+        static bool isEnabled();
+        static void clear();
+        static AString getStatistics();
+
+        ///reads the file through the cache and gives the caller its own copy, so the command may modify it, returns false if the cache is disabled (caller should read the file itself)
+        template<typename T>
+        static bool readFile(const AString& filename, CaretPointer<T>& fileOut);
+
+        ///cifti files are shared rather than copied (they may be on-disk), as cifti inputs are only read from, returns false if the cache is disabled
+        static bool openCiftiFile(const AString& filename, CaretPointer<CiftiFile>& fileOut, const bool& readIntoMemory);
+    };
+
+    template<typename T>
+    bool OperationInputFileCache::readFile(const AString& filename, CaretPointer<T>& fileOut)
+    {
+        if (!isEnabled()) return false;
+        FileStamp stamp;
+        if (!getFileStamp(filename, typeid(T).name(), stamp)) return false;//let the normal reading code generate the error
+        std::shared_ptr<void> cached = findFile(stamp);
+        if (!cached)
+        {
+            std::shared_ptr<T> newFile(new T());
+            newFile->readFile(filename);
+            addFile(stamp, newFile);
+            cached = newFile;
+        }
+        fileOut.grabNew(new T(*static_cast<const T*>(cached.get())));
+        fileOut->setFileName(filename);//it may have been read with a different relative path
+        fileOut->clearModified();
+        return true;
+    }
+
+}
+
+#endif //__OPERATION_INPUT_FILE_CACHE_H__
@@ -31,6 +31,8 @@
 #include "FociFile.h"
 #include "LabelFile.h"
 #include "MetricFile.h"
+#include "OperationInputFileCache.h"
+#include "OperationPipelineFiles.h"
 #include "ProgramParametersException.h"
 #include "SurfaceFile.h"
 #include "VolumeFile.h"
@@ -744,7 +746,10 @@ AnnotationFile* ParameterComponent::getAnnotation(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::ANNOTATION, myParam->m_parameter))
+            {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -760,7 +765,10 @@ BorderFile* ParameterComponent::getBorder(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::BORDER, myParam->m_parameter))
+            {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -776,10 +784,14 @@ CiftiFile* ParameterComponent::getCifti(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->openFile(myParam->m_filename);
-            if (caret_global_command_options.m_ciftiReadMemory)
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::CIFTI, myParam->m_parameter) &&
+                !OperationInputFileCache::openCiftiFile(myParam->m_filename, myParam->m_parameter, caret_global_command_options.m_ciftiReadMemory))
             {
-                myParam->m_parameter->convertToInMemory();
+                myParam->lazyGet()->openFile(myParam->m_filename);
+                if (caret_global_command_options.m_ciftiReadMemory)
+                {
+                    myParam->m_parameter->convertToInMemory();
+                }
             }
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -796,7 +808,10 @@ FociFile* ParameterComponent::getFoci(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::FOCI, myParam->m_parameter))
+            {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -812,7 +827,11 @@ LabelFile* ParameterComponent::getLabel(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::LABEL, myParam->m_parameter) &&
+                !OperationInputFileCache::readFile(myParam->m_filename, myParam->m_parameter))
+            {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -828,7 +847,11 @@ MetricFile* ParameterComponent::getMetric(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::METRIC, myParam->m_parameter) &&
+                !OperationInputFileCache::readFile(myParam->m_filename, myParam->m_parameter))
+            {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -844,7 +867,11 @@ SurfaceFile* ParameterComponent::getSurface(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::SURFACE, myParam->m_parameter) &&
+                !OperationInputFileCache::readFile(myParam->m_filename, myParam->m_parameter))
+            {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -860,7 +887,10 @@ VolumeFile* ParameterComponent::getVolume(const int32_t key)
     {
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (!OperationPipelineFiles::getFile(myParam->m_filename, OperationParametersEnum::VOLUME, myParam->m_parameter))
+            {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -25,6 +25,7 @@
 #include "CaretMutex.h"
 #include "CaretPointer.h"
 #include "OperationParametersEnum.h"
+#include "OperationPipelineFiles.h"
 #include "DataFileException.h"
 
 #include <QFile>
@@ -418,7 +419,15 @@ namespace caret {
             m_doOnDiskWrite = true;//NOTE: on-disk writing, like cifti, needs special checks for overwriting inputs
             m_collidingParam = NULL;
         }
-        void checkExists() { if (!QFile::exists(m_filename)) throw DataFileException(m_filename, "file does not exist"); }
+        void checkExists()
+        {
+            if (OperationPipelineFiles::isPipelineName(m_filename))
+            {
+                OperationPipelineFiles::checkFileExists(m_filename, TYPE);
+                return;
+            }
+            if (!QFile::exists(m_filename)) throw DataFileException(m_filename, "file does not exist");
+        }
         T* lazyGet() { if (m_parameter == NULL) { m_parameter.grabNew(new T()); } return m_parameter; }
     };
     
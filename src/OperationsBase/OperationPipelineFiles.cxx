@@ -0,0 +1,93 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "OperationPipelineFiles.h"
+
+#include "CaretMutex.h"
+#include "DataFileException.h"
+
+#include <map>
+
+using namespace caret;
+using namespace std;
+
+const AString OperationPipelineFiles::PREFIX = "@";
+
+namespace
+{
+    struct PipelineFile
+    {
+        OperationParametersEnum::Enum m_type;
+        shared_ptr<void> m_file;//holds a CaretPointer of the type matching m_type
+    };
+
+    CaretMutex g_pipelineMutex;
+    bool g_pipelineActive = false;
+    map<AString, PipelineFile> g_pipelineFiles;
+}
+
+void OperationPipelineFiles::beginPipeline()
+{
+    CaretMutexLocker locked(&g_pipelineMutex);
+    g_pipelineFiles.clear();
+    g_pipelineActive = true;
+}
+
+void OperationPipelineFiles::endPipeline()
+{
+    CaretMutexLocker locked(&g_pipelineMutex);
+    g_pipelineFiles.clear();//release the memory of the intermediate files
+    g_pipelineActive = false;
+}
+
+bool OperationPipelineFiles::isPipelineName(const AString& name)
+{
+    CaretMutexLocker locked(&g_pipelineMutex);
+    return g_pipelineActive && name.startsWith(PREFIX) && name.size() > PREFIX.size();
+}
+
+void OperationPipelineFiles::checkFileExists(const AString& name, const OperationParametersEnum::Enum& type)
+{
+    findFile(name, type);
+}
+
+void OperationPipelineFiles::storeFile(const AString& name, const OperationParametersEnum::Enum& type, const shared_ptr<void>& file)
+{
+    CaretMutexLocker locked(&g_pipelineMutex);
+    PipelineFile& myFile = g_pipelineFiles[name];//a later step may replace an intermediate file
+    myFile.m_type = type;
+    myFile.m_file = file;
+}
+
+shared_ptr<void> OperationPipelineFiles::findFile(const AString& name, const OperationParametersEnum::Enum& type)
+{
+    CaretMutexLocker locked(&g_pipelineMutex);
+    map<AString, PipelineFile>::const_iterator iter = g_pipelineFiles.find(name);
+    if (iter == g_pipelineFiles.end())
+    {
+        throw DataFileException(name, "pipeline file has not been output by an earlier step");
+    }
+    if (iter->second.m_type != type)
+    {
+        throw DataFileException(name, "pipeline file is a " + OperationParametersEnum::toName(iter->second.m_type) +
+                                      " file, but is used as a " + OperationParametersEnum::toName(type) + " file");
+    }
+    return iter->second.m_file;
+}
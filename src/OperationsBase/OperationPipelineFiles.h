@@ -0,0 +1,73 @@
+#ifndef __OPERATION_PIPELINE_FILES_H__
+#define __OPERATION_PIPELINE_FILES_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+#include "CaretPointer.h"
+#include "OperationParametersEnum.h"
+
+#include <memory>
+
+namespace caret {
+
+    ///named in-memory files that connect the steps of a pipeline, so intermediate outputs are never written to disk
+    ///while a pipeline is running, an input or output file name starting with PREFIX refers to one of these instead of a file
+    class OperationPipelineFiles
+    {
+        static void storeFile(const AString& name, const OperationParametersEnum::Enum& type, const std::shared_ptr<void>& file);
+        static std::shared_ptr<void> findFile(const AString& name, const OperationParametersEnum::Enum& type);
+    public:
+        static const AString PREFIX;
+
+        static void beginPipeline();
+        static void endPipeline();
+        static bool isPipelineName(const AString& name);
+
+        ///throws if the name has not been produced by an earlier step, or was produced as a different type of file
+        static void checkFileExists(const AString& name, const OperationParametersEnum::Enum& type);
+
+        ///the file is shared with later steps, not copied
+        template<typename T>
+        static void setFile(const AString& name, const OperationParametersEnum::Enum& type, const CaretPointer<T>& file);
+
+        ///returns false if the name isn't a pipeline name (caller should read the file), throws if the named file doesn't exist
+        template<typename T>
+        static bool getFile(const AString& name, const OperationParametersEnum::Enum& type, CaretPointer<T>& fileOut);
+    };
+
+    template<typename T>
+    void OperationPipelineFiles::setFile(const AString& name, const OperationParametersEnum::Enum& type, const CaretPointer<T>& file)
+    {
+        storeFile(name, type, std::shared_ptr<void>(new CaretPointer<T>(file)));
+    }
+
+    template<typename T>
+    bool OperationPipelineFiles::getFile(const AString& name, const OperationParametersEnum::Enum& type, CaretPointer<T>& fileOut)
+    {
+        if (!isPipelineName(name)) return false;
+        fileOut = *static_cast<CaretPointer<T>*>(findFile(name, type).get());
+        return true;
+    }
+
+}
+
+#endif //__OPERATION_PIPELINE_FILES_H__
@@ -26,6 +26,7 @@
 #include "Palette.h"
 #undef __PALETTE_DEFINE__
 
+#include "PaletteLookupTable.h"
 #include "PaletteScalarAndColor.h"
 
 using namespace caret;
@@ -83,6 +84,11 @@ Palette::operator=(const Palette& o)
 void
 Palette::copyHelper(const Palette& o)
 {
+    {
+        CaretMutexLocker locker(&m_lookupTableMutex);
+        m_lookupTables[0].reset();
+        m_lookupTables[1].reset();
+    }
     this->name = o.name;
     this->paletteScalars.clear();
     uint64_t num = o.paletteScalars.size();
@@ -483,6 +489,31 @@ Palette::getPaletteColor(
     }
 }
 
+/**
+ * Get a lookup table for quickly coloring many normalized values with
+ * the same colors as getPaletteColor().  The lookup table is created
+ * when first requested and is replaced when this palette is modified.
+ * A table already handed out stays valid while it is shared, but
+ * it has the colors from before the modification.
+ *
+ * @param interpolateColorFlag
+ *    Interpolate the color between scalars.
+ * @return
+ *    The lookup table.
+ */
+std::shared_ptr<const PaletteLookupTable>
+Palette::getLookupTable(const bool interpolateColorFlag) const
+{
+    const int32_t tableIndex = (interpolateColorFlag ? 1 : 0);
+    CaretMutexLocker locker(&m_lookupTableMutex);
+    if ( ! m_lookupTables[tableIndex]) {
+        m_lookupTables[tableIndex].reset(new PaletteLookupTable(this,
+                                                                interpolateColorFlag));
+    }
+    
+    return m_lookupTables[tableIndex];
+}
+
 /**
  * Set this object has been modified.
  *
@@ -491,6 +522,13 @@ void
 Palette::setModified()
 {
     this->modifiedFlag = true;
+    
+    /*
+     * Lookup tables are no longer valid
+     */
+    CaretMutexLocker locker(&m_lookupTableMutex);
+    m_lookupTables[0].reset();
+    m_lookupTables[1].reset();
 }
 
 /**
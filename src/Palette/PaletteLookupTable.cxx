@@ -0,0 +1,149 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "PaletteLookupTable.h"
+
+#include "CaretAssert.h"
+#include "Palette.h"
+#include "PaletteScalarAndColor.h"
+
+using namespace caret;
+
+/**
+ * Constructor.
+ *
+ * @param palette
+ *    Palette for colors, must exist as long as this lookup table.
+ * @param interpolateColorFlag
+ *    Interpolate the color between scalars.
+ */
+PaletteLookupTable::PaletteLookupTable(const Palette* palette,
+                                       const bool interpolateColorFlag)
+{
+    CaretAssert(palette);
+    m_palette = palette;
+    m_interpolateColorFlag = interpolateColorFlag;
+    m_binsPerUnit = NUMBER_OF_BINS / 2.0f;
+    m_bins.resize(NUMBER_OF_BINS);
+
+    /*
+     * Palette scalars are in DESCENDING order.
+     * Same as Palette::getPaletteColor(), a palette with two colors always interpolates.
+     */
+    const int32_t numScalarColors = palette->getNumberOfScalarsAndColors();
+    const bool interpolateSegmentsFlag = ((numScalarColors == 2)
+                                          || interpolateColorFlag);
+    std::vector<int32_t> segmentIndices(numScalarColors, -1);
+
+    /*
+     * Bins near a palette scalar are searched, the margin is much larger
+     * than rounding error when computing a bin from a value
+     */
+    const double binWidth = 2.0 / NUMBER_OF_BINS;
+    const double margin = binWidth * 0.01;
+    for (int32_t iBin = 0; iBin < NUMBER_OF_BINS; iBin++) {
+        Bin& bin = m_bins[iBin];
+        bin.m_segmentIndex = SEGMENT_SEARCH;
+        const double binLow  = -1.0 + iBin * binWidth;
+        const double binHigh = binLow + binWidth;
+
+        bool containsScalarFlag = false;
+        if (numScalarColors > 1) {
+            for (int32_t i = 0; i < numScalarColors; i++) {
+                const float scalar = palette->getScalarAndColor(i)->getScalar();
+                if ((scalar >= (binLow - margin))
+                    && (scalar <= (binHigh + margin))) {
+                    containsScalarFlag = true;
+                    break;
+                }
+            }
+        }
+        if (containsScalarFlag) {
+            continue;
+        }
+
+        const float binCenter = (binLow + binHigh) / 2.0;
+
+        /*
+         * Find palette scalars above and below the bin
+         */
+        int32_t aboveIndex = -1;
+        if (numScalarColors > 1) {
+            for (int32_t i = 0; i < (numScalarColors - 1); i++) {
+                if ((binCenter < palette->getScalarAndColor(i)->getScalar())
+                    && (binCenter > palette->getScalarAndColor(i + 1)->getScalar())) {
+                    aboveIndex = i;
+                    break;
+                }
+            }
+        }
+
+        bool constantFlag = true;
+        if (aboveIndex >= 0) {
+            const PaletteScalarAndColor* psac = palette->getScalarAndColor(aboveIndex);
+            const PaletteScalarAndColor* psacBelow = palette->getScalarAndColor(aboveIndex + 1);
+            if (interpolateSegmentsFlag
+                && ( ! psac->isNoneColor())
+                && ( ! psacBelow->isNoneColor())) {
+                constantFlag = false;
+                if (segmentIndices[aboveIndex] < 0) {
+                    Segment segment;
+                    psac->getColor(segment.m_rgbaAbove);
+                    const float* rgbaBelow = psacBelow->getColor();
+                    segment.m_rgbBelow[0] = rgbaBelow[0];
+                    segment.m_rgbBelow[1] = rgbaBelow[1];
+                    segment.m_rgbBelow[2] = rgbaBelow[2];
+                    segment.m_belowScalar = psacBelow->getScalar();
+                    segment.m_totalDiff = psac->getScalar() - psacBelow->getScalar();
+                    segmentIndices[aboveIndex] = static_cast<int32_t>(m_segments.size());
+                    m_segments.push_back(segment);
+                }
+                bin.m_segmentIndex = segmentIndices[aboveIndex];
+            }
+        }
+
+        if (constantFlag) {
+            /*
+             * Color does not vary within the bin, so any value in the bin gives the same color
+             */
+            palette->getPaletteColor(binCenter,
+                                     interpolateColorFlag,
+                                     bin.m_rgba);
+            bin.m_segmentIndex = SEGMENT_CONSTANT;
+        }
+    }
+}
+
+/**
+ * Get the color by searching the palette.
+ *
+ * @param normalizedValue
+ *    Normalized value for which color is sought.
+ * @param rgbaOut
+ *    Output containing color components ranging zero to one.
+ */
+void
+PaletteLookupTable::getPaletteColorSearch(const float normalizedValue,
+                                          float rgbaOut[4]) const
+{
+    m_palette->getPaletteColor(normalizedValue,
+                               m_interpolateColorFlag,
+                               rgbaOut);
+}
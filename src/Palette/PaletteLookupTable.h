@@ -0,0 +1,133 @@
+#ifndef __PALETTE_LOOKUP_TABLE_H__
+#define __PALETTE_LOOKUP_TABLE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret {
+
+    class Palette;
+
+    /**
+     * \class caret::PaletteLookupTable
+     * \brief Precomputed palette colors for quickly coloring many normalized values.
+     *
+     * The normalized range [-1, 1] is divided into bins.  A bin that does not
+     * contain a palette scalar has either one color or one pair of colors to
+     * interpolate between, so its color needs no search of the palette.  Bins
+     * containing a palette scalar use Palette::getPaletteColor(), so colors are
+     * identical to those from Palette::getPaletteColor().
+     */
+    class PaletteLookupTable {
+
+    public:
+        PaletteLookupTable(const Palette* palette,
+                           const bool interpolateColorFlag);
+
+        /**
+         * Get the color for a normalized value, same as Palette::getPaletteColor().
+         *
+         * @param normalizedValue
+         *    Normalized value for which color is sought.
+         * @param rgbaOut
+         *    Output containing color components ranging zero to one.
+         */
+        inline void getPaletteColor(const float normalizedValue,
+                                    float rgbaOut[4]) const {
+            const float position = (normalizedValue + 1.0f) * m_binsPerUnit;
+            if ((position >= 0.0f)
+                && (position < NUMBER_OF_BINS)) { /* also false for NaN */
+                const Bin& bin = m_bins[static_cast<int32_t>(position)];
+                if (bin.m_segmentIndex == SEGMENT_CONSTANT) {
+                    rgbaOut[0] = bin.m_rgba[0];
+                    rgbaOut[1] = bin.m_rgba[1];
+                    rgbaOut[2] = bin.m_rgba[2];
+                    rgbaOut[3] = bin.m_rgba[3];
+                    return;
+                }
+                if (bin.m_segmentIndex >= 0) {
+                    /*
+                     * Same operations as Palette::getPaletteColor() so result is identical
+                     */
+                    const Segment& segment = m_segments[bin.m_segmentIndex];
+                    const float offset = normalizedValue - segment.m_belowScalar;
+                    const float percentAbove = offset / segment.m_totalDiff;
+                    const float percentBelow = 1.0f - percentAbove;
+                    rgbaOut[0] = (percentAbove * segment.m_rgbaAbove[0]
+                                  + percentBelow * segment.m_rgbBelow[0]);
+                    rgbaOut[1] = (percentAbove * segment.m_rgbaAbove[1]
+                                  + percentBelow * segment.m_rgbBelow[1]);
+                    rgbaOut[2] = (percentAbove * segment.m_rgbaAbove[2]
+                                  + percentBelow * segment.m_rgbBelow[2]);
+                    rgbaOut[3] = segment.m_rgbaAbove[3];
+                    return;
+                }
+            }
+            getPaletteColorSearch(normalizedValue,
+                                  rgbaOut);
+        }
+
+    private:
+        PaletteLookupTable(const PaletteLookupTable&);
+
+        PaletteLookupTable& operator=(const PaletteLookupTable&);
+
+        void getPaletteColorSearch(const float normalizedValue,
+                                   float rgbaOut[4]) const;
+
+        /** Number of bins covering [-1, 1] */
+        static const int32_t NUMBER_OF_BINS = 4096;
+
+        /** Bin uses its color */
+        static const int32_t SEGMENT_CONSTANT = -1;
+
+        /** Bin contains a palette scalar, so the palette must be searched */
+        static const int32_t SEGMENT_SEARCH = -2;
+
+        /** A pair of adjacent palette scalars that colors are interpolated between */
+        struct Segment {
+            float m_rgbaAbove[4];
+            float m_rgbBelow[3];
+            float m_belowScalar;
+            float m_totalDiff;
+        };
+
+        struct Bin {
+            int32_t m_segmentIndex;
+            float m_rgba[4];
+        };
+
+        const Palette* m_palette;
+
+        bool m_interpolateColorFlag;
+
+        float m_binsPerUnit;
+
+        std::vector<Segment> m_segments;
+
+        std::vector<Bin> m_bins;
+    };
+
+} // namespace
+
+#endif  //__PALETTE_LOOKUP_TABLE_H__
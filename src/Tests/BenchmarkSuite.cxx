@@ -0,0 +1,470 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "BenchmarkSuite.h"
+
+#include "AlgorithmCiftiCorrelation.h"
+#include "AlgorithmMetricResample.h"
+#include "AlgorithmMetricSmoothing.h"
+#include "AlgorithmMetricTFCE.h"
+#include "AlgorithmSurfaceCreateSphere.h"
+#include "AlgorithmVolumeSmoothing.h"
+#include "AlgorithmVolumeTFCE.h"
+#include "ApplicationInformation.h"
+#include "CaretException.h"
+#include "CaretOMP.h"
+#include "CiftiFile.h"
+#include "ElapsedTimer.h"
+#include "GeodesicHelper.h"
+#include "MetricFile.h"
+#include "SurfaceFile.h"
+#include "VolumeFile.h"
+
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    const int NUM_METRIC_COLUMNS = 4;
+    const int NUM_GEODESIC_STARTS = 64;
+    const float SURFACE_KERNEL = 4.0f;//mm, on the radius 100 sphere made by AlgorithmSurfaceCreateSphere
+    const float VOLUME_KERNEL = 4.0f;
+    const float VOXEL_SIZE = 2.0f;
+
+    AString jsonString(const AString& input)
+    {
+        AString ret = input;
+        ret.replace("\\", "\\\\");
+        ret.replace("\"", "\\\"");
+        ret.replace("\n", "\\n");
+        return "\"" + ret + "\"";
+    }
+
+    void fillRandom(mt19937& generator, vector<float>& data)
+    {
+        normal_distribution<float> dist(0.0f, 1.0f);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = dist(generator);
+        }
+    }
+
+    CaretPointer<CiftiFile> makeDtseries(mt19937& generator, const int64_t& numVertices, const int64_t& numTimepoints)
+    {
+        CiftiBrainModelsMap myModels;
+        myModels.addSurfaceModel(numVertices, StructureEnum::CORTEX_LEFT);
+        CiftiXML myXML;
+        myXML.setNumberOfDimensions(2);
+        myXML.setMap(CiftiXML::ALONG_ROW, CiftiSeriesMap(numTimepoints, 0.0f, 0.72f));
+        myXML.setMap(CiftiXML::ALONG_COLUMN, myModels);
+        CaretPointer<CiftiFile> ret(new CiftiFile());
+        ret->setCiftiXML(myXML);
+        vector<float> row(numTimepoints);
+        for (int64_t i = 0; i < numVertices; ++i)
+        {
+            fillRandom(generator, row);
+            ret->setRow(row.data(), i);
+        }
+        return ret;
+    }
+
+    void readAllRows(const CiftiFile& myCifti)
+    {
+        vector<float> row(myCifti.getNumberOfColumns());
+        const int64_t numRows = myCifti.getNumberOfRows();
+        for (int64_t i = 0; i < numRows; ++i)
+        {
+            myCifti.getRow(row.data(), i);
+        }
+    }
+
+    vector<int> defaultThreadCounts()
+    {
+        int maxThreads = 1;
+#ifdef CARET_OMP
+        maxThreads = omp_get_max_threads();
+#endif
+        vector<int> ret;
+        for (int threads = 1; threads < maxThreads; threads *= 2)
+        {
+            ret.push_back(threads);
+        }
+        ret.push_back(maxThreads);
+        return ret;
+    }
+
+    void setThreadCount(const int& threads)
+    {
+#ifdef CARET_OMP
+        omp_set_num_threads(threads);
+#endif
+    }
+}
+
+BenchmarkSuite::Options::Options()
+{
+    m_repeats = 3;
+    m_sphereVertices = 32492;
+    m_timepoints = 400;
+    m_volumeDim = 96;
+    m_seed = 12345;
+}
+
+BenchmarkSuite::BenchmarkSuite(const Options& options) : m_options(options)
+{
+    m_generated = false;
+    if (m_options.m_repeats < 1) throw CaretException("benchmark repeats must be positive");
+    if (m_options.m_sphereVertices < 4 * 12) throw CaretException("benchmark sphere needs at least 48 vertices");
+    if (m_options.m_timepoints < 2) throw CaretException("benchmark timeseries needs at least 2 timepoints");
+    if (m_options.m_volumeDim < 8) throw CaretException("benchmark volume dimension must be at least 8");
+    vector<AString> allNames = getKernelNames();
+    for (size_t i = 0; i < m_options.m_kernels.size(); ++i)
+    {
+        if (find(allNames.begin(), allNames.end(), m_options.m_kernels[i]) == allNames.end())
+        {
+            throw CaretException("unknown benchmark kernel '" + m_options.m_kernels[i] + "'");
+        }
+    }
+    if (m_options.m_threadCounts.empty()) m_options.m_threadCounts = defaultThreadCounts();
+}
+
+BenchmarkSuite::~BenchmarkSuite()
+{
+}
+
+vector<AString> BenchmarkSuite::getKernelNames()
+{
+    BenchmarkSuite dummy((Options()));
+    vector<Kernel> kernels = dummy.getKernels();
+    vector<AString> ret;
+    for (size_t i = 0; i < kernels.size(); ++i)
+    {
+        ret.push_back(kernels[i].m_name);
+    }
+    return ret;
+}
+
+vector<BenchmarkSuite::Kernel> BenchmarkSuite::getKernels() const
+{
+    const int64_t ciftiBytes = int64_t(m_options.m_sphereVertices) * m_options.m_timepoints * sizeof(float);//approximate, sphere creation rounds the vertex count
+    const int64_t volumeBytes = int64_t(m_options.m_volumeDim) * m_options.m_volumeDim * m_options.m_volumeDim * sizeof(float);
+    vector<Kernel> ret;
+    Kernel temp;
+    temp.m_threaded = false;
+    temp.m_bytes = ciftiBytes;
+    temp.m_name = "cifti-write-ondisk"; temp.m_function = &BenchmarkSuite::ciftiWriteOnDisk; ret.push_back(temp);
+    temp.m_name = "cifti-read-ondisk"; temp.m_function = &BenchmarkSuite::ciftiReadOnDisk; ret.push_back(temp);
+    temp.m_name = "cifti-read-inmemory"; temp.m_function = &BenchmarkSuite::ciftiReadInMemory; ret.push_back(temp);
+    temp.m_name = "cifti-write-gz"; temp.m_function = &BenchmarkSuite::ciftiWriteGz; ret.push_back(temp);
+    temp.m_name = "cifti-read-gz"; temp.m_function = &BenchmarkSuite::ciftiReadGz; ret.push_back(temp);
+    temp.m_threaded = true;
+    temp.m_bytes = ciftiBytes / 4;
+    temp.m_name = "correlation"; temp.m_function = &BenchmarkSuite::correlation; ret.push_back(temp);
+    temp.m_bytes = int64_t(m_options.m_sphereVertices) * NUM_METRIC_COLUMNS * sizeof(float);
+    temp.m_name = "metric-smoothing"; temp.m_function = &BenchmarkSuite::metricSmoothing; ret.push_back(temp);
+    temp.m_name = "metric-resample"; temp.m_function = &BenchmarkSuite::metricResample; ret.push_back(temp);
+    temp.m_name = "metric-tfce"; temp.m_function = &BenchmarkSuite::metricTFCE; ret.push_back(temp);
+    temp.m_bytes = volumeBytes;
+    temp.m_name = "volume-smoothing"; temp.m_function = &BenchmarkSuite::volumeSmoothing; ret.push_back(temp);
+    temp.m_name = "volume-tfce"; temp.m_function = &BenchmarkSuite::volumeTFCE; ret.push_back(temp);
+    temp.m_bytes = 0;
+    temp.m_name = "geodesic"; temp.m_function = &BenchmarkSuite::geodesic; ret.push_back(temp);
+    temp.m_threaded = false;
+    temp.m_bytes = int64_t(m_options.m_sphereVertices) * (NUM_METRIC_COLUMNS + 3) * sizeof(float);//triangles not counted
+    temp.m_name = "gifti-write"; temp.m_function = &BenchmarkSuite::giftiWrite; ret.push_back(temp);
+    temp.m_name = "gifti-read"; temp.m_function = &BenchmarkSuite::giftiRead; ret.push_back(temp);
+    return ret;
+}
+
+void BenchmarkSuite::generateInputs()
+{
+    if (m_generated) return;
+    if (m_options.m_workDir.isEmpty())
+    {
+        m_tempDir.grabNew(new QTemporaryDir());
+        if (!m_tempDir->isValid()) throw CaretException("failed to create temporary directory for benchmark files");
+        m_workDir = m_tempDir->path();
+    } else {
+        m_workDir = m_options.m_workDir;
+    }
+    mt19937 generator(m_options.m_seed);
+    m_sphere.grabNew(new SurfaceFile());
+    AlgorithmSurfaceCreateSphere(NULL, m_options.m_sphereVertices, m_sphere);
+    m_coarseSphere.grabNew(new SurfaceFile());
+    AlgorithmSurfaceCreateSphere(NULL, m_options.m_sphereVertices / 4, m_coarseSphere);
+    const int numVertices = m_sphere->getNumberOfNodes();
+    m_metric.grabNew(new MetricFile());
+    m_metric->setNumberOfNodesAndColumns(numVertices, NUM_METRIC_COLUMNS);
+    m_metric->setStructure(StructureEnum::CORTEX_LEFT);
+    vector<float> scratch(numVertices);
+    for (int i = 0; i < NUM_METRIC_COLUMNS; ++i)
+    {
+        fillRandom(generator, scratch);
+        m_metric->setValuesForColumn(i, scratch.data());
+    }
+    m_smoothMetric.grabNew(new MetricFile());//smooth noise has clusters of varying size, more representative input for tfce than raw noise
+    AlgorithmMetricSmoothing(NULL, m_sphere, m_metric, SURFACE_KERNEL, m_smoothMetric);
+    vector<int64_t> dims(3, m_options.m_volumeDim);
+    vector<vector<float> > sform(3, vector<float>(4, 0.0f));
+    for (int i = 0; i < 3; ++i)
+    {
+        sform[i][i] = VOXEL_SIZE;
+        sform[i][3] = -VOXEL_SIZE * m_options.m_volumeDim / 2;
+    }
+    m_volume.grabNew(new VolumeFile(dims, sform));
+    scratch.resize(dims[0] * dims[1] * dims[2]);
+    fillRandom(generator, scratch);
+    m_volume->setFrame(scratch.data());
+    m_smoothVolume.grabNew(new VolumeFile());
+    AlgorithmVolumeSmoothing(NULL, m_volume, VOLUME_KERNEL, m_smoothVolume);
+    m_dtseries = makeDtseries(generator, numVertices, m_options.m_timepoints);
+    m_coarseDtseries = makeDtseries(generator, m_coarseSphere->getNumberOfNodes(), m_options.m_timepoints);
+    uniform_int_distribution<int32_t> nodeDist(0, numVertices - 1);
+    m_geodesicStarts.resize(NUM_GEODESIC_STARTS);
+    for (int i = 0; i < NUM_GEODESIC_STARTS; ++i)
+    {
+        m_geodesicStarts[i] = nodeDist(generator);
+    }
+    //files for the read kernels, so any subset of kernels can be run
+    m_dtseries->writeFile(m_workDir + "/input.dtseries.nii");
+    m_dtseries->writeFile(m_workDir + "/input.dtseries.nii.gz");
+    m_sphere->writeFile(m_workDir + "/input.surf.gii");
+    m_metric->writeFile(m_workDir + "/input.func.gii");
+    m_generated = true;
+}
+
+bool BenchmarkSuite::run(const AString& jsonFileName)
+{
+    cout << "generating benchmark inputs in " << flush;
+    generateInputs();
+    cout << m_workDir << endl;
+    int maxThreads = 1;
+#ifdef CARET_OMP
+    maxThreads = omp_get_max_threads();
+#endif
+    vector<Kernel> kernels = getKernels();
+    vector<Result> results;
+    bool success = true;
+    for (size_t i = 0; i < kernels.size(); ++i)
+    {
+        if (!m_options.m_kernels.empty() && find(m_options.m_kernels.begin(), m_options.m_kernels.end(), kernels[i].m_name) == m_options.m_kernels.end()) continue;
+        vector<int> threadCounts = kernels[i].m_threaded ? m_options.m_threadCounts : vector<int>(1, 1);
+        for (size_t j = 0; j < threadCounts.size(); ++j)
+        {
+            Result myResult;
+            myResult.m_kernel = kernels[i].m_name;
+            myResult.m_threads = threadCounts[j];
+            myResult.m_bytes = kernels[i].m_bytes;
+            setThreadCount(threadCounts[j]);
+            try
+            {
+                (this->*kernels[i].m_function)();//warmup, not recorded, also gets any lazily built helpers out of the timings
+                for (int k = 0; k < m_options.m_repeats; ++k)
+                {
+                    ElapsedTimer myTimer;
+                    myTimer.start();
+                    (this->*kernels[i].m_function)();
+                    myResult.m_seconds.push_back(myTimer.getElapsedTimeSeconds());
+                }
+            } catch (CaretException& e) {
+                myResult.m_error = e.whatString();
+                success = false;
+            }
+            setThreadCount(maxThreads);
+            results.push_back(myResult);
+            cout << myResult.m_kernel << ", " << myResult.m_threads << " thread(s): ";
+            if (myResult.m_error.isEmpty())
+            {
+                cout << *min_element(myResult.m_seconds.begin(), myResult.m_seconds.end()) << " s (best of " << myResult.m_seconds.size() << ")" << endl;
+            } else {
+                cout << "failed: " << myResult.m_error << endl;
+            }
+        }
+    }
+    writeJson(jsonFileName, results);
+    return success;
+}
+
+void BenchmarkSuite::writeJson(const AString& jsonFileName, const vector<Result>& results) const
+{
+    ofstream output(jsonFileName.toLocal8Bit().constData());
+    if (!output) throw CaretException("unable to open benchmark output file '" + jsonFileName + "'");
+    int maxThreads = 1;
+#ifdef CARET_OMP
+    maxThreads = omp_get_max_threads();
+#endif
+    ApplicationInformation myInfo;
+    output << "{" << endl;
+    output << "  \"version\": " << jsonString(myInfo.getVersion()) << "," << endl;
+    output << "  \"commit\": " << jsonString(myInfo.getCommit()) << "," << endl;
+    output << "  \"max_threads\": " << maxThreads << "," << endl;
+    output << "  \"options\": {\"repeats\": " << m_options.m_repeats << ", \"sphere_vertices\": " << m_sphere->getNumberOfNodes()
+           << ", \"coarse_sphere_vertices\": " << m_coarseSphere->getNumberOfNodes() << ", \"timepoints\": " << m_options.m_timepoints
+           << ", \"volume_dim\": " << m_options.m_volumeDim << ", \"seed\": " << m_options.m_seed << "}," << endl;
+    output << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& myResult = results[i];
+        if (i != 0) output << ",";
+        output << endl << "    {\"kernel\": " << jsonString(myResult.m_kernel) << ", \"threads\": " << myResult.m_threads;
+        if (!myResult.m_error.isEmpty())
+        {
+            output << ", \"error\": " << jsonString(myResult.m_error) << "}";
+            continue;
+        }
+        vector<double> sorted = myResult.m_seconds;
+        sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        output << ", \"seconds\": [";
+        for (size_t j = 0; j < myResult.m_seconds.size(); ++j)
+        {
+            if (j != 0) output << ", ";
+            output << myResult.m_seconds[j];
+            sum += myResult.m_seconds[j];
+        }
+        output << "], \"min\": " << sorted[0] << ", \"median\": " << sorted[sorted.size() / 2] << ", \"mean\": " << sum / sorted.size();
+        if (myResult.m_bytes > 0 && sorted[0] > 0.0)
+        {
+            output << ", \"bytes\": " << myResult.m_bytes << ", \"mb_per_second\": " << myResult.m_bytes / sorted[0] / 1000000.0;
+        }
+        for (size_t j = 0; j < results.size(); ++j)
+        {//speedup relative to the single thread result of the same kernel, for the scaling sweep
+            if (results[j].m_kernel == myResult.m_kernel && results[j].m_threads == 1 && results[j].m_error.isEmpty() && myResult.m_threads != 1)
+            {
+                output << ", \"speedup\": " << *min_element(results[j].m_seconds.begin(), results[j].m_seconds.end()) / sorted[0];
+                break;
+            }
+        }
+        output << "}";
+    }
+    output << endl << "  ]" << endl << "}" << endl;
+    if (!output) throw CaretException("error writing benchmark output file '" + jsonFileName + "'");
+}
+
+void BenchmarkSuite::ciftiWriteOnDisk()
+{
+    CiftiFile writer;
+    writer.setWritingFile(m_workDir + "/output.dtseries.nii");
+    writer.setCiftiXML(m_dtseries->getCiftiXML());
+    vector<float> row(m_dtseries->getNumberOfColumns());
+    const int64_t numRows = m_dtseries->getNumberOfRows();
+    for (int64_t i = 0; i < numRows; ++i)
+    {
+        m_dtseries->getRow(row.data(), i);
+        writer.setRow(row.data(), i);
+    }
+    writer.close();
+}
+
+void BenchmarkSuite::ciftiReadOnDisk()
+{
+    CiftiFile reader(m_workDir + "/input.dtseries.nii");
+    readAllRows(reader);
+}
+
+void BenchmarkSuite::ciftiReadInMemory()
+{
+    CiftiFile reader(m_workDir + "/input.dtseries.nii");
+    reader.convertToInMemory();
+    readAllRows(reader);
+}
+
+void BenchmarkSuite::ciftiWriteGz()
+{
+    m_dtseries->writeFile(m_workDir + "/output.dtseries.nii.gz");
+}
+
+void BenchmarkSuite::ciftiReadGz()
+{
+    CiftiFile reader(m_workDir + "/input.dtseries.nii.gz");
+    readAllRows(reader);//sequential, as random row access to a compressed file is much slower
+}
+
+void BenchmarkSuite::correlation()
+{
+    CiftiFile output;
+    AlgorithmCiftiCorrelation(NULL, m_coarseDtseries, &output);
+}
+
+void BenchmarkSuite::metricSmoothing()
+{
+    MetricFile output;
+    AlgorithmMetricSmoothing(NULL, m_sphere, m_metric, SURFACE_KERNEL, &output);
+}
+
+void BenchmarkSuite::volumeSmoothing()
+{
+    VolumeFile output;
+    AlgorithmVolumeSmoothing(NULL, m_volume, VOLUME_KERNEL, &output);
+}
+
+void BenchmarkSuite::metricResample()
+{
+    MetricFile output;
+    AlgorithmMetricResample(NULL, m_metric, m_sphere, m_coarseSphere, SurfaceResamplingMethodEnum::BARYCENTRIC, &output);
+}
+
+void BenchmarkSuite::metricTFCE()
+{
+    MetricFile output;
+    AlgorithmMetricTFCE(NULL, m_sphere, m_smoothMetric, &output);
+}
+
+void BenchmarkSuite::volumeTFCE()
+{
+    VolumeFile output;
+    AlgorithmVolumeTFCE(NULL, m_smoothVolume, &output);
+}
+
+void BenchmarkSuite::geodesic()
+{
+    const int numVertices = m_sphere->getNumberOfNodes();
+#pragma omp CARET_PAR
+    {
+        CaretPointer<GeodesicHelper> myHelper = m_sphere->getGeodesicHelper();
+        vector<float> distances(numVertices);
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int i = 0; i < (int)m_geodesicStarts.size(); ++i)
+        {
+            myHelper->getGeoFromNode(m_geodesicStarts[i], distances.data());
+        }
+    }
+}
+
+void BenchmarkSuite::giftiWrite()
+{
+    m_sphere->writeFile(m_workDir + "/output.surf.gii");
+    m_metric->writeFile(m_workDir + "/output.func.gii");
+}
+
+void BenchmarkSuite::giftiRead()
+{
+    SurfaceFile mySurf;
+    mySurf.readFile(m_workDir + "/input.surf.gii");
+    MetricFile myMetric;
+    myMetric.readFile(m_workDir + "/input.func.gii");
+}
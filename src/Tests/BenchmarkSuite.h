@@ -0,0 +1,108 @@
+#ifndef __BENCHMARK_SUITE_H__
+#define __BENCHMARK_SUITE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "AString.h"
+#include "CaretPointer.h"
+
+#include <stdint.h>
+#include <vector>
+
+class QTemporaryDir;
+
+namespace caret {
+
+    class CiftiFile;
+    class MetricFile;
+    class SurfaceFile;
+    class VolumeFile;
+
+    ///times core processing kernels on synthetic inputs generated from a fixed seed, so runs with the same options are comparable across builds
+    ///threaded kernels are run at each thread count in the sweep, results are written as json
+    class BenchmarkSuite
+    {
+    public:
+        struct Options
+        {
+            std::vector<int> m_threadCounts;//empty means powers of 2 up to the openmp maximum
+            int m_repeats;
+            int m_sphereVertices;//correlation uses a sphere with a quarter as many vertices, as its output is square
+            int m_timepoints;
+            int m_volumeDim;
+            unsigned int m_seed;
+            AString m_workDir;//for the files used by the io kernels, empty means a new temporary directory
+            std::vector<AString> m_kernels;//empty means all
+            Options();
+        };
+        BenchmarkSuite(const Options& options);
+        ~BenchmarkSuite();
+        static std::vector<AString> getKernelNames();
+        ///returns false if any kernel threw, results from the other kernels are still written
+        bool run(const AString& jsonFileName);
+    private:
+        struct Kernel
+        {
+            AString m_name;
+            bool m_threaded;
+            int64_t m_bytes;//data moved by one run, for throughput, 0 if not meaningful
+            void (BenchmarkSuite::*m_function)();
+        };
+        struct Result
+        {
+            AString m_kernel, m_error;
+            int m_threads;
+            int64_t m_bytes;
+            std::vector<double> m_seconds;
+        };
+        BenchmarkSuite(const BenchmarkSuite&);
+        BenchmarkSuite& operator=(const BenchmarkSuite&);
+        std::vector<Kernel> getKernels() const;
+        void generateInputs();
+        void writeJson(const AString& jsonFileName, const std::vector<Result>& results) const;
+
+        void ciftiWriteOnDisk();
+        void ciftiReadOnDisk();
+        void ciftiReadInMemory();
+        void ciftiWriteGz();
+        void ciftiReadGz();
+        void correlation();
+        void metricSmoothing();
+        void volumeSmoothing();
+        void metricResample();
+        void metricTFCE();
+        void volumeTFCE();
+        void geodesic();
+        void giftiWrite();
+        void giftiRead();
+
+        Options m_options;
+        AString m_workDir;
+        CaretPointer<QTemporaryDir> m_tempDir;
+        bool m_generated;
+        CaretPointer<SurfaceFile> m_sphere, m_coarseSphere;
+        CaretPointer<MetricFile> m_metric, m_smoothMetric;
+        CaretPointer<VolumeFile> m_volume, m_smoothVolume;
+        CaretPointer<CiftiFile> m_dtseries, m_coarseDtseries;
+        std::vector<int32_t> m_geodesicStarts;
+    };
+
+}
+#endif //__BENCHMARK_SUITE_H__
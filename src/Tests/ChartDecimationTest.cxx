@@ -0,0 +1,143 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "ChartDecimationTest.h"
+
+#include "ChartTwoDataCartesian.h"
+#include "GraphicsPrimitiveV3f.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace caret;
+using namespace std;
+
+ChartDecimationTest::ChartDecimationTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    //checks the drawn points against buckets of the given size, returns an empty string if every visible bucket has its first, last, minimum and maximum points and no others
+    AString checkBuckets(const vector<int64_t>& drawnIndices, const vector<float>& yValues, const int64_t& firstVisible, const int64_t& lastVisible, const int64_t& bucketSize)
+    {
+        const int64_t numPoints = (int64_t)yValues.size();
+        const int64_t firstBucket = firstVisible / bucketSize, lastBucket = lastVisible / bucketSize;
+        size_t drawn = 0;
+        for (int64_t bucket = firstBucket; bucket <= lastBucket; ++bucket)
+        {
+            const int64_t bucketStart = bucket * bucketSize, bucketEnd = min((bucket + 1) * bucketSize, numPoints);
+            float minY = yValues[bucketStart], maxY = yValues[bucketStart];
+            for (int64_t i = bucketStart + 1; i < bucketEnd; ++i)
+            {
+                minY = min(minY, yValues[i]);
+                maxY = max(maxY, yValues[i]);
+            }
+            bool haveFirst = false, haveLast = false, haveMin = false, haveMax = false;
+            int numInBucket = 0;
+            while (drawn < drawnIndices.size() && drawnIndices[drawn] < bucketEnd)
+            {
+                const int64_t index = drawnIndices[drawn];
+                if (index < bucketStart) return "point " + AString::number(index) + " is outside the visible buckets";
+                if (index == bucketStart) haveFirst = true;
+                if (index == bucketEnd - 1) haveLast = true;
+                if (yValues[index] == minY) haveMin = true;
+                if (yValues[index] == maxY) haveMax = true;
+                ++numInBucket;
+                ++drawn;
+            }
+            if (!haveFirst) return "bucket starting at " + AString::number(bucketStart) + " is missing its first point";
+            if (!haveLast) return "bucket starting at " + AString::number(bucketStart) + " is missing its last point";
+            if (!haveMin) return "bucket starting at " + AString::number(bucketStart) + " is missing its minimum";
+            if (!haveMax) return "bucket starting at " + AString::number(bucketStart) + " is missing its maximum";
+            if (numInBucket > 4) return "bucket starting at " + AString::number(bucketStart) + " has " + AString::number(numInBucket) + " points";
+        }
+        if (drawn != drawnIndices.size()) return "point " + AString::number(drawnIndices[drawn]) + " is outside the visible buckets";
+        return "";
+    }
+}
+
+void ChartDecimationTest::checkRange(const ChartTwoDataCartesian& chartData, const vector<float>& yValues, const float& xMinimum, const float& xMaximum, const int& width)
+{
+    const AString rangeText = "range " + AString::number(xMinimum) + " to " + AString::number(xMaximum) + ", width " + AString::number(width) + ": ";
+    const int64_t numPoints = (int64_t)yValues.size();
+    const GraphicsPrimitiveV3f* drawPrimitive = chartData.getGraphicsPrimitiveForDrawing(xMinimum, xMaximum, width);
+    const vector<float>& xyz = drawPrimitive->getFloatXYZ();
+    const int64_t numDrawn = drawPrimitive->getNumberOfVertices();
+    vector<int64_t> drawnIndices(numDrawn);
+    for (int64_t i = 0; i < numDrawn; ++i)
+    {//x is the point index, so drawn points can be matched to the data
+        const int64_t index = (int64_t)xyz[i * 3];
+        if (index < 0 || index >= numPoints || xyz[i * 3] != (float)index || xyz[i * 3 + 1] != yValues[index])
+        {
+            setFailed(rangeText + "drawn point " + AString::number(i) + " is not a data point");
+            return;
+        }
+        if (i > 0 && index <= drawnIndices[i - 1])
+        {
+            setFailed(rangeText + "drawn points are not in increasing order");
+            return;
+        }
+        drawnIndices[i] = index;
+    }
+    const int64_t firstVisible = max((int64_t)ceil(xMinimum) - 1, (int64_t)0);//includes the point on each side of the visible range
+    const int64_t lastVisible = min((int64_t)floor(xMaximum) + 1, numPoints - 1);
+    if (numDrawn >= lastVisible - firstVisible + 1)
+    {
+        setFailed(rangeText + "points were not decimated");
+        return;
+    }
+    //the bucket size depends on the level chosen for the width, accept any power of two whose buckets are all kept correctly
+    AString firstError;
+    for (int64_t bucketSize = 2; bucketSize <= numPoints * 2; bucketSize *= 2)
+    {
+        const AString error = checkBuckets(drawnIndices, yValues, firstVisible, lastVisible, bucketSize);
+        if (error.isEmpty())
+        {
+            if ((lastVisible - firstVisible + 1) / bucketSize > width) setFailed(rangeText + "more buckets than pixels");
+            return;
+        }
+        if (firstError.isEmpty()) firstError = error;
+    }
+    setFailed(rangeText + "no bucket size matches the drawn points, with the smallest: " + firstError);
+}
+
+void ChartDecimationTest::execute()
+{
+    const int64_t NUM_POINTS = 100003;//not a power of two, so the last bucket of each level is partial
+    mt19937 myrand(46);
+    normal_distribution<float> mydist;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        ChartTwoDataCartesian chartData(ChartTwoDataTypeEnum::CHART_DATA_TYPE_LINE_SERIES, CaretUnitsTypeEnum::NONE, CaretUnitsTypeEnum::NONE,
+                                        GraphicsPrimitive::PrimitiveType::OPENGL_LINE_STRIP);
+        vector<float> yValues(NUM_POINTS);
+        for (int64_t i = 0; i < NUM_POINTS; ++i)
+        {
+            yValues[i] = mydist(myrand);
+            if (pass == 1) yValues[i] = floor(yValues[i] * 2.0f);//many ties
+            chartData.addPoint(i, yValues[i]);
+        }
+        checkRange(chartData, yValues, 0.0f, NUM_POINTS - 1, 500);
+        checkRange(chartData, yValues, 20000.5f, 31000.25f, 300);
+        checkRange(chartData, yValues, 99000.0f, NUM_POINTS - 1, 7);
+        checkRange(chartData, yValues, 0.0f, NUM_POINTS - 1, 1);
+    }
+}
@@ -0,0 +1,117 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "CorrelationGradientTest.h"
+
+#include "AlgorithmCiftiCorrelationGradient.h"
+#include "CaretException.h"
+#include "CiftiFile.h"
+#include "FloatMatrix.h"
+#include "VolumeSpace.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+CorrelationGradientTest::CorrelationGradientTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void CorrelationGradientTest::execute()
+{
+    //voxel timeseries that are mixtures of 3 random signals, with mixing weights that vary smoothly across the volume, so the correlation matrix is exactly rank 3
+    const int64_t dims[3] = { 6, 5, 4 }, numTimepoints = 120, numSources = 3;
+    mt19937 generator(1);
+    normal_distribution<float> dist;
+    vector<vector<float> > sources(numSources, vector<float>(numTimepoints));
+    for (int64_t s = 0; s < numSources; ++s)
+    {
+        for (int64_t t = 0; t < numTimepoints; ++t)
+        {
+            sources[s][t] = dist(generator);
+        }
+    }
+    vector<int64_t> ijkList;
+    for (int64_t k = 0; k < dims[2]; ++k)
+    {
+        for (int64_t j = 0; j < dims[1]; ++j)
+        {
+            for (int64_t i = 0; i < dims[0]; ++i)
+            {
+                ijkList.push_back(i);
+                ijkList.push_back(j);
+                ijkList.push_back(k);
+            }
+        }
+    }
+    CiftiBrainModelsMap myModels;
+    myModels.setVolumeSpace(VolumeSpace(dims, FloatMatrix::identity(4).getMatrix()));
+    myModels.addVolumeModel(StructureEnum::THALAMUS_LEFT, ijkList);
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    myXML.setMap(CiftiXML::ALONG_ROW, CiftiSeriesMap(numTimepoints));
+    myXML.setMap(CiftiXML::ALONG_COLUMN, myModels);
+    CiftiFile input;
+    input.setCiftiXML(myXML);
+    const int64_t numRows = (int64_t)ijkList.size() / 3;
+    vector<float> row(numTimepoints);
+    for (int64_t r = 0; r < numRows; ++r)
+    {
+        const float i = ijkList[r * 3], j = ijkList[r * 3 + 1], k = ijkList[r * 3 + 2];
+        const float weights[numSources] = { 1.0f + 0.3f * i, 0.5f + 0.2f * j * j, 1.0f + sin(0.7f * k + 0.4f * i) };
+        for (int64_t t = 0; t < numTimepoints; ++t)
+        {
+            row[t] = 10.0f;//nonzero mean, it should be removed
+            for (int64_t s = 0; s < numSources; ++s)
+            {
+                row[t] += weights[s] * sources[s][t];
+            }
+        }
+        input.setRow(row.data(), r);
+    }
+    CiftiFile fullOut, lowRankOut;
+    AlgorithmCiftiCorrelationGradient fullAlg(NULL, &input, &fullOut);
+    if (fullAlg.getLowRankComponents() != 0)
+    {
+        setFailed("full correlation gradient reported using a low rank basis");
+        return;
+    }
+    AlgorithmCiftiCorrelationGradient lowRankAlg(NULL, &input, &lowRankOut, NULL, NULL, NULL, NULL, NULL, NULL, -1.0f, -1.0f, false, false, -1.0f, -1.0f, false, -1.0f,
+                                                 false, false, false, false, 0.99f);
+    if (lowRankAlg.getLowRankComponents() < 1 || lowRankAlg.getLowRankComponents() > numSources)
+    {//fewer timepoints than the old minimum subspace of 256 used to always fall back to full correlation
+        setFailed("low rank correlation gradient used " + AString::number(lowRankAlg.getLowRankComponents()) + " components on rank " + AString::number(numSources) + " input");
+        return;
+    }
+    vector<float> fullGrad(numRows), lowRankGrad(numRows);
+    fullOut.getColumn(fullGrad.data(), 0);
+    lowRankOut.getColumn(lowRankGrad.data(), 0);
+    const float tolerance = 0.001f;//correlations agree to float precision, the gradient averages differences of them
+    for (int64_t r = 0; r < numRows; ++r)
+    {
+        if (!(abs(fullGrad[r] - lowRankGrad[r]) <= tolerance * max(1.0f, abs(fullGrad[r]))))
+        {
+            setFailed("low rank gradient at row " + AString::number(r) + " was " + AString::number(lowRankGrad[r]) + ", full gradient was " + AString::number(fullGrad[r]));
+            return;
+        }
+    }
+}
@@ -21,6 +21,7 @@
 
 #include "CaretMathExpression.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
@@ -55,4 +56,60 @@ void MathExpressionTest::execute()
     {
         setFailed("output value incorrect, expected " + AString::number(correctresult) + ", got " + AString::number(testresult));
     }
+    //compiled evaluation of many elements must match the per-element evaluation, use enough elements for multiple blocks
+    CaretMathExpression blockExpr("mod(x, 3) + (x > 2) * clamp(yip, -1, 1) - (x == yip) + max(x, 2) / 4 - (x <= 3 || yip >= 0) + -yip ^ 2 + !(x != 1) + 5");
+    const int64_t numElements = 2500;
+    vector<float> xData(numElements), yipData(numElements), blockResult(numElements);
+    for (int64_t i = 0; i < numElements; ++i)
+    {
+        xData[i] = (i % 17) * 0.5f - 2.0f;
+        yipData[i] = (i % 13) * 0.25f - 1.5f;
+    }
+    vector<const float*> blockVars(2);
+    if (blockExpr.getVarNames()[0] == "x")
+    {
+        blockVars[0] = xData.data();
+        blockVars[1] = yipData.data();
+    } else {
+        blockVars[0] = yipData.data();
+        blockVars[1] = xData.data();
+    }
+    blockExpr.evaluate(blockVars, blockResult.data(), numElements);
+    for (int64_t i = 0; i < numElements; ++i)
+    {
+        vars[0] = blockVars[0][i];
+        vars[1] = blockVars[1][i];
+        float expected = (float)blockExpr.evaluate(vars);
+        if (blockResult[i] != expected)
+        {
+            setFailed("block evaluation incorrect at element " + AString::number(i) + ", expected " + AString::number(expected) + ", got " + AString::number(blockResult[i]));
+            break;
+        }
+    }
+    //constants that come after freed temporaries must not share a register with them
+    const char* constExprs[2] = {"(x+y)*2+z", "max(x+y,2)*z"};
+    const float constX[3] = {1.0f, -3.0f, 0.5f}, constY[3] = {10.0f, 1.0f, 0.25f}, constZ[3] = {100.0f, 7.0f, -2.0f};
+    for (int e = 0; e < 2; ++e)
+    {
+        CaretMathExpression constExpr(constExprs[e]);
+        vector<AString> constNames = constExpr.getVarNames();
+        vector<const float*> constVars(constNames.size());
+        for (int v = 0; v < (int)constNames.size(); ++v)
+        {
+            if (constNames[v] == "x") constVars[v] = constX;
+            if (constNames[v] == "y") constVars[v] = constY;
+            if (constNames[v] == "z") constVars[v] = constZ;
+        }
+        float constResult[3];
+        constExpr.evaluate(constVars, constResult, 3);
+        for (int i = 0; i < 3; ++i)
+        {
+            float expected = (e == 0 ? (constX[i] + constY[i]) * 2.0f + constZ[i] : max(constX[i] + constY[i], 2.0f) * constZ[i]);
+            if (constResult[i] != expected)
+            {
+                setFailed(AString("compiled evaluation of '") + constExprs[e] + "' incorrect at element " + AString::number(i) +
+                          ", expected " + AString::number(expected) + ", got " + AString::number(constResult[i]));
+            }
+        }
+    }
 }
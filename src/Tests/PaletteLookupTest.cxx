@@ -0,0 +1,130 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "PaletteLookupTest.h"
+
+#include "Palette.h"
+#include "PaletteFile.h"
+#include "PaletteLookupTable.h"
+#include "PaletteScalarAndColor.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    //table colors come from the same float operations as the palette search, the tolerance only allows for a different compiler contraction
+    const float TOLERANCE = 1e-5f;
+    const int NUM_RANDOM = 200000;
+}
+
+PaletteLookupTest::PaletteLookupTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void PaletteLookupTest::checkPalette(const Palette* palette, const bool& interpolate)
+{
+    shared_ptr<const PaletteLookupTable> table = palette->getLookupTable(interpolate);
+    if (!table)
+    {
+        setFailed("no lookup table for palette " + palette->getName());
+        return;
+    }
+    vector<float> values;
+    mt19937 myrand(4096);
+    uniform_real_distribution<float> mydist(-1.05f, 1.05f);
+    for (int i = 0; i < NUM_RANDOM; ++i)
+    {
+        values.push_back(mydist(myrand));
+    }
+    //bin edges, and values at and beside each palette scalar, which are in SEGMENT_SEARCH bins
+    for (int i = 0; i <= 4096; ++i)
+    {
+        values.push_back(-1.0f + i * (2.0f / 4096));
+    }
+    const int numScalars = palette->getNumberOfScalarsAndColors();
+    for (int i = 0; i < numScalars; ++i)
+    {
+        const float scalar = palette->getScalarAndColor(i)->getScalar();
+        values.push_back(scalar);
+        values.push_back(nextafterf(scalar, 2.0f));
+        values.push_back(nextafterf(scalar, -2.0f));
+        values.push_back(scalar + 0.5f / 4096);
+        values.push_back(scalar - 0.5f / 4096);
+    }
+    int numBad = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        float tableRGBA[4], exactRGBA[4];
+        table->getPaletteColor(values[i], tableRGBA);
+        palette->getPaletteColor(values[i], interpolate, exactRGBA);
+        for (int c = 0; c < 4; ++c)
+        {
+            if (!(abs(tableRGBA[c] - exactRGBA[c]) <= TOLERANCE))
+            {
+                if (numBad < 5)
+                {
+                    setFailed("palette " + palette->getName() + (interpolate ? " (interpolated)" : "") + " at " + AString::number(values[i]) +
+                              ": lookup table gave " + AString::number(tableRGBA[c]) + ", palette gave " + AString::number(exactRGBA[c]) +
+                              " for component " + AString::number(c));
+                }
+                ++numBad;
+                break;
+            }
+        }
+    }
+    if (numBad > 5)
+    {
+        setFailed("palette " + palette->getName() + ": " + AString::number(numBad) + " values differ in total");
+    }
+}
+
+void PaletteLookupTest::execute()
+{
+    PaletteFile paletteFile;//default palettes have both interpolated segments and constant colors (e.g. videen_style, PSYCH-FIXED without interpolation)
+    const int numPalettes = paletteFile.getNumberOfPalettes();
+    if (numPalettes == 0)
+    {
+        setFailed("no default palettes");
+        return;
+    }
+    for (int i = 0; i < numPalettes; ++i)
+    {
+        const Palette* palette = paletteFile.getPalette(i);
+        checkPalette(palette, false);//SEGMENT_CONSTANT bins, except for 2-color palettes
+        checkPalette(palette, true);//interpolated segments
+    }
+    //a table already handed out must survive a palette change, and the palette must make a new table
+    Palette* palette = paletteFile.getPalette(0);
+    shared_ptr<const PaletteLookupTable> before = palette->getLookupTable(true);
+    palette->setModified();
+    shared_ptr<const PaletteLookupTable> after = palette->getLookupTable(true);
+    if (before == after) setFailed("lookup table not replaced after palette modification");
+    float rgbaBefore[4], rgbaAfter[4];
+    before->getPaletteColor(0.3f, rgbaBefore);
+    after->getPaletteColor(0.3f, rgbaAfter);
+    for (int c = 0; c < 4; ++c)
+    {
+        if (rgbaBefore[c] != rgbaAfter[c]) setFailed("lookup table changed color without a palette change");
+    }
+}
@@ -0,0 +1,196 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "ReductionTest.h"
+
+#include "CaretException.h"
+#include "ReductionOperation.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    enum CheckMode
+    {
+        PLAIN,
+        ONLY_NUMERIC,
+        EXCLUDE_DEV
+    };
+    
+    const float DEV_BELOW = 1.5f, DEV_ABOVE = 1.0f;
+    
+    float scalarReduce(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, const int& mode)
+    {
+        switch (mode)
+        {
+            case ONLY_NUMERIC:
+                return ReductionOperation::reduceOnlyNumeric(data, numElems, type);
+            case EXCLUDE_DEV:
+                return ReductionOperation::reduceExcludeDev(data, numElems, type, DEV_BELOW, DEV_ABOVE);
+            default:
+                return ReductionOperation::reduce(data, numElems, type);
+        }
+    }
+    
+    bool sameResult(const float& left, const float& right)
+    {
+        return left == right || (left != left && right != right);//NaN is a valid result when the input has NaNs
+    }
+    
+    AString modeName(const int& mode)
+    {
+        switch (mode)
+        {
+            case ONLY_NUMERIC:
+                return "only numeric";
+            case EXCLUDE_DEV:
+                return "exclude outliers";
+            default:
+                return "plain";
+        }
+    }
+}
+
+ReductionTest::ReductionTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void ReductionTest::checkCase(const vector<float>& rows, const int64_t& numRows, const int64_t& rowLength, const ReductionEnum::Enum& type, const int& mode)
+{
+    const AString caseName = ReductionEnum::toName(type) + ", " + modeName(mode) + ", length " + AString::number(rowLength);
+    vector<float> expected(numRows);
+    AString expectedError;
+    for (int64_t r = 0; r < numRows; ++r)
+    {
+        try
+        {
+            expected[r] = scalarReduce(rows.data() + r * rowLength, rowLength, type, mode);
+        } catch (CaretException& e) {
+            expectedError = e.whatString();//the parallel versions report the error from the lowest index
+            break;
+        }
+    }
+    vector<float> transposed(numRows * rowLength);//reduceAcross reduces element r over arrays j
+    for (int64_t r = 0; r < numRows; ++r)
+    {
+        for (int64_t j = 0; j < rowLength; ++j)
+        {
+            transposed[j * numRows + r] = rows[r * rowLength + j];
+        }
+    }
+    vector<const float*> arrays(rowLength);
+    for (int64_t j = 0; j < rowLength; ++j)
+    {
+        arrays[j] = transposed.data() + j * numRows;
+    }
+    for (int direction = 0; direction < 2; ++direction)
+    {
+        const AString directionName = (direction == 0 ? "reduceRows" : "reduceAcross");
+        vector<float> results(numRows);
+        AString error;
+        try
+        {
+            if (direction == 0)
+            {
+                if (mode == EXCLUDE_DEV)
+                {
+                    ReductionOperation::reduceRowsExcludeDev(rows.data(), numRows, rowLength, type, DEV_BELOW, DEV_ABOVE, results.data());
+                } else {
+                    ReductionOperation::reduceRows(rows.data(), numRows, rowLength, type, results.data(), mode == ONLY_NUMERIC);
+                }
+            } else {
+                if (mode == EXCLUDE_DEV)
+                {
+                    ReductionOperation::reduceAcrossExcludeDev(arrays, numRows, type, DEV_BELOW, DEV_ABOVE, results.data());
+                } else {
+                    ReductionOperation::reduceAcross(arrays, numRows, type, results.data(), mode == ONLY_NUMERIC);
+                }
+            }
+        } catch (CaretException& e) {
+            error = e.whatString();
+        }
+        if (error != expectedError)
+        {
+            setFailed(directionName + " (" + caseName + ") gave error '" + error + "', scalar reduction gave '" + expectedError + "'");
+            return;
+        }
+        if (expectedError != "") continue;
+        for (int64_t r = 0; r < numRows; ++r)
+        {
+            if (!sameResult(results[r], expected[r]))
+            {
+                setFailed(directionName + " (" + caseName + ") gave " + AString::number(results[r]) + " for row " + AString::number(r) +
+                          ", scalar reduction gave " + AString::number(expected[r]));
+                return;
+            }
+        }
+    }
+}
+
+void ReductionTest::execute()
+{
+    //more rows than one chunk of the across-array path, small integer values so there are ties for mode, median and the index reductions
+    const int64_t numRows = 2500;
+    const int64_t rowLengths[] = { 1, 2, 3, 6, 7 };//even lengths average the middle two for median, length 1 hits the sample stdev errors
+    const float nan = numeric_limits<float>::quiet_NaN();
+    mt19937 generator(1);
+    uniform_int_distribution<int> valueDist(-3, 3), nanDist(0, 9);
+    vector<ReductionEnum::Enum> allTypes;
+    ReductionEnum::getAllEnums(allTypes);
+    for (size_t lengthIndex = 0; lengthIndex < sizeof(rowLengths) / sizeof(rowLengths[0]); ++lengthIndex)
+    {
+        const int64_t rowLength = rowLengths[lengthIndex];
+        vector<float> rows(numRows * rowLength), numericRows;
+        for (int64_t r = 0; r < numRows; ++r)
+        {
+            for (int64_t j = 0; j < rowLength; ++j)
+            {
+                rows[r * rowLength + j] = valueDist(generator) * 0.5f;
+            }
+            if (r % 5 == 0)
+            {//all equal, a tie everywhere
+                for (int64_t j = 1; j < rowLength; ++j) rows[r * rowLength + j] = rows[r * rowLength];
+            }
+        }
+        numericRows = rows;
+        for (int64_t r = 0; r < numRows; ++r)
+        {//NaNs, but always leave at least 2 numeric values so -only-numeric doesn't run out
+            for (int64_t j = 2; j < rowLength; ++j)
+            {
+                if (nanDist(generator) == 0) rows[r * rowLength + j] = nan;
+            }
+        }
+        for (size_t t = 0; t < allTypes.size(); ++t)
+        {
+            checkCase(numericRows, numRows, rowLength, allTypes[t], PLAIN);
+            checkCase(rows, numRows, rowLength, allTypes[t], PLAIN);
+            checkCase(rows, numRows, rowLength, allTypes[t], ONLY_NUMERIC);
+            checkCase(rows, numRows, rowLength, allTypes[t], EXCLUDE_DEV);
+            if (failed()) return;
+        }
+    }
+    vector<float> allNaN(numRows * 3, nan);//every row non-numeric, the error must come back out of the parallel loops
+    checkCase(allNaN, numRows, 3, ReductionEnum::MEAN, ONLY_NUMERIC);
+    checkCase(allNaN, numRows, 3, ReductionEnum::MEDIAN, EXCLUDE_DEV);
+}
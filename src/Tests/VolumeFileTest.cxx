@@ -19,6 +19,7 @@
 /*LICENSE_END*/
 #include "VolumeFileTest.h"
 
+#include "CaretOMP.h"
 #include "FloatMatrix.h"
 #include "VolumeFile.h"
 
@@ -27,6 +28,51 @@
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    //value depends only on brick, component and voxel, so anything read from the wrong brick shows up
+    float onDemandTestValue(const int64_t& brick, const int64_t& component, const int64_t& voxel)
+    {
+        return brick * 10000.0f + component * 1000.0f + voxel;
+    }
+    
+    struct OnDemandTestReader : public AbstractVolumeFrameReader
+    {
+        int64_t m_frameSize, m_numComponents;
+        int64_t m_dims[3];
+        OnDemandTestReader(const int64_t dims[3], const int64_t& numComponents)
+        {
+            m_dims[0] = dims[0]; m_dims[1] = dims[1]; m_dims[2] = dims[2];
+            m_frameSize = dims[0] * dims[1] * dims[2];
+            m_numComponents = numComponents;
+        }
+        void readBrick(const int64_t& brickIndex, float* const* componentFramesOut)
+        {
+            for (int64_t c = 0; c < m_numComponents; ++c)
+            {
+                for (int64_t v = 0; v < m_frameSize; ++v)
+                {
+                    componentFramesOut[c][v] = onDemandTestValue(brickIndex, c, v);
+                }
+            }
+        }
+        void readVoxel(const int64_t indexIn[3], const int64_t& brickIndex, float* componentValuesOut)
+        {
+            const int64_t voxel = indexIn[0] + m_dims[0] * (indexIn[1] + m_dims[1] * indexIn[2]);
+            for (int64_t c = 0; c < m_numComponents; ++c)
+            {
+                componentValuesOut[c] = onDemandTestValue(brickIndex, c, voxel);
+            }
+        }
+    };
+    
+    class OnDemandTestVolume : public VolumeFile
+    {
+    public:
+        using VolumeFile::setReadingOnDemand;
+    };
+}
+
 VolumeFileTest::VolumeFileTest(const AString& identifier) : TestInterface(identifier)
 {
 }
@@ -110,4 +156,55 @@ void VolumeFileTest::execute()
             }
         }
     }
+    onDemandTest();
+}
+
+void VolumeFileTest::onDemandTest()
+{
+    const int64_t dims[3] = { 7, 5, 3 }, numBricks = 64, numComponents = 2;
+    const int64_t frameSize = dims[0] * dims[1] * dims[2];
+    vector<int64_t> myDims(dims, dims + 3);
+    myDims.push_back(numBricks);
+    OnDemandTestVolume myTestVol;
+    myTestVol.reinitialize(myDims, FloatMatrix::identity(4).getMatrix(), numComponents);
+    myTestVol.setReadingOnDemand(CaretPointer<AbstractVolumeFrameReader>(new OnDemandTestReader(dims, numComponents)), 0);//cache only holds the minimum number of bricks
+    AString failMessage;
+    const int64_t numPasses = 8;
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t iter = 0; iter < numPasses * numBricks; ++iter)
+    {
+        const int64_t b = (iter * 7) % numBricks, c = iter % numComponents;//jump around so threads keep evicting each other's bricks
+        VolumeFramePin framePin;
+        const float* frame = myTestVol.getFrame(b, c, framePin);
+        vector<float> frameData;
+        myTestVol.getFileDataFrame((b + 1) % numBricks, frameData);//read another brick while holding this one
+        for (int64_t v = 0; v < frameSize; ++v)
+        {
+            if (frame[v] != onDemandTestValue(b, c, v) ||
+                frameData[v + c * frameSize] != onDemandTestValue((b + 1) % numBricks, c, v))
+            {
+#pragma omp critical
+                {
+                    failMessage = "on-demand frame " + AString::number(b) + " component " + AString::number(c) + " had wrong value at voxel " + AString::number(v);
+                }
+                break;
+            }
+        }
+    }
+    if (failMessage != "")
+    {
+        setFailed(failMessage);
+        return;
+    }
+    const int64_t voxel[3] = { 3, 2, 1 };
+    vector<float> timeCourse(numBricks);
+    myTestVol.getValueAllBricks(voxel, timeCourse.data(), 1);
+    for (int64_t b = 0; b < numBricks; ++b)
+    {
+        if (timeCourse[b] != onDemandTestValue(b, 1, voxel[0] + dims[0] * (voxel[1] + dims[1] * voxel[2])))
+        {
+            setFailed("on-demand time course was wrong at brick " + AString::number(b));
+            return;
+        }
+    }
 }
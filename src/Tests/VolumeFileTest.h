@@ -29,6 +29,8 @@ namespace caret {
     public:
         VolumeFileTest(const AString& identifier);
         virtual void execute();
+    private:
+        void onDemandTest();
     };
 
 }
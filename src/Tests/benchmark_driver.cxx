@@ -0,0 +1,125 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+//program for running performance benchmarks
+
+#include <iostream>
+#include <vector>
+
+#include <QCoreApplication>
+
+#include "BenchmarkSuite.h"
+#include "CaretCommandLine.h"
+#include "CaretException.h"
+#include "SessionManager.h"
+
+using namespace std;
+using namespace caret;
+
+namespace
+{
+    void printUsage()
+    {
+        cout << "usage: benchmark_driver <output.json> [options]" << endl;
+        cout << endl;
+        cout << "   -threads <n,n,...>   thread counts for threaded kernels (default powers of 2" << endl;
+        cout << "                           up to the openmp maximum)" << endl;
+        cout << "   -repeats <n>         timed runs per kernel, after one warmup (default 3)" << endl;
+        cout << "   -vertices <n>        sphere vertices (default 32492)" << endl;
+        cout << "   -timepoints <n>      dtseries length (default 400)" << endl;
+        cout << "   -volume-dim <n>      volume size in each dimension (default 96)" << endl;
+        cout << "   -seed <n>            random seed for the synthetic data (default 12345)" << endl;
+        cout << "   -work-dir <dir>      directory for the io kernel files (default temporary)" << endl;
+        cout << "   -kernel <name>       run only this kernel, can be repeated" << endl;
+        cout << endl;
+        cout << "kernels:" << endl;
+        vector<AString> names = BenchmarkSuite::getKernelNames();
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            cout << "   " << names[i] << endl;
+        }
+    }
+
+    int toPositiveInt(const AString& option, const AString& value)
+    {
+        bool ok = false;
+        int ret = value.toInt(&ok);
+        if (!ok || ret < 1) throw CaretException("option " + option + " requires a positive integer, got '" + value + "'");
+        return ret;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int ret = 0;
+    {
+        QCoreApplication myApp(argc, argv);
+        caret_global_commandLine_init(argc, argv);
+        SessionManager::createSessionManager(ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE);
+        try
+        {
+            if (argc < 2 || AString(argv[1]).startsWith("-"))
+            {
+                printUsage();
+                ret = 1;
+            } else {
+                const AString outputName = argv[1];
+                BenchmarkSuite::Options myOptions;
+                for (int i = 2; i < argc; ++i)
+                {
+                    const AString option = argv[i];
+                    if (i + 1 >= argc) throw CaretException("option " + option + " requires an argument");
+                    const AString value = argv[++i];
+                    if (option == "-threads")
+                    {
+                        QStringList counts = value.split(",");
+                        for (int j = 0; j < counts.size(); ++j)
+                        {
+                            myOptions.m_threadCounts.push_back(toPositiveInt(option, counts[j]));
+                        }
+                    } else if (option == "-repeats") {
+                        myOptions.m_repeats = toPositiveInt(option, value);
+                    } else if (option == "-vertices") {
+                        myOptions.m_sphereVertices = toPositiveInt(option, value);
+                    } else if (option == "-timepoints") {
+                        myOptions.m_timepoints = toPositiveInt(option, value);
+                    } else if (option == "-volume-dim") {
+                        myOptions.m_volumeDim = toPositiveInt(option, value);
+                    } else if (option == "-seed") {
+                        myOptions.m_seed = toPositiveInt(option, value);
+                    } else if (option == "-work-dir") {
+                        myOptions.m_workDir = value;
+                    } else if (option == "-kernel") {
+                        myOptions.m_kernels.push_back(value);
+                    } else {
+                        throw CaretException("unrecognized option '" + option + "'");
+                    }
+                }
+                BenchmarkSuite mySuite(myOptions);
+                if (!mySuite.run(outputName)) ret = 1;
+            }
+        } catch (CaretException& e) {
+            cout << "benchmark failed: " << e.whatString() << endl;
+            ret = 1;
+        }
+        SessionManager::deleteSessionManager();
+    }
+    return ret;
+}
@@ -33,7 +33,9 @@
 #include "CaretException.h"
 
 //tests
+#include "ChartDecimationTest.h"
 #include "CiftiFileTest.h"
+#include "CorrelationGradientTest.h"
 #include "DotTest.h"
 #include "GeodesicHelperTest.h"
 #include "HttpTest.h"
@@ -41,9 +43,11 @@
 #include "LookupTest.h"
 #include "MathExpressionTest.h"
 #include "NiftiTest.h"
+#include "PaletteLookupTest.h"
 #include "PointerTest.h"
 #include "ProgressTest.h"
 #include "QuatTest.h"
+#include "ReductionTest.h"
 #include "StatisticsTest.h"
 #include "TimerTest.h"
 #include "TopologyHelperTest.h"
@@ -69,7 +73,9 @@ int main(int argc, char** argv)
         caret_global_commandLine_init(argc, argv);
         SessionManager::createSessionManager(ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE);
         vector<TestInterface*> mytests;
+        mytests.push_back(new ChartDecimationTest("chartdecimation"));
         mytests.push_back(new CiftiFileTest("ciftifile"));
+        mytests.push_back(new CorrelationGradientTest("correlationgradient"));
         mytests.push_back(new DotTest("dotsimd"));
         mytests.push_back(new GeodesicHelperTest("geohelp"));
         mytests.push_back(new HeapTest("heap"));
@@ -78,9 +84,11 @@ int main(int argc, char** argv)
         mytests.push_back(new MathExpressionTest("mathexpression"));
         mytests.push_back(new NiftiFileTest("niftifile"));
         mytests.push_back(new NiftiHeaderTest("niftiheader"));
+        mytests.push_back(new PaletteLookupTest("palettelookup"));
         mytests.push_back(new PointerTest("pointer"));
         mytests.push_back(new ProgressTest("progress"));
         mytests.push_back(new QuatTest("quaternion"));
+        mytests.push_back(new ReductionTest("reduction"));
         mytests.push_back(new StatisticsTest("statistics"));
         mytests.push_back(new TimerTest("timer"));
         mytests.push_back(new TopologyHelperTest("topohelp"));